@@ -198,11 +198,20 @@ BASE_API_GET, HTTP_HEAD | API.http_get()
 BASE_API_PUT | API.http_put()
 BASE_API_DELETE | API.http_delete()
 
+A GET of a key scan (E.g. //lmdb/entity/~from:k1~to:k2~limit:100, see Persisted::scan()), an index lookup (E.g.
+//lmdb/entity/~index:url~eq:/index.html, see Persisted::lookup()) or a block-log dump or restore (E.g. //lmdb/entity/~dump:a.log,
+see Persisted::dump()) is parsed as APPLY_URL with the whole locator in q_state.url since its arguments do not fit in a Name. The
+container parses it in its get(p_txn, p_what).
+
+A GET of a chain of filters (E.g. //lmdb/e/x[//lmdb/e/f1][//lmdb/e/f2], each filter selecting from the result of the previous one) is
+parsed as APPLY_FILTER with the first filter in q_state.r_value and the rest in q_state.url. get() fuses them with new_fused_filter()
+and selects once. Chains are not supported in the right part of an assignment.
+
 */
 bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurse) {
 
 	int buf_size;
-	pChar p_out;
+	pChar p_out, p_chain = nullptr;
 
 	if (!recurse) {
 		q_state.l_node[0] = 0;
@@ -390,9 +399,30 @@ bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurs
 
 					return true;
 				}
+				if (strcmp("arrow", p_url) == 0) {
+					q_state.state = PSTATE_COMPLETE_OK;
+					q_state.apply = APPLY_ARROW;
+
+					return true;
+				}
+				if (strcmp("npy", p_url) == 0) {
+					q_state.state = PSTATE_COMPLETE_OK;
+					q_state.apply = APPLY_NPY;
+
+					return true;
+				}
 				if (method != BASE_API_GET)
 					return false;
 
+				if (*p_url == 'T') {
+					if (!parse_slice(q_state, p_url - 1))
+						return false;
+
+					q_state.state = PSTATE_COMPLETE_OK;
+					q_state.apply = APPLY_SLICE;
+
+					return true;
+				}
 				if (strcmp("new", p_url) == 0) {
 					q_state.state = PSTATE_COMPLETE_OK;
 					q_state.apply = APPLY_NEW_ENTITY;
@@ -432,7 +462,21 @@ bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurs
 				return false;
 
 			case ':':
-				if (method != BASE_API_GET || strlen(p_url) >= NAME_SIZE)
+				if (method != BASE_API_GET)
+					return false;
+
+				if (!recurse && is_key_scan(q_state.key)) {
+					if (   q_state.l_node[0] == 0
+						&& snprintf(q_state.url, MAX_FILE_OR_URL_SIZE, "//%s/%s/%s:%s", q_state.base, q_state.entity, q_state.key,
+									p_url) >= MAX_FILE_OR_URL_SIZE)
+						return false;
+
+					q_state.apply = APPLY_URL;
+					q_state.state = PSTATE_COMPLETE_OK;
+
+					return true;
+				}
+				if (strlen(p_url) >= NAME_SIZE)
 					return false;
 
 				strcpy(q_state.name, p_url);
@@ -482,6 +526,15 @@ bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurs
 				case APPLY_TEXT:
 					q_state.apply = APPLY_ASSIGN_TEXT;
 					return true;
+				case APPLY_ARROW:
+					q_state.apply = APPLY_ASSIGN_ARROW;
+					return true;
+				case APPLY_NPY:
+					q_state.apply = APPLY_ASSIGN_NPY;
+					return true;
+				case APPLY_SLICE:
+					q_state.apply = APPLY_ASSIGN_SLICE;
+					return true;
 				}
 				q_state.state = PSTATE_FAILED;
 
@@ -491,11 +544,17 @@ bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurs
 				if (method != BASE_API_GET)
 					return false;
 
-				if (*p_url == '&' && move_const((pChar) &q_state.url, MAX_FILE_OR_URL_SIZE, p_url) == RET_MV_CONST_NOTHING)
-					q_state.apply = APPLY_FILT_CONST;
-				else if (	*p_url == '/'
-						 && ((recurse && parse_locator(q_state.rr_value, p_url)) || (!recurse && parse_locator(q_state.r_value, p_url))))
+				if (*p_url != '&' && *p_url != '/') {
+					if (!parse_slice(q_state, p_url - 1))
+						return false;
 
+					q_state.apply = APPLY_SLICE;
+				} else if (*p_url == '&' && move_const((pChar) &q_state.url, MAX_FILE_OR_URL_SIZE, p_url) == RET_MV_CONST_NOTHING)
+					q_state.apply = APPLY_FILT_CONST;
+				else if (*p_url == '/' && recurse && parse_locator(q_state.rr_value, p_url))
+					q_state.apply = APPLY_FILTER;
+				else if (	*p_url == '/' && !recurse && parse_locator(q_state.r_value, p_url, &p_chain)
+						 && (p_chain == nullptr || parse_filter_chain(q_state, p_chain)))
 					q_state.apply = APPLY_FILTER;
 				else
 					return false;
@@ -545,12 +604,14 @@ bool BaseAPI::parse(ApiQueryState &q_state, pChar p_url, int method, bool recurs
 
 /** Parse a simple //base/entity/key string (Used inside the main API.parse()).
 
-	\param loc	 A Locator to store the result (that will be left in undetermined on error).
-	\param p_url The input string.
+	\param loc		A Locator to store the result (that will be left in undetermined on error).
+	\param p_url	The input string.
+	\param pp_next	(optional) In a chain of filters, it accepts a "[" after the closing "]" and returns a pointer to it (or nullptr
+					if the string ends after the "]" or without one).
 
 	\return		 `true` if successful.
 */
-bool BaseAPI::parse_locator(Locator &loc, pChar p_url) {
+bool BaseAPI::parse_locator(Locator &loc, pChar p_url, pChar *pp_next) {
 
 	int buf_size, state = PSTATE_INITIAL;
 	pChar p_out;
@@ -604,9 +665,19 @@ bool BaseAPI::parse_locator(Locator &loc, pChar p_url) {
 
 			switch (cursor) {
 			case 0:
+				if (pp_next != nullptr)
+					*pp_next = nullptr;
+
 				return true;
-			case ')':
 			case ']':
+				if (pp_next != nullptr) {
+					*pp_next = *(p_url) == '[' ? p_url : nullptr;
+
+					return *(p_url) == 0 || *(p_url) == '[';
+				}
+				return *(p_url) == 0;
+
+			case ')':
 				return *(p_url) == 0;
 			}
 			return false;
@@ -687,12 +758,12 @@ In the BaseAPI class, this implements all the apply cases from APPLY_NOTHING to
 What the aseAPI class does is forwarding the request to the right container (if the base is found, returning SERVICE_ERROR_WRONG_BASE
 if not).
 
-In the descendants (Core and ModelsAPI) it should support the range from APPLY_NOTHING to APPLY_TEXT. This includes function calls
+In the descendants (Core and ModelsAPI) it should support the range from APPLY_NOTHING to APPLY_SLICE. This includes function calls
 APPLY_FUNCTION and APPLY_FUNCT_CONST, but also APPLY_FILTER and APPLY_FILT_CONST to select from the result of a function call.
 Also, APPLY_URL is very convenient for passing text as an argument to a function. APPLY_NOTHING can return some metadata about
-the model including a list of endpoints. APPLY_NAME can define specifics of an endpoint. APPLY_RAW and APPLY_TEXT can be used to
-select the favorite serialization format of the result. Therefore, the function interface should be considered as the whole range
-and not just APPLY_FUNCTION.
+the model including a list of endpoints. APPLY_NAME can define specifics of an endpoint. APPLY_RAW, APPLY_TEXT, APPLY_ARROW and
+APPLY_NPY can be used to select the favorite serialization format of the result and APPLY_SLICE a strided view of it. Therefore, the function
+interface should be considered as the whole range and not just APPLY_FUNCTION.
 */
 StatusCode BaseAPI::get(pTransaction &p_txn, ApiQueryState &what) {
 
@@ -701,13 +772,13 @@ StatusCode BaseAPI::get(pTransaction &p_txn, ApiQueryState &what) {
 	p_txn = nullptr;
 
 	switch (what.apply) {
-	case APPLY_NOTHING ... APPLY_TEXT:
+	case APPLY_NOTHING ... APPLY_SLICE:
 		if (what.l_node[0] != 0)
 			return p_channels->forward_get(p_txn, what.l_node, what.url);
 
 		return get_left_local(p_txn, what);
 
-	case APPLY_ASSIGN_NOTHING ... APPLY_ASSIGN_TEXT:
+	case APPLY_ASSIGN_NOTHING ... APPLY_ASSIGN_SLICE:
 		if (what.r_node[0] != 0)
 			ret = get_right_remote(p_txn, what);
 		else
@@ -835,7 +906,8 @@ makes intensive use of WRITE_AS_STRING, WRITE_AS_CONTENT, ... Also, it is nice t
 WRITE_ONLY_IF_NOT_EXISTS to support things like one-time initialization or preventing undesired creation of new variables. Therefore,
 think twice before completely removing mode even if the http API does not use it. At Bebop level and model level, it can be used.
 
-NOTE: From an API perspective, put() only supports: APPLY_NOTHING, APPLY_RAW, APPLY_TEXT and APPLY_URL (both local and remote).
+NOTE: From an API perspective, put() only supports: APPLY_NOTHING, APPLY_RAW, APPLY_TEXT, APPLY_ARROW, APPLY_NPY and APPLY_URL (both
+local and remote).
 */
 StatusCode BaseAPI::put(ApiQueryState &where, pBlock p_block, int mode) {
 
@@ -885,6 +957,21 @@ StatusCode BaseAPI::put(ApiQueryState &where, pBlock p_block, int mode) {
 
 		return ret;
 
+	case APPLY_ARROW:
+	case APPLY_NPY:
+		ret = where.apply == APPLY_ARROW ? new_from_arrow(p_aux, p_block) : new_from_npy(p_aux, p_block);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		memcpy(&loc, &where.base, SIZE_OF_BASE_ENT_KEY);
+
+		ret = p_container->put(loc, p_aux->p_block);
+
+		destroy_transaction(p_aux);
+
+		return ret;
+
 	case APPLY_URL:
 		return p_container->put(where.url, p_block);
 
@@ -951,7 +1038,7 @@ bool BaseAPI::block_from_const(pTransaction &p_txn, pChar p_const, bool make_tup
 
 	p_txn = nullptr;
 
-	pTransaction p_text, p_tensor, p_result;
+	pTransaction p_text, p_tensor;
 
 	int dim[MAX_TENSOR_RANK] = {0};
 
@@ -980,28 +1067,33 @@ bool BaseAPI::block_from_const(pTransaction &p_txn, pChar p_const, bool make_tup
 		return true;
 	}
 
-	dim[0] = RESULT_BUFFER_SIZE;
-	dim[1] = 0;
-	if (new_block(p_result, CELL_TYPE_BYTE, &dim[0], FILL_NEW_WITH_ZERO) !=  SERVICE_NO_ERROR) {
-		destroy_transaction(p_tensor);
+	ItemHeader item[2];
+	Name	   names[2]		= {"input", "result"};
+	int		   str_bytes[2] = {0, 0};
 
-		return false;
-	}
+	pBlock p_input = p_tensor->p_block;
 
-	StaticBlockHeader hea[2];
-	Name			  names[2]	 = {"input", "result"};
-	pBlock			  p_block[2] = {p_tensor->p_block, p_result->p_block};
+	item[0].cell_type = p_input->cell_type;
+	p_input->get_dimensions(item[0].dim);
 
-	memcpy(&hea[0], p_block[0], sizeof(StaticBlockHeader));
-	memcpy(&hea[1], p_block[1], sizeof(StaticBlockHeader));
+	item[1].cell_type = CELL_TYPE_BYTE;
+	memset(item[1].dim, 0, sizeof(item[1].dim));
+	item[1].dim[0] = RESULT_BUFFER_SIZE;
 
-	p_block[0]->get_dimensions(hea[0].range.dim);
-	p_block[1]->get_dimensions(hea[1].range.dim);
+	str_bytes[0] = p_input->total_bytes - Tuple::item_total_bytes(item[0].cell_type, item[0].dim);
 
-	int ret = new_block(p_txn, 2, hea, names, p_block);
+	int ret = new_tuple_block(p_txn, 2, item, names, str_bytes);
+
+	if (ret == SERVICE_NO_ERROR) {
+		memcpy(pTuple(p_txn->p_block)->get_block(0), p_input, p_input->total_bytes);
+
+		pBlock p_result = pTuple(p_txn->p_block)->get_block(1);
+
+		memset(&p_result->tensor, 0, RESULT_BUFFER_SIZE);
+		p_result->has_NA = false;
+	}
 
 	destroy_transaction(p_tensor);
-	destroy_transaction(p_result);
 
 	return ret == SERVICE_NO_ERROR;
 }
@@ -63,6 +63,7 @@ using namespace jazz_elements;
 
 #define RESULT_BUFFER_SIZE				  4096	///< The "result" item size in a Tuple used in a modify() call.
 #define SIZE_BUFFER_REMOTE_CALL			  2048	///< The size of the buffer in which URLS for remote calls are built.
+#define MAX_FILTER_CHAIN					 8	///< The maximum number of filters in a chain //base/entity/key[//f1][//f2]..
 
 #define BASE_API_GET						 3	///< This is numerically equivalent to HTTP_GET in api.h http predicate GET
 #define BASE_API_PUT						 4	///< This is numerically equivalent to HTTP_PUT in api.h http predicate PUT
@@ -188,7 +189,75 @@ class BaseAPI : public Container {
 #endif
 
 		bool parse_locator (Locator &loc,
-							pChar	 p_url);
+							pChar	 p_url,
+							pChar	*pp_next = nullptr);
+
+		/** Check the rest of a chain of filters (an internal part of parse()).
+
+			\param q_state	The structure containing the parts of the url parsed so far. The first filter is already in q_state.r_value.
+			\param p_chain	The rest of the chain. E.g., "[//lmdb/e/f2][//lmdb/e/f3]" in //lmdb/e/x[//lmdb/e/f1][//lmdb/e/f2][//lmdb/e/f3]
+
+			\return			`true` if successful.
+
+		The rest of the chain is kept as text in q_state.url (unless it is forwarded, then q_state.url already has the whole url) and it
+		is parsed again by get_filter_chain() to get the filters.
+		*/
+		inline bool parse_filter_chain(ApiQueryState &q_state, pChar p_chain) {
+
+			Locator loc;
+			pChar	p_next = p_chain;
+
+			for (int num_filters = 1; p_next != nullptr; num_filters++) {
+				if (num_filters == MAX_FILTER_CHAIN || p_next[1] != '/' || !parse_locator(loc, &p_next[1], &p_next))
+					return false;
+			}
+
+			if (q_state.l_node[0] == 0) {
+				if (strlen(p_chain) >= MAX_FILE_OR_URL_SIZE)
+					return false;
+
+				strcpy(q_state.url, p_chain);
+			}
+
+			return true;
+		}
+
+		/** Check the syntax of a strided view (an internal part of parse()).
+
+			\param q_state	The structure containing the parts of the url parsed so far.
+			\param p_slice	The slices and transposes. E.g., "[::2,10:20].T" in //lmdb/e/x[::2,10:20].T
+
+			\return			`true` if successful.
+
+		The shape of the tensor is not known yet, so this only checks it on a dummy view of MAX_TENSOR_RANK large dimensions.
+		The text is kept in q_state.url (unless it is forwarded, then q_state.url already has the whole url) and it is applied by
+		get_slice() to the real tensor.
+		*/
+		inline bool parse_slice(ApiQueryState &q_state, pChar p_slice) {
+
+			StridedView view;
+
+			view.p_block = nullptr;
+			view.rank	 = MAX_TENSOR_RANK;
+			view.offset	 = 0;
+
+			for (int i = 0; i < MAX_TENSOR_RANK; i++) {
+				view.shape[i]  = 1 << 24;
+				view.stride[i] = 0;
+			}
+
+			if (!slice_view(view, p_slice))
+				return false;
+
+			if (q_state.l_node[0] == 0) {
+				if (strlen(p_slice) >= MAX_FILE_OR_URL_SIZE)
+					return false;
+
+				strcpy(q_state.url, p_slice);
+			}
+
+			return true;
+		}
 
 		/** Copy the string "as-is" (without percent-decoding) a string into a buffer.
 
@@ -263,6 +332,26 @@ class BaseAPI : public Container {
 			return ret;
 		}
 
+		/** Check if a key (already parsed, before a ':') is the beginning of a key scan, an index lookup, a block-log dump or restore
+			or a snapshot.
+
+			\param p_key	The key.
+
+			\return			True if it starts with ~ and ends with ~from, ~after, ~to, ~prefix, ~limit, ~index, ~eq, ~codec, ~dump,
+							~restore or ~snapshot. (E.g., "~blocks~from")
+		*/
+		inline bool is_key_scan(pChar p_key) {
+			if (p_key[0] != '~')
+				return false;
+
+			p_key = strrchr(p_key, '~');
+
+			return	  strcmp(p_key, "~from") == 0 || strcmp(p_key, "~after") == 0 || strcmp(p_key, "~to") == 0
+				   || strcmp(p_key, "~prefix") == 0 || strcmp(p_key, "~limit") == 0 || strcmp(p_key, "~index") == 0
+				   || strcmp(p_key, "~eq") == 0 || strcmp(p_key, "~codec") == 0 || strcmp(p_key, "~dump") == 0
+				   || strcmp(p_key, "~restore") == 0 || strcmp(p_key, "~snapshot") == 0;
+		}
+
 		/** This is an internal part of get() made independent to keep the function less crowded.
 
 			\param p_txn		A pointer to the transaction that will be used to store the result.
@@ -272,7 +361,7 @@ class BaseAPI : public Container {
 
 		Context: This in any possible assignment in which the right part is NOT a remote call. Functionally, it is similar to
 		get_left_local(), but since it is the right of an assignment, arguments are stored at a different place and also, apply
-		code are in range APPLY_ASSIGN_NOTHING..APPLY_ASSIGN_CONST instead of APPLY_NOTHING..APPLY_TEXT.
+		code are in range APPLY_ASSIGN_NOTHING..APPLY_ASSIGN_CONST instead of APPLY_NOTHING..APPLY_SLICE.
 		It returns the final block as it will be returned with a new_block() interface.
 		*/
 		inline StatusCode get_right_local(pTransaction &p_txn, ApiQueryState &q_state) {
@@ -413,6 +502,24 @@ class BaseAPI : public Container {
 				p_container->destroy_transaction(p_aux);
 
 				return SERVICE_NO_ERROR;
+
+			case APPLY_ASSIGN_ARROW:
+			case APPLY_ASSIGN_NPY:
+				if (p_container->get(p_aux, q_state.r_value) != SERVICE_NO_ERROR)
+					return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+				if ((q_state.apply == APPLY_ASSIGN_ARROW ? new_arrow(p_txn, p_aux->p_block) : new_npy(p_txn, p_aux->p_block))
+					!= SERVICE_NO_ERROR) {
+					p_container->destroy_transaction(p_aux);
+
+					return SERVICE_ERROR_IO_ERROR;
+				}
+				p_container->destroy_transaction(p_aux);
+
+				return SERVICE_NO_ERROR;
+
+			case APPLY_ASSIGN_SLICE:
+				return get_slice(p_txn, p_container, q_state.r_value, q_state.url);
 			}
 			return SERVICE_ERROR_MISC_SERVER;
 		}
@@ -462,6 +569,15 @@ class BaseAPI : public Container {
 			case APPLY_ASSIGN_TEXT:
 				sprintf(buffer_2k, "//%s/%s/%s.text", q_state.r_value.base, q_state.r_value.entity, q_state.r_value.key);
 				break;
+			case APPLY_ASSIGN_ARROW:
+				sprintf(buffer_2k, "//%s/%s/%s.arrow", q_state.r_value.base, q_state.r_value.entity, q_state.r_value.key);
+				break;
+			case APPLY_ASSIGN_NPY:
+				sprintf(buffer_2k, "//%s/%s/%s.npy", q_state.r_value.base, q_state.r_value.entity, q_state.r_value.key);
+				break;
+			case APPLY_ASSIGN_SLICE:
+				sprintf(buffer_2k, "//%s/%s/%s%s", q_state.r_value.base, q_state.r_value.entity, q_state.r_value.key, q_state.url);
+				break;
 			default:
 				return SERVICE_ERROR_WRONG_ARGUMENTS;
 			}
@@ -471,11 +587,103 @@ class BaseAPI : public Container {
 		/** This is an internal part of get() made independent to keep the function less crowded.
 
 			\param p_txn		A pointer to the transaction that will be used to store the result.
+			\param p_container	The Container of the l_value.
 			\param q_state		The structure containing the parts of the url successfully parsed.
 
 			\return				SERVICE_NO_ERROR if successful, or an error code.
 
-		Context: This is called when q_state.apply is APPLY_NOTHING ... APPLY_TEXT and there is no forwarding.
+		Context: This is an APPLY_FILTER with a chain of filters. The first one is q_state.r_value and the rest are still in q_state.url
+				 (E.g., "[//lmdb/e/f2][//lmdb/e/f3]"). The filters are fused by new_fused_filter() into one, so the rows of the l_value
+				 are gathered once, instead of copying a whole intermediate block per filter.
+		*/
+		inline StatusCode get_filter_chain(pTransaction &p_txn, pContainer p_container, ApiQueryState &q_state) {
+
+			pTransaction p_filter[MAX_FILTER_CHAIN], p_fused;
+			pContainer	 p_owner [MAX_FILTER_CHAIN];
+			pBlock		 p_block [MAX_FILTER_CHAIN];
+			Locator		 loc;
+			pChar		 p_next		 = q_state.url;
+			int			 num_filters = 0;
+			StatusCode	 ret		 = SERVICE_NO_ERROR;
+
+			memcpy(&loc, &q_state.r_value, SIZE_OF_BASE_ENT_KEY);
+
+			while (true) {
+				p_owner[num_filters] = (pContainer) base_server[TenBitsAtAddress(loc.base)];
+
+				if (p_owner[num_filters] == nullptr) {
+					ret = SERVICE_ERROR_WRONG_BASE;
+					break;
+				}
+				if (p_owner[num_filters]->get(p_filter[num_filters], loc) != SERVICE_NO_ERROR) {
+					ret = SERVICE_ERROR_BLOCK_NOT_FOUND;
+					break;
+				}
+				p_block[num_filters] = p_filter[num_filters]->p_block;
+				num_filters++;
+
+				if (p_next == nullptr)
+					break;
+
+				if (num_filters == MAX_FILTER_CHAIN || !parse_locator(loc, &p_next[1], &p_next)) {
+					ret = SERVICE_ERROR_WRONG_ARGUMENTS;
+					break;
+				}
+			}
+
+			if (ret == SERVICE_NO_ERROR && (ret = new_fused_filter(p_fused, p_block, num_filters)) == SERVICE_NO_ERROR) {
+				memcpy(&loc, &q_state.base, SIZE_OF_BASE_ENT_KEY);
+
+				if (p_container->get(p_txn, loc, p_fused->p_block) != SERVICE_NO_ERROR)
+					ret = SERVICE_ERROR_IO_ERROR;
+
+				destroy_transaction(p_fused);
+			}
+
+			for (int i = 0; i < num_filters; i++)
+				p_owner[i]->destroy_transaction(p_filter[i]);
+
+			return ret;
+		}
+
+		/** This is an internal part of get() made independent to keep the function less crowded.
+
+			\param p_txn		A pointer to the transaction that will be used to store the result.
+			\param p_container	The Container of the tensor.
+			\param loc			The tensor.
+			\param p_slice		The slices and transposes, already checked by parse_slice(). E.g., "[::2,10:20].T"
+
+			\return				SERVICE_NO_ERROR if successful, or an error code.
+
+		Context: This is an APPLY_SLICE or an APPLY_ASSIGN_SLICE. The view is only a descriptor over the tensor and its cells are copied
+				 once by new_block() (10) into the block that is returned (or stored).
+		*/
+		inline StatusCode get_slice(pTransaction &p_txn, pContainer p_container, Locator &loc, pChar p_slice) {
+
+			pTransaction p_aux;
+			StridedView	 view;
+
+			if (p_container->get(p_aux, loc) != SERVICE_NO_ERROR)
+				return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+			StatusCode ret = SERVICE_ERROR_WRONG_ARGUMENTS;
+
+			if (new_strided_view(view, p_aux->p_block) && slice_view(view, p_slice))
+				ret = new_block(p_txn, view);
+
+			p_container->destroy_transaction(p_aux);
+
+			return ret;
+		}
+
+		/** This is an internal part of get() made independent to keep the function less crowded.
+
+			\param p_txn		A pointer to the transaction that will be used to store the result.
+			\param q_state		The structure containing the parts of the url successfully parsed.
+
+			\return				SERVICE_NO_ERROR if successful, or an error code.
+
+		Context: This is called when q_state.apply is APPLY_NOTHING ... APPLY_SLICE and there is no forwarding.
 		It returns the final block as it will be returned to the user with a new_block() interface.
 		*/
 		inline StatusCode get_left_local(pTransaction &p_txn, ApiQueryState &q_state) {
@@ -563,6 +771,9 @@ class BaseAPI : public Container {
 				return SERVICE_NO_ERROR;
 
 			case APPLY_FILTER:
+				if (q_state.url[0] == '[')
+					return get_filter_chain(p_txn, p_container, q_state);
+
 				p_aux_cont = (pContainer) base_server[TenBitsAtAddress(q_state.r_value.base)];
 
 				if (p_aux_cont == nullptr)
@@ -622,6 +833,26 @@ class BaseAPI : public Container {
 				p_container->destroy_transaction(p_aux);
 
 				return SERVICE_NO_ERROR;
+
+			case APPLY_ARROW:
+			case APPLY_NPY:
+				memcpy(&loc, &q_state.base, SIZE_OF_BASE_ENT_KEY);
+				if (p_container->get(p_aux, loc) != SERVICE_NO_ERROR)
+					return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+				if ((q_state.apply == APPLY_ARROW ? new_arrow(p_txn, p_aux->p_block) : new_npy(p_txn, p_aux->p_block))
+					!= SERVICE_NO_ERROR) {
+					p_container->destroy_transaction(p_aux);
+
+					return SERVICE_ERROR_IO_ERROR;
+				}
+				p_container->destroy_transaction(p_aux);
+
+				return SERVICE_NO_ERROR;
+
+			case APPLY_SLICE:
+				memcpy(&loc, &q_state.base, SIZE_OF_BASE_ENT_KEY);
+				return get_slice(p_txn, p_container, loc, q_state.url);
 			}
 			return SERVICE_ERROR_MISC_SERVER;
 		}
@@ -38,6 +38,9 @@
 namespace jazz_elements
 {
 
+int Block::default_hash_scheme = HASH_SCHEME_MURMUR64A;
+
+
 /** Scan a tensor object to see if it contains any NA valued of the type specified in cell_type.
 
 	\return		True if NA values of the give type were found.
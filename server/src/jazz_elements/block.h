@@ -400,7 +400,8 @@ class Block: public StaticBlockHeader {
 
 			\param set_has_NA	SET_HAS_NA_FALSE (set the attribute as no NA without checking), SET_HAS_NA_TRUE (set it
 								as true which is always safe) or SET_HAS_NA_AUTO (search the whole tensor for NA and set accordingly).
-			\param set_hash		Compute MurmurHash64A and set attribute **hash64** accordingly.
+			\param set_hash		Compute the hash with the scheme in Block::default_hash_scheme and set attributes **hash64** and
+								**hash_scheme** accordingly.
 			\param set_time		Set attribute **created** as the current time.
 		*/
 		inline void close_block(int set_has_NA = SET_HAS_NA_FALSE,
@@ -432,23 +433,83 @@ class Block: public StaticBlockHeader {
 			if (void_size > 0)
 				memset(p_start, 0, void_size);
 #endif
-			if (set_hash)
-				hash64 = MurmurHash64A(&tensor, total_bytes - sizeof(BlockHeader));
+			if (set_hash) {
+				hash_scheme = default_hash_scheme;
+				hash64		= hash_of_content(hash_scheme);
+			}
 
 			if (set_time)
 				created = std::chrono::steady_clock::now();
 		}
 
+		/** Compute the hash of everything but the header.
+
+			\param scheme	One of HASH_SCHEME_* (anything else is HASH_SCHEME_MURMUR64A).
+
+			\return	The hash (or zero for a block without content).
+		*/
+		inline uint64_t hash_of_content(int scheme) {
+			int siz = total_bytes - sizeof(BlockHeader);
+
+			if (siz <= 0)
+				return 0;
+
+			switch (scheme) {
+			case HASH_SCHEME_CRC32C:
+				return Crc32cHash64(&tensor, siz);
+
+			case HASH_SCHEME_TREE:
+				return TreeHash64(&tensor, siz);
+			}
+			return MurmurHash64A(&tensor, siz);
+		}
+
 		/** Check the hash of a JazzBlock based on the content of the tensor
 
 			\return true if the hash is correct.
+
+		The hash is verified with the scheme in hash_scheme. Blocks older than hash_scheme have anything in it (it was padding) and
+		were all hashed with MurmurHash64A(), so a block that fails with another scheme is also checked with MurmurHash64A().
 		*/
 		inline bool check_hash() {
-			int siz = total_bytes - sizeof(BlockHeader);
-			return siz > 0 && hash64 == MurmurHash64A(&tensor, siz);
+			if (total_bytes <= (int) sizeof(BlockHeader))
+				return false;
+
+			if (hash64 == hash_of_content(hash_scheme))
+				return true;
+
+			return (hash_scheme == HASH_SCHEME_CRC32C || hash_scheme == HASH_SCHEME_TREE) && hash64 == hash_of_content(HASH_SCHEME_MURMUR64A);
 		}
+
+		static int default_hash_scheme;		///< The HASH_SCHEME_* used by close_block(). Set from ONE_SHOT_BLOCK_HASH_SCHEME by Container.start().
 };
 
+
+/** \brief The 64 bit value of the strong validator (ETag) of a block.
+
+	\param p_hea	The header of the block (a pBlock or a StaticBlockHeader filled by header()).
+
+	\return	Zero if the block has no hash64, else a (non zero) hash of the hash64 and the cell_type, size, rank and range.
+
+The hash64 only covers what follows the header, so the same bytes as an INTEGER[6] or as a FACTOR[2,3] have the same hash64. Anything
+revalidating a copy of a block (http ETag, If-None-Match) must compare this instead.
+*/
+inline uint64_t etag_of_block(pStaticBlockHeader p_hea) {
+	if (p_hea->hash64 == 0)
+		return 0;
+
+	int rank = p_hea->rank < 0 ? 0 : (p_hea->rank > MAX_TENSOR_RANK ? MAX_TENSOR_RANK : p_hea->rank);
+
+	uint64_t key[4 + MAX_TENSOR_RANK] = {p_hea->hash64, (uint64_t) p_hea->cell_type, (uint64_t) p_hea->size, (uint64_t) rank};
+
+	for (int i = 0; i < rank; i++)
+		key[4 + i] = p_hea->range.dim[i];
+
+	uint64_t etag = MurmurHash64A(key, (4 + rank)*sizeof(uint64_t));
+
+	return etag == 0 ? 1 : etag;
+}
+
 } // namespace jazz_elements
 
 #endif // ifndef INCLUDED_JAZZ_ELEMENTS_BLOCK
@@ -33,6 +33,7 @@
 
 
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <filesystem>
 
 #include <zmq.h>
@@ -47,6 +48,23 @@
 namespace jazz_elements
 {
 
+/** \brief A unique temporary name in the same folder as a file that is about to be written.
+
+	\param p_path	The path of the file.
+
+	\return			The path of the temporary file.
+
+	Files are written under a temporary name and renamed over the original when done. Truncating the original would kill (SIGBUS) anyone
+	reading a mapping of it (see Container::new_mapped_block()), but a renamed file keeps the old content alive until it is unmapped.
+*/
+String temp_path(pChar p_path) {
+
+	static std::atomic<uint32_t> num_temp = {0};
+
+	return String(p_path) + ".jazz_tmp." + std::to_string(getpid()) + "." + std::to_string(num_temp++);
+}
+
+
 /** \brief A callback for libCURL GET.
 
 	\param ptr			The incoming data chunk.
@@ -118,6 +136,83 @@ size_t put_callback(char *ptr, size_t size, size_t nmemb, void *container) {	//
 	return size;
 }
 
+
+/** \brief A callback for libCURL GET writing into a LargeBlockStream. (See Channels::get_large().)
+
+	\param ptr		The incoming data chunk.
+	\param size	Size in whatever_units.
+	\param nmemb	whatever_unit size in bytes.
+	\param stream	A pointer owned by the caller. (A LargeBlockStream in this case.)
+
+	\return			The number of bytes processed (anything else aborts the transfer).
+
+	(see https://curl.haxx.se/libcurl/c/CURLOPT_WRITEFUNCTION.html)
+*/
+size_t large_get_callback(char *ptr, size_t size, size_t nmemb, void *stream) {	// cppcheck-suppress unusedFunction
+	size = size*nmemb;
+
+	if (size && !pLargeBlockStream(stream)->write(ptr, size))
+		return 0;
+
+	return size;
+}
+
+
+/** \brief A callback for libCURL PUT reading from a LargeBlockStream. (See Channels::put_large().)
+
+	\param ptr		The buffer to be filled.
+	\param size	Size in whatever_units.
+	\param nmemb	whatever_unit size in bytes.
+	\param stream	A pointer owned by the caller. (A LargeBlockStream in this case.)
+
+	\return			The number of bytes written into ptr (0 at the end of the stream) or CURL_READFUNC_ABORT.
+
+	(see https://curl.haxx.se/libcurl/c/CURLOPT_READFUNCTION.html)
+*/
+size_t large_put_callback(char *ptr, size_t size, size_t nmemb, void *stream) {	// cppcheck-suppress unusedFunction
+	int64_t len = pLargeBlockStream(stream)->read(ptr, size*nmemb);
+
+	if (len < 0)
+		return CURL_READFUNC_ABORT;
+
+	return len;
+}
+
+
+/** Write a buffer into a file in pieces that end at multiples of CHANNELS_LARGE_BUFFER_BYTES in the file.
+
+	\param fd		A file descriptor open for writing.
+	\param p_buff	The data to be written.
+	\param size		The number of bytes in p_buff.
+	\param offset	The current position in the file (i.e., the number of bytes written before). The first piece is shorter to make
+					all the others aligned.
+
+	\return			True if everything was written.
+
+	Unlike fwrite(), this does not copy the data into a stdio buffer and retries on partial writes and EINTR.
+*/
+bool write_pieces(int fd, const char *p_buff, int64_t size, int64_t offset) {
+	int64_t piece = CHANNELS_LARGE_BUFFER_BYTES - offset % CHANNELS_LARGE_BUFFER_BYTES;
+
+	while (size > 0) {
+		ssize_t len = write(fd, p_buff, std::min(piece, size));
+
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return false;
+		}
+		p_buff += len;
+		size   -= len;
+		piece  -= len;
+
+		if (piece == 0)
+			piece = CHANNELS_LARGE_BUFFER_BYTES;
+	}
+	return true;
+}
+
 /*	-----------------------------------------------
 	 Channels : I m p l e m e n t a t i o n
 --------------------------------------------------- */
@@ -293,6 +388,24 @@ StatusCode Channels::start() {
 		return EXIT_FAILURE;
 	}
 
+	int mmap_kbytes;
+
+	if (!get_conf_key("FILE_MMAP_MIN_KBYTES", mmap_kbytes) || !get_conf_key("FILE_FALLOCATE", file_fallocate)) {
+		log(log_error_level, "Channels::start() failed to find FILE_MMAP_MIN_KBYTES or FILE_FALLOCATE");
+
+		return EXIT_FAILURE;
+	}
+	file_mmap_min_bytes = 1024*(uint64_t) mmap_kbytes;
+
+	int cache_kbytes;
+
+	if (!get_conf_key("FORWARD_CACHE_MAX_ITEMS", forward_cache_max_items) || !get_conf_key("FORWARD_CACHE_MAX_KBYTES", cache_kbytes)) {
+		log(log_error_level, "Channels::start() failed to find FORWARD_CACHE_MAX_ITEMS or FORWARD_CACHE_MAX_KBYTES");
+
+		return EXIT_FAILURE;
+	}
+	forward_cache_max_bytes = 1024*(uint64_t) cache_kbytes;
+
 	if (!curl_ok)
 		curl_ok = can_curl && curl_global_init(CURL_GLOBAL_SSL) == CURLE_OK;
 
@@ -331,6 +444,8 @@ StatusCode Channels::shut_down() {
 
 	connect.clear();
 
+	forward_cache_clear();
+
 	return Container::shut_down();	// Closes the one-shot functionality.
 }
 
@@ -397,28 +512,90 @@ StatusCode Channels::get(pTransaction &p_txn, pChar p_what) {
 		if (S_ISREG(p_stat.st_mode)) {
 			if (p_stat.st_size > MAX_BLOCK_SIZE) return SERVICE_ERROR_BLOCK_TOO_BIG;
 
-			int dim[MAX_TENSOR_RANK] = {(int) p_stat.st_size, 0};
+			int	 len = strlen(p_what);
+			bool npy = len > 4 && strcmp(&p_what[len - 4], ".npy") == 0, npz = len > 4 && strcmp(&p_what[len - 4], ".npz") == 0;
+			bool map = file_mmap_min_bytes > 0 && (uint64_t) p_stat.st_size >= file_mmap_min_bytes;
+
+			if (npy) {							// Parse the preamble, then map or read the data straight into the tensor.
+				FILE *fp;
+				fp = fopen(p_what, "rb");
+				if (fp == nullptr) return SERVICE_ERROR_IO_ERROR;
+
+				uint8_t	   pre[12 + NPY_MAX_HEADER];
+				int		   pre_len = fread(pre, 1, sizeof(pre), fp);
+				ItemHeader item;
+
+				bool is_npy =	pre_len >= NPY_MAGIC_LENGTH && memcmp(pre, NPY_MAGIC, NPY_MAGIC_LENGTH) == 0
+							 && (ret = npy_parse_header(item, pre, pre_len < sizeof(pre) ? pre_len : p_stat.st_size)) > 0;
+
+				if (is_npy && map && new_mapped_block(p_txn, fileno(fp), p_stat.st_size, ret, item.cell_type, item.dim) == SERVICE_NO_ERROR) {
+					fclose(fp);
+
+					p_txn->p_block->close_block(SET_HAS_NA_TRUE, false);	// Hashing or scanning for NA would read every page.
+
+					return SERVICE_NO_ERROR;
+				}
+
+				if (is_npy && new_block(p_txn, item.cell_type, item.dim, FILL_NEW_DONT_FILL) == SERVICE_NO_ERROR) {
+					size_t size = (size_t) p_txn->p_block->size*(item.cell_type & 0xff);
+
+					bool read_ok = fseek(fp, ret, SEEK_SET) == 0 && fread(&p_txn->p_block->tensor, 1, size, fp) == size;
+
+					fclose(fp);
+
+					if (!read_ok) {
+						destroy_transaction(p_txn);
 
-			ret = new_block(p_txn, CELL_TYPE_BYTE, dim, FILL_NEW_DONT_FILL);
+						return SERVICE_ERROR_IO_ERROR;
+					}
+					p_txn->p_block->close_block(SET_HAS_NA_AUTO);
 
-			if (ret != SERVICE_NO_ERROR) return ret;
+					return SERVICE_NO_ERROR;
+				}
+				fclose(fp);						// Not a .npy Jazz can hold, it is returned as bytes.
+			}
 
+			int	 dim[MAX_TENSOR_RANK] = {(int) p_stat.st_size, 0};
 			bool read_ok = false;
-			FILE *fp;
-			fp = fopen(p_what, "rb");
-			if (fp != nullptr) {
-				read_ok = fread(&p_txn->p_block->tensor.cell_byte, 1, p_stat.st_size, fp) == p_stat.st_size;
 
-				fclose(fp);
+			if (map) {							// A zero-copy Block, the file is read from the page cache as the tensor is used.
+				int fd = open(p_what, O_RDONLY);
+
+				if (fd >= 0) {
+					read_ok = new_mapped_block(p_txn, fd, p_stat.st_size, 0, CELL_TYPE_BYTE, dim) == SERVICE_NO_ERROR;
+
+					close(fd);
+				}
 			}
+
+			if (!read_ok) {
+				ret = new_block(p_txn, CELL_TYPE_BYTE, dim, FILL_NEW_DONT_FILL);
+
+				if (ret != SERVICE_NO_ERROR) return ret;
+
+				FILE *fp;
+				fp = fopen(p_what, "rb");
+				if (fp != nullptr) {
+					read_ok = fread(&p_txn->p_block->tensor.cell_byte, 1, p_stat.st_size, fp) == p_stat.st_size;
+
+					fclose(fp);
+				}
 #ifdef CATCH_TEST
-			if (debug_trigger_failure & TRIGGER_FAIL_FILE_IO)
-				read_ok = false;
+				if (debug_trigger_failure & TRIGGER_FAIL_FILE_IO)
+					read_ok = false;
 #endif
-			if (!read_ok) {
-				destroy_transaction(p_txn);
+				if (!read_ok) {
+					destroy_transaction(p_txn);
+
+					return SERVICE_ERROR_IO_ERROR;
+				}
+			}
+			pTransaction p_tuple;
+
+			if (npz && new_from_npy(p_tuple, p_txn->p_block) == SERVICE_NO_ERROR) {
+				destroy_transaction(p_txn);		// Not a .npz Jazz can hold (e.g., compressed), it is returned as bytes.
 
-				return SERVICE_ERROR_IO_ERROR;
+				p_txn = p_tuple;
 			}
 			return SERVICE_NO_ERROR;
 		}}
@@ -606,10 +783,25 @@ StatusCode Channels::put(pChar p_where, pBlock p_block, int mode) {
 				return SERVICE_ERROR_BASE_FORBIDDEN;
 		}
 
-		pChar p_buff;
-		int	  size;
+		pChar		 p_buff;
+		int			 size, len = strlen(p_where), pre_len = 0;
+		bool		 npy = len > 4 && strcmp(&p_where[len - 4], ".npy") == 0, npz = len > 4 && strcmp(&p_where[len - 4], ".npz") == 0;
+		uint8_t		 pre[NPY_MAX_HEADER];
+		pTransaction p_npz = nullptr;
 
-		if ((mode & WRITE_AS_STRING) && (	(p_block->cell_type == CELL_TYPE_STRING && p_block->size == 1)
+		if (	(mode & WRITE_AS_CONTENT) && npy && !(p_block->cell_type == CELL_TYPE_BYTE && p_block->rank == 1)
+			&& (pre_len = npy_header(p_block, pre)) > 0) {
+			size   = p_block->size*(p_block->cell_type & 0xff);		// The .npy preamble is written first, then the content.
+			p_buff = reinterpret_cast<pChar>(&p_block->tensor.cell_byte[0]);
+		} else if ((mode & WRITE_AS_CONTENT) && npz && p_block->cell_type == CELL_TYPE_TUPLE) {
+			StatusCode ret = new_npy(p_npz, p_block);
+
+			if (ret != SERVICE_NO_ERROR)
+				return ret;
+
+			size   = p_npz->p_block->size;
+			p_buff = reinterpret_cast<pChar>(&p_npz->p_block->tensor.cell_byte[0]);
+		} else if ((mode & WRITE_AS_STRING) && (	(p_block->cell_type == CELL_TYPE_STRING && p_block->size == 1)
 										 || (p_block->cell_type == CELL_TYPE_BYTE	&& p_block->rank == 1))) {
 			if (p_block->cell_type == CELL_TYPE_STRING) {
 				p_buff = p_block->get_string(0);
@@ -627,14 +819,29 @@ StatusCode Channels::put(pChar p_where, pBlock p_block, int mode) {
 		} else
 			return SERVICE_ERROR_WRITE_FORBIDDEN;
 
-		FILE *fp;
-		fp = fopen(p_where, "wb");
-		if (fp == nullptr) return SERVICE_ERROR_IO_ERROR;
+		String tmp_where = temp_path(p_where);
 
-		size_t w_len = fwrite(p_buff, 1, size, fp);
-		fclose(fp);
+		int fd = open(tmp_where.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
 
-		if (w_len != size) return SERVICE_ERROR_IO_ERROR;}
+		bool write_ok = fd >= 0;
+
+		if (write_ok && file_fallocate && pre_len + size > 0)
+			write_ok = posix_fallocate(fd, 0, pre_len + size) != ENOSPC;
+
+		write_ok = write_ok && write_pieces(fd, (const char *) pre, pre_len, 0) && write_pieces(fd, p_buff, size, pre_len);
+
+		if (fd >= 0)
+			write_ok = close(fd) == 0 && write_ok;
+
+		write_ok = write_ok && rename(tmp_where.c_str(), p_where) == 0;
+
+		if (!write_ok && fd >= 0)
+			unlink(tmp_where.c_str());
+
+		if (p_npz != nullptr)
+			destroy_transaction(p_npz);
+
+		if (!write_ok) return SERVICE_ERROR_IO_ERROR;}
 
 		return SERVICE_NO_ERROR;
 
@@ -930,6 +1137,170 @@ StatusCode Channels::copy(pChar p_where, pChar p_what) {
 }
 
 
+/** Get a tensor of any size in the large block format (see LargeBlockHeader) from a file or an http url into a stream.
+
+	\param p_what		The endpoint (only "file" or "http", as in get()).
+	\param p_stream	A stream opened for writing by another Container. E.g., by Persisted::put_large().
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error). Either way, the caller closes the stream (without committing
+			on error).
+
+The content is written into the stream in pieces (of at most CHANNELS_LARGE_BUFFER_BYTES for files), so it is never in RAM as a whole
+and there is no MAX_BLOCK_SIZE limit. The stream validates the header.
+*/
+StatusCode Channels::get_large(pChar p_what, pLargeBlockStream p_stream) {
+
+	if ((*p_what++ != '/') || (*p_what++ != '/') || (*p_what == 0))
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	switch (TenBitsAtAddress(p_what)) {
+	case BASE_FILE_10BIT: {
+		if (file_lev < 1)
+			return SERVICE_ERROR_BASE_FORBIDDEN;
+
+		p_what += 4;
+		if (*p_what++ != '/')
+			return SERVICE_ERROR_WRONG_BASE;
+
+		FILE *fp = fopen(p_what, "rb");
+		if (fp == nullptr) return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+		pChar p_buff = (pChar) std::malloc(CHANNELS_LARGE_BUFFER_BYTES);
+
+		if (p_buff == nullptr) {
+			fclose(fp);
+
+			return SERVICE_ERROR_NO_MEM;
+		}
+
+		StatusCode ret = SERVICE_NO_ERROR;
+		size_t	   len;
+
+		while ((len = fread(p_buff, 1, CHANNELS_LARGE_BUFFER_BYTES, fp)) > 0) {
+			if (!p_stream->write(p_buff, len)) {
+				ret = SERVICE_ERROR_WRITE_FAILED;
+
+				break;
+			}
+		}
+		if (ret == SERVICE_NO_ERROR && ferror(fp))
+			ret = SERVICE_ERROR_IO_ERROR;
+
+#ifdef CATCH_TEST
+		if (debug_trigger_failure & TRIGGER_FAIL_FILE_IO)
+			ret = SERVICE_ERROR_IO_ERROR;
+#endif
+
+		std::free(p_buff);
+		fclose(fp);
+
+		return ret; }
+
+	case BASE_HTTP_10BIT: {
+		if (!curl_ok)
+			return SERVICE_ERROR_BASE_FORBIDDEN;
+
+		p_what += 4;
+		if (*p_what++ != '/')
+			return SERVICE_ERROR_WRONG_BASE;
+
+		String url;
+		Index *p_idx = connection_url(url, p_what);
+
+		return curl_get_large(url.c_str(), p_stream, p_idx); }
+	}
+
+	return SERVICE_ERROR_WRONG_BASE;
+}
+
+
+/** Put a tensor of any size in the large block format (see LargeBlockHeader) read from a stream into a file or an http url.
+
+	\param p_where		The endpoint (only "file" or "http", as in put()).
+	\param p_stream	A stream opened for reading by another Container. E.g., by Persisted::get_large().
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error). Either way, the caller closes the stream.
+
+The stream is read in pieces of CHANNELS_LARGE_BUFFER_BYTES and written to the file (with the permissions of put() with WRITE_AS_CONTENT)
+or sent as the body of an http PUT (with a Content-Length if the stream knows its .stream_bytes).
+*/
+StatusCode Channels::put_large(pChar p_where, pLargeBlockStream p_stream) {
+
+	if ((*p_where++ != '/') || (*p_where++ != '/') || (*p_where == 0))
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	switch (TenBitsAtAddress(p_where)) {
+	case BASE_FILE_10BIT: {
+		if (file_lev < 2)
+			return SERVICE_ERROR_BASE_FORBIDDEN;
+
+		p_where += 4;
+		if (*p_where++ != '/')
+			return SERVICE_ERROR_WRONG_BASE;
+
+		if (file_lev == 2) {
+		    struct stat p_stat;
+			if (stat(p_where, &p_stat) == 0)
+				return SERVICE_ERROR_BASE_FORBIDDEN;
+		}
+
+		pChar p_buff = (pChar) std::malloc(CHANNELS_LARGE_BUFFER_BYTES);
+
+		if (p_buff == nullptr) return SERVICE_ERROR_NO_MEM;
+
+		String tmp_where = temp_path(p_where);
+
+		FILE *fp = fopen(tmp_where.c_str(), "wbx");
+		if (fp == nullptr) {
+			std::free(p_buff);
+
+			return SERVICE_ERROR_IO_ERROR;
+		}
+
+		StatusCode ret = SERVICE_NO_ERROR;
+		int64_t	   len;
+
+		while ((len = p_stream->read(p_buff, CHANNELS_LARGE_BUFFER_BYTES)) > 0) {
+			if (fwrite(p_buff, 1, len, fp) != (size_t) len) {
+				ret = SERVICE_ERROR_IO_ERROR;
+
+				break;
+			}
+		}
+		if (len < 0)
+			ret = SERVICE_ERROR_CORRUPTED;
+
+		std::free(p_buff);
+
+		if (fclose(fp) != 0 && ret == SERVICE_NO_ERROR)
+			ret = SERVICE_ERROR_IO_ERROR;
+
+		if (ret == SERVICE_NO_ERROR && rename(tmp_where.c_str(), p_where) != 0)
+			ret = SERVICE_ERROR_IO_ERROR;
+
+		if (ret != SERVICE_NO_ERROR)
+			unlink(tmp_where.c_str());
+
+		return ret; }
+
+	case BASE_HTTP_10BIT: {
+		if (!curl_ok)
+			return SERVICE_ERROR_BASE_FORBIDDEN;
+
+		p_where += 4;
+		if (*p_where++ != '/')
+			return SERVICE_ERROR_WRONG_BASE;
+
+		String url;
+		Index *p_idx = connection_url(url, p_where);
+
+		return curl_put_large(url.c_str(), p_stream, p_idx); }
+	}
+
+	return SERVICE_ERROR_WRONG_BASE;
+}
+
+
 /** The function call interface for **modify**: In jazz_elements, this is only implemented in Channels.
 
 	\param function	Some description of a service. In general base/entity/key. In Channels the key must be empty and the entity is
@@ -1095,7 +1466,40 @@ MHD_StatusCode Channels::forward_get(pTransaction &p_txn, Name node, pChar p_url
 
 	if (!compose_url(buffer, (pChar) node, p_url, sizeof(buffer))) return SERVICE_ERROR_UNKNOWN_JAZZNODE;
 
-	return curl_get(p_txn, buffer);
+	if (forward_cache_max_items <= 0)
+		return curl_get(p_txn, buffer);
+
+	String	 key(buffer);
+	uint64_t etag = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		ForwardCache::iterator it = forward_cache.find(key);
+
+		if (it != forward_cache.end())
+			etag = it->second->etag;
+	}
+
+	int ret = curl_get(p_txn, buffer, nullptr, etag);
+
+	if (ret == CURL_GET_NOT_MODIFIED) {
+		if (forward_cache_hit(p_txn, key, etag) == SERVICE_NO_ERROR)
+			return SERVICE_NO_ERROR;
+
+		return curl_get(p_txn, buffer);		// Evicted (or out of memory) after the request was sent, just get it again.
+	}
+
+	if (ret != SERVICE_NO_ERROR) {
+		if (etag != 0)
+			forward_cache_remove(key);
+
+		return ret;
+	}
+
+	forward_cache_store(key, p_txn->p_block);
+
+	return SERVICE_NO_ERROR;
 }
 
 
@@ -1116,8 +1520,10 @@ MHD_StatusCode Channels::forward_put(Name node, pChar p_url, pBlock p_block, int
 
 	if (!compose_url(buffer, (pChar) node, p_url, sizeof(buffer))) return SERVICE_ERROR_UNKNOWN_JAZZNODE;
 
-	if (p_block->hash64 == 0)
-		p_block->close_block();
+	forward_cache_invalidate(node, p_url);
+
+	if (p_block->hash64 == 0)		// E.g., a mapped file. Keep its (conservative) has_NA.
+		p_block->close_block(p_block->has_NA ? SET_HAS_NA_TRUE : SET_HAS_NA_FALSE);
 
 	return curl_put(buffer, p_block, mode);
 }
@@ -1138,9 +1544,308 @@ MHD_StatusCode Channels::forward_del(Name node, pChar p_url) {
 
 	if (!compose_url(buffer, (pChar) node, p_url, sizeof(buffer))) return SERVICE_ERROR_UNKNOWN_JAZZNODE;
 
+	forward_cache_invalidate(node, p_url);
+
 	return curl_remove(buffer);
 }
 
+
+/** Removes a url from the forward_get() cache (if it is there).
+
+	\param node	  The name of the endpoint node.
+	\param p_url  The unparsed url (server excluded) as it was passed to forward_get().
+
+Since the remote node is not aware of this cache, anything modifying a remote block by other means than forward_put() or forward_del()
+should call this. Note that the cache is revalidated on each forward_get() anyway, this just frees the memory.
+*/
+void Channels::forward_cache_invalidate(Name node, pChar p_url) {
+
+	char buffer[1024];
+
+	if (!compose_url(buffer, (pChar) node, p_url, sizeof(buffer)))
+		return;
+
+	String key(buffer);
+
+	forward_cache_remove(key);
+}
+
+
+/** Removes everything from the forward_get() cache returning the memory to the Container.
+*/
+void Channels::forward_cache_clear() {
+
+	pForwardCacheItem p_free = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		while (p_forward_lru != nullptr) {
+			pForwardCacheItem p_item = p_forward_lru;
+
+			if (forward_cache_unlink(p_item)) {
+				p_item->p_next = p_free;
+				p_free		   = p_item;
+			}
+		}
+	}
+
+	while (p_free != nullptr) {
+		pForwardCacheItem p_item = p_free;
+
+		p_free = p_free->p_next;
+
+		forward_cache_free(p_item);
+	}
+}
+
+
+/** Creates a new transaction with a copy of a cached block after the remote node answered 304 (Not Modified).
+
+	\param p_txn	A pTransaction owned by Channels. It must be destroy_transaction()-ed after successful use.
+	\param key	The composed url used as the key of the cache.
+	\param etag	The etag_of_block() sent in the If-None-Match header.
+
+	\return		SERVICE_NO_ERROR on success, SERVICE_ERROR_BLOCK_NOT_FOUND if the item is not in the cache anymore or SERVICE_ERROR_NO_MEM.
+
+The lock is only held to find the item, pin it and make it the most recently used. The block is copied outside the lock.
+*/
+StatusCode Channels::forward_cache_hit(pTransaction &p_txn, String &key, uint64_t etag) {
+
+	pForwardCacheItem p_item;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		ForwardCache::iterator it = forward_cache.find(key);
+
+		if (it == forward_cache.end() || it->second->etag != etag)
+			return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+		p_item = it->second;
+
+		p_item->readers++;
+
+		if (p_item != p_forward_mru) {		// Move it to the front of the LRU list
+			p_item->p_prev->p_next = p_item->p_next;
+
+			if (p_item->p_next != nullptr)
+				p_item->p_next->p_prev = p_item->p_prev;
+			else
+				p_forward_lru = p_item->p_prev;
+
+			p_item->p_prev		   = nullptr;
+			p_item->p_next		   = p_forward_mru;
+			p_forward_mru->p_prev = p_item;
+			p_forward_mru		   = p_item;
+		}
+	}
+
+	int	   size	 = p_item->p_block->total_bytes;
+	pBlock p_new = block_malloc(size);
+
+	if (p_new != nullptr)
+		memcpy(p_new, p_item->p_block, size);
+
+	bool free_it;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		free_it = --p_item->readers == 0 && p_item->unlinked;
+	}
+
+	if (free_it)
+		forward_cache_free(p_item);
+
+	if (p_new == nullptr)
+		return SERVICE_ERROR_NO_MEM;
+
+	int ret = new_transaction(p_txn);
+
+	if (ret != SERVICE_NO_ERROR) {
+		alloc_bytes -= size;
+		free(p_new);
+
+		return ret;
+	}
+
+	p_txn->p_block = p_new;
+	p_txn->status  = BLOCK_STATUS_READY;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Stores a copy of a block returned by forward_get() in the cache, evicting the least recently used items to make room.
+
+	\param key		The composed url used as the key of the cache.
+	\param p_block	The block just received. Only complete blocks (with a valid hash64) that fit in the cache are stored.
+
+Failing to store is not an error: the block is just not cached. The copy is made and the evicted blocks are freed outside the lock.
+*/
+void Channels::forward_cache_store(String &key, pBlock p_block) {
+
+	uint64_t size = p_block->total_bytes;
+
+	if (p_block->hash64 == 0 || p_block->cell_type == CELL_TYPE_INDEX || size > forward_cache_max_bytes)
+		return;
+
+	pBlock p_copy = block_malloc(size);
+
+	if (p_copy == nullptr)
+		return;
+
+	memcpy(p_copy, p_block, size);
+
+	pForwardCacheItem p_new = new ForwardCacheItem{key, p_copy, etag_of_block(p_copy), 0, false, nullptr, nullptr};
+	pForwardCacheItem p_free = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		ForwardCache::iterator it = forward_cache.find(key);
+
+		if (it != forward_cache.end()) {
+			pForwardCacheItem p_item = it->second;
+
+			if (forward_cache_unlink(p_item)) {
+				p_item->p_next = p_free;
+				p_free		   = p_item;
+			}
+		}
+
+		while (   p_forward_lru != nullptr
+			   && (forward_cache.size() >= (size_t) forward_cache_max_items || forward_cache_bytes + size > forward_cache_max_bytes)) {
+			pForwardCacheItem p_item = p_forward_lru;
+
+			if (forward_cache_unlink(p_item)) {
+				p_item->p_next = p_free;
+				p_free		   = p_item;
+			}
+		}
+
+		forward_cache[key] = p_new;
+		forward_cache_bytes += size;
+
+		p_new->p_next = p_forward_mru;
+
+		if (p_forward_mru != nullptr)
+			p_forward_mru->p_prev = p_new;
+		else
+			p_forward_lru = p_new;
+
+		p_forward_mru = p_new;
+	}
+
+	while (p_free != nullptr) {
+		pForwardCacheItem p_item = p_free;
+
+		p_free = p_free->p_next;
+
+		forward_cache_free(p_item);
+	}
+}
+
+
+/** Removes a key from the cache (if it is there) and frees its block unless a forward_cache_hit() is still copying it.
+
+	\param key	The composed url used as the key of the cache.
+*/
+void Channels::forward_cache_remove(String &key) {
+
+	pForwardCacheItem p_item = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(forward_cache_lock);
+
+		ForwardCache::iterator it = forward_cache.find(key);
+
+		if (it != forward_cache.end() && !forward_cache_unlink(p_item = it->second))
+			p_item = nullptr;
+	}
+
+	if (p_item != nullptr)
+		forward_cache_free(p_item);
+}
+
+
+/** Removes an item from the map and the LRU list of the cache. The caller must hold forward_cache_lock.
+
+	\param p_item	An item in the cache.
+
+	\return		True if the caller must forward_cache_free() it (after releasing the lock). False if it has readers, the last one frees it.
+*/
+bool Channels::forward_cache_unlink(pForwardCacheItem p_item) {
+
+	if (p_item->p_prev != nullptr)
+		p_item->p_prev->p_next = p_item->p_next;
+	else
+		p_forward_mru = p_item->p_next;
+
+	if (p_item->p_next != nullptr)
+		p_item->p_next->p_prev = p_item->p_prev;
+	else
+		p_forward_lru = p_item->p_prev;
+
+	p_item->p_prev = nullptr;
+	p_item->p_next = nullptr;
+
+	forward_cache_bytes -= p_item->p_block->total_bytes;
+	forward_cache.erase(p_item->key);
+
+	p_item->unlinked = true;
+
+	return p_item->readers == 0;
+}
+
+
+/** Frees an item already forward_cache_unlink()-ed and its block. This is called without holding any lock.
+
+	\param p_item	The item.
+*/
+void Channels::forward_cache_free(pForwardCacheItem p_item) {
+
+	alloc_bytes -= p_item->p_block->total_bytes;
+
+	free(p_item->p_block);
+
+	delete p_item;
+}
+
+
+/** \brief Resolve an http endpoint that may start with the name of a connection (as get() and put() do).
+
+	\param url		Returns the url: the URL of the connection followed by the rest of p_what or just p_what.
+	\param p_what	The endpoint after "//http/".
+
+	\return	The Index of the connection when it has curl options besides the URL or nullptr.
+*/
+Index *Channels::connection_url(String &url, pChar p_what) {
+
+	ConnMap::iterator it;
+
+	pChar pt = strchr(p_what, '/');
+	if (pt == nullptr)
+		it = connect.find(p_what);
+	else {
+		*pt = 0;
+		it  = connect.find(p_what);
+		*pt = '/';
+	}
+	if (it == connect.end()) {
+		url = p_what;
+
+		return nullptr;
+	}
+	url = it->second["URL"];
+
+	if (pt != nullptr)
+		url += ++pt;
+
+	return it->second.size() > 1 ? &it->second : nullptr;
+}
+
 #ifdef CATCH_TEST
 
 CURL *Channels::curl_easy_init() {
@@ -63,6 +63,10 @@ namespace jazz_elements
 
 #define MAX_FILE_OR_URL_SIZE		1712		///< Used inside an ExtraLocator, it makes the structure 2 Kbytes.
 
+#define CURL_GET_NOT_MODIFIED			 1		///< Returned by curl_get() when an If-None-Match is answered with 304 (Not Modified).
+
+#define CHANNELS_LARGE_BUFFER_BYTES	(1 << 20)	///< The size of the buffer used by get_large() and put_large() to stream files.
+
 /// ApiQueryState apply values (on state == PSTATE_COMPLETE_OK)
 
 #define APPLY_NOTHING					 0		///< Just an l_value with {///node}//base/entity or {///node}//base/entity/key
@@ -70,24 +74,30 @@ namespace jazz_elements
 #define APPLY_URL						 2		///< {///node}////base& any_url_encoded_url ; (A call to http or file)
 #define APPLY_FUNCTION					 3		///< {///node}//base/entity/key(//r_base/r_entity/r_key) (A function call with a block.)
 #define APPLY_FUNCT_CONST				 4		///< {///node}////base/entity/key(& any_url_encoded_const) (A function call with a const.)
-#define APPLY_FILTER					 5		///< {///node}//base/entity/key[//r_base/r_entity/r_key] (A filter using a a block.)
+#define APPLY_FILTER					 5		///< {///node}//base/entity/key[//r_base/r_entity/r_key] (A filter using a a block or a chain of them.)
 #define APPLY_FILT_CONST				 6		///< {///node}//base/entity/key[& any_url_encoded_const] (A filter using a a const.)
 #define APPLY_RAW						 7		///< {///node}//base/entity/key.raw (Serialize text to raw.)
 #define APPLY_TEXT						 8		///< {///node}//base/entity/key.text (Serialize raw to text.)
-#define APPLY_ASSIGN_NOTHING			 9		///< {///node}//base/entity/key=//r_base/r_entity/r_key (Assign block to block.)
-#define APPLY_ASSIGN_NAME				10		///< {///node}//base/entity/key=//r_base/r_entity/r_key:name (Tuple item -> block)
-#define APPLY_ASSIGN_URL				11		///< {///node}//base/entity/key=//r_base/r_entity& any_url_encoded_url ; (Assign using url.)
-#define APPLY_ASSIGN_FUNCTION			12		///< {///node}//base/entity/key=//r_base/r_entity/r_key(//t_base/t_entity/t_key)
-#define APPLY_ASSIGN_FUNCT_CONST		13		///< {///node}//base/entity/key=//r_base/r_entity/r_key(& any_url_encoded_const)
-#define APPLY_ASSIGN_FILTER				14		///< {///node}//base/entity/key=//r_base/r_entity/r_key[//t_base/t_entity/t_key]
-#define APPLY_ASSIGN_FILT_CONST			15		///< {///node}//base/entity/key=//r_base/r_entity/r_key[& any_url_encoded_const]
-#define APPLY_ASSIGN_RAW				16		///< {///node}//base/entity/key=//r_base/r_entity/r_key.raw
-#define APPLY_ASSIGN_TEXT				17		///< {///node}//base/entity/key=//r_base/r_entity/r_key.text
-#define APPLY_ASSIGN_CONST				18		///< {///node}//base/entity/key=& any_url_encoded_const ; (Assign const to block.)
-#define APPLY_NEW_ENTITY				19		///< {///node}//base/entity.new (Create a new entity)
-#define APPLY_GET_ATTRIBUTE				20		///< {///node}//base/entity/key.attribute(123) (read attribute 123 with HTTP_GET)
-#define APPLY_SET_ATTRIBUTE				21		///< {///node}////base/entity/key.attribute(46)=& url_encoded ; (set attrib. with HTTP_GET)
-#define APPLY_JAZZ_INFO					22		///< /// Show the server info.
+#define APPLY_ARROW						 9		///< {///node}//base/entity/key.arrow (Serialize raw to an Apache Arrow IPC stream.)
+#define APPLY_NPY						10		///< {///node}//base/entity/key.npy (Serialize raw to a NumPy .npy or .npz file.)
+#define APPLY_SLICE						11		///< {///node}//base/entity/key[::2,10:20].T (A strided view: slice and/or transpose a tensor.)
+#define APPLY_ASSIGN_NOTHING			12		///< {///node}//base/entity/key=//r_base/r_entity/r_key (Assign block to block.)
+#define APPLY_ASSIGN_NAME				13		///< {///node}//base/entity/key=//r_base/r_entity/r_key:name (Tuple item -> block)
+#define APPLY_ASSIGN_URL				14		///< {///node}//base/entity/key=//r_base/r_entity& any_url_encoded_url ; (Assign using url.)
+#define APPLY_ASSIGN_FUNCTION			15		///< {///node}//base/entity/key=//r_base/r_entity/r_key(//t_base/t_entity/t_key)
+#define APPLY_ASSIGN_FUNCT_CONST		16		///< {///node}//base/entity/key=//r_base/r_entity/r_key(& any_url_encoded_const)
+#define APPLY_ASSIGN_FILTER				17		///< {///node}//base/entity/key=//r_base/r_entity/r_key[//t_base/t_entity/t_key]
+#define APPLY_ASSIGN_FILT_CONST			18		///< {///node}//base/entity/key=//r_base/r_entity/r_key[& any_url_encoded_const]
+#define APPLY_ASSIGN_RAW				19		///< {///node}//base/entity/key=//r_base/r_entity/r_key.raw
+#define APPLY_ASSIGN_TEXT				20		///< {///node}//base/entity/key=//r_base/r_entity/r_key.text
+#define APPLY_ASSIGN_ARROW				21		///< {///node}//base/entity/key=//r_base/r_entity/r_key.arrow
+#define APPLY_ASSIGN_NPY				22		///< {///node}//base/entity/key=//r_base/r_entity/r_key.npy
+#define APPLY_ASSIGN_SLICE				23		///< {///node}//base/entity/key=//r_base/r_entity/r_key[::2,10:20].T
+#define APPLY_ASSIGN_CONST				24		///< {///node}//base/entity/key=& any_url_encoded_const ; (Assign const to block.)
+#define APPLY_NEW_ENTITY				25		///< {///node}//base/entity.new (Create a new entity)
+#define APPLY_GET_ATTRIBUTE				26		///< {///node}//base/entity/key.attribute(123) (read attribute 123 with HTTP_GET)
+#define APPLY_SET_ATTRIBUTE				27		///< {///node}////base/entity/key.attribute(46)=& url_encoded ; (set attrib. with HTTP_GET)
+#define APPLY_JAZZ_INFO					28		///< /// Show the server info.
 
 
 // Bit masks to trigger curl failures in Channel wrappers during tests.
@@ -138,6 +148,28 @@ typedef PutBuffer *pPutBuffer;				///< A pointer to a PutBuffer
 typedef std::map<String, Socket> PipeMap;
 
 
+/** \brief A forward_get() result kept in the node-local forward cache.
+
+The items are in a map (by key) and in a doubly linked list from the most to the least recently used. Both are only accessed under
+Channels.forward_cache_lock. The block is copied outside the lock: a reader pins the item and, if it is unlinked meanwhile, the last
+reader frees it.
+*/
+struct ForwardCacheItem {
+	String			  key;				///< The composed url (the key in .forward_cache)
+	pBlock			  p_block;			///< A private copy of the block (allocated by block_malloc() and counted in .alloc_bytes).
+	uint64_t		  etag;				///< The etag_of_block() of p_block (sent as If-None-Match)
+	int				  readers;			///< The number of forward_cache_hit() copying p_block outside the lock
+	bool			  unlinked;			///< Removed from the cache while readers > 0 (the last reader frees it)
+	ForwardCacheItem *p_prev;			///< The previous (more recently used) item or nullptr
+	ForwardCacheItem *p_next;			///< The next (less recently used) item or nullptr
+};
+typedef ForwardCacheItem *pForwardCacheItem;	///< A pointer to a ForwardCacheItem
+
+
+/// The node-local forward cache keyed by the composed url (node ip:port + the url sent to the node).
+typedef std::map<String, pForwardCacheItem> ForwardCache;
+
+
 /// A map for defining http config ports
 typedef std::map<int, int>	MapII;
 
@@ -158,6 +190,9 @@ typedef unsigned int MHD_StatusCode;
 extern size_t get_callback(char *ptr, size_t size, size_t nmemb, void *container);
 extern size_t put_callback(char *ptr, size_t size, size_t nmemb, void *container);
 extern size_t dev_null(char *_ignore, size_t size, size_t nmemb, void *_ignore_2);
+extern size_t large_get_callback(char *ptr, size_t size, size_t nmemb, void *stream);
+extern size_t large_put_callback(char *ptr, size_t size, size_t nmemb, void *stream);
+extern bool   write_pieces(int fd, const char *p_buff, int64_t size, int64_t offset);
 
 /** \brief Channels: A Container doing block transactions across media (files, folders, shell, http urls and zeroMQ servers)
 
@@ -210,6 +245,13 @@ Note that "//file/" is a mandatory prefix, therefore "//file/aa" is "aa" and //f
 get() gets files as arrays of byte and folders as an Index serialized as a Tuple (the keys are file names and the values either "file" or
 "folder"). put() writes either Jazz blocks with all the metadata (if mode == WRITE_EVERYTHING) of just the content of the tensor
 (if mode == WRITE_TENSOR_DATA).
+Regular files of at least FILE_MMAP_MIN_KBYTES (if it is non-zero) are not read, but mapped with mmap() as zero-copy Blocks (see
+Container::new_mapped_block()) that are unmapped when destroy_transaction()-ed. Their content is read from the page cache as it is used,
+e.g., when it is put() into "lmdb" by copy(). put() writes with write() in pieces aligned to CHANNELS_LARGE_BUFFER_BYTES and, if
+FILE_FALLOCATE is set, reserves the file size with posix_fallocate() first, failing early when the disk is full.
+NumPy files are recognized by their name: get() of a ".npy" parses its header and reads the data straight into a tensor, get() of a
+".npz" returns a Tuple (see Container::new_from_npy()). Files Jazz cannot hold (e.g., compressed .npz) are returned as bytes. put() of a
+tensor to a ".npy" writes the header before the content and put() of a Tuple to a ".npz" writes an uncompressed .npz.
 WRITE_ONLY_IF_EXISTS and WRITE_ONLY_IF_NOT_EXISTS work as expected. remove() deletes whatever matches the path either a file or a folder
 (with anything inside it).
 new_entity() creates a new folder.
@@ -224,6 +266,10 @@ Besides being an http server, Jazz is also an http client. The simplest mode of
 calls that are intended for other nodes in a Jazz cluster. This is done at the top API level by just adding a node name. E.g.,
 get("///node_x//lmdb/things/this") will forward the call to the node_x (if anything is well configured see JAZZ_NODE_NAME_.., etc.)
 and return the result just as if is was a local call. At the class level, this is done by forward_get(), forward_put() and forward_del().
+forward_get() results that are complete blocks are kept in a node-local LRU cache bounded by FORWARD_CACHE_MAX_ITEMS and
+FORWARD_CACHE_MAX_KBYTES (both counted inside the allocation of Channels). A cached url is always revalidated by sending its
+etag_of_block() (which, unlike the hash64, also covers the type and shape) as an ETag in an If-None-Match header. When the remote node answers 304 (Not Modified) the cached copy is returned without any transfer.
+forward_put() and forward_del() invalidate the url they address and forward_cache_invalidate() does it explicitly.
 You can also send simple GET, PUT and DELETE http calls to random urls by either using the get(), put() and remove() or using the Jazz http
 server API GET "//http&https://google.com;"
 
@@ -237,6 +283,14 @@ get(txn, "//http/a_name/args") will send the http GET to connection[URL] + "args
 If you remove("//http/connection/a_name"), you destroy the connection. get("//http/connection/a_name") returns an Index serialized as a
 Tuple with all the connection parameters.
 
+Large tensors
+-------------
+
+get() and put() move whole Blocks (below MAX_BLOCK_SIZE). Tensors of any size move in the large block format (see LargeBlockHeader) with
+get_large() and put_large() between "file" or "http" and a LargeBlockStream opened by another Container (see Persisted::get_large()).
+get_large() writes what it reads from the file or the http GET into the stream and put_large() writes (or http PUTs) what it reads from
+the stream, in pieces of CHANNELS_LARGE_BUFFER_BYTES, never holding the whole tensor in RAM.
+
 "http" operation must be enabled via configuration by setting ENABLE_HTTP_CLIENT to something non-zero.
 */
 class Channels : public Container {
@@ -275,6 +329,10 @@ class Channels : public Container {
 									  pChar				 p_what);
 		virtual StatusCode modify    (Locator			&function,
 									  pTuple			 p_args);
+		StatusCode	   get_large	 (pChar				 p_what,
+									  pLargeBlockStream	 p_stream);
+		StatusCode	   put_large	 (pChar				 p_where,
+									  pLargeBlockStream	 p_stream);
 		MHD_StatusCode forward_get	 (pTransaction		&p_txn,
 									  Name				 node,
 									  pChar				 p_url);
@@ -284,6 +342,9 @@ class Channels : public Container {
 									  int				 mode = WRITE_AS_BASE_DEFAULT);
 		MHD_StatusCode forward_del	 (Name				 node,
 									  pChar				 p_url);
+		void forward_cache_invalidate(Name				 node,
+									  pChar				 p_url);
+		void forward_cache_clear	 ();
 
 		// Support for container names in the BaseAPI .base_names()
 
@@ -311,11 +372,13 @@ class Channels : public Container {
 						 it when done.
 			\param url	 The url to be got.
 			\param p_idx Additional curl_easy_setopt() options passed in an Index.
+			\param etag	 If not zero, the hash64 of a cached copy sent as an If-None-Match header.
 
-			\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+			\return	SERVICE_NO_ERROR on success (and a valid p_txn), CURL_GET_NOT_MODIFIED if etag is still valid (p_txn is not
+					created) or some negative value (error).
 
 		*/
-		inline StatusCode curl_get(pTransaction &p_txn, const char *url, Index *p_idx = nullptr) {
+		inline StatusCode curl_get(pTransaction &p_txn, const char *url, Index *p_idx = nullptr, uint64_t etag = 0) {
 			CURL *curl;
 			CURLcode c_ret;
 
@@ -324,12 +387,22 @@ class Channels : public Container {
 
 			GetBuffer buff = {};
 
+			struct curl_slist *p_headers = nullptr;
+
 			curl_easy_setopt(curl, CURLOPT_URL, url);
 			curl_easy_setopt(curl, CURLOPT_VERBOSE, 0);
 			curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
 			curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, get_callback);
 			curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) &buff);
 
+			if (etag != 0) {
+				char if_none_match[48];
+				sprintf(if_none_match, "If-None-Match: \"%016lx\"", etag);
+
+				p_headers = curl_slist_append(p_headers, if_none_match);
+				curl_easy_setopt(curl, CURLOPT_HTTPHEADER, p_headers);
+			}
+
 			if (p_idx != nullptr) {
 				Index:: iterator it;
 				if ((it = p_idx->find("CURLOPT_USERNAME")) != p_idx->end())
@@ -353,6 +426,9 @@ class Channels : public Container {
 
 			curl_easy_cleanup(curl);
 
+			if (p_headers != nullptr)
+				curl_slist_free_all(p_headers);
+
 			switch (c_ret) {
 			case CURLE_OK:
 				break;
@@ -370,6 +446,11 @@ class Channels : public Container {
 			case MHD_HTTP_CREATED:
 			case MHD_HTTP_ACCEPTED:
 				break;
+			case MHD_HTTP_NOT_MODIFIED:
+				if (etag != 0)
+					return CURL_GET_NOT_MODIFIED;
+
+				return SERVICE_ERROR_IO_ERROR;
 			case MHD_HTTP_NOT_FOUND:
 			case MHD_HTTP_GONE:
 				return SERVICE_ERROR_BLOCK_NOT_FOUND;
@@ -587,6 +668,177 @@ class Channels : public Container {
 			return SERVICE_ERROR_IO_ERROR;
 		}
 
+		/** \brief The most low level get function for large tensors: stream the body of an http GET into a LargeBlockStream.
+
+			\param url		 The url to be got.
+			\param p_stream The stream the body is written into.
+			\param p_idx	 Additional curl_easy_setopt() options passed in an Index.
+
+			\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+		*/
+		inline StatusCode curl_get_large(const char *url, pLargeBlockStream p_stream, Index *p_idx = nullptr) {
+			CURL *curl;
+			CURLcode c_ret;
+
+			curl = curl_easy_init();
+			if (curl == nullptr) return SERVICE_ERROR_NOT_READY;
+
+			curl_easy_setopt(curl, CURLOPT_URL, url);
+			curl_easy_setopt(curl, CURLOPT_VERBOSE, 0);
+			curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
+			curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+			curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, large_get_callback);
+			curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) p_stream);
+
+			if (p_idx != nullptr) {
+				Index:: iterator it;
+				if ((it = p_idx->find("CURLOPT_USERNAME")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_USERNAME, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_USERPWD")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_USERPWD, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_COOKIEFILE")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_COOKIEFILE, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_COOKIEJAR")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_COOKIEJAR, it->second.c_str());
+			}
+			c_ret = curl_easy_perform(curl);
+
+			uint64_t response_code = 0;
+
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+			curl_easy_cleanup(curl);
+
+			switch (c_ret) {
+			case CURLE_OK:
+				return SERVICE_NO_ERROR;
+			case CURLE_REMOTE_ACCESS_DENIED:
+			case CURLE_AUTH_ERROR:
+				return SERVICE_ERROR_READ_FORBIDDEN;
+			case CURLE_REMOTE_FILE_NOT_FOUND:
+				return SERVICE_ERROR_BLOCK_NOT_FOUND;
+			case CURLE_WRITE_ERROR:
+				return SERVICE_ERROR_WRITE_FAILED;
+			case CURLE_HTTP_RETURNED_ERROR:
+				break;
+			default:
+				return SERVICE_ERROR_IO_ERROR;
+			}
+
+			switch (response_code) {
+			case MHD_HTTP_NOT_FOUND:
+			case MHD_HTTP_GONE:
+				return SERVICE_ERROR_BLOCK_NOT_FOUND;
+			case MHD_HTTP_BAD_REQUEST:
+				return SERVICE_ERROR_WRONG_ARGUMENTS;
+			case MHD_HTTP_UNAUTHORIZED:
+			case MHD_HTTP_PAYMENT_REQUIRED:
+			case MHD_HTTP_FORBIDDEN:
+			case MHD_HTTP_METHOD_NOT_ALLOWED:
+			case MHD_HTTP_NOT_ACCEPTABLE:
+			case MHD_HTTP_PROXY_AUTHENTICATION_REQUIRED:
+			case MHD_HTTP_TOO_MANY_REQUESTS:
+				return SERVICE_ERROR_READ_FORBIDDEN;
+			case MHD_HTTP_INTERNAL_SERVER_ERROR ... MHD_HTTP_LOOP_DETECTED:
+				return SERVICE_ERROR_MISC_SERVER;
+			}
+			return SERVICE_ERROR_IO_ERROR;
+		}
+
+
+		/** \brief The most low level put function for large tensors: http PUT what is read from a LargeBlockStream.
+
+			\param url		 The url to put to.
+			\param p_stream The stream providing the body. If its .stream_bytes is known, it is sent as the Content-Length.
+			\param p_idx	 Additional curl_easy_setopt() options passed in an Index.
+
+			\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+		*/
+		inline StatusCode curl_put_large(const char *url, pLargeBlockStream p_stream, Index *p_idx = nullptr) {
+			CURL *curl;
+			CURLcode c_ret;
+
+			curl = curl_easy_init();
+			if (curl == nullptr) return SERVICE_ERROR_NOT_READY;
+
+			curl_easy_setopt(curl, CURLOPT_URL, url);
+			curl_easy_setopt(curl, CURLOPT_VERBOSE, 0);
+			curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
+			curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, dev_null);
+			curl_easy_setopt(curl, CURLOPT_READFUNCTION, large_put_callback);
+			curl_easy_setopt(curl, CURLOPT_READDATA, (void *) p_stream);
+			curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+
+			if (p_stream->stream_bytes >= 0)
+				curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t) p_stream->stream_bytes);
+
+			if (p_idx != nullptr) {
+				Index:: iterator it;
+				if ((it = p_idx->find("CURLOPT_USERNAME")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_USERNAME, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_USERPWD")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_USERPWD, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_COOKIEFILE")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_COOKIEFILE, it->second.c_str());
+
+				if ((it = p_idx->find("CURLOPT_COOKIEJAR")) != p_idx->end())
+					curl_easy_setopt(curl, CURLOPT_COOKIEJAR, it->second.c_str());
+			}
+			c_ret = curl_easy_perform(curl);
+
+			uint64_t response_code;
+
+			if (c_ret == CURLE_OK)
+    			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+			curl_easy_cleanup(curl);
+
+			switch (c_ret) {
+			case CURLE_OK:
+				break;
+			case CURLE_REMOTE_ACCESS_DENIED:
+			case CURLE_AUTH_ERROR:
+				return SERVICE_ERROR_WRITE_FORBIDDEN;
+			case CURLE_REMOTE_FILE_NOT_FOUND:
+				return SERVICE_ERROR_BLOCK_NOT_FOUND;
+			case CURLE_ABORTED_BY_CALLBACK:
+			case CURLE_READ_ERROR:
+				return SERVICE_ERROR_CORRUPTED;
+			default:
+				return SERVICE_ERROR_IO_ERROR;
+			}
+
+			switch (response_code) {
+			case MHD_HTTP_OK:
+			case MHD_HTTP_CREATED:
+			case MHD_HTTP_ACCEPTED:
+				return SERVICE_NO_ERROR;
+			case MHD_HTTP_NOT_FOUND:
+			case MHD_HTTP_GONE:
+				return SERVICE_ERROR_BLOCK_NOT_FOUND;
+			case MHD_HTTP_BAD_REQUEST:
+				return SERVICE_ERROR_WRONG_ARGUMENTS;
+			case MHD_HTTP_UNAUTHORIZED:
+			case MHD_HTTP_PAYMENT_REQUIRED:
+			case MHD_HTTP_FORBIDDEN:
+			case MHD_HTTP_METHOD_NOT_ALLOWED:
+			case MHD_HTTP_NOT_ACCEPTABLE:
+			case MHD_HTTP_PROXY_AUTHENTICATION_REQUIRED:
+			case MHD_HTTP_TOO_MANY_REQUESTS:
+				return SERVICE_ERROR_WRITE_FORBIDDEN;
+			case MHD_HTTP_INTERNAL_SERVER_ERROR ... MHD_HTTP_LOOP_DETECTED:
+				return SERVICE_ERROR_MISC_SERVER;
+			}
+			return SERVICE_ERROR_IO_ERROR;
+		}
+
 #ifndef CATCH_TEST
 	private:
 #endif
@@ -663,12 +915,30 @@ class Channels : public Container {
 		int zmq_ok	 = false;			///< If true, zeroMQ is ready to be used based on config + zeroMQ initialization
 		int can_bash = false;			///< If true, the server can use bash based on configuration key ENABLE_BASH_EXEC
 		int file_lev = 0;				///< The level of file operations allowed based on configuration key ENABLE_FILE_LEVEL
+		int file_fallocate = false;		///< If true, put() reserves the file size with posix_fallocate() based on FILE_FALLOCATE
+		uint64_t file_mmap_min_bytes = 0;	///< Taken from FILE_MMAP_MIN_KBYTES (0 disables mapping files)
 
 		PipeMap	pipes	= {};			///< A map of pipelines (zeroMQ connections)
 		ConnMap connect = {};			///< A map of http connections
 
 		void *zmq_context = nullptr;	///< The zeroMQ context
 
+		ForwardCache	  forward_cache = {};			///< The node-local cache of forward_get() results
+		std::mutex		  forward_cache_lock;			///< Protects forward_cache, the LRU list and forward_cache_bytes
+		pForwardCacheItem p_forward_mru = nullptr;		///< The most recently used item in the cache
+		pForwardCacheItem p_forward_lru = nullptr;		///< The least recently used item in the cache (the first evicted)
+		int				  forward_cache_max_items = 0;	///< The configured FORWARD_CACHE_MAX_ITEMS (0 disables the cache)
+		uint64_t		  forward_cache_max_bytes = 0;	///< Taken from FORWARD_CACHE_MAX_KBYTES
+		uint64_t		  forward_cache_bytes	  = 0;	///< The total bytes of the blocks in the cache (already included in .alloc_bytes)
+
+		StatusCode forward_cache_hit   (pTransaction &p_txn, String &key, uint64_t etag);
+		void	   forward_cache_store (String &key, pBlock p_block);
+		void	   forward_cache_remove(String &key);
+		bool	   forward_cache_unlink(pForwardCacheItem p_item);
+		void	   forward_cache_free  (pForwardCacheItem p_item);
+
+		Index	  *connection_url	  (String &url, pChar p_what);
+
 #ifdef CATCH_TEST
 		CURL *	 curl_easy_init	  ();
 		CURLcode curl_easy_perform(CURL *curl);
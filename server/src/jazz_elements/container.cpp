@@ -32,6 +32,10 @@
 */
 
 
+#include <zlib.h>
+#include <sys/mman.h>
+
+
 #include "src/jazz_elements/container.h"
 
 namespace jazz_elements
@@ -313,6 +317,21 @@ StatusCode Container::start() {
 	}
 	fail_alloc_bytes = 1024; fail_alloc_bytes *= i;
 
+	if (!get_conf_key("ONE_SHOT_GATHER_PARALLEL_KBYTES", i))
+		i = GATHER_PARALLEL_KBYTES;
+
+	gather_parallel_bytes = 1024; gather_parallel_bytes *= i;
+
+	if (!get_conf_key("ONE_SHOT_BLOCK_HASH_SCHEME", i))
+		i = HASH_SCHEME_MURMUR64A;
+
+	if (i < HASH_SCHEME_MURMUR64A || i > HASH_SCHEME_TREE) {
+		log(log_error_level, "Config key ONE_SHOT_BLOCK_HASH_SCHEME is not a valid HASH_SCHEME_ in Container::start");
+
+		return SERVICE_ERROR_BAD_CONFIG;
+	}
+	Block::default_hash_scheme = i;
+
 	return new_container();
 }
 
@@ -498,17 +517,21 @@ void Container::destroy_transaction  (pTransaction &p_txn) {
 		return;
 	}
 
+	if (num_views > 0 && release_view(p_txn))
+		return;
+
 	enter_write(p_txn);
 
 	if (p_txn->p_block != nullptr) {
-		if (p_txn->p_block->cell_type == CELL_TYPE_INDEX) {
-			p_txn->p_hea->index.~map();
-			alloc_bytes -= sizeof(BlockHeader);
-		} else
-			alloc_bytes -= p_txn->p_block->total_bytes;
-
-		free(p_txn->p_block);
+		if (num_mapped == 0 || !release_mapped(p_txn->p_block)) {
+			if (p_txn->p_block->cell_type == CELL_TYPE_INDEX) {
+				p_txn->p_hea->index.~map();
+				alloc_bytes -= sizeof(BlockHeader);
+			} else
+				alloc_bytes -= p_txn->p_block->total_bytes;
 
+			free(p_txn->p_block);
+		}
 		p_txn->p_block = nullptr;
 	}
 
@@ -525,6 +548,305 @@ void Container::destroy_transaction  (pTransaction &p_txn) {
 }
 
 
+/** Create a view: a Transaction pointing inside the Block of another Transaction (or one of its Tuple items) without copying it.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction (with status BLOCK_STATUS_VIEW) owned by the same Container as p_parent. The caller can only use it
+					read-only and **must** destroy_transaction() it when done.
+	\param p_parent	The Transaction owning the Block. It can be destroy_transaction()-ed before the view, its Block will be kept
+					until the last view on it is destroyed. If it is a view itself, the new view pins the same Transaction.
+	\param name		The name of an item if p_parent is a Tuple or nullptr for a view of the whole Block.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+This is the zero-copy alternative to new_block() (4) when the attributes are not changed.
+*/
+StatusCode Container::new_view(pTransaction &p_txn, pTransaction p_parent, pChar name) {
+
+	if (p_parent == nullptr || p_parent->p_owner == nullptr || p_parent->p_block == nullptr
+		|| (p_parent->status != BLOCK_STATUS_READY && p_parent->status != BLOCK_STATUS_VIEW)) {
+		p_txn = nullptr;
+
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+	}
+
+	if (p_parent->p_owner != this)
+		return p_parent->p_owner->new_view(p_txn, p_parent, name);
+
+	pBlock p_block = p_parent->p_block;
+
+	if (p_block->cell_type == CELL_TYPE_INDEX) {
+		p_txn = nullptr;
+
+		return SERVICE_ERROR_WRONG_TYPE;
+	}
+
+	if (name != nullptr) {
+		if (p_block->cell_type != CELL_TYPE_TUPLE) {
+			p_txn = nullptr;
+
+			return SERVICE_ERROR_WRONG_TYPE;
+		}
+
+		int idx = ((pTuple) p_block)->index(name);
+
+		if (idx < 0) {
+			p_txn = nullptr;
+
+			return SERVICE_ERROR_WRONG_NAME;
+		}
+		p_block = ((pTuple) p_block)->get_block(idx);
+	}
+
+	StatusCode ret = new_transaction(p_txn);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	lock_container();
+
+	if (p_parent->status == BLOCK_STATUS_VIEW)
+		p_parent = views[p_parent];
+
+	views[p_txn] = p_parent;
+	pins[p_parent]++;
+	num_views++;
+
+	p_txn->p_block = p_block;
+	p_txn->status  = BLOCK_STATUS_VIEW;
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Release the pin of a view or defer destroying a pinned Transaction. Called by destroy_transaction() when there are views.
+
+	\param p_txn	The Transaction being destroyed (owned by this Container).
+
+	\return	True if the destruction is deferred (p_txn is set to nullptr) or false if the caller must proceed destroying p_txn. (For a
+			view, p_block is set to nullptr first, since the Block is not owned by the view.)
+
+When the last view pinning a Transaction that was already destroy_transaction()-ed is released, that Transaction is destroyed too.
+*/
+bool Container::release_view(pTransaction &p_txn) {
+
+	lock_container();
+
+	if (p_txn->status == BLOCK_STATUS_VIEW) {
+		ViewMap::iterator it = views.find(p_txn);
+
+		pTransaction p_parent = it->second;
+
+		views.erase(it);
+		num_views--;
+
+		PinMap::iterator jt = pins.find(p_parent);
+
+		bool destroy_parent = false;
+
+		if (--jt->second == 0) {
+			pins.erase(jt);
+
+			destroy_parent = p_parent->status == BLOCK_STATUS_PINNED;
+		}
+
+		unlock_container();
+
+		p_txn->p_block = nullptr;
+
+		if (destroy_parent)
+			destroy_transaction(p_parent);
+
+		return false;
+	}
+
+	if (pins.find(p_txn) != pins.end()) {
+		p_txn->status = BLOCK_STATUS_PINNED;
+
+		unlock_container();
+
+		p_txn = nullptr;
+
+		return true;
+	}
+
+	unlock_container();
+
+	return false;
+}
+
+
+/** Hand the Block of a Transaction with views on it to a new (BLOCK_STATUS_PINNED) Transaction, before its Block is replaced in place.
+
+	\param p_txn	A Transaction owned by this Container whose p_block is about to be freed and replaced by its owner.
+
+	\return	SERVICE_NO_ERROR or SERVICE_ERROR_NO_MEM (nothing is changed). If there were views on p_txn, its p_block is set to nullptr: the
+			Block now belongs to the new Transaction (destroyed with the last view) and the caller must not free it.
+
+Volatile replaces the Blocks of existing keys without destroying their Transactions, this keeps the views on the old Block valid.
+*/
+StatusCode Container::detach_views(pTransaction p_txn) {
+
+	if (num_views == 0)
+		return SERVICE_NO_ERROR;
+
+	lock_container();
+
+	bool pinned = pins.find(p_txn) != pins.end();
+
+	unlock_container();
+
+	if (!pinned)
+		return SERVICE_NO_ERROR;
+
+	pTransaction p_old;
+
+	if (new_transaction(p_old) != SERVICE_NO_ERROR)
+		return SERVICE_ERROR_NO_MEM;
+
+	lock_container();
+
+	PinMap::iterator it = pins.find(p_txn);
+
+	if (it != pins.end()) {
+		pins[p_old] = it->second;
+		pins.erase(it);
+
+		for (auto &view : views)
+			if (view.second == p_txn)
+				view.second = p_old;
+
+		p_old->p_block = p_txn->p_block;
+		p_old->status  = BLOCK_STATUS_PINNED;
+		p_txn->p_block = nullptr;
+		p_old		   = nullptr;
+	}
+
+	unlock_container();
+
+	if (p_old != nullptr)
+		destroy_transaction(p_old);
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Create a Block whose tensor is (a part of) a file mapped with mmap() instead of read into RAM.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param fd			A file descriptor open for reading. It can be closed after the call, the mapping does not need it.
+	\param file_size	The size of the file in bytes.
+	\param offset		The offset in the file where the tensor starts. E.g., after the header of a .npy file.
+	\param cell_type	The type of the tensor. Only types without strings or items (not CELL_TYPE_STRING, CELL_TYPE_TUPLE, etc.)
+	\param dim			The shape of the tensor in "human-readable" format. It must fit in the file after offset.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+The mapping is private: the file is mapped at a page boundary inside an anonymous mapping large enough for the header (right before the
+file) and the string buffer (right after the tensor). The Block has no attributes, has_NA is false for CELL_TYPE_BYTE and true otherwise
+(just like new_block() with FILL_NEW_DONT_FILL) and it is not counted in the allocation. release_mapped() unmaps it.
+*/
+StatusCode Container::new_mapped_block(pTransaction &p_txn, int fd, int64_t file_size, int64_t offset, int cell_type, int *dim) {
+
+	if (	(cell_type & 0xf0) != 0 || cell_type == CELL_TYPE_STRING || cell_type == CELL_TYPE_OBJECT_KIND
+		|| offset < 0 || dim == nullptr)
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+	StaticBlockHeader hea;
+
+	hea.cell_type = cell_type;
+	reinterpret_cast<pBlock>(&hea)->set_dimensions(dim);
+
+	if (offset + (int64_t) hea.size*(cell_type & 0xff) > file_size)
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+	hea.num_attributes = 0;
+	hea.total_bytes	   = (uintptr_t) reinterpret_cast<pBlock>(&hea)->p_string_buffer() - (uintptr_t) (&hea) + sizeof(StringBuffer) + 4;
+	hea.has_NA		   = cell_type != CELL_TYPE_BYTE;
+	hea.hash64		   = 0;
+
+	int64_t page   = sysconf(_SC_PAGESIZE);
+	int64_t head   = (uintptr_t) &reinterpret_cast<pBlock>(&hea)->tensor - (uintptr_t) (&hea);
+	int64_t length = std::max(page + offset - head + hea.total_bytes, page + file_size);
+
+	length = (length + page - 1) & ~(page - 1);
+
+	if (head > page + offset)
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+	uint8_t *p_base = (uint8_t *) mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (p_base == MAP_FAILED)
+		return SERVICE_ERROR_NO_MEM;
+
+	if (	file_size > 0
+		&& mmap(p_base + page, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(p_base, length);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	StatusCode ret = new_transaction(p_txn);
+
+	if (ret != SERVICE_NO_ERROR) {
+		munmap(p_base, length);
+
+		return ret;
+	}
+
+	pBlock p_block = reinterpret_cast<pBlock>(p_base + page + offset - head);
+
+	memcpy(p_block, &hea, head);
+	p_block->set_attributes(nullptr);
+
+	lock_container();
+
+	mapped[p_block] = {p_base, (size_t) length};
+	num_mapped++;
+
+	unlock_container();
+
+	p_txn->p_block = p_block;
+	p_txn->status  = BLOCK_STATUS_READY;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Unmap a Block created by new_mapped_block(). Called by destroy_transaction() when there are mapped Blocks.
+
+	\param p_block	The Block being destroyed.
+
+	\return	True if the Block was mapped (and is now unmapped) or false if the caller must free() it.
+*/
+bool Container::release_mapped(pBlock p_block) {
+
+	lock_container();
+
+	MappedMap::iterator it = mapped.find(p_block);
+
+	if (it == mapped.end()) {
+		unlock_container();
+
+		return false;
+	}
+	MappedBlock mb = it->second;
+
+	mapped.erase(it);
+	num_mapped--;
+
+	unlock_container();
+
+	munmap(mb.p_base, mb.length);
+
+	return true;
+}
+
+
 /** Create a new Block (1): Create a Tensor from raw data specifying everything from scratch.
 
 	\param p_txn			A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
@@ -690,46 +1012,8 @@ StatusCode Container::new_block(pTransaction &p_txn,
 
 	if (p_text != nullptr) {
 		p_txn->p_block->has_NA = false;
-		pStringBuffer psb = p_txn->p_block->p_string_buffer();
-
-		int offset = psb->last_idx;
 
-		char *pt_out = &psb->buffer[offset];
-
-		int row = 1, len = 0;
-		const char *pt_in = p_text;
-
-		p_txn->p_block->tensor.cell_int[0] = offset;
-
-		while (*pt_in) {
-			offset++;
-			if (*pt_in != eol) {
-				*pt_out = *pt_in;
-				len++;
-			} else {
-				if (!len)
-					p_txn->p_block->tensor.cell_int[row - 1] = STRING_EMPTY;
-
-				if (!pt_in[1])
-					break;
-
-				*pt_out = 0;
-
-				p_txn->p_block->tensor.cell_int[row] = offset;
-
-				len = 0;
-				row++;
-			}
-			pt_out++;
-			pt_in++;
-		}
-		if (!len)
-			p_txn->p_block->tensor.cell_int[row - 1] = STRING_EMPTY;
-
-		*pt_out = 0;
-
-		psb->last_idx			= offset + (*pt_in == 0);
-		psb->stop_check_4_match = true;							// Block::get_string_offset() does not support match with empty strings.
+		fill_text_tensor(p_txn->p_block, p_text, eol);
 	} else {
 		switch (fill_tensor) {
 		case FILL_NEW_DONT_FILL:
@@ -961,7 +1245,9 @@ StatusCode Container::new_block(pTransaction &p_txn,
 		old_tensor_size = p_from->size*(p_from->cell_type & 0xff),
 		tensor_rows,
 		bytes_per_row,
-		selected_rows;
+		selected_rows,
+		num_threads		= 1,
+		chunk_rows[GATHER_MAX_THREADS];
 
 	if (p_row_filter != nullptr) {
 		if (!p_row_filter->can_filter(p_from)) {
@@ -969,14 +1255,13 @@ StatusCode Container::new_block(pTransaction &p_txn,
 
 			return SERVICE_ERROR_NEW_BLOCK_ARGS;
 		}
-		if (p_row_filter->cell_type == CELL_TYPE_BYTE_BOOLEAN) {
-			selected_rows = 0;
-			for (int i = 0; i < p_row_filter->size; i++)
-				if (p_row_filter->tensor.cell_bool[i])
-					selected_rows++;
-		} else {
+		num_threads = gather_threads(old_tensor_size, p_row_filter->size);
+
+		if (p_row_filter->cell_type == CELL_TYPE_BYTE_BOOLEAN)
+			selected_rows = count_selected(p_row_filter, num_threads, chunk_rows);
+		else
 			selected_rows = p_row_filter->size;
-		}
+
 		if (p_from->size) {
 			tensor_rows = p_from->size/p_from->range.dim[0];
 
@@ -1049,27 +1334,10 @@ StatusCode Container::new_block(pTransaction &p_txn,
 		u_char *p_dest = &p_txn->p_block->tensor.cell_byte[0],
 			   *p_src  = &p_from->tensor.cell_byte[0];
 
-		if (p_row_filter->cell_type == CELL_TYPE_BYTE_BOOLEAN) {
-			for (int i = 0; i < p_row_filter->size; i++) {
-				if (p_row_filter->tensor.cell_bool[i]) {
-					memcpy(p_dest, p_src, bytes_per_row);
-					p_dest = p_dest + bytes_per_row;
-				}
-				p_src = p_src + bytes_per_row;
-			}
-		} else {
-			int j2 = -1;
-			for (int i = 0; i < p_row_filter->size; i++) {
-				int j = p_row_filter->tensor.cell_int[i];
-				if (j <= j2 || j >= tensor_rows) {
-					destroy_transaction(p_txn);
+		if (!gather_rows(p_dest, p_src, p_row_filter, bytes_per_row, tensor_rows, num_threads, chunk_rows)) {
+			destroy_transaction(p_txn);
 
-					return SERVICE_ERROR_NEW_BLOCK_ARGS;
-				}
-				memcpy(p_dest, p_src + j*bytes_per_row, bytes_per_row);
-				p_dest = p_dest + bytes_per_row;
-				j2 = j;
-			}
+			return SERVICE_ERROR_NEW_BLOCK_ARGS;
 		}
 	} else {
 		memcpy(&p_txn->p_block->tensor, &p_from->tensor, old_tensor_size);
@@ -1117,50 +1385,340 @@ StatusCode Container::new_block(pTransaction &p_txn,
 }
 
 
-/** Create a new Block (4): Create a Tensor by selecting an item from a Tuple.
+/** The number of threads new_block(3) uses to filter a tensor.
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
-					it when done.
-	\param p_from	The Tuple from which the item is selected.
-	\param name		The name of the item to be selected.
-	\param att		The attributes to set when creating the block. They are immutable. To change the attributes of a Block
-					use the version of new_block() with parameter p_from.
+	\param tensor_bytes	The size of the tensor being filtered.
+	\param filter_size		The size of the filter (there is no point in more threads than cells in the filter).
 
-	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+	\return	1 for tensors below ONE_SHOT_GATHER_PARALLEL_KBYTES, else up to GATHER_MAX_THREADS (or Pool::num_threads()).
+*/
+int Container::gather_threads(int tensor_bytes, int filter_size) {
 
-The Tuple already has a method .block() that does this, the difference is the .block() method returns a pointer inside the Tuple
-while this makes a copy to a new block, possibly with attributes.
+	if ((uint64_t) tensor_bytes < gather_parallel_bytes)
+		return 1;
+
+	int num_threads = std::min(Pool::num_threads(), GATHER_MAX_THREADS);
+
+	return std::max(1, std::min(num_threads, filter_size));
+}
+
+
+/** Count the rows selected by a boolean filter, chunk by chunk, running the chunks on the Pool.
+
+	\param p_row_filter	A tensor of CELL_TYPE_BYTE_BOOLEAN.
+	\param num_threads		The number of chunks, from 1 to GATHER_MAX_THREADS.
+	\param chunk_rows		Returns the number of rows selected in each chunk (the chunks are those of gather_rows()).
+
+	\return	The total number of rows selected.
 */
-StatusCode Container::new_block(pTransaction &p_txn,
-								pTuple		  p_from,
-						   		pChar		  name,
-								AttributeMap *att) {
+int Container::count_selected(pBlock p_row_filter, int num_threads, int chunk_rows[]) {
 
-	if (p_from->cell_type != CELL_TYPE_TUPLE) {
-		p_txn = nullptr;
+	int size = p_row_filter->size;
 
-		return SERVICE_ERROR_WRONG_TYPE;
-	}
+	auto count = [p_row_filter, size, num_threads, chunk_rows](int chunk) {
+		bool *p_first = p_row_filter->tensor.cell_bool + (int64_t) size*chunk/num_threads,
+			 *p_last  = p_row_filter->tensor.cell_bool + (int64_t) size*(chunk + 1)/num_threads;
 
-	int idx = p_from->index(name);
+		chunk_rows[chunk] = std::count_if(p_first, p_last, [](bool sel) { return sel; });
+	};
 
-	if (idx < 0) {
-		p_txn = nullptr;
+	Pool::parallel_for(0, num_threads, count);
 
-		return SERVICE_ERROR_WRONG_NAME;
-	}
+	int rows = 0;
 
-	pBlock p_block = p_from->get_block(idx);
+	for (int i = 0; i < num_threads; i++)
+		rows += chunk_rows[i];
 
-	return new_block(p_txn, p_block, (pBlock) nullptr, att);	// This manages the alloc issues of att and possible strings already.
+	return rows;
 }
 
 
-/** Create a new Block (5): Create a Tensor, Kind or Tuple from a Text block kept as a Tensor of CELL_TYPE_BYTE of rank == 1 or a
-							Tensor of CELL_TYPE_STRING of size == 1
+/** Copy the rows selected by a filter, chunk by chunk, running the chunks on the Pool.
 
-	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+	\param p_dest			The tensor of the new block.
+	\param p_src			The tensor being filtered.
+	\param p_row_filter	A tensor of boolean or integer that can_filter() the source.
+	\param bytes_per_row	The size of a row in bytes.
+	\param tensor_rows		The number of rows in the source.
+	\param num_threads		The number of chunks, from 1 to GATHER_MAX_THREADS.
+	\param chunk_rows		For a boolean filter, the rows selected in each chunk as returned by count_selected().
+
+	\return	True on success, false if an integer filter is not sorted or out of range.
+
+Chunk i is the range [size*i/num_threads, size*(i + 1)/num_threads) of the filter. It is written where the previous chunks end: the sum
+of chunk_rows[] of the previous chunks for a boolean filter, or the start of the range itself for an integer filter.
+*/
+bool Container::gather_rows(u_char *p_dest,
+							u_char *p_src,
+							pBlock	p_row_filter,
+							int		bytes_per_row,
+							int		tensor_rows,
+							int		num_threads,
+							int		chunk_rows[]) {
+
+	int size = p_row_filter->size;
+
+	if (num_threads <= 1)
+		return gather_chunk(p_dest, p_src, p_row_filter, 0, size, bytes_per_row, tensor_rows);
+
+	int64_t offset[GATHER_MAX_THREADS];
+
+	for (int i = 0, rows = 0; i < num_threads; i++) {
+		if (p_row_filter->cell_type == CELL_TYPE_BYTE_BOOLEAN) {
+			offset[i] = (int64_t) rows*bytes_per_row;
+			rows	 += chunk_rows[i];
+		} else
+			offset[i] = (int64_t) size*i/num_threads*bytes_per_row;
+	}
+
+	std::atomic<bool> ok = {true};
+
+	auto gather = [this, p_dest, p_src, p_row_filter, bytes_per_row, tensor_rows, size, num_threads, &offset, &ok](int chunk) {
+		int first = (int64_t) size*chunk/num_threads,
+			last  = (int64_t) size*(chunk + 1)/num_threads;
+
+		if (!gather_chunk(p_dest + offset[chunk], p_src, p_row_filter, first, last, bytes_per_row, tensor_rows))
+			ok = false;
+	};
+
+	Pool::parallel_for(0, num_threads, gather);
+
+	return ok;
+}
+
+
+/** Copy the rows selected by a range of a filter (a chunk in gather_rows()).
+
+	\param p_dest			Where the first selected row of the chunk is written.
+	\param p_src			The tensor being filtered.
+	\param p_row_filter	A tensor of boolean or integer that can_filter() the source.
+	\param first			The first cell of the filter in the chunk.
+	\param last			The cell of the filter after the chunk.
+	\param bytes_per_row	The size of a row in bytes.
+	\param tensor_rows		The number of rows in the source.
+
+	\return	True on success, false if an integer filter is not sorted or out of range.
+
+Runs of consecutive selected rows are copied with a single memcpy(): a row range costs one call.
+*/
+bool Container::gather_chunk(u_char *p_dest,
+							 u_char *p_src,
+							 pBlock	 p_row_filter,
+							 int	 first,
+							 int	 last,
+							 int	 bytes_per_row,
+							 int	 tensor_rows) {
+
+	int run_start = 0, run_rows = 0;
+
+	if (p_row_filter->cell_type == CELL_TYPE_BYTE_BOOLEAN) {
+		for (int i = first; i < last; i++) {
+			if (p_row_filter->tensor.cell_bool[i]) {
+				if (run_rows == 0)
+					run_start = i;
+				run_rows++;
+			} else if (run_rows) {
+				memcpy(p_dest, p_src + (int64_t) run_start*bytes_per_row, (int64_t) run_rows*bytes_per_row);
+				p_dest	 = p_dest + (int64_t) run_rows*bytes_per_row;
+				run_rows = 0;
+			}
+		}
+	} else {
+		int j2 = first > 0 ? p_row_filter->tensor.cell_int[first - 1] : -1;	// The previous chunk checks its own, this only the order
+		for (int i = first; i < last; i++) {
+			int j = p_row_filter->tensor.cell_int[i];
+			if (j <= j2 || j >= tensor_rows)
+				return false;
+
+			if (run_rows && j != j2 + 1) {
+				memcpy(p_dest, p_src + (int64_t) run_start*bytes_per_row, (int64_t) run_rows*bytes_per_row);
+				p_dest	 = p_dest + (int64_t) run_rows*bytes_per_row;
+				run_rows = 0;
+			}
+			if (run_rows == 0)
+				run_start = j;
+			run_rows++;
+			j2 = j;
+		}
+	}
+	if (run_rows)
+		memcpy(p_dest, p_src + (int64_t) run_start*bytes_per_row, (int64_t) run_rows*bytes_per_row);
+
+	return true;
+}
+
+
+/** Create a filter that selects, in a single new_block(3), the same rows as applying a chain of filters one after the other.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_filter		The chain of filters. p_filter[0] selects rows from the block to be filtered, p_filter[1] selects rows from
+						the result of that, etc. Each one is a tensor of boolean or integer of rank 1 (as in new_block(3)).
+	\param num_filters	The number of filters in p_filter[] (at least 1).
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Only the filters are visited, never the data. A chain of booleans is fused into a boolean of the size of p_filter[0] (each filter is
+AND-ed into the rows that survived the previous ones) and a chain with any integer filter into an integer filter (a composition of the
+lists of indices). Therefore, x[f1][f2][f3] gathers the rows of x once instead of copying a full intermediate block per filter.
+*/
+StatusCode Container::new_fused_filter(pTransaction &p_txn, pBlock p_filter[], int num_filters) {
+
+	if (num_filters < 1)
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+	int num_bool = 0;		// The number of leading boolean filters
+
+	for (int i = 0; i < num_filters; i++) {
+		if (p_filter[i] == nullptr || p_filter[i]->rank != 1 || !p_filter[i]->is_a_filter())
+			return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+		if (num_bool == i && p_filter[i]->cell_type == CELL_TYPE_BYTE_BOOLEAN)
+			num_bool++;
+	}
+
+	int dim[MAX_TENSOR_RANK] = {0, 0};
+
+	// A chain of booleans is AND-ed into the output (no list of rows is needed).
+
+	if (num_bool == num_filters) {
+		int size = p_filter[0]->size, rows = 0;
+
+		dim[0] = size;
+
+		StatusCode ret = new_block(p_txn, CELL_TYPE_BYTE_BOOLEAN, dim, FILL_NEW_DONT_FILL);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		bool *p_bool = p_txn->p_block->tensor.cell_bool;
+
+		for (int i = 0; i < size; i++)
+			rows += (p_bool[i] = p_filter[0]->tensor.cell_bool[i]);
+
+		for (int j = 1; j < num_filters; j++) {
+			bool *p_next = p_filter[j]->tensor.cell_bool;
+
+			if (p_filter[j]->size != rows) {
+				destroy_transaction(p_txn);
+
+				return SERVICE_ERROR_NEW_BLOCK_ARGS;
+			}
+			int num_rows = rows;
+
+			rows = 0;
+
+			for (int i = 0, k = 0; k < num_rows; i++) {
+				if (p_bool[i])
+					rows += (p_bool[i] = p_next[k++]);
+			}
+		}
+
+		return SERVICE_NO_ERROR;
+	}
+
+	// Otherwise, the first filter becomes a list of rows and all the others are applied to it in place.
+
+	pBlock p_first = p_filter[0];
+
+	std::vector<int> row;
+
+	if (num_bool == 0)
+		row.assign(p_first->tensor.cell_int, p_first->tensor.cell_int + p_first->size);
+	else {
+		bool *p_bool = p_first->tensor.cell_bool;
+		int	  size	 = p_first->size, k = 0;
+
+		row.resize(std::count(p_bool, p_bool + size, true) + 1);
+
+		for (int i = 0; i < size; i++) {		// Branchless: row[k] is overwritten until the k-th selected row is found
+			row[k] = i;
+			k	  += p_bool[i];
+		}
+		row.resize(k);
+	}
+
+	for (int j = 1; j < num_filters; j++) {
+		pBlock p_next	= p_filter[j];
+		int	   num_rows = row.size(), k = 0;
+
+		if (p_next->cell_type == CELL_TYPE_INTEGER) {
+			if (p_next->size > 0 && p_next->tensor.cell_int[p_next->size - 1] >= num_rows)
+				return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+			for (; k < p_next->size; k++)		// Safe in place: the indices are sorted and unique, so cell_int[k] >= k
+				row[k] = row[p_next->tensor.cell_int[k]];
+		} else {
+			if (p_next->size != num_rows)
+				return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+			for (int i = 0; i < num_rows; i++) {		// Branchless, as above
+				row[k] = row[i];
+				k	  += p_next->tensor.cell_bool[i];
+			}
+		}
+		row.resize(k);
+	}
+
+	dim[0] = row.size();
+
+	StatusCode ret = new_block(p_txn, CELL_TYPE_INTEGER, dim, FILL_NEW_DONT_FILL);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	if (dim[0] > 0)
+		memcpy(p_txn->p_block->tensor.cell_int, row.data(), dim[0]*sizeof(int));
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Create a new Block (4): Create a Tensor by selecting an item from a Tuple.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+					it when done.
+	\param p_from	The Tuple from which the item is selected.
+	\param name		The name of the item to be selected.
+	\param att		The attributes to set when creating the block. They are immutable. To change the attributes of a Block
+					use the version of new_block() with parameter p_from.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+The Tuple already has a method .block() that does this, the difference is the .block() method returns a pointer inside the Tuple
+while this makes a copy to a new block, possibly with attributes.
+*/
+StatusCode Container::new_block(pTransaction &p_txn,
+								pTuple		  p_from,
+						   		pChar		  name,
+								AttributeMap *att) {
+
+	if (p_from->cell_type != CELL_TYPE_TUPLE) {
+		p_txn = nullptr;
+
+		return SERVICE_ERROR_WRONG_TYPE;
+	}
+
+	int idx = p_from->index(name);
+
+	if (idx < 0) {
+		p_txn = nullptr;
+
+		return SERVICE_ERROR_WRONG_NAME;
+	}
+
+	pBlock p_block = p_from->get_block(idx);
+
+	return new_block(p_txn, p_block, (pBlock) nullptr, att);	// This manages the alloc issues of att and possible strings already.
+}
+
+
+/** Create a new Block (5): Create a Tensor, Kind or Tuple from a Text block kept as a Tensor of CELL_TYPE_BYTE of rank == 1 or a
+							Tensor of CELL_TYPE_STRING of size == 1
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
 						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
 						it when done.
 	\param p_from_text	The block containing a valid serialization of Tensor, Kind or Tuple.
@@ -1364,7 +1922,26 @@ StatusCode Container::new_block(pTransaction &p_txn,
 
 	switch (cell_type) {
 	case CELL_TYPE_TUPLE: {
-		pTransaction p_aux_txn[MAX_ITEMS_IN_KIND];
+		int str_bytes[MAX_ITEMS_IN_KIND];
+
+		for (int i = 0; i < num_items; i++) {
+			if (item_hea[i].cell_type == CELL_TYPE_STRING) {
+				int num_cells = item_hea[i].dim[0];
+
+				for (int j = 1; j < item_hea[i].rank; j++)
+					num_cells *= item_hea[i].dim[j];
+
+				str_bytes[i] = item_hea[i].item_size + num_cells;
+			} else
+				str_bytes[i] = 0;
+		}
+
+		int ret = new_tuple_block(p_txn, num_items, item_hea, item_name, str_bytes, att);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		pTuple p_tuple = reinterpret_cast<pTuple>(p_txn->p_block);
 
 		get_char(p_in, num_bytes);		// '(')
 
@@ -1373,27 +1950,19 @@ StatusCode Container::new_block(pTransaction &p_txn,
 			get_item_name(p_in, num_bytes, it_name);
 
 			if (item_hea[i].cell_type == CELL_TYPE_STRING) {
-				StatusCode ret = new_text_block(p_aux_txn[i], item_hea[i], p_in, num_bytes);
+				pTransaction p_none;
 
-				if (ret != SERVICE_NO_ERROR) {
-					for (int j = i - 1; j >= 0; j--) destroy_transaction(p_aux_txn[j]);
-
-					return ret;
-				}
-			} else {
-				int ret = new_block(p_aux_txn[i], item_hea[i].cell_type, item_hea[i].dim, FILL_NEW_DONT_FILL);
+				ret = new_text_block(p_none, item_hea[i], p_in, num_bytes, nullptr, p_tuple->get_block(i));
 
 				if (ret != SERVICE_NO_ERROR) {
-					for (int j = i - 1; j >= 0; j--) destroy_transaction(p_aux_txn[j]);
+					destroy_transaction(p_txn);
 
 					return ret;
 				}
+			} else if (!fill_tensor(p_in, num_bytes, p_tuple->get_block(i))) {
+				destroy_transaction(p_txn);
 
-				if (!fill_tensor(p_in, num_bytes, p_aux_txn[i]->p_block)) {
-					for (int j = i; j >= 0; j--) destroy_transaction(p_aux_txn[j]);
-
-					return PARSE_ERROR_TENSOR_FILLING;
-				}
+				return PARSE_ERROR_TENSOR_FILLING;
 			}
 			skip_space(p_in, num_bytes);
 
@@ -1401,21 +1970,7 @@ StatusCode Container::new_block(pTransaction &p_txn,
 				get_char(p_in, num_bytes);
 		}
 
-		pBlock			  p_item_blck[MAX_ITEMS_IN_KIND];
-		StaticBlockHeader p_hea		 [MAX_ITEMS_IN_KIND];
-
-		for (int i = 0; i < num_items; i++) {
-			p_item_blck[i] = p_aux_txn[i]->p_block;
-			memcpy(&p_hea[i], p_item_blck[i], sizeof(StaticBlockHeader));
-			p_item_blck[i]->get_dimensions(&p_hea[i].range.dim[0]);
-		}
-
-		int ret = new_block(p_txn, num_items, p_hea, item_name, p_item_blck, nullptr, att);
-
-		for (int i = 0; i < num_items; i++)
-			destroy_transaction(p_aux_txn[i]);
-
-		return ret;
+		return SERVICE_NO_ERROR;
 	}
 	case CELL_TYPE_BLOCK_KIND:
 	case CELL_TYPE_TUPLE_KIND: {
@@ -1732,660 +2287,2057 @@ StatusCode Container::new_block(pTransaction &p_txn, Index &index) {
 		bytes_val += it->second.length();
 	}
 
-	pTransaction p_key, p_val;
-
-	int dim[MAX_TENSOR_RANK] = {num_rows, 0, 0, 0, 0, 0};
-
-	int ret;
-
-	if ((ret = new_block(p_key, CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, bytes_key + 2*num_rows)) != SERVICE_NO_ERROR) return ret;
+	ItemHeader item[2] = {{CELL_TYPE_STRING, 0, 1, {num_rows, 0, 0, 0, 0, 0}}, {CELL_TYPE_STRING, 0, 1, {num_rows, 0, 0, 0, 0, 0}}};
+	Name	   name[2] = {"key", "value"};
+	int		   str_bytes[2] = {bytes_key + 2*num_rows, bytes_val + 2*num_rows};
 
-	if ((ret = new_block(p_val, CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, bytes_val + 2*num_rows)) != SERVICE_NO_ERROR) {
-		destroy_transaction(p_key);
+	int ret = new_tuple_block(p_txn, 2, item, name, str_bytes);
 
+	if (ret != SERVICE_NO_ERROR)
 		return ret;
-	}
+
 	int i = 0;
-	pBlock key = p_key->p_block, val = p_val->p_block;
+	pBlock key = pTuple(p_txn->p_block)->get_block(0), val = pTuple(p_txn->p_block)->get_block(1);
 	for (Index::iterator it = index.begin(); it != index.end(); ++it) {
 		key->set_string(i, it->first.c_str());
 		val->set_string(i++, it->second.c_str());
 	}
 
-	StaticBlockHeader hea[2];
-	Name			  name[2]  = {"key", "value"};
-	pBlock			  block[2] = {key, val};
-
-	memcpy(&hea[0], key, sizeof(StaticBlockHeader));
-	memcpy(&hea[1], val, sizeof(StaticBlockHeader));
-	hea[0].range.dim[0] = num_rows;
-	hea[1].range.dim[0] = num_rows;
-
-	ret = new_block(p_txn, 2, hea, name, block);
-
-	destroy_transaction(p_key);
-	destroy_transaction(p_val);
-
-	return ret;
+	return SERVICE_NO_ERROR;
 }
 
 
-/** "Easy" interface **complete Block** retrieval. This parses p_what and, on success, calls the native get() equivalent.
+/** Create a new Block (9): Create a Tuple of a Kind, laid out in place, ready to be filled without copying its items.
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_kind		The Kind (a block of CELL_TYPE_TUPLE_KIND) defining the names, types and shapes of the items.
+	\param dims		The values of all the dimensions used by the Kind, by name.
+	\param p_str_bytes	An (optional) array of p_kind->size sizes of the string buffers to reserve for each item. It is only useful for
+						items of CELL_TYPE_STRING that are filled with Block.set_string().
+	\param att			The attributes to set when creating the block. They are immutable.
 
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
+The items are initialized (as new_block() with FILL_NEW_DONT_FILL would do) at their final place inside the Tuple. The caller fills them
+via pTuple(p_txn->p_block)->get_block() and, when done, calls close_tuple() to set has_NA, the hashes and the creation times. This
+avoids creating each item as a Block just to copy it into the Tuple.
 */
-StatusCode Container::get(pTransaction &p_txn, pChar p_what) {
-	Locator loc;
-	StatusCode ret;
+StatusCode Container::new_block(pTransaction &p_txn,
+								pKind		  p_kind,
+								MapSI		 &dims,
+								int			  p_str_bytes[],
+								AttributeMap *att) {
 
 	p_txn = nullptr;
 
-	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+	if (p_kind == nullptr || p_kind->cell_type != CELL_TYPE_TUPLE_KIND)
+		return SERVICE_ERROR_WRONG_TYPE;
 
-	return get(p_txn, loc);
-}
+	int num_items = p_kind->size;
 
+	if (num_items < 1 || num_items > MAX_ITEMS_IN_KIND)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
 
-/** "Easy" interface **selection of rows in a Block** retrieval. This parses p_what and, on success, calls the native get() equivalent.
+	ItemHeader item[MAX_ITEMS_IN_KIND];
+	Name	   name[MAX_ITEMS_IN_KIND];
 
-	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-						Transaction inside the Container.
-	\param p_what		Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
-	\param p_row_filter	The block we want to use as a filter. This is either a tensor of boolean or integer that can_filter(p_from).
+	for (int i = 0; i < num_items; i++) {
+		ItemHeader *p_it_hea = &p_kind->tensor.cell_item[i];
 
-	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+		item[i].cell_type = p_it_hea->cell_type;
+		item[i].rank	  = p_it_hea->rank;
 
-Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
-*/
-StatusCode Container::get(pTransaction &p_txn, pChar p_what, pBlock p_row_filter) {
-	Locator loc;
-	StatusCode ret;
+		for (int j = 0; j < MAX_TENSOR_RANK; j++) {
+			if (j >= p_it_hea->rank) {
+				item[i].dim[j] = 0;
 
-	p_txn = nullptr;
+				continue;
+			}
+			int k = p_it_hea->dim[j];
 
-	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+			if (k < 0) {
+				MapSI::iterator it = dims.find(String(&p_kind->p_string_buffer()->buffer[-k]));
 
-	return get(p_txn, loc, p_row_filter);
-}
+				if (it == dims.end())
+					return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+				if ((k = it->second) < 0)
+					return SERVICE_ERROR_WRONG_ARGUMENTS;
+			}
+			item[i].dim[j] = k;
+		}
+		strncpy(name[i], p_kind->item_name(i), NAME_SIZE);
+		name[i][NAME_LENGTH] = 0;
+	}
 
+	return new_tuple_block(p_txn, num_items, item, name, p_str_bytes, att);
+}
 
-/** "Easy" interface **selection of a tensor in a Tuple** retrieval. This parses p_what and, on success, calls the native get() equivalent.
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
-	\param name		The name of the item to be selected.
+/** Copies the cells selected by a StridedView into a contiguous (row major) tensor.
 
-	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+	\param p_dest	The destination with space for all the cells of the view.
+	\param p_src	The cells of the tensor of the view.
+	\param view		The view (its offset and strides are in cells).
 
-Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
+The last two dimensions are copied as rows (memcpy when the innermost stride is 1) or, when the innermost stride is not 1 (e.g., a
+transposed view), in STRIDED_VIEW_TILE x STRIDED_VIEW_TILE tiles so that both the reads and the writes stay within a few cache lines.
+The outer dimensions (if any) are walked with an odometer.
 */
-StatusCode Container::get(pTransaction &p_txn, pChar p_what, pChar name) {
-	Locator loc;
-	StatusCode ret;
+template <typename T> void strided_copy(T *p_dest, T *p_src, StridedView &view) {
+	int r = view.rank;
 
-	p_txn = nullptr;
+	if (r == 1) {
+		T *p_s = p_src + view.offset;
+		int st = view.stride[0];
 
-	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+		for (int i = 0; i < view.shape[0]; i++)
+			p_dest[i] = p_s[i*st];
 
-	return get(p_txn, loc, name);
-}
+		return;
+	}
 
+	int rows = view.shape[r - 2], cols = view.shape[r - 1], s_row = view.stride[r - 2], s_col = view.stride[r - 1];
+	int idx[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0};
 
-/** "Easy" interface : Locate a block by some relation that is understandable by the descendant.
+	while (true) {
+		int base = view.offset;
 
-	\param location	The solved location of the block.
-	\param p_what	A valid reference to a block. E.g. //deque/ent/~first, //tree/ent/key~parent, //queue/ent/~highest
+		for (int k = 0; k < r - 2; k++)
+			base += idx[k]*view.stride[k];
 
-	\return	SERVICE_NO_ERROR on success (and a valid location), or some negative value (error).
+		T *p_s = p_src + base;
 
-The default behaviour of this is returning the same locator that is given for most Containers. Only containers like Volatile which
-support block relations defined by commands will return actual //base/ent/key locators that are the result of some computation.
-*/
-StatusCode Container::locate(Locator &location, pChar p_what) {
-	Locator what;
-	StatusCode ret;
-
-	if ((ret = as_locator(what, p_what)) != SERVICE_NO_ERROR)
-		return ret;
-
-	return locate(location, what);
-}
-
-
-/** "Easy" interface **metadata of a Block** retrieval. This parses p_what and, on success, calls the native header() equivalent.
+		if (s_col == 1) {
+			for (int i = 0; i < rows; i++)
+				memcpy(&p_dest[i*cols], &p_s[i*s_row], cols*sizeof(T));
+		} else {
+			for (int ii = 0; ii < rows; ii += STRIDED_VIEW_TILE) {
+				int i_end = std::min(ii + STRIDED_VIEW_TILE, rows);
 
-	\param hea		A StaticBlockHeader structure that will receive the metadata.
-	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+				for (int jj = 0; jj < cols; jj += STRIDED_VIEW_TILE) {
+					int j_end = std::min(jj + STRIDED_VIEW_TILE, cols);
 
-	\return	SERVICE_NO_ERROR on success (and a valid hea), or some negative value (error).
+					for (int j = jj; j < j_end; j++)
+						for (int i = ii; i < i_end; i++)
+							p_dest[i*cols + j] = p_s[i*s_row + j*s_col];
+				}
+			}
+		}
+		p_dest += rows*cols;
 
-This is a faster, not involving RAM allocation version of the other form of header. For a tensor, is will be the only thing you need, but
-for a Kind or a Tuple, you probably want the types of all its items and need to pass a pTransaction to hold the data.
-*/
-StatusCode Container::header(StaticBlockHeader &hea, pChar p_what) {
-	Locator loc;
-	StatusCode ret;
+		int k = r - 3;
 
-	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+		while (k >= 0 && ++idx[k] == view.shape[k])
+			idx[k--] = 0;
 
-	return header(hea, loc);
+		if (k < 0)
+			return;
+	}
 }
 
 
-/** "Easy" interface **metadata of a Block** retrieval. This parses p_what and, on success, calls the native header() equivalent.
+/** Create a new Block (10): Create a Tensor with the cells selected by a StridedView.
 
 	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+					Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+					it when done.
+	\param view		A StridedView (see new_strided_view(), slice_view() and transpose_view()).
 
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-Unlike its faster form, this allocates a Block and therefore, it is equivalent to a new_block() call. On success, it will return a
-Transaction that belongs to the Container and must be destroy_transaction()-ed when the caller is done.
-
-For Tensors it will allocate a block that only has the StaticBlockHeader (What you can more efficiently get from the other form.)
-For Kinds, the metadata of all the items is exactly the same a .get() call returns.
-For Tuples, it does what you expect: returning a Block with the metadata of all the items without the data.
+The new block has the shape of the view, the attributes of the source and (for strings) its StringBuffer as is, since the cells are
+offsets into it. The cells are copied once, in the order of the view (see strided_copy()).
 */
-StatusCode Container::header(pTransaction &p_txn, pChar p_what) {
-	Locator loc;
-	StatusCode ret;
+StatusCode Container::new_block(pTransaction &p_txn, StridedView &view) {
 
-	p_txn = nullptr;
+	pBlock p_from = view.p_block;
 
-	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+	if (p_from == nullptr || p_from->size <= 0 || view.rank != p_from->rank) {
+		p_txn = nullptr;
 
-	return header(p_txn, loc);
-}
+		return SERVICE_ERROR_NEW_BLOCK_ARGS;
+	}
 
+	int cell_size = p_from->cell_type & 0xff;
 
-/** "Easy" interface for **Block storing**: This parses p_where and, on success, calls the native put() equivalent.
+	if (cell_size != 1 && cell_size != 2 && cell_size != 4 && cell_size != 8) {
+		p_txn = nullptr;
 
-	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
-	\param p_block	A block to be stored. Notice it is a block, not a Transaction. If necessary, the Container will make a copy, write to
-					disc, PUT it via http, etc. The container does not own the pointer in any way.
-	\param mode		Some writing restriction that should return an error if not supported. It controls overriding or writing just the data
-					as when writing to a file.
+		return SERVICE_ERROR_WRONG_TYPE;
+	}
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
-*/
-StatusCode Container::put(pChar p_where, pBlock p_block, int mode) {
-	Locator loc;
-	StatusCode ret;
+	int dim[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0}, size = 1;
 
-	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
-		return ret;
+	for (int i = 0; i < view.rank; i++) {
+		if (view.shape[i] <= 0) {
+			p_txn = nullptr;
 
-	return put(loc, p_block, mode);
-}
+			return SERVICE_ERROR_NEW_BLOCK_ARGS;
+		}
+		dim[i] = view.shape[i];
+		size  *= view.shape[i];
+	}
 
+	StatusCode ret = new_transaction(p_txn);
 
-/** "Easy" interface for **creating entities**: This parses p_where and, on success, calls the native new_entity() equivalent.
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
 
-	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity
+	int old_tensor_size = (uintptr_t) p_from->align64bit(p_from->size*cell_size),
+		new_tensor_size = (uintptr_t) p_from->align64bit(size*cell_size),
+		total_bytes		= p_from->total_bytes + new_tensor_size - old_tensor_size;
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+	p_txn->p_block = block_malloc(total_bytes);
 
-	What an entity is, is Container and base dependent. It can be an lmdb database, a folder in a filesystem, a Volatile tree, ...
-*/
-StatusCode Container::new_entity(pChar p_where) {
-	Locator loc;
-	StatusCode ret;
+	if (p_txn->p_block == nullptr) {
+		destroy_transaction(p_txn);
 
-	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
-		return ret;
+		return SERVICE_ERROR_NO_MEM;
+	}
 
-	return new_entity(loc);
-}
+#ifdef DEBUG		// Initialize everything for Valgrind.
+	memset(p_txn->p_block, 0, total_bytes);
+#endif
+
+	memcpy(p_txn->p_block, p_from, sizeof(BlockHeader));
 
+	p_txn->p_block->total_bytes = total_bytes;
+	p_txn->p_block->set_dimensions(dim);
 
-/** "Easy" interface for **deleting entities and blocks**: This parses p_where and, on success, calls the native header() equivalent.
+	switch (cell_size) {
+	case 1:
+		strided_copy(p_txn->p_block->tensor.cell_byte, p_from->tensor.cell_byte, view);
+		break;
+	case 2:
+		strided_copy((uint16_t *) p_txn->p_block->tensor.cell_byte, (uint16_t *) p_from->tensor.cell_byte, view);
+		break;
+	case 4:
+		strided_copy(p_txn->p_block->tensor.cell_uint, p_from->tensor.cell_uint, view);
+		break;
+	default:
+		strided_copy(p_txn->p_block->tensor.cell_ulongint, p_from->tensor.cell_ulongint, view);
+	}
 
-	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity or //base/entity/key
+	memcpy(p_txn->p_block->p_attribute_keys(), p_from->p_attribute_keys(), p_from->num_attributes*2*sizeof(int));
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+	pStringBuffer p_nsb = p_txn->p_block->p_string_buffer(), p_osb = p_from->p_string_buffer();
 
-	What an entity is, is Container and base dependent. It can be an lmdb database, a folder in a filesystem, a Volatile tree, ...
-*/
-StatusCode Container::remove(pChar p_where) {
-	Locator loc;
-	StatusCode ret;
+	memcpy(p_nsb, p_osb, p_osb->buffer_size + sizeof(StringBuffer));
 
-	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
-		return ret;
+	p_txn->p_block->hash64 = 0;
 
-	return remove(loc);
-}
+	p_txn->status = BLOCK_STATUS_READY;
 
+	return SERVICE_NO_ERROR;
+}
 
-/** "Easy" interface for **Block copying**: This parses p_what and p_where. On success, it calls the native copy() equivalent.
 
-	\param p_where	Some **destination** that as_locator() can parse into a Locator. E.g. //base/entity/key
-	\param p_what	Some **source** that as_locator() can parse into a Locator. E.g. //base/entity/key
+/** Initialize a StridedView as the whole tensor of a Block (the identity view).
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+	\param view		The view.
+	\param p_from	The tensor. It must outlive the view.
 
-**NOTE**: This does not copy blocks across Containers. A copy() call is a short way to do "get(tx, what); put(where, tx);
-destroy_transaction(tx);" without the Container needing to allocate Transactions and, possibly, not even blocks. To copy blocks
-across containers, you need channels.
+	\return	False if p_from is not a (non-empty) tensor.
 */
-StatusCode Container::copy(pChar p_where, pChar p_what) {
-	Locator where, what;
-	StatusCode ret;
+bool Container::new_strided_view(StridedView &view, pBlock p_from) {
 
-	if ((ret = as_locator(where, p_where)) != SERVICE_NO_ERROR)
-		return ret;
+	if (p_from == nullptr || p_from->size <= 0 || p_from->rank < 1 || p_from->rank > MAX_TENSOR_RANK || (p_from->cell_type & 0xff) > 8)
+		return false;
 
-	if ((ret = as_locator(what, p_what)) != SERVICE_NO_ERROR)
-		return ret;
+	view.p_block = p_from;
+	view.rank	 = p_from->rank;
+	view.offset	 = 0;
 
-	return copy(where, what);
+	p_from->get_dimensions(view.shape);
+
+	for (int i = 0; i < view.rank; i++)
+		view.stride[i] = p_from->range.dim[i];
+
+	return true;
 }
 
 
-/** The function call interface for **exec**: Execute a function or a model.
+/** Apply a sequence of slices and transposes to a StridedView.
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param function	Some description of a service. In general base/entity/key. In Channels the key must be empty and the entity is
-					the pipeline. In Core, the key is field/snippet, In Model (via ModelAPI), model/(entry point).
-	\param p_args	A Tuple passed as argument to the call that is not modified.
+	\param view		The view.
+	\param p_slice	A sequence of "[slice]" and ".T" (E.g., "[::2,10:20].T[3:]"). Each slice is a comma separated list of up to view.rank
+					start:stop:step ranges (as in Python, any part can be omitted and negative start or stop count from the end) or
+					single indices (which keep the dimension with size 1). The dimensions not in the list are kept whole.
 
-	\return	SERVICE_ERROR_NOT_APPLICABLE since this method must be implemented in the Container descendants.
+	\return	False on a syntax error, a step of zero, an index out of range or an empty slice. The view is undefined then.
 
-Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
+Only the descriptor is updated, nothing is read from the tensor.
 */
-StatusCode Container::exec(pTransaction &p_txn, Locator &function, pTuple p_args) {
+bool Container::slice_view(StridedView &view, pChar p_slice) {
 
-	return SERVICE_ERROR_NOT_APPLICABLE;
-}
+	while (*p_slice) {
+		if (*p_slice == '.') {
+			if (p_slice[1] != 'T')
+				return false;
 
+			transpose_view(view);
+			p_slice += 2;
 
-/** The function call interface for **modify**: In jazz_elements, this is only implemented in Channels.
+			continue;
+		}
+		if (*(p_slice++) != '[')
+			return false;
 
-	\param function	Some description of a service. In general base/entity/key. In Channels the key must be empty and the entity is
-					the pipeline.
-	\param p_args	In Channels: A Tuple with two items, "input" with the data passed to the service and "result" with the data returned.
-					The result will be overridden in-place without any allocation.
+		for (int i = 0; true; i++) {
+			if (i == view.rank)
+				return false;
 
-	\return	SERVICE_ERROR_NOT_APPLICABLE since this method must be implemented in the Container descendants.
+			int	 value[3], parts = 0;
+			bool given[3] = {false, false, false};
 
-modify() is similar to exec(), but, rather than creating a new block with the result, it modifies the Tuple p_args.
-*/
-StatusCode Container::modify(Locator &function, pTuple p_args) {
+			while (true) {
+				if (*p_slice != ':' && *p_slice != ',' && *p_slice != ']') {
+					pChar p_end;
+					value[parts] = strtol(p_slice, &p_end, 10);
 
-	return SERVICE_ERROR_NOT_APPLICABLE;
-}
+					if (p_end == p_slice)
+						return false;
 
+					given[parts] = true;
+					p_slice		 = p_end;
+				}
+				parts++;
 
-/** The parser: A simple parser that does not support Locator.p_extra, but is enough for Volatile and Persisted.
+				if (*p_slice != ':')
+					break;
 
-	\param result	A Locator to contained the parsed result on success. (Undefined content on error.)
-	\param p_what	Some string to be parsed. E.g. //base/entity/key
+				if (parts == 3)
+					return false;
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+				p_slice++;
+			}
 
-More complex Container descendants that support URLs, credentials, cookies, etc. will override this minimalistic parser.
-*/
-StatusCode Container::as_locator(Locator &result, pChar p_what) {
+			int len = view.shape[i], start, size, step = 1;
 
-	if (p_what[0] != '/' || p_what[1] != '/')
-		return SERVICE_ERROR_PARSING_NAMES;
+			if (parts == 1) {
+				if (!given[0])
+					return false;
 
-	p_what += 2;
+				start = value[0] < 0 ? value[0] + len : value[0];
 
-	int	  section = 0;
-	int	  size	  = LOCATOR_SIZE[section];
-	bool  written = false, number = false;
-	pChar p_out	  = (pChar) &result.base;
+				if (start < 0 || start >= len)
+					return false;
 
-	while (true) {
-		switch (char ch = *(p_what++)) {
-		case '~':
-			number = section == 2;
+				size = 1;
+			} else {
+				if (given[2])
+					step = value[2];
+
+				if (step == 0)
+					return false;
+
+				int stop;
+
+				if (step > 0) {
+					start = !given[0] ? 0	: value[0] < 0 ? std::max(0, value[0] + len) : std::min(value[0], len);
+					stop  = !given[1] ? len : value[1] < 0 ? std::max(0, value[1] + len) : std::min(value[1], len);
+					size  = stop > start ? (stop - start + step - 1)/step : 0;
+				} else {
+					start = !given[0] ? len - 1 : value[0] < 0 ? std::max(-1, value[0] + len) : std::min(value[0], len - 1);
+					stop  = !given[1] ? -1		: value[1] < 0 ? std::max(-1, value[1] + len) : std::min(value[1], len - 1);
+					size  = start > stop ? (start - stop - step - 1)/(-step) : 0;
+				}
+				if (size == 0)
+					return false;
+			}
+			view.offset	   += start*view.stride[i];
+			view.stride[i] *= step;
+			view.shape[i]	= size;
 
-			if (--size < 0) return SERVICE_ERROR_PARSING_NAMES;
+			if (*p_slice == ']')
+				break;
 
-			*(p_out++) = ch;
-			written	   = true;
+			if (*(p_slice++) != ',')
+				return false;
+		}
+		p_slice++;
+	}
 
-			break;
+	return true;
+}
 
-		case '.':
-			if (!number) return SERVICE_ERROR_PARSING_NUMBERS;
 
-		case 'a' ... 'z':
-		case 'A' ... 'Z':
-		case '_':
-			number = false;
-		case '0' ... '9':
-		case '-':
-			if (--size < 0) return SERVICE_ERROR_PARSING_NAMES;
+/** Transpose a StridedView: reverse the order of its dimensions (like .T in NumPy).
 
-			*(p_out++) = ch;
-			written	   = true;
+	\param view		The view.
 
-			break;
+Only the descriptor is updated, nothing is read from the tensor.
+*/
+void Container::transpose_view(StridedView &view) {
 
-		case '/':
-			if (!written) return SERVICE_ERROR_PARSING_NAMES;
+	std::reverse(view.shape, view.shape + view.rank);
+	std::reverse(view.stride, view.stride + view.rank);
+}
 
-			*(p_out++) = 0;
 
-			if (++section > 2) return SERVICE_ERROR_PARSING_NAMES;
+/** Create a TextStream to parse a numeric tensor from its text as it arrives (see the "Streaming text parser" section).
 
-			if (section == 1)
-				p_out = (pChar) &result.entity;
-			else
-				p_out = (pChar) &result.key;
+	\return	The TextStream (the caller **must** destroy_text_stream() it) or nullptr if the allocation fails.
+*/
+pTextStream Container::new_text_stream() {
 
-			size	= LOCATOR_SIZE[section];
-			written = false;
+	pTextStream p_stream = (pTextStream) malloc(sizeof(TextStream));
 
-			break;
+	if (p_stream == nullptr)
+		return nullptr;
 
-		case 0:
-			if (!written) return SERVICE_ERROR_PARSING_NAMES;
+	memset(p_stream, 0, sizeof(TextStream) - sizeof(p_stream->p_chunk));
+	memset(p_stream->dim, -1, sizeof(p_stream->dim));
 
-			*(p_out++) = 0;
+	p_stream->state		= PSTATE_IN_AUTO;
+	p_stream->cell_type = CELL_TYPE_UNDEFINED;
+	p_stream->level		= -1;
+	p_stream->first_row = true;
 
-			if (section == 0) return SERVICE_ERROR_PARSING_NAMES;
+	return p_stream;
+}
 
-			if (section == 1)
-				result.key[0] = 0;
 
-			result.p_extra = nullptr;
+/** Parse the next bytes of the text of a numeric tensor.
 
-			return SERVICE_NO_ERROR;
+	\param p_stream		The TextStream returned by new_text_stream().
+	\param p_in			The next bytes of the text. They can end anywhere, even inside a cell.
+	\param num_bytes	The number of bytes in p_in.
 
-		default:
-			return SERVICE_ERROR_PARSING_NAMES;
-		}
-	}
-}
+	\return	True on success. False if the text is not a valid numeric tensor or the allocation of a chunk fails. If .cell_type is still
+			CELL_TYPE_UNDEFINED after a failure, the text may still be something else that new_block() (5) can parse.
 
+This is get_shape_and_size() and fill_tensor() merged into a single pass: each ']' checks the size of the dimension it closes and
+each ',' or ']' ending a cell writes it to the chunks. Only spaces can follow the last ']'. It is new_block() (11) that checks the number of
+cells matches the shape.
+*/
+bool Container::feed_text_stream(pTextStream p_stream, pChar p_in, int num_bytes) {
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+	TextStream &ts = *p_stream;
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param what		A valid reference to a block as a locator. E.g. //base/entity/key
+	while (num_bytes > 0) {
+		unsigned char cursor = get_char(p_in, num_bytes);
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+		if (ts.closed) {
+			if (cursor == ' ' || cursor == '\t' || cursor == '\n' || cursor == '\r')
+				continue;
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::get(pTransaction &p_txn, Locator &what) {
+			return false;
+		}
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+		int state = parser_state_switch[ts.state].next[cursor];
 
+		if (ts.cell_type == CELL_TYPE_UNDEFINED) {
+			switch (state) {
+			case PSTATE_CONST_REAL:
+				ts.cell_type = CELL_TYPE_DOUBLE;
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+				break;
 
-	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-						Transaction inside the Container.
-	\param what			A valid reference to a block as a locator. E.g. //base/entity/key
-	\param p_row_filter	The block we want to use as a filter. This is either a tensor of boolean or integer that can_filter(p_from).
+			case PSTATE_SEP_INT:
+			case PSTATE_OUT_INT:
+				ts.cell_type = CELL_TYPE_INTEGER;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+				break;
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::get(pTransaction &p_txn, Locator &what, pBlock p_row_filter) {
+			case PSTATE_IN_REAL:	// A leading '.' is not a valid cell for new_block() (5) either.
+				return false;
+			}
+		}
+		ts.state = state;
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+		switch (state) {
+		case PSTATE_OUT_INT:
+		case PSTATE_OUT_REAL:
+			if (cursor == ']') {
+				if (ts.level == ts.rank - 1) {
+					if (!push_stream_cell(p_stream)) return false;
+				} else if (ts.cell_len != 0)
+					return false;
 
+				ts.n_item[ts.level]++;
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+				if (ts.dim[ts.level] < 0)
+					ts.dim[ts.level] = ts.n_item[ts.level];
+				else if (ts.dim[ts.level] != ts.n_item[ts.level])
+					return false;
 
-	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param what		A valid reference to a block as a locator. E.g. //base/entity/key
-	\param name		The name of the item to be selected.
+				ts.first_row = false;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+				if (--ts.level < 0)
+					ts.closed = true;
+			}
+			break;
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::get(pTransaction &p_txn, Locator &what, pChar name) {
+		case PSTATE_IN_AUTO:
+		case PSTATE_IN_INT:
+		case PSTATE_IN_REAL:
+			if (cursor == ',') {
+				if (ts.level == ts.rank - 1) {		// A cell ended by a space, then the ','
+					if (!push_stream_cell(p_stream)) return false;
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+					ts.first_row = false;
+				}
+				ts.n_item[ts.level]++;
+			}
 
+			if (cursor == '[') {
+				if (++ts.level >= MAX_TENSOR_RANK) return false;
 
-/** The "native" interface: The default behavior for most Container descendants that do not support commands is just copying.
+				if (ts.first_row)
+					ts.rank = ts.level + 1;
+				else if (ts.level >= ts.rank)
+					return false;
 
-	\param location	The solved location of the block.
-	\param what		A valid reference to a block. E.g. //deque/ent/~first, //tree/ent/key~parent, //queue/ent/~highest
+				ts.n_item[ts.level] = 0;
+			}
+			break;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+		case PSTATE_SEP_INT:
+		case PSTATE_SEP_REAL:
+			if (cursor == ',') {
+				if (ts.level != ts.rank - 1 || !push_stream_cell(p_stream)) return false;
 
-NOTE: This just copies what into location. It will not verify the existence of the block. The function of locate() is to
-evaluate commands in Containers supporting them (E.g, Volatile). Otherwise, it is a trivial conversion from the easy into the native API.
-*/
-StatusCode Container::locate(Locator &location, Locator &what) {
+				ts.n_item[ts.level]++;
+			}
+			ts.first_row = false;
 
-	memcpy(&location, &what, sizeof(Locator));
+			break;
 
-	return SERVICE_NO_ERROR;
-}
+		case PSTATE_CONST_AUTO:
+		case PSTATE_CONST_INT:
+		case PSTATE_CONST_REAL:
+			if (ts.level < 0 || ts.level != ts.rank - 1 || ts.cell_len == MAX_SIZE_OF_CELL_AS_TEXT - 1) return false;
 
+			ts.cell[ts.cell_len++] = cursor;
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+			break;
 
-	\param hea		A StaticBlockHeader structure that will receive the metadata.
-	\param what		Some Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+		case PSTATE_NA_INT:
+		case PSTATE_NA_REAL:
+			break;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+		default:			// Strings, times, an empty tensor or an invalid char.
 
-	**NOTE**: The root Container class does not implement this.
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/** Release a TextStream and all its chunks.
+
+	\param p_stream	The TextStream returned by new_text_stream(). It is set to nullptr.
 */
-StatusCode Container::header(StaticBlockHeader &hea, Locator &what) {
+void Container::destroy_text_stream(pTextStream &p_stream) {
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+	for (int i = 0; i < p_stream->num_chunks; i++) {
+		std::free(p_stream->p_chunk[i]);
+
+		alloc_bytes -= TEXT_STREAM_CHUNK_BYTES;
+	}
+	std::free(p_stream);
+
+	alloc_bytes -= sizeof(TextStream);
+
+	p_stream = nullptr;
 }
 
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+/** Create a new Block (11): Create a Tensor from a TextStream that has been fed a complete numeric tensor.
 
 	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-					Transaction inside the Container.
-	\param what		Some Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+					Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+					it when done.
+	\param p_stream	A TextStream after the feed_text_stream() call with its last ']'. It is not destroyed.
+	\param att		The attributes to set when creating the block. They are immutable.
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-	**NOTE**: The root Container class does not implement this.
+The result is the same as new_block() (5) with CELL_TYPE_UNDEFINED would return from the whole text.
 */
-StatusCode Container::header(pTransaction &p_txn, Locator &what) {
+StatusCode Container::new_block(pTransaction &p_txn, pTextStream p_stream, AttributeMap *att) {
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+	p_txn = nullptr;
 
+	if (!p_stream->closed)
+		return PARSE_ERROR_UNEXPECTED_EOF;
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+	int dim[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0};
 
-	\param where	Some **destination** Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
-	\param p_block	The Block to be stored in Volatile. The Block hash and dated will be updated by this call!!
-	\param mode		Some writing restriction, either WRITE_ONLY_IF_EXISTS or WRITE_ONLY_IF_NOT_EXISTS. WRITE_TENSOR_DATA returns
-					the error SERVICE_ERROR_WRONG_ARGUMENTS
+	memcpy(dim, p_stream->dim, p_stream->rank*sizeof(int));
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+	StatusCode ret = new_block(p_txn, p_stream->cell_type, dim, FILL_NEW_DONT_FILL, 0, nullptr, '\n', att);
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::put(Locator &where, pBlock p_block, int mode) {
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+	if (p_txn->p_block->size != p_stream->num_cells) {
+		destroy_transaction(p_txn);
 
+		return PARSE_ERROR_TENSOR_FILLING;
+	}
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+	uint8_t *p_dest	= &p_txn->p_block->tensor.cell_byte[0];
+	int64_t	 bytes	= (int64_t) p_stream->num_cells*(p_stream->cell_type & 0xf);
 
-	\param where	Some **destination** Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+	for (int i = 0; i < p_stream->num_chunks; i++) {
+		int size = bytes < TEXT_STREAM_CHUNK_BYTES ? bytes : TEXT_STREAM_CHUNK_BYTES;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+		memcpy(p_dest, p_stream->p_chunk[i], size);
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::new_entity(Locator &where) {
+		p_dest += size;
+		bytes  -= size;
+	}
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+	return SERVICE_NO_ERROR;
 }
 
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+/** Serialize a tensor or a Tuple as an Apache Arrow IPC stream.
 
-	\param where	The block or entity to be removed. (See Node Method Reference in the documentation of the class Volatile.)
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_from_raw	The tensor or Tuple to be serialized.
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-	**NOTE**: The root Container class does not implement this.
+The result is a Tensor of CELL_TYPE_BYTE of rank == 1 with the stream: a Schema message, a RecordBatch message and the end-of-stream
+marker. Each message is 8-byte aligned (relative to the start of the stream) and so is every Buffer in the body of the RecordBatch,
+so a client can memory-map it as is. See the "Apache Arrow" section of the Container documentation for the mapping.
 */
-StatusCode Container::remove(Locator &where) {
+StatusCode Container::new_arrow(pTransaction &p_txn, pBlock p_from_raw) {
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+	p_txn = nullptr;
 
+	ArrowColumn col[MAX_ITEMS_IN_KIND];
+	int			num_cols, layout;
 
-/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+	memset(col, 0, sizeof(col));
 
-	\param where	The block or entity to be written. (See Node Method Reference in the documentation of the class Volatile.)
-	\param what		The block or entity to be read. (See Node Method Reference in the documentation of the class Volatile.)
+	if (p_from_raw->cell_type == CELL_TYPE_TUPLE) {
+		num_cols = p_from_raw->size;
+		layout	 = ARROW_LAYOUT_ROWS;
 
-	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+		if (num_cols < 1 || num_cols > MAX_ITEMS_IN_KIND)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
 
-	**NOTE**: The root Container class does not implement this.
-*/
-StatusCode Container::copy(Locator &where, Locator &what) {
+		for (int i = 0; i < num_cols; i++) {
+			col[i].p_block = pTuple(p_from_raw)->get_block(i);
+			strncpy(col[i].name, pTuple(p_from_raw)->item_name(i), NAME_LENGTH);
 
-	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
-}
+			if (col[i].p_block->size != 0 || col[0].p_block->size != 0) {
+				int dim_0[MAX_TENSOR_RANK], dim_i[MAX_TENSOR_RANK];
 
+				col[0].p_block->get_dimensions(dim_0);
+				col[i].p_block->get_dimensions(dim_i);
 
-/** Add the base names for this Container.
+				if (dim_i[0] != dim_0[0])
+					layout = ARROW_LAYOUT_ITEMS;
+			}
+		}
+	} else {
+		num_cols = 1;
+		layout	 = ARROW_LAYOUT_TENSOR;
 
-	\param base_names	A BaseNames map passed by reference to which the base names of this object are added by this call.
+		col[0].p_block = p_from_raw;
+		strcpy(col[0].name, "tensor");
+	}
 
-	The root class Container does not add any base names.
-*/
-void Container::base_names(BaseNames &base_names) {}
+	int64_t rows = 1;
+	int		num_nodes = 0, num_buffers = 0;
 
+	for (int i = 0; i < num_cols; i++) {
+		pBlock p_blk = col[i].p_block;
 
-/** Creates the buffers for new_transaction()/destroy_transaction()
+		col[i].cell_type = p_blk->cell_type;
 
-	\return	SERVICE_NO_ERROR or SERVICE_ERROR_NO_MEM on RAM alloc failure.
-*/
-StatusCode Container::new_container() {
+		if (!arrow_type_of(col[i]))
+			return SERVICE_ERROR_WRONG_TYPE;
 
-	if (p_buffer != nullptr || max_transactions <= 0) {
-#ifdef CATCH_TEST
-		destroy_container();
-#else
-		log(log_error_level, "new_container() called on a running Container().");
-		return SERVICE_ERROR_STARTING;
-#endif
+		int dim[MAX_TENSOR_RANK];
+
+		p_blk->get_dimensions(dim);
+
+		int first = layout == ARROW_LAYOUT_ITEMS ? 0 : 1;
+
+		col[i].rank		 = p_blk->rank - first;
+		col[i].list_size = 1;
+
+		for (int j = 0; j < col[i].rank; j++) {
+			col[i].shape[j]	  = dim[j + first];
+			col[i].list_size *= dim[j + first];
+		}
+		if (layout != ARROW_LAYOUT_ITEMS)
+			rows = dim[0];
+
+		if (rows*col[i].list_size != p_blk->size)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+		col[i].null_count = arrow_validity(p_blk, nullptr);
+
+		if (col[i].arrow_type == ARROW_TYPE_UTF8) {
+			for (int j = 0; j < p_blk->size; j++) {
+				int k = p_blk->tensor.cell_int[j];
+
+				if (k != STRING_NA && k != STRING_EMPTY)
+					col[i].str_bytes += strlen(&p_blk->p_string_buffer()->buffer[k]);
+			}
+		}
+		col[i].node_ix	 = num_nodes;
+		col[i].buffer_ix = num_buffers;
+
+		num_nodes	+= col[i].rank > 0 ? 2 : 1;
+		num_buffers += (col[i].rank > 0 ? 1 : 0) + (col[i].arrow_type == ARROW_TYPE_UTF8 ? 3 : 2);
 	}
 
-	alloc_bytes = 0;
+	int64_t node[2*MAX_ITEMS_IN_KIND][2], buffer[4*MAX_ITEMS_IN_KIND][2], body = 0;
+	int		i_node = 0, i_buff = 0;
 
-	alloc_warning_issued = false;
+	for (int i = 0; i < num_cols; i++) {
+		int64_t n = col[i].p_block->size;
 
-	_lock_ = 0;
+		if (col[i].rank > 0) {
+			node[i_node][0]		= rows;
+			node[i_node++][1]	= 0;
+			buffer[i_buff][0]	= body;
+			buffer[i_buff++][1] = 0;
+		}
+		node[i_node][0]	  = n;
+		node[i_node++][1] = col[i].null_count;
 
-	p_buffer = (pStoredTransaction) malloc(max_transactions*sizeof(StoredTransaction));
+		int64_t len[3] = {col[i].null_count ? (n + 7)/8 : 0, 0, 0};
 
-	if (p_buffer == nullptr)
+		switch (col[i].arrow_type) {
+		case ARROW_TYPE_UTF8:
+			len[1] = 4*(n + 1);
+			len[2] = col[i].str_bytes;
+			break;
+
+		case ARROW_TYPE_BOOL:
+			len[1] = (n + 7)/8;
+			break;
+
+		default:
+			len[1] = n*(col[i].cell_type & 0xff);
+		}
+		for (int k = 0; k < (col[i].arrow_type == ARROW_TYPE_UTF8 ? 3 : 2); k++) {
+			buffer[i_buff][0]	= body;
+			buffer[i_buff++][1] = len[k];
+
+			body += (len[k] + 7) & ~7;
+		}
+	}
+
+	int cap = ARROW_FLATBUFFER_BYTES*(num_cols + 1);
+
+	uint8_t *p_mem = (uint8_t *) malloc(2*cap);
+
+	if (p_mem == nullptr)
 		return SERVICE_ERROR_NO_MEM;
 
-	p_free = p_buffer;
+	FlatBuffer fb_s = {p_mem, 0, cap, false}, fb_b = {p_mem + cap, 0, cap, false};
 
-	pStoredTransaction pt = (pStoredTransaction) p_buffer;
+	int s_size[3] = {0, 4, layout == ARROW_LAYOUT_ROWS ? 0 : 4}, s_pos[3];
 
-	for (int i = 1; i < max_transactions; i++) {
-		pt->status = BLOCK_STATUS_DESTROYED;
-		pStoredTransaction l_pt = pt++;
-		l_pt->p_next = pt;
+	arrow_message(fb_s, ARROW_HEADER_SCHEMA, 0, 3, s_size, s_pos);
+
+	int vec = fb_s.vector(num_cols, 4);
+
+	fb_s.offset(s_pos[1], vec);
+
+	for (int i = 0; i < num_cols; i++)
+		fb_s.offset(vec + 4 + 4*i, arrow_field(fb_s, col[i], false));
+
+	if (layout != ARROW_LAYOUT_ROWS) {
+		vec = fb_s.vector(1, 4);
+
+		fb_s.offset(s_pos[2], vec);
+		fb_s.offset(vec + 4, arrow_key_value(fb_s, "jazz.layout", layout == ARROW_LAYOUT_TENSOR ? "tensor" : "items"));
 	}
-	pt->status = BLOCK_STATUS_DESTROYED;
-	pt->p_next = nullptr;
 
-	return SERVICE_NO_ERROR;
-}
+	int r_size[4] = {8, 4, 4, 0}, r_pos[4];
 
+	arrow_message(fb_b, ARROW_HEADER_RECORD_BATCH, body, 4, r_size, r_pos);
 
-/** Destroys everything: all transactions and the buffer itself
+	int vec_nodes = fb_b.vector(num_nodes, 16);
 
-	\return	SERVICE_NO_ERROR.
-*/
-StatusCode Container::destroy_container() {
+	fb_b.offset(r_pos[1], vec_nodes);
 
-	if (p_buffer != nullptr) {
-		pStoredTransaction pt = (pStoredTransaction) p_buffer;
+	int vec_buffers = fb_b.vector(num_buffers, 16);
 
-		for (int i = 0; i < max_transactions; i++) {
-			if (pt->status != BLOCK_STATUS_DESTROYED) {
-				pTransaction p_txn = pt;
-				destroy_transaction(p_txn);
-			}
-			pt++;
-		}
-		free(p_buffer);
+	fb_b.offset(r_pos[2], vec_buffers);
+
+	if (!fb_b.failed) {
+		*(int64_t *) &fb_b.p_buf[r_pos[0]] = rows;
+
+		memcpy(&fb_b.p_buf[vec_nodes + 4], node, 16*num_nodes);
+		memcpy(&fb_b.p_buf[vec_buffers + 4], buffer, 16*num_buffers);
 	}
-	alloc_bytes = 0;
-	p_buffer = p_free = nullptr;
-	_lock_ = 0;
 
-	return SERVICE_NO_ERROR;
-}
+	int64_t meta_s = (fb_s.size + 7) & ~7, meta_b = (fb_b.size + 7) & ~7, total = 8 + meta_s + 8 + meta_b + body + 8;
 
+	StatusCode ret = SERVICE_NO_ERROR;
 
-/** Parse a source definition of an item in a Kind, possibly with dimensions.
+	if (fb_s.failed || fb_b.failed)
+		ret = SERVICE_ERROR_NO_MEM;
+	else if (total > INT_MAX)
+		ret = SERVICE_ERROR_BLOCK_TOO_BIG;
+	else {
+		int dim[MAX_TENSOR_RANK] = {(int) total, 0, 0, 0, 0, 0};
 
-	\param p_in			The input char stream cursor.
-	\param num_bytes	The number of bytes with data above *p_in
-	\param item_hea		The structure that receives the resulting cell_type, rank and shape.
-	\param dims			A MapSI to retrieve the dimension names.
+		ret = new_block(p_txn, CELL_TYPE_BYTE, dim, FILL_NEW_WITH_ZERO);
+	}
 
-	\return	True on success will return a valid item_hea (otherwise ite_hea is undefined).
-*/
-bool Container::get_type_and_shape(pChar &p_in, int &num_bytes, ItemHeader *item_hea, MapSI &dims) {
+	if (ret != SERVICE_NO_ERROR) {
+		alloc_bytes -= 2*cap;
+		free(p_mem);
 
-	if (skip_space(p_in, num_bytes) < 7) return false;
+		return ret;
+	}
 
-	if (strncmp(p_in, "INTEGER", 7) == 0) {
-		item_hea->cell_type = CELL_TYPE_INTEGER;
-		num_bytes -= 7;
-		p_in	  += 7;
-	} else if (strncmp(p_in, "LONG_INTEGER", 12) == 0) {
-		item_hea->cell_type = CELL_TYPE_LONG_INTEGER;
-		num_bytes -= 12;
-		p_in	  += 12;
-	} else if (strncmp(p_in, "BYTE_BOOLEAN", 12) == 0) {	// IMPORTANT: This must be before BYTE, since it starts with BYTE
-		item_hea->cell_type = CELL_TYPE_BYTE_BOOLEAN;
-		num_bytes -= 12;
-		p_in	  += 12;
-	} else if (strncmp(p_in, "BYTE", 4) == 0) {				// IMPORTANT: Must be after BYTE_BOOLEAN, since it is a prefix of BYTE_BOOLEAN
-		item_hea->cell_type = CELL_TYPE_BYTE;
-		num_bytes -= 4;
-		p_in	  += 4;
+	uint8_t *p_out = &p_txn->p_block->tensor.cell_byte[0];
+
+	*(uint32_t *) &p_out[0] = ARROW_CONTINUATION;
+	*(int32_t *)  &p_out[4] = meta_s;
+	memcpy(&p_out[8], fb_s.p_buf, fb_s.size);
+
+	p_out += 8 + meta_s;
+
+	*(uint32_t *) &p_out[0] = ARROW_CONTINUATION;
+	*(int32_t *)  &p_out[4] = meta_b;
+	memcpy(&p_out[8], fb_b.p_buf, fb_b.size);
+
+	p_out += 8 + meta_b;
+
+	alloc_bytes -= 2*cap;
+	free(p_mem);
+
+	i_buff = 0;
+
+	for (int i = 0; i < num_cols; i++) {
+		pBlock p_blk = col[i].p_block;
+		int	   n	 = p_blk->size;
+
+		if (col[i].rank > 0)
+			i_buff++;
+
+		if (col[i].null_count)
+			arrow_validity(p_blk, &p_out[buffer[i_buff][0]]);
+
+		i_buff++;
+
+		uint8_t *p_data = &p_out[buffer[i_buff++][0]];
+
+		switch (col[i].arrow_type) {
+		case ARROW_TYPE_UTF8: {
+			int32_t *p_offs = (int32_t *) p_data, off = 0;
+			pChar	 p_str	= (pChar) &p_out[buffer[i_buff++][0]];
+
+			for (int j = 0; j < n; j++) {
+				p_offs[j] = off;
+
+				int k = p_blk->tensor.cell_int[j];
+
+				if (k != STRING_NA && k != STRING_EMPTY) {
+					pChar p_cell = &p_blk->p_string_buffer()->buffer[k];
+					int	  len	 = strlen(p_cell);
+
+					memcpy(&p_str[off], p_cell, len);
+					off += len;
+				}
+			}
+			p_offs[n] = off;
+
+			break; }
+
+		case ARROW_TYPE_BOOL:
+			for (int j = 0; j < n; j++) {
+				uint32_t v = p_blk->cell_type == CELL_TYPE_BYTE_BOOLEAN ? p_blk->tensor.cell_byte[j] : p_blk->tensor.cell_uint[j];
+
+				if (v == 1)
+					p_data[j >> 3] |= 1 << (j & 7);
+			}
+			break;
+
+		default:
+			memcpy(p_data, &p_blk->tensor, (int64_t) n*(p_blk->cell_type & 0xff));
+		}
+	}
+	p_out += body;
+
+	*(uint32_t *) &p_out[0] = ARROW_CONTINUATION;
+	*(int32_t *)  &p_out[4] = 0;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Build a tensor or a Tuple from an Apache Arrow IPC stream.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_from_arrow	A Tensor of CELL_TYPE_BYTE of rank == 1 with the stream. E.g., what new_arrow() returns.
+	\param att			The attributes to set when creating the block. They are immutable.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error): SERVICE_ERROR_CORRUPTED if the stream
+			is malformed, SERVICE_ERROR_WRONG_TYPE if it uses something not supported (see the "Apache Arrow" section of the Container
+			documentation), SERVICE_ERROR_WRONG_NAME if some field name is not a valid Name, ...
+
+The stream must start with the Schema. All its RecordBatches are concatenated. The result is a Tuple built in place (see new_block() (9)),
+unless the schema says it is a tensor.
+*/
+StatusCode Container::new_from_arrow(pTransaction &p_txn, pBlock p_from_arrow, AttributeMap *att) {
+
+	p_txn = nullptr;
+
+	if (p_from_arrow->cell_type != CELL_TYPE_BYTE || p_from_arrow->rank != 1)
+		return SERVICE_ERROR_WRONG_TYPE;
+
+	uint8_t *p_in = &p_from_arrow->tensor.cell_byte[0];
+	int64_t	 size = p_from_arrow->size, pos = 0, rows = 0;
+
+	ArrowColumn col[MAX_ITEMS_IN_KIND];
+	int			num_cols = 0, layout = ARROW_LAYOUT_ROWS;
+
+	std::vector<int64_t> batch;		// (metadata position, metadata size, body position, body size) for each RecordBatch
+
+	memset(col, 0, sizeof(col));
+
+	while (pos + 4 <= size) {
+		uint32_t meta = *(uint32_t *) &p_in[pos];
+
+		pos += 4;
+
+		if (meta == ARROW_CONTINUATION) {
+			if (pos + 4 > size)
+				return SERVICE_ERROR_CORRUPTED;
+
+			meta = *(uint32_t *) &p_in[pos];
+			pos += 4;
+		}
+		if (meta == 0)
+			break;
+
+		if (pos + (int64_t) meta > size)
+			return SERVICE_ERROR_CORRUPTED;
+
+		FlatBuffer fb = {&p_in[pos], (int) meta, 0, false};
+
+		int		msg			= fb.deref(0);
+		int		header_type = fb.get<uint8_t>(fb.field(msg, 1));
+		int		header		= fb.child(msg, 2);
+		int64_t body_len	= fb.get<int64_t>(fb.field(msg, 3));
+
+		if (fb.failed || header == 0 || body_len < 0 || pos + meta + body_len > size)
+			return SERVICE_ERROR_CORRUPTED;
+
+		switch (header_type) {
+		case ARROW_HEADER_SCHEMA: {
+			if (num_cols != 0)
+				return SERVICE_ERROR_CORRUPTED;
+
+			int vec = fb.child(header, 1);
+
+			num_cols = fb.get<uint32_t>(vec);
+
+			if (num_cols < 1 || num_cols > MAX_ITEMS_IN_KIND)
+				return num_cols < 1 ? SERVICE_ERROR_CORRUPTED : SERVICE_ERROR_WRONG_ARGUMENTS;
+
+			int num_nodes = 0, num_buffers = 0;
+
+			for (int i = 0; i < num_cols; i++) {
+				StatusCode ret = arrow_parse_field(fb, fb.deref(vec + 4 + 4*i), col[i]);
+
+				if (ret != SERVICE_NO_ERROR)
+					return ret;
+
+				col[i].node_ix	 = num_nodes;
+				col[i].buffer_ix = num_buffers;
+
+				num_nodes	+= col[i].rank > 0 ? 2 : 1;
+				num_buffers += (col[i].rank > 0 ? 1 : 0) + (col[i].arrow_type == ARROW_TYPE_UTF8 ? 3 : 2);
+			}
+			int kv = fb.child(header, 2);
+
+			for (int i = 0; i < (kv ? (int) fb.get<uint32_t>(kv) : 0) && !fb.failed; i++) {
+				int k = fb.deref(kv + 4 + 4*i), key = fb.child(k, 0), val = fb.child(k, 1);
+
+				if (fb.get<uint32_t>(key) == 11 && fb.valid(key + 4, 11) && memcmp(&fb.p_buf[key + 4], "jazz.layout", 11) == 0) {
+					if (fb.get<uint32_t>(val) == 6 && fb.valid(val + 4, 6) && memcmp(&fb.p_buf[val + 4], "tensor", 6) == 0)
+						layout = ARROW_LAYOUT_TENSOR;
+					else if (fb.get<uint32_t>(val) == 5 && fb.valid(val + 4, 5) && memcmp(&fb.p_buf[val + 4], "items", 5) == 0)
+						layout = ARROW_LAYOUT_ITEMS;
+				}
+			}
+			if (fb.failed)
+				return SERVICE_ERROR_CORRUPTED;
+
+			break; }
+
+		case ARROW_HEADER_RECORD_BATCH: {
+			if (num_cols == 0 || fb.field(header, 3) != 0)
+				return num_cols == 0 ? SERVICE_ERROR_CORRUPTED : SERVICE_ERROR_WRONG_TYPE;	// compressed bodies are not supported
+
+			int64_t length = fb.get<int64_t>(fb.field(header, 0));
+
+			if (fb.failed || length < 0)
+				return SERVICE_ERROR_CORRUPTED;
+
+			rows += length;
+
+			batch.push_back(pos);
+			batch.push_back(meta);
+			batch.push_back(pos + meta);
+			batch.push_back(body_len);
+
+			break; }
+
+		default:
+			return SERVICE_ERROR_WRONG_TYPE;			// dictionaries, tensors, ..
+		}
+		pos += meta + body_len;
+	}
+	if (num_cols == 0)
+		return SERVICE_ERROR_CORRUPTED;
+
+	if ((layout == ARROW_LAYOUT_TENSOR && num_cols != 1) || (layout == ARROW_LAYOUT_ITEMS && rows != 1) || rows > INT_MAX)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	ItemHeader item[MAX_ITEMS_IN_KIND];
+	Name	   name[MAX_ITEMS_IN_KIND];
+	int		   str_bytes[MAX_ITEMS_IN_KIND];
+	int64_t	   total_bytes = 0;
+
+	for (int i = 0; i < num_cols; i++) {
+		int first = layout == ARROW_LAYOUT_ITEMS ? 0 : 1;
+
+		if (col[i].rank + first > MAX_TENSOR_RANK || (col[i].rank == 0 && first == 0))
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+		memset(item[i].dim, 0, sizeof(item[i].dim));
+
+		item[i].cell_type = col[i].cell_type;
+		item[i].rank	  = col[i].rank + first;
+
+		if (first)
+			item[i].dim[0] = rows;
+
+		int64_t cells = first ? rows : 1;
+
+		for (int j = 0; j < col[i].rank; j++) {
+			item[i].dim[j + first] = col[i].shape[j];
+			cells *= col[i].shape[j];
+		}
+		if ((total_bytes += cells*(col[i].cell_type & 0xff)) > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_BLOCK_TOO_BIG;
+
+		strcpy(name[i], col[i].name);
+
+		str_bytes[i] = 0;
+
+		int64_t bytes = cells;
+
+		for (int b = 0; b < (int) batch.size(); b += 4) {		// Check the sizes before allocating anything, get the size of the strings
+			FlatBuffer fb	 = {&p_in[batch[b]], (int) batch[b + 1], 0, false};
+			int		   rb	 = fb.child(fb.deref(0), 2);
+			int		   nodes = fb.child(rb, 1), bufs = fb.child(rb, 2);
+			int		   i_nd	 = col[i].node_ix + (col[i].rank > 0 ? 1 : 0), ix = col[i].buffer_ix + (col[i].rank > 0 ? 1 : 0) + 1;
+			int64_t	   n	 = fb.get<int64_t>(nodes + 4 + 16*i_nd);
+			int64_t	   d_off = fb.get<int64_t>(bufs + 4 + 16*ix), d_len = fb.get<int64_t>(bufs + 12 + 16*ix);
+
+			if (fb.failed || fb.get<uint32_t>(nodes) <= (uint32_t) i_nd || fb.get<uint32_t>(bufs) <= (uint32_t) ix
+				|| n != fb.get<int64_t>(fb.field(rb, 0))*col[i].list_size || d_off < 0 || d_len < 0 || d_off + d_len > batch[b + 3])
+				return SERVICE_ERROR_CORRUPTED;
+
+			switch (col[i].arrow_type) {
+			case ARROW_TYPE_UTF8: {
+				if (n > d_len/4 - 1)
+					return SERVICE_ERROR_CORRUPTED;
+
+				int32_t *p_offs = (int32_t *) &p_in[batch[b + 2] + d_off];
+
+				bytes += p_offs[n] - p_offs[0];
+
+				break; }
+
+			case ARROW_TYPE_BOOL:
+				if (d_len < (n + 7)/8)
+					return SERVICE_ERROR_CORRUPTED;
+
+				break;
+
+			default:
+				if (d_len < n*(col[i].cell_type & 0xff))
+					return SERVICE_ERROR_CORRUPTED;
+			}
+		}
+		if (col[i].arrow_type == ARROW_TYPE_UTF8) {
+			if (bytes < 0 || (total_bytes += bytes) > MAX_BLOCK_SIZE)
+				return bytes < 0 ? SERVICE_ERROR_CORRUPTED : SERVICE_ERROR_BLOCK_TOO_BIG;
+
+			str_bytes[i] = bytes;
+		}
+	}
+
+	StatusCode ret;
+
+	if (layout == ARROW_LAYOUT_TENSOR) {
+		ret = new_block(p_txn, item[0].cell_type, item[0].dim, FILL_NEW_DONT_FILL, str_bytes[0], nullptr, '\n', att);
+
+		if (ret == SERVICE_NO_ERROR)
+			col[0].p_block = p_txn->p_block;
+	} else {
+		ret = new_tuple_block(p_txn, num_cols, item, name, str_bytes, att);
+
+		if (ret == SERVICE_NO_ERROR)
+			for (int i = 0; i < num_cols; i++)
+				col[i].p_block = pTuple(p_txn->p_block)->get_block(i);
+	}
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	int64_t cell_0 = 0;
+
+	for (int b = 0; b < (int) batch.size(); b += 4) {
+		FlatBuffer fb = {&p_in[batch[b]], (int) batch[b + 1], 0, false};
+		int		   rb = fb.child(fb.deref(0), 2);
+
+		for (int i = 0; i < num_cols; i++) {
+			ret = arrow_fill(fb, rb, (pChar) &p_in[batch[b + 2]], batch[b + 3], col[i], cell_0*col[i].list_size);
+
+			if (ret != SERVICE_NO_ERROR) {
+				destroy_transaction(p_txn);
+
+				return ret;
+			}
+		}
+		cell_0 += fb.get<int64_t>(fb.field(rb, 0));
+	}
+
+	for (int i = 0; i < num_cols; i++) {
+		if (col[i].cell_type == CELL_TYPE_STRING)
+			col[i].p_block->p_string_buffer()->stop_check_4_match = true;	// Block::get_string_offset() does not support match with empty strings.
+
+		col[i].p_block->close_block(col[i].null_count > 0 ? SET_HAS_NA_TRUE : SET_HAS_NA_FALSE);
+	}
+	if (layout != ARROW_LAYOUT_TENSOR)
+		p_txn->p_block->close_block();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Serialize a tensor as a NumPy .npy file or a Tuple as an uncompressed NumPy .npz file.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_from_raw	The tensor or Tuple to be serialized.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error): SERVICE_ERROR_WRONG_TYPE if some cell_type
+			has no NumPy dtype (see the "NumPy" section of the Container documentation), SERVICE_ERROR_BLOCK_TOO_BIG, ...
+
+The result is a Tensor of CELL_TYPE_BYTE of rank == 1 with the file. A .npy is version 1.0 with the data aligned to NPY_ALIGN bytes. A .npz is a zip file with one stored (method 0) "<item name>.npy" entry per item.
+*/
+StatusCode Container::new_npy(pTransaction &p_txn, pBlock p_from_raw) {
+
+	p_txn = nullptr;
+
+	if (p_from_raw->cell_type != CELL_TYPE_TUPLE) {
+		int64_t hea_len = npy_header(p_from_raw, nullptr);
+
+		if (hea_len == 0)
+			return SERVICE_ERROR_WRONG_TYPE;
+
+		int64_t data_len = (int64_t) p_from_raw->size*(p_from_raw->cell_type & 0xff);
+
+		if (hea_len + data_len > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_BLOCK_TOO_BIG;
+
+		int dim[MAX_TENSOR_RANK] = {(int) (hea_len + data_len), 0};
+
+		StatusCode ret = new_block(p_txn, CELL_TYPE_BYTE, dim, FILL_NEW_DONT_FILL);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		uint8_t *p_out = &p_txn->p_block->tensor.cell_byte[0];
+
+		npy_header(p_from_raw, p_out);
+		memcpy(&p_out[hea_len], &p_from_raw->tensor, data_len);
+
+		p_txn->p_block->close_block();
+
+		return SERVICE_NO_ERROR;
+	}
+
+	int num_items = p_from_raw->size;
+
+	if (num_items < 1 || num_items > MAX_ITEMS_IN_KIND)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	int64_t hea_len[MAX_ITEMS_IN_KIND], data_len[MAX_ITEMS_IN_KIND], total = 22;	// The end of central directory record
+
+	for (int i = 0; i < num_items; i++) {
+		pBlock p_blk = pTuple(p_from_raw)->get_block(i);
+
+		if ((hea_len[i] = npy_header(p_blk, nullptr)) == 0)
+			return SERVICE_ERROR_WRONG_TYPE;
+
+		data_len[i] = (int64_t) p_blk->size*(p_blk->cell_type & 0xff);
+
+		int name_len = strlen(pTuple(p_from_raw)->item_name(i)) + 4;
+
+		if ((total += 30 + 46 + 2*name_len + hea_len[i] + data_len[i]) > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_BLOCK_TOO_BIG;
+	}
+
+	int dim[MAX_TENSOR_RANK] = {(int) total, 0};
+
+	StatusCode ret = new_block(p_txn, CELL_TYPE_BYTE, dim, FILL_NEW_DONT_FILL);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	uint8_t *p_out = &p_txn->p_block->tensor.cell_byte[0];
+	uint32_t crc[MAX_ITEMS_IN_KIND], offset[MAX_ITEMS_IN_KIND];
+	int		 pos = 0;
+
+	for (int i = 0; i < num_items; i++) {		// The local file headers followed by the .npy of each item
+		pBlock p_blk	= pTuple(p_from_raw)->get_block(i);
+		pChar  p_name	= pTuple(p_from_raw)->item_name(i);
+		int	   name_len = strlen(p_name) + 4;
+
+		offset[i] = pos;
+
+		uint8_t *p_npy = &p_out[pos + 30 + name_len];
+
+		npy_header(p_blk, p_npy);
+		memcpy(&p_npy[hea_len[i]], &p_blk->tensor, data_len[i]);
+
+		crc[i] = crc32(0L, p_npy, hea_len[i] + data_len[i]);
+
+		*(uint32_t *) &p_out[pos]	   = ZIP_LOCAL_FILE_SIG;
+		*(uint16_t *) &p_out[pos + 4]  = 20;							// version needed to extract (2.0)
+		*(uint16_t *) &p_out[pos + 6]  = 0;								// flags
+		*(uint16_t *) &p_out[pos + 8]  = 0;								// method: stored
+		*(uint16_t *) &p_out[pos + 10] = 0;								// time 00:00:00
+		*(uint16_t *) &p_out[pos + 12] = 0x21;							// date 1980-01-01
+		*(uint32_t *) &p_out[pos + 14] = crc[i];
+		*(uint32_t *) &p_out[pos + 18] = hea_len[i] + data_len[i];		// compressed size
+		*(uint32_t *) &p_out[pos + 22] = hea_len[i] + data_len[i];		// uncompressed size
+		*(uint16_t *) &p_out[pos + 26] = name_len;
+		*(uint16_t *) &p_out[pos + 28] = 0;								// extra field length
+
+		memcpy(&p_out[pos + 30], p_name, name_len - 4);
+		memcpy(&p_out[pos + 26 + name_len], ".npy", 4);
+
+		pos += 30 + name_len + hea_len[i] + data_len[i];
+	}
+
+	int cent_dir = pos;
+
+	for (int i = 0; i < num_items; i++) {		// The central directory: the same fields plus the offset of the local file header
+		int name_len = *(uint16_t *) &p_out[offset[i] + 26];
+
+		*(uint32_t *) &p_out[pos] = ZIP_CENTRAL_DIR_SIG;
+		*(uint16_t *) &p_out[pos + 4] = 20;								// version made by
+		memcpy(&p_out[pos + 6], &p_out[offset[i] + 4], 26);				// version needed .. extra field length
+		*(uint16_t *) &p_out[pos + 32] = 0;								// file comment length
+		*(uint16_t *) &p_out[pos + 34] = 0;								// disk number start
+		*(uint16_t *) &p_out[pos + 36] = 0;								// internal file attributes
+		*(uint32_t *) &p_out[pos + 38] = 0;								// external file attributes
+		*(uint32_t *) &p_out[pos + 42] = offset[i];
+
+		memcpy(&p_out[pos + 46], &p_out[offset[i] + 30], name_len);
+
+		pos += 46 + name_len;
+	}
+
+	*(uint32_t *) &p_out[pos]	   = ZIP_END_OF_CENTRAL_DIR_SIG;
+	*(uint16_t *) &p_out[pos + 4]  = 0;									// number of this disk
+	*(uint16_t *) &p_out[pos + 6]  = 0;									// disk with the central directory
+	*(uint16_t *) &p_out[pos + 8]  = num_items;
+	*(uint16_t *) &p_out[pos + 10] = num_items;
+	*(uint32_t *) &p_out[pos + 12] = pos - cent_dir;
+	*(uint32_t *) &p_out[pos + 16] = cent_dir;
+	*(uint16_t *) &p_out[pos + 20] = 0;									// comment length
+
+	p_txn->p_block->close_block();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Build a tensor from a NumPy .npy file or a Tuple from an uncompressed NumPy .npz file.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container. The caller can only use it read-only and **must** destroy_transaction()
+						it when done.
+	\param p_from_npy	A Tensor of CELL_TYPE_BYTE of rank == 1 with the file. E.g., what new_npy() returns.
+	\param att			The attributes to set when creating the block. They are immutable.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error): SERVICE_ERROR_CORRUPTED if the file
+			is malformed, SERVICE_ERROR_WRONG_TYPE if it uses something not supported (see the "NumPy" section of the Container
+			documentation), SERVICE_ERROR_WRONG_NAME if some entry of a .npz is not a valid Name followed by ".npy", ...
+
+The file is recognized by its content (NPY_MAGIC or ZIP_LOCAL_FILE_SIG), not by its name. The items of the Tuple are in the order of the
+entries in the .npz and the Tuple is built in place (see new_block() (9)).
+*/
+StatusCode Container::new_from_npy(pTransaction &p_txn, pBlock p_from_npy, AttributeMap *att) {
+
+	p_txn = nullptr;
+
+	if (p_from_npy->cell_type != CELL_TYPE_BYTE || p_from_npy->rank != 1)
+		return SERVICE_ERROR_WRONG_TYPE;
+
+	uint8_t *p_in = &p_from_npy->tensor.cell_byte[0];
+	int64_t	 size = p_from_npy->size;
+
+	ItemHeader item[MAX_ITEMS_IN_KIND];
+	Name	   name[MAX_ITEMS_IN_KIND];
+	uint8_t	  *p_data[MAX_ITEMS_IN_KIND];
+	int		   num_items = 0;
+
+	if (size >= NPY_MAGIC_LENGTH && memcmp(p_in, NPY_MAGIC, NPY_MAGIC_LENGTH) == 0) {
+		int hea_len = npy_parse_header(item[0], p_in, size);
+
+		if (hea_len < 0)
+			return hea_len;
+
+		StatusCode ret = new_block(p_txn, item[0].cell_type, item[0].dim, FILL_NEW_DONT_FILL, 0, nullptr, '\n', att);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		memcpy(&p_txn->p_block->tensor, &p_in[hea_len], (int64_t) p_txn->p_block->size*(item[0].cell_type & 0xff));
+
+		p_txn->p_block->close_block(SET_HAS_NA_AUTO);
+
+		return SERVICE_NO_ERROR;
+	}
+
+	int64_t pos = 0, total_bytes = 0;
+
+	while (pos + 30 <= size && *(uint32_t *) &p_in[pos] == ZIP_LOCAL_FILE_SIG) {
+		int		flags	 = *(uint16_t *) &p_in[pos + 6];
+		int		method	 = *(uint16_t *) &p_in[pos + 8];
+		int64_t c_size	 = *(uint32_t *) &p_in[pos + 18];
+		int64_t u_size	 = *(uint32_t *) &p_in[pos + 22];
+		int		name_len = *(uint16_t *) &p_in[pos + 26];
+		int		extra	 = *(uint16_t *) &p_in[pos + 28];
+
+		pos += 30;
+
+		if (pos + name_len + extra > size)
+			return SERVICE_ERROR_CORRUPTED;
+
+		if (method != 0 || (flags & 0x01) != 0)
+			return SERVICE_ERROR_WRONG_TYPE;		// deflated (np.savez_compressed()) or encrypted
+
+		for (int64_t e = pos + name_len; e + 4 <= pos + name_len + extra;) {	// The zip64 extra field has the real sizes
+			int id = *(uint16_t *) &p_in[e], len = *(uint16_t *) &p_in[e + 2];
+
+			if (id == ZIP_ZIP64_EXTRA_ID && len >= 16 && e + 4 + 16 <= pos + name_len + extra) {
+				if (u_size == 0xffffffff)
+					u_size = *(int64_t *) &p_in[e + 4];
+				if (c_size == 0xffffffff)
+					c_size = *(int64_t *) &p_in[e + 12];
+			}
+			e += 4 + len;
+		}
+		if ((flags & 0x08) != 0 && c_size == 0)
+			return SERVICE_ERROR_WRONG_TYPE;		// sizes in a data descriptor after the data (written by a stream)
+
+		if (num_items == MAX_ITEMS_IN_KIND)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+		if (c_size != u_size || c_size < 0 || c_size > size - pos - name_len - extra)
+			return SERVICE_ERROR_CORRUPTED;
+
+		if (name_len < 5 || name_len - 4 > NAME_LENGTH || memcmp(&p_in[pos + name_len - 4], ".npy", 4) != 0)
+			return SERVICE_ERROR_WRONG_NAME;
+
+		memcpy(name[num_items], &p_in[pos], name_len - 4);
+		name[num_items][name_len - 4] = 0;
+
+		if (!valid_name(name[num_items]))
+			return SERVICE_ERROR_WRONG_NAME;
+
+		pos += name_len + extra;
+
+		if (c_size < NPY_MAGIC_LENGTH || memcmp(&p_in[pos], NPY_MAGIC, NPY_MAGIC_LENGTH) != 0)
+			return SERVICE_ERROR_CORRUPTED;
+
+		int hea_len = npy_parse_header(item[num_items], &p_in[pos], c_size);
+
+		if (hea_len < 0)
+			return hea_len;
+
+		int64_t cells = 1;
+
+		for (int j = 0; j < item[num_items].rank; j++)
+			cells *= item[num_items].dim[j];
+
+		if ((total_bytes += cells*(item[num_items].cell_type & 0xff)) > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_BLOCK_TOO_BIG;
+
+		p_data[num_items++] = &p_in[pos + hea_len];
+
+		pos += c_size;
+	}
+
+	if (num_items == 0 || pos + 4 > size || *(uint32_t *) &p_in[pos] != ZIP_CENTRAL_DIR_SIG)
+		return SERVICE_ERROR_CORRUPTED;
+
+	StatusCode ret = new_tuple_block(p_txn, num_items, item, name, nullptr, att);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	for (int i = 0; i < num_items; i++) {
+		pBlock p_blk = pTuple(p_txn->p_block)->get_block(i);
+
+		memcpy(&p_blk->tensor, p_data[i], (int64_t) p_blk->size*(p_blk->cell_type & 0xff));
+
+		p_blk->close_block(SET_HAS_NA_AUTO);
+	}
+	p_txn->p_block->close_block();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** "Easy" interface **complete Block** retrieval. This parses p_what and, on success, calls the native get() equivalent.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
+be destroy_transaction()-ed when the caller is done.
+*/
+StatusCode Container::get(pTransaction &p_txn, pChar p_what) {
+	Locator loc;
+	StatusCode ret;
+
+	p_txn = nullptr;
+
+	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return get(p_txn, loc);
+}
+
+
+/** "Easy" interface **selection of rows in a Block** retrieval. This parses p_what and, on success, calls the native get() equivalent.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container.
+	\param p_what		Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+	\param p_row_filter	The block we want to use as a filter. This is either a tensor of boolean or integer that can_filter(p_from).
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
+be destroy_transaction()-ed when the caller is done.
+*/
+StatusCode Container::get(pTransaction &p_txn, pChar p_what, pBlock p_row_filter) {
+	Locator loc;
+	StatusCode ret;
+
+	p_txn = nullptr;
+
+	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return get(p_txn, loc, p_row_filter);
+}
+
+
+/** "Easy" interface **selection of a tensor in a Tuple** retrieval. This parses p_what and, on success, calls the native get() equivalent.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+	\param name		The name of the item to be selected.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
+be destroy_transaction()-ed when the caller is done.
+*/
+StatusCode Container::get(pTransaction &p_txn, pChar p_what, pChar name) {
+	Locator loc;
+	StatusCode ret;
+
+	p_txn = nullptr;
+
+	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return get(p_txn, loc, name);
+}
+
+
+/** "Easy" interface : Locate a block by some relation that is understandable by the descendant.
+
+	\param location	The solved location of the block.
+	\param p_what	A valid reference to a block. E.g. //deque/ent/~first, //tree/ent/key~parent, //queue/ent/~highest
+
+	\return	SERVICE_NO_ERROR on success (and a valid location), or some negative value (error).
+
+The default behaviour of this is returning the same locator that is given for most Containers. Only containers like Volatile which
+support block relations defined by commands will return actual //base/ent/key locators that are the result of some computation.
+*/
+StatusCode Container::locate(Locator &location, pChar p_what) {
+	Locator what;
+	StatusCode ret;
+
+	if ((ret = as_locator(what, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return locate(location, what);
+}
+
+
+/** "Easy" interface **metadata of a Block** retrieval. This parses p_what and, on success, calls the native header() equivalent.
+
+	\param hea		A StaticBlockHeader structure that will receive the metadata.
+	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success (and a valid hea), or some negative value (error).
+
+This is a faster, not involving RAM allocation version of the other form of header. For a tensor, is will be the only thing you need, but
+for a Kind or a Tuple, you probably want the types of all its items and need to pass a pTransaction to hold the data.
+*/
+StatusCode Container::header(StaticBlockHeader &hea, pChar p_what) {
+	Locator loc;
+	StatusCode ret;
+
+	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return header(hea, loc);
+}
+
+
+/** "Easy" interface **metadata of a Block** retrieval. This parses p_what and, on success, calls the native header() equivalent.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param p_what	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Unlike its faster form, this allocates a Block and therefore, it is equivalent to a new_block() call. On success, it will return a
+Transaction that belongs to the Container and must be destroy_transaction()-ed when the caller is done.
+
+For Tensors it will allocate a block that only has the StaticBlockHeader (What you can more efficiently get from the other form.)
+For Kinds, the metadata of all the items is exactly the same a .get() call returns.
+For Tuples, it does what you expect: returning a Block with the metadata of all the items without the data.
+*/
+StatusCode Container::header(pTransaction &p_txn, pChar p_what) {
+	Locator loc;
+	StatusCode ret;
+
+	p_txn = nullptr;
+
+	if ((ret = as_locator(loc, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return header(p_txn, loc);
+}
+
+
+/** "Easy" interface for **Block storing**: This parses p_where and, on success, calls the native put() equivalent.
+
+	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity/key
+	\param p_block	A block to be stored. Notice it is a block, not a Transaction. If necessary, the Container will make a copy, write to
+					disc, PUT it via http, etc. The container does not own the pointer in any way.
+	\param mode		Some writing restriction that should return an error if not supported. It controls overriding or writing just the data
+					as when writing to a file.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+*/
+StatusCode Container::put(pChar p_where, pBlock p_block, int mode) {
+	Locator loc;
+	StatusCode ret;
+
+	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return put(loc, p_block, mode);
+}
+
+
+/** "Easy" interface for **creating entities**: This parses p_where and, on success, calls the native new_entity() equivalent.
+
+	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+	What an entity is, is Container and base dependent. It can be an lmdb database, a folder in a filesystem, a Volatile tree, ...
+*/
+StatusCode Container::new_entity(pChar p_where) {
+	Locator loc;
+	StatusCode ret;
+
+	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return new_entity(loc);
+}
+
+
+/** "Easy" interface for **deleting entities and blocks**: This parses p_where and, on success, calls the native header() equivalent.
+
+	\param p_where	Some string that as_locator() can parse into a Locator. E.g. //base/entity or //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+	What an entity is, is Container and base dependent. It can be an lmdb database, a folder in a filesystem, a Volatile tree, ...
+*/
+StatusCode Container::remove(pChar p_where) {
+	Locator loc;
+	StatusCode ret;
+
+	if ((ret = as_locator(loc, p_where)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return remove(loc);
+}
+
+
+/** "Easy" interface for **Block copying**: This parses p_what and p_where. On success, it calls the native copy() equivalent.
+
+	\param p_where	Some **destination** that as_locator() can parse into a Locator. E.g. //base/entity/key
+	\param p_what	Some **source** that as_locator() can parse into a Locator. E.g. //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+**NOTE**: This does not copy blocks across Containers. A copy() call is a short way to do "get(tx, what); put(where, tx);
+destroy_transaction(tx);" without the Container needing to allocate Transactions and, possibly, not even blocks. To copy blocks
+across containers, you need channels.
+*/
+StatusCode Container::copy(pChar p_where, pChar p_what) {
+	Locator where, what;
+	StatusCode ret;
+
+	if ((ret = as_locator(where, p_where)) != SERVICE_NO_ERROR)
+		return ret;
+
+	if ((ret = as_locator(what, p_what)) != SERVICE_NO_ERROR)
+		return ret;
+
+	return copy(where, what);
+}
+
+
+/** The function call interface for **exec**: Execute a function or a model.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param function	Some description of a service. In general base/entity/key. In Channels the key must be empty and the entity is
+					the pipeline. In Core, the key is field/snippet, In Model (via ModelAPI), model/(entry point).
+	\param p_args	A Tuple passed as argument to the call that is not modified.
+
+	\return	SERVICE_ERROR_NOT_APPLICABLE since this method must be implemented in the Container descendants.
+
+Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
+be destroy_transaction()-ed when the caller is done.
+*/
+StatusCode Container::exec(pTransaction &p_txn, Locator &function, pTuple p_args) {
+
+	return SERVICE_ERROR_NOT_APPLICABLE;
+}
+
+
+/** The function call interface for **modify**: In jazz_elements, this is only implemented in Channels.
+
+	\param function	Some description of a service. In general base/entity/key. In Channels the key must be empty and the entity is
+					the pipeline.
+	\param p_args	In Channels: A Tuple with two items, "input" with the data passed to the service and "result" with the data returned.
+					The result will be overridden in-place without any allocation.
+
+	\return	SERVICE_ERROR_NOT_APPLICABLE since this method must be implemented in the Container descendants.
+
+modify() is similar to exec(), but, rather than creating a new block with the result, it modifies the Tuple p_args.
+*/
+StatusCode Container::modify(Locator &function, pTuple p_args) {
+
+	return SERVICE_ERROR_NOT_APPLICABLE;
+}
+
+
+/** The parser: A simple parser that does not support Locator.p_extra, but is enough for Volatile and Persisted.
+
+	\param result	A Locator to contained the parsed result on success. (Undefined content on error.)
+	\param p_what	Some string to be parsed. E.g. //base/entity/key
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+More complex Container descendants that support URLs, credentials, cookies, etc. will override this minimalistic parser.
+*/
+StatusCode Container::as_locator(Locator &result, pChar p_what) {
+
+	if (p_what[0] != '/' || p_what[1] != '/')
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	p_what += 2;
+
+	int	  section = 0;
+	int	  size	  = LOCATOR_SIZE[section];
+	bool  written = false, number = false;
+	pChar p_out	  = (pChar) &result.base;
+
+	while (true) {
+		switch (char ch = *(p_what++)) {
+		case '~':
+			number = section == 2;
+
+			if (--size < 0) return SERVICE_ERROR_PARSING_NAMES;
+
+			*(p_out++) = ch;
+			written	   = true;
+
+			break;
+
+		case '.':
+			if (!number) return SERVICE_ERROR_PARSING_NUMBERS;
+
+		case 'a' ... 'z':
+		case 'A' ... 'Z':
+		case '_':
+			number = false;
+		case '0' ... '9':
+		case '-':
+			if (--size < 0) return SERVICE_ERROR_PARSING_NAMES;
+
+			*(p_out++) = ch;
+			written	   = true;
+
+			break;
+
+		case '/':
+			if (!written) return SERVICE_ERROR_PARSING_NAMES;
+
+			*(p_out++) = 0;
+
+			if (++section > 2) return SERVICE_ERROR_PARSING_NAMES;
+
+			if (section == 1)
+				p_out = (pChar) &result.entity;
+			else
+				p_out = (pChar) &result.key;
+
+			size	= LOCATOR_SIZE[section];
+			written = false;
+
+			break;
+
+		case 0:
+			if (!written) return SERVICE_ERROR_PARSING_NAMES;
+
+			*(p_out++) = 0;
+
+			if (section == 0) return SERVICE_ERROR_PARSING_NAMES;
+
+			if (section == 1)
+				result.key[0] = 0;
+
+			result.p_extra = nullptr;
+
+			return SERVICE_NO_ERROR;
+
+		default:
+			return SERVICE_ERROR_PARSING_NAMES;
+		}
+	}
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param what		A valid reference to a block as a locator. E.g. //base/entity/key
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::get(pTransaction &p_txn, Locator &what) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container.
+	\param what			A valid reference to a block as a locator. E.g. //base/entity/key
+	\param p_row_filter	The block we want to use as a filter. This is either a tensor of boolean or integer that can_filter(p_from).
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::get(pTransaction &p_txn, Locator &what, pBlock p_row_filter) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param what		A valid reference to a block as a locator. E.g. //base/entity/key
+	\param name		The name of the item to be selected.
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::get(pTransaction &p_txn, Locator &what, pChar name) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: The default behavior for most Container descendants that do not support commands is just copying.
+
+	\param location	The solved location of the block.
+	\param what		A valid reference to a block. E.g. //deque/ent/~first, //tree/ent/key~parent, //queue/ent/~highest
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+NOTE: This just copies what into location. It will not verify the existence of the block. The function of locate() is to
+evaluate commands in Containers supporting them (E.g, Volatile). Otherwise, it is a trivial conversion from the easy into the native API.
+*/
+StatusCode Container::locate(Locator &location, Locator &what) {
+
+	memcpy(&location, &what, sizeof(Locator));
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param hea		A StaticBlockHeader structure that will receive the metadata.
+	\param what		Some Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::header(StaticBlockHeader &hea, Locator &what) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param what		Some Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::header(pTransaction &p_txn, Locator &what) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param where	Some **destination** Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+	\param p_block	The Block to be stored in Volatile. The Block hash and dated will be updated by this call!!
+	\param mode		Some writing restriction, either WRITE_ONLY_IF_EXISTS or WRITE_ONLY_IF_NOT_EXISTS. WRITE_TENSOR_DATA returns
+					the error SERVICE_ERROR_WRONG_ARGUMENTS
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::put(Locator &where, pBlock p_block, int mode) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param where	Some **destination** Locator to the block. (See Node Method Reference in the documentation of the class Volatile.)
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::new_entity(Locator &where) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param where	The block or entity to be removed. (See Node Method Reference in the documentation of the class Volatile.)
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::remove(Locator &where) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** The "native" interface: This is what really does the job and **must be implemented in the Container descendants**.
+
+	\param where	The block or entity to be written. (See Node Method Reference in the documentation of the class Volatile.)
+	\param what		The block or entity to be read. (See Node Method Reference in the documentation of the class Volatile.)
+
+	\return	SERVICE_NOT_IMPLEMENTED since this method must be implemented in the Container descendants.
+
+	**NOTE**: The root Container class does not implement this.
+*/
+StatusCode Container::copy(Locator &where, Locator &what) {
+
+	return SERVICE_NOT_IMPLEMENTED;		// API Only: One-shot container does not support this.
+}
+
+
+/** Add the base names for this Container.
+
+	\param base_names	A BaseNames map passed by reference to which the base names of this object are added by this call.
+
+	The root class Container does not add any base names.
+*/
+void Container::base_names(BaseNames &base_names) {}
+
+
+/** Creates the buffers for new_transaction()/destroy_transaction()
+
+	\return	SERVICE_NO_ERROR or SERVICE_ERROR_NO_MEM on RAM alloc failure.
+*/
+StatusCode Container::new_container() {
+
+	if (p_buffer != nullptr || max_transactions <= 0) {
+#ifdef CATCH_TEST
+		destroy_container();
+#else
+		log(log_error_level, "new_container() called on a running Container().");
+		return SERVICE_ERROR_STARTING;
+#endif
+	}
+
+	alloc_bytes = 0;
+
+	alloc_warning_issued = false;
+
+	_lock_ = 0;
+
+	p_buffer = (pStoredTransaction) malloc(max_transactions*sizeof(StoredTransaction));
+
+	if (p_buffer == nullptr)
+		return SERVICE_ERROR_NO_MEM;
+
+	p_free = p_buffer;
+
+	pStoredTransaction pt = (pStoredTransaction) p_buffer;
+
+	for (int i = 1; i < max_transactions; i++) {
+		pt->status = BLOCK_STATUS_DESTROYED;
+		pStoredTransaction l_pt = pt++;
+		l_pt->p_next = pt;
+	}
+	pt->status = BLOCK_STATUS_DESTROYED;
+	pt->p_next = nullptr;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Destroys everything: all transactions and the buffer itself
+
+	\return	SERVICE_NO_ERROR.
+*/
+StatusCode Container::destroy_container() {
+
+	if (p_buffer != nullptr) {
+		pStoredTransaction pt = (pStoredTransaction) p_buffer;
+
+		for (int i = 0; i < max_transactions; i++) {
+			if (pt->status != BLOCK_STATUS_DESTROYED) {
+				pTransaction p_txn = pt;
+				destroy_transaction(p_txn);
+			}
+			pt++;
+		}
+		free(p_buffer);
+	}
+	views.clear();
+	pins.clear();
+	num_views = 0;
+	mapped.clear();
+	num_mapped = 0;
+
+	alloc_bytes = 0;
+	p_buffer = p_free = nullptr;
+	_lock_ = 0;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Parse a source definition of an item in a Kind, possibly with dimensions.
+
+	\param p_in			The input char stream cursor.
+	\param num_bytes	The number of bytes with data above *p_in
+	\param item_hea		The structure that receives the resulting cell_type, rank and shape.
+	\param dims			A MapSI to retrieve the dimension names.
+
+	\return	True on success will return a valid item_hea (otherwise ite_hea is undefined).
+*/
+bool Container::get_type_and_shape(pChar &p_in, int &num_bytes, ItemHeader *item_hea, MapSI &dims) {
+
+	if (skip_space(p_in, num_bytes) < 7) return false;
+
+	if (strncmp(p_in, "INTEGER", 7) == 0) {
+		item_hea->cell_type = CELL_TYPE_INTEGER;
+		num_bytes -= 7;
+		p_in	  += 7;
+	} else if (strncmp(p_in, "LONG_INTEGER", 12) == 0) {
+		item_hea->cell_type = CELL_TYPE_LONG_INTEGER;
+		num_bytes -= 12;
+		p_in	  += 12;
+	} else if (strncmp(p_in, "BYTE_BOOLEAN", 12) == 0) {	// IMPORTANT: This must be before BYTE, since it starts with BYTE
+		item_hea->cell_type = CELL_TYPE_BYTE_BOOLEAN;
+		num_bytes -= 12;
+		p_in	  += 12;
+	} else if (strncmp(p_in, "BYTE", 4) == 0) {				// IMPORTANT: Must be after BYTE_BOOLEAN, since it is a prefix of BYTE_BOOLEAN
+		item_hea->cell_type = CELL_TYPE_BYTE;
+		num_bytes -= 4;
+		p_in	  += 4;
 	} else if (strncmp(p_in, "STRING", 6) == 0) {
 		item_hea->cell_type = CELL_TYPE_STRING;
 		num_bytes -= 6;
@@ -2417,861 +4369,1898 @@ bool Container::get_type_and_shape(pChar &p_in, int &num_bytes, ItemHeader *item
 	} else
 		return false;
 
-	if (skip_space(p_in, num_bytes) < 3) return false;
+	if (skip_space(p_in, num_bytes) < 3) return false;
+
+	if (get_char(p_in, num_bytes) != '[') return false;
+
+	item_hea->rank = 0;
+
+	memset(&item_hea->dim, 0, sizeof(TensorDim));
+
+	while (true) {
+		Name dim_name;
+		if (skip_space(p_in, num_bytes) < 2) return false;
+
+		char cl = *p_in;
+
+		if (cl >= '0' && cl <= '9') {
+			if (!sscanf_int32(p_in, num_bytes, item_hea->dim[item_hea->rank]) || item_hea->dim[item_hea->rank] < 1) return false;
+
+		} else if ((cl >= 'A' && cl <= 'Z') || (cl >= 'a' && cl <= 'z')) {
+			if (!get_item_name(p_in, num_bytes, dim_name, false, false)) return false;
+
+			if (dims.find(dim_name) == dims.end()) {
+				int ix = -(dims.size() + 1);
+
+				dims[dim_name] = ix;
+
+				item_hea->dim[item_hea->rank] = ix;
+			} else
+				item_hea->dim[item_hea->rank] = dims[dim_name];
+		}
+		if (skip_space(p_in, num_bytes) < 1) return false;
+
+		cl = get_char(p_in, num_bytes);
+
+		if (item_hea->rank++ >= MAX_TENSOR_RANK) return false;
+
+		if (cl == ']') return true;
+
+		if (cl != ',') return false;
+	}
+}
+
+
+/** Parse a tensor, measure it and fail on inconsistent shape
+
+	\param p_in			The input char stream cursor.
+	\param num_bytes	The number of bytes with data above *p_in
+	\param cell_type	The type of the tensor being parsed (if CELL_TYPE_UNDEFINED, it will be detected)
+	\param item_hea		The structure that receives the resulting cell_type, rank, shape and item_size.
+
+	\return	True on success will return a valid item_hea (otherwise ite_hea is undefined).
+
+In the case of CELL_TYPE_STRING, item_size will return the serialized total size of all the strings.
+*/
+bool Container::get_shape_and_size(pChar &p_in, int &num_bytes, int cell_type, ItemHeader *item_hea) {
+
+	char state;
+
+	switch (cell_type) {
+	case CELL_TYPE_UNDEFINED:
+		state = PSTATE_IN_AUTO;
+		break;
+	case CELL_TYPE_BYTE:
+	case CELL_TYPE_INTEGER:
+	case CELL_TYPE_FACTOR:
+	case CELL_TYPE_GRADE:
+	case CELL_TYPE_LONG_INTEGER:
+	case CELL_TYPE_BYTE_BOOLEAN:
+	case CELL_TYPE_BOOLEAN:
+		state = PSTATE_IN_INT;
+		break;
+	case CELL_TYPE_SINGLE:
+	case CELL_TYPE_DOUBLE:
+		state = PSTATE_IN_REAL;
+		break;
+	case CELL_TYPE_STRING:
+		state = PSTATE_IN_STRING;
+		break;
+	case CELL_TYPE_TIME:
+		state = PSTATE_IN_TIME;
+		break;
+	default:
+		return false;
+	}
+
+	item_hea->cell_type = cell_type;
+	item_hea->item_size = 0;
+
+	memset(item_hea->dim, -1, sizeof(TensorDim));		// == {-1, -1, -1, -1, -1, -1};
+	TensorDim n_item = {0,  0,  0,  0,  0,  0};
+
+	int level = -1;
+	bool first_row = true;
+
+	while (true) {
+		unsigned char cursor;
+
+		if (num_bytes <= 0) return false;
+
+		cursor = get_char(p_in, num_bytes);
+		state  = parser_state_switch[state].next[cursor];
+
+		switch (state) {
+		case PSTATE_OUT_INT:
+			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
+				item_hea->cell_type = CELL_TYPE_INTEGER;
+
+		case PSTATE_OUT_REAL:
+			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
+				item_hea->cell_type = CELL_TYPE_DOUBLE;
+
+		case PSTATE_OUT_STRING:
+			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
+				item_hea->cell_type = CELL_TYPE_STRING;
+
+		case PSTATE_OUT_TIME:
+			if (cursor == ']') {
+				n_item.dim[level]++;
+
+				if (item_hea->dim[level] < 0)
+					item_hea->dim[level] = n_item.dim[level];
+				else {
+					if (item_hea->dim[level] != n_item.dim[level]) return false;
+				};
+				level--;
+
+				if (level == -1) {
+					for (int i = item_hea->rank; i < MAX_TENSOR_RANK; i++)
+						item_hea->dim[i] = 0;
+
+					return true;
+				}
+			}
+			break;
+
+		case PSTATE_IN_AUTO:
+		case PSTATE_IN_INT:
+		case PSTATE_IN_REAL:
+		case PSTATE_IN_STRING:
+		case PSTATE_IN_TIME:
+			if (cursor == ',')
+				n_item.dim[level]++;
+
+			if (cursor == '[') {
+				level++;
+				if (first_row)
+					item_hea->rank = level + 1;
+				else {
+					if (level >= item_hea->rank) return false;
+				}
+				if (level >= MAX_TENSOR_RANK) return false;
+
+				n_item.dim[level] = 0;
+			};
+			break;
+
+		case PSTATE_SEP_INT:
+		case PSTATE_SEP_REAL:
+		case PSTATE_SEP_STRING:
+		case PSTATE_SEP_TIME:
+			if (cursor == ',') {
+				if (level != item_hea->rank - 1) return false;
+
+				n_item.dim[level]++;
+			}
+
+			first_row = false;
+
+			break;
+
+		case PSTATE_CONST_STRING_E0:
+			if (*p_in == 'n')
+				item_hea->item_size++;
+
+		case PSTATE_CONST_STRING_N:
+			item_hea->item_size++;
+
+			break;
+
+		case PSTATE_CONST_STRING0:
+			// if (*p_in == '"')
+			// 	this_is_an_empty_string();
+		case PSTATE_CONST_AUTO:
+		case PSTATE_CONST_INT:
+		case PSTATE_CONST_REAL:
+		case PSTATE_CONST_STRING_E1:
+		case PSTATE_CONST_STRING_E2:
+		case PSTATE_CONST_TIME:
+		case PSTATE_NA_INT:
+		case PSTATE_NA_REAL:
+		case PSTATE_NA_STRING:
+		case PSTATE_NA_TIME:
+		case PSTATE_END_STRING:
+			break;
+
+		case PSTATE_EMPTY_FILE:		// Only CELL_TYPE_BYTE supports empty files because there is no NA for bytes. syntax is [] (no space)
+			memset(item_hea->dim, 0, sizeof(TensorDim));
+			return (cursor == ']') && (level == 0) && (cell_type == CELL_TYPE_BYTE) && (item_hea->rank == 1) && (item_hea->item_size == 0);
+
+		default:
+			return false;
+		}
+	}
+}
+
+
+/** Parse a tensor of CELL_TYPE_STRING by serializing it into a buffer compatible with a new_block(1).p_text
+
+	\param p_in			The input char stream cursor.
+	\param num_bytes	The number of bytes with data above *p_in
+	\param p_out		A pointer to a buffer that has enough size for the serialized output.
+	\param num_cells	The expected number of cell for verification.
+	\param is_NA		An array to store the indices of the NA cells (to be set after the new_block() call).
+	\param hasLN		An array to store the indices of the string containing \n (which is serialized) and to be deserialized later.
+
+	\return	True on success
+
+**Note**: Cells are separated by a \\n character (not escaped) which is not confused with a \\n inside the string which becomes escaped.
+*/
+bool Container::fill_text_buffer(pChar &p_in, int &num_bytes, pChar p_out, int num_cells, int is_NA[], int hasLN[]) {
+
+	char state = PSTATE_IN_STRING;
+
+	int level = 0, ix_NA = 0, ix_LN = 0, ix = 0;
+
+	is_NA[0] = -1;
+	hasLN[0] = -1;
+
+	while (true) {
+		unsigned char cursor;
+
+		if (num_bytes <= 0)
+			return false;
+
+		cursor = get_char(p_in, num_bytes);
+		state  = parser_state_switch[state].next[cursor];
+
+		switch (state) {
+		case PSTATE_OUT_STRING:
+			if (cursor == ']') {
+				level--;
+
+				if (level == 0) {
+					*p_out = 0;
+
+					return ix == num_cells;
+				}
+			}
+
+			break;
+
+		case PSTATE_NA_STRING:
+			if (cursor == 'A') {
+				*(p_out++) = '\n';
+
+				is_NA[ix_NA++] = ix;
+				is_NA[ix_NA]   = -1;
+
+				ix++;
+			}
+
+			break;
+
+		case PSTATE_IN_STRING:
+			if (cursor == '[')
+				level++;
+
+			break;
+
+		case PSTATE_CONST_STRING_E0:
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (cursor) {
+			case 'a':
+				*(p_out++) = '\a';
+				break;
+
+			case 'b':
+				*(p_out++) = '\b';
+				break;
+
+			case 't':
+				*(p_out++) = '\t';
+				break;
+
+			case 'n':
+				*(p_out++) = '\\';
+				*(p_out++) = 'n';
+				if (hasLN[0] < 0) {
+					hasLN[0] = ix;
+					hasLN[1] = -1;
+				} else if (hasLN[ix_LN] != ix) {
+					ix_LN++;
+					hasLN[ix_LN]	 = ix;
+					hasLN[ix_LN + 1] = -1;
+				}
+
+				break;
+
+			case 'v':
+				*(p_out++) = '\v';
+				break;
+
+			case 'f':
+				*(p_out++) = '\f';
+				break;
+
+			case 'r':
+				*(p_out++) = '\r';
+				break;
+
+			case '\"':
+				*(p_out++) = '\"';
+				break;
+
+			case '\\':
+				*(p_out++) = '\\';
+				break;
+
+			default:
+				int xhi = from_hex(cursor = get_char(p_in, num_bytes));
+				state	= parser_state_switch[state].next[cursor];
+
+				int xlo = from_hex(cursor = get_char(p_in, num_bytes));
+				state	= parser_state_switch[state].next[cursor];
+
+				*(p_out++) = (xhi << 4) + xlo;
+
+				break;
+			}
+			break;
+
+		case PSTATE_CONST_STRING_N:
+			*(p_out++) = cursor;
+
+			break;
+
+		case PSTATE_END_STRING:
+			*(p_out++) = '\n';
+			ix++;
+
+			break;
+
+		case PSTATE_CONST_STRING0:
+		case PSTATE_CONST_STRING_E1:
+		case PSTATE_CONST_STRING_E2:
+		case PSTATE_SEP_STRING:
+			break;
+#ifndef CATCH_TEST
+		default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+			return false;
+#endif
+		}
+	}
+}
+
+
+/** Parse a tensor of anything other than CELL_TYPE_STRING into a binary (allocated but not initialized) Block.
+
+	\param p_in			The input char stream cursor.
+	\param num_bytes	The number of bytes with data above *p_in
+	\param p_block		The allocated block. Already has anything, (cell type, shape, etc.), except the data.
+
+	\return	True on success
+*/
+bool Container::fill_tensor(pChar &p_in, int &num_bytes, pBlock p_block) {
+
+#ifdef CATCH_TEST
+	if (debug_trigger_failure & TRIGGER_FAIL_FILL_TENSOR)
+		return false;
+#endif
+
+	char cell [MAX_SIZE_OF_CELL_AS_TEXT];
+
+	pChar p_st = (pChar) &cell, p_end = (pChar) &cell + sizeof(cell) - 1;
+
+	switch (p_block->cell_type) {
+	case CELL_TYPE_BYTE: {
+		char state = PSTATE_IN_INT;
+		int level = 0;
+		uint8_t *p_out = &p_block->tensor.cell_byte[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_INT:
+				if (cursor == ']') {
+					if (p_st != ((pChar) &cell)) {		// Ugly parenthesis required by cppcheck
+						*p_st = 0;
+						p_st  = (pChar) &cell;
+
+						if (sscanf(p_st, "%hhu", p_out) != 1) return false;
+
+						p_out++;
+					}
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_byte[p_block->size];
+				}
+				break;
+
+			case PSTATE_IN_INT:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_INT:
+				if (cursor == ',') {
+					*p_st = 0;
+					p_st  = (pChar) &cell;
+
+					if (sscanf(p_st, "%hhu", p_out) != 1) return false;
+
+					p_out++;
+				}
+				break;
+
+			case PSTATE_CONST_INT:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+				break;
+
+			case PSTATE_EMPTY_FILE:
+				return true;
+
+#ifndef CATCH_TEST
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_INTEGER:
+	case CELL_TYPE_FACTOR:
+	case CELL_TYPE_GRADE: {
+		char state = PSTATE_IN_INT;
+		int level = 0;
+		int *p_out = &p_block->tensor.cell_int[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_INT:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_int_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_int[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_INT:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_INT:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_INT:
+				if (cursor == ',')
+					if (!push_int_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_INT:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_LONG_INTEGER: {
+		char state = PSTATE_IN_INT;
+		int level = 0;
+		long long *p_out = &p_block->tensor.cell_longint[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_INT:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_int_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_longint[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_INT:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_INT:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_INT:
+				if (cursor == ',')
+					if (!push_int_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_INT:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_BYTE_BOOLEAN: {
+		char state = PSTATE_IN_INT;
+		int level = 0;
+		bool *p_out = &p_block->tensor.cell_bool[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_INT:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_bool_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_bool[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_INT:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_INT:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_INT:
+				if (cursor == ',')
+					if (!push_bool_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_INT:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_BOOLEAN: {
+		char state = PSTATE_IN_INT;
+		int level = 0;
+		uint32_t *p_out = &p_block->tensor.cell_uint[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_INT:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_bool_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_uint[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_INT:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_INT:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_INT:
+				if (cursor == ',')
+					if (!push_bool_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_INT:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_SINGLE: {
+		char state = PSTATE_IN_REAL;
+		int level = 0;
+		float *p_out = &p_block->tensor.cell_single[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_REAL:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_real_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_single[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_REAL:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_REAL:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_REAL:
+				if (cursor == ',')
+					if (!push_real_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_REAL:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_DOUBLE: {
+		char state = PSTATE_IN_REAL;
+		int level = 0;
+		double *p_out = &p_block->tensor.cell_double[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_REAL:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_real_cell(cell, p_st, p_out)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_double[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_REAL:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_REAL:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_REAL:
+				if (cursor == ',')
+					if (!push_real_cell(cell, p_st, p_out)) return false;
+
+				break;
+
+			case PSTATE_CONST_REAL:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	case CELL_TYPE_TIME: {
+		char state = PSTATE_IN_TIME;
+		int level = 0;
+		time_t *p_out = &p_block->tensor.cell_time[0];
+
+		while (true) {
+			unsigned char cursor;
+
+			if (num_bytes == 0) return false;
+
+			cursor = get_char(p_in, num_bytes);
+			state  = parser_state_switch[state].next[cursor];
+
+			switch (state) {
+			case PSTATE_OUT_TIME:
+				if (cursor == ']') {
+					if (level == p_block->rank && !push_time_cell(cell, p_st, p_out, DEF_FLOAT_TIME)) return false;
+
+					level--;
+
+					if (level == 0)
+						return p_out == &p_block->tensor.cell_time[p_block->size];
+				}
+				break;
+
+			case PSTATE_NA_TIME:
+				if (cursor == 'A')
+					p_st = (pChar) &cell;
+
+				break;
+
+			case PSTATE_IN_TIME:
+				if (cursor == '[')
+					level++;
+
+				break;
+
+			case PSTATE_SEP_TIME:
+				if (cursor == ',')
+					if (!push_time_cell(cell, p_st, p_out, DEF_FLOAT_TIME)) return false;
+
+				break;
+
+			case PSTATE_CONST_TIME:
+				if (p_st == p_end) return false;
+
+				*(p_st++) = cursor;
+
+#ifndef CATCH_TEST
+				break;
+
+			default:			// Only binary corruption of the state table can force this, still better keeping it.
+
+				return false;
+#endif
+			}
+		}
+	}
+	default:
+		return false;
+	}
+}
+
+
+/** Writes the lines of a text into the tensor and the string buffer of a Block of CELL_TYPE_STRING.
+
+	\param p_block		The Block. Its size must be the number of lines in p_text and its string buffer must have space for the text.
+	\param p_text		The text, one cell per line, zero ended.
+	\param eol			The character separating the cells. It is not pushed to the string buffer.
+
+	This is the FILL_WITH_TEXTFILE part of new_block(). It does not check the size of anything: the caller must.
+*/
+void Container::fill_text_tensor(pBlock p_block, const char *p_text, char eol) {
+	pStringBuffer psb = p_block->p_string_buffer();
+
+	int offset = psb->last_idx;
+
+	char *pt_out = &psb->buffer[offset];
+
+	int row = 1, len = 0;
+	const char *pt_in = p_text;
+
+	p_block->tensor.cell_int[0] = offset;
+
+	while (*pt_in) {
+		offset++;
+		if (*pt_in != eol) {
+			*pt_out = *pt_in;
+			len++;
+		} else {
+			if (!len)
+				p_block->tensor.cell_int[row - 1] = STRING_EMPTY;
+
+			if (!pt_in[1])
+				break;
+
+			*pt_out = 0;
+
+			p_block->tensor.cell_int[row] = offset;
+
+			len = 0;
+			row++;
+		}
+		pt_out++;
+		pt_in++;
+	}
+	if (!len)
+		p_block->tensor.cell_int[row - 1] = STRING_EMPTY;
+
+	*pt_out = 0;
+
+	psb->last_idx			= offset + (*pt_in == 0);
+	psb->stop_check_4_match = true;							// Block::get_string_offset() does not support match with empty strings.
+}
+
+
+/** Creates a Tuple whose items are laid out, but not filled, in place: The sizing part of new_block() (2) + the in-place new_tuple().
+
+	\param p_txn		Transaction for the new Tuple.
+	\param num_items	The number of items.
+	\param p_items		An array of ItemHeader with the cell_type and (human-readable) dim of each item.
+	\param p_names		An array of Name by which the items will go.
+	\param p_str_bytes	An (optional) array with the size of the string buffer reserved for each item.
+	\param att			The attributes of the Tuple.
+
+	\return	StatusCode like a new_block() call. On success, the Tuple is BLOCK_STATUS_READY with hash64 == 0, like new_block() (2)
+			leaves it.
+*/
+StatusCode Container::new_tuple_block(pTransaction &p_txn,
+									  int			num_items,
+									  ItemHeader	p_items[],
+									  Name			p_names[],
+									  int			p_str_bytes[],
+									  AttributeMap *att) {
+
+	if (num_items < 1 || num_items > MAX_ITEMS_IN_KIND)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	StatusCode ret = new_transaction(p_txn);
+
+	if (ret != SERVICE_NO_ERROR) return ret;
+
+	StaticBlockHeader hea;
+	TensorDim i_dim = {};
+	i_dim.dim[0] = num_items;
+	i_dim.dim[1] = 0;
+
+	hea.cell_type = CELL_TYPE_TUPLE;
+
+	reinterpret_cast<pBlock>(&hea)->set_dimensions(i_dim.dim);
+
+	hea.num_attributes = 0;
+
+	hea.total_bytes = (uintptr_t) reinterpret_cast<pBlock>(&hea)->p_string_buffer() - (uintptr_t) (&hea) + sizeof(StringBuffer) + 4;
+
+	if (att != nullptr && att->size() == 0) att = nullptr;
+
+	if (att	!= nullptr) {
+		for (AttributeMap::iterator it = att->begin(); it != att->end(); ++it) {
+			int len = it->second == nullptr ? 0 : strlen(it->second);
+
+			if (len)
+				hea.total_bytes += len + 1;
 
-	if (get_char(p_in, num_bytes) != '[') return false;
+			hea.num_attributes++;
+		}
+		hea.total_bytes += 2*hea.num_attributes*sizeof(int);
+	}
 
-	item_hea->rank = 0;
+	for (int i = 0; i < num_items; i++) {
+		pChar p_name = (pChar) &p_names[i];
 
-	memset(&item_hea->dim, 0, sizeof(TensorDim));
+		hea.total_bytes += strlen(p_name) + 1;
+		hea.total_bytes +=   Tuple::item_total_bytes(p_items[i].cell_type, p_items[i].dim, p_str_bytes == nullptr ? 0 : p_str_bytes[i])
+						   + 15;	// 15 == worst case of align 128-bit
+	}
 
-	while (true) {
-		Name dim_name;
-		if (skip_space(p_in, num_bytes) < 2) return false;
+	p_txn->p_block = block_malloc(hea.total_bytes);
 
-		char cl = *p_in;
+	if (p_txn->p_block == nullptr) {
+		destroy_transaction(p_txn);
 
-		if (cl >= '0' && cl <= '9') {
-			if (!sscanf_int32(p_in, num_bytes, item_hea->dim[item_hea->rank]) || item_hea->dim[item_hea->rank] < 1) return false;
+		return SERVICE_ERROR_NO_MEM;
+	}
 
-		} else if ((cl >= 'A' && cl <= 'Z') || (cl >= 'a' && cl <= 'z')) {
-			if (!get_item_name(p_in, num_bytes, dim_name, false, false)) return false;
+#ifdef DEBUG		// Initialize everything for Valgrind.
+	memset(p_txn->p_block, 0, hea.total_bytes);
+#endif
 
-			if (dims.find(dim_name) == dims.end()) {
-				int ix = -(dims.size() + 1);
+	ret = reinterpret_cast<pTuple>(p_txn->p_block)->new_tuple(num_items, p_items, p_names, p_str_bytes, hea.total_bytes, att);
 
-				dims[dim_name] = ix;
+	if (ret == SERVICE_NO_ERROR) {
+		p_txn->p_block->hash64 = 0;
+		p_txn->status = BLOCK_STATUS_READY;
+	} else
+		destroy_transaction(p_txn);
 
-				item_hea->dim[item_hea->rank] = ix;
-			} else
-				item_hea->dim[item_hea->rank] = dims[dim_name];
-		}
-		if (skip_space(p_in, num_bytes) < 1) return false;
+	return ret;
+}
 
-		cl = get_char(p_in, num_bytes);
 
-		if (item_hea->rank++ >= MAX_TENSOR_RANK) return false;
+/** Counts the NA cells of a tensor and, optionally, writes its Arrow validity bitmap.
 
-		if (cl == ']') return true;
+	\param p_cell	The cells of the tensor.
+	\param size		The number of cells.
+	\param na		The NA value (not used by booleans where anything other than 0 or 1 is NA, like in Block.find_NAs_in_tensor()).
+	\param p_bits	If not nullptr, a zero-filled bitmap of (size + 7)/8 bytes to set the bits of the cells that are not NA.
 
-		if (cl != ',') return false;
+	\return The number of NA cells.
+*/
+template <typename T, bool IS_BOOLEAN> int64_t arrow_nulls(T *p_cell, int size, T na, uint8_t *p_bits) {
+	int64_t nulls = 0;
+
+	for (int i = 0; i < size; i++) {
+		if (IS_BOOLEAN ? (p_cell[i] & ~((T) 1)) != 0 : p_cell[i] == na)
+			nulls++;
+		else if (p_bits != nullptr)
+			p_bits[i >> 3] |= 1 << (i & 7);
 	}
+	return nulls;
 }
 
 
-/** Parse a tensor, measure it and fail on inconsistent shape
-
-	\param p_in			The input char stream cursor.
-	\param num_bytes	The number of bytes with data above *p_in
-	\param cell_type	The type of the tensor being parsed (if CELL_TYPE_UNDEFINED, it will be detected)
-	\param item_hea		The structure that receives the resulting cell_type, rank, shape and item_size.
+/** Sets the Arrow type of a column from its Jazz cell_type.
 
-	\return	True on success will return a valid item_hea (otherwise ite_hea is undefined).
+	\param col	The column with a cell_type. Sets its arrow_type, bit_width and is_signed.
 
-In the case of CELL_TYPE_STRING, item_size will return the serialized total size of all the strings.
+	\return False if the cell_type has no Arrow type (BFLOAT16, Kinds, Tuples, Index, ..).
 */
-bool Container::get_shape_and_size(pChar &p_in, int &num_bytes, int cell_type, ItemHeader *item_hea) {
+bool Container::arrow_type_of(ArrowColumn &col) {
+	col.arrow_type = ARROW_TYPE_INT;
+	col.is_signed  = true;
 
-	char state;
-
-	switch (cell_type) {
-	case CELL_TYPE_UNDEFINED:
-		state = PSTATE_IN_AUTO;
-		break;
+	switch (col.cell_type) {
 	case CELL_TYPE_BYTE:
+		col.is_signed = false;
+		col.bit_width = 8;
+
+		return true;
+
+	case CELL_TYPE_INT8:
+		col.bit_width = 8;
+
+		return true;
+
+	case CELL_TYPE_UINT16:
+		col.is_signed = false;
+
+		[[fallthrough]];
+
+	case CELL_TYPE_INT16:
+		col.bit_width = 16;
+
+		return true;
+
+	case CELL_TYPE_UINT32:
+		col.is_signed = false;
+
+		[[fallthrough]];
+
 	case CELL_TYPE_INTEGER:
 	case CELL_TYPE_FACTOR:
 	case CELL_TYPE_GRADE:
+		col.bit_width = 32;
+
+		return true;
+
+	case CELL_TYPE_UINT64:
+		col.is_signed = false;
+
+		[[fallthrough]];
+
 	case CELL_TYPE_LONG_INTEGER:
-	case CELL_TYPE_BYTE_BOOLEAN:
-	case CELL_TYPE_BOOLEAN:
-		state = PSTATE_IN_INT;
-		break;
+		col.bit_width = 64;
+
+		return true;
+
+	case CELL_TYPE_FLOAT16:
 	case CELL_TYPE_SINGLE:
 	case CELL_TYPE_DOUBLE:
-		state = PSTATE_IN_REAL;
-		break;
-	case CELL_TYPE_STRING:
-		state = PSTATE_IN_STRING;
-		break;
+		col.arrow_type = ARROW_TYPE_FLOATING_POINT;
+		col.bit_width  = col.cell_type == CELL_TYPE_FLOAT16 ? 0 : col.cell_type == CELL_TYPE_SINGLE ? 1 : 2;
+
+		return true;
+
 	case CELL_TYPE_TIME:
-		state = PSTATE_IN_TIME;
-		break;
-	default:
-		return false;
-	}
+		col.arrow_type = ARROW_TYPE_TIMESTAMP;
+		col.bit_width  = 0;							// Seconds, the cells are time_t.
 
-	item_hea->cell_type = cell_type;
-	item_hea->item_size = 0;
+		return true;
 
-	memset(item_hea->dim, -1, sizeof(TensorDim));		// == {-1, -1, -1, -1, -1, -1};
-	TensorDim n_item = {0,  0,  0,  0,  0,  0};
+	case CELL_TYPE_BYTE_BOOLEAN:
+	case CELL_TYPE_BOOLEAN:
+		col.arrow_type = ARROW_TYPE_BOOL;
 
-	int level = -1;
-	bool first_row = true;
+		return true;
 
-	while (true) {
-		unsigned char cursor;
+	case CELL_TYPE_STRING:
+		col.arrow_type = ARROW_TYPE_UTF8;
 
-		if (num_bytes <= 0) return false;
+		return true;
+	}
+	return false;
+}
 
-		cursor = get_char(p_in, num_bytes);
-		state  = parser_state_switch[state].next[cursor];
 
-		switch (state) {
-		case PSTATE_OUT_INT:
-			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
-				item_hea->cell_type = CELL_TYPE_INTEGER;
+/** Finds the Jazz cell_type of a column from its Arrow type.
 
-		case PSTATE_OUT_REAL:
-			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
-				item_hea->cell_type = CELL_TYPE_DOUBLE;
+	\param col				The column with an arrow_type, bit_width and is_signed.
+	\param jazz_cell_type	The cell_type found in the "jazz.cell_type" metadata of the field or 0.
 
-		case PSTATE_OUT_STRING:
-			if (item_hea->cell_type == CELL_TYPE_UNDEFINED)
-				item_hea->cell_type = CELL_TYPE_STRING;
+	\return The cell_type or 0 if the Arrow type is not supported. jazz_cell_type is only used if it has the same Arrow type.
+*/
+int Container::arrow_cell_type(ArrowColumn &col, int jazz_cell_type) {
+	if (jazz_cell_type != 0) {
+		ArrowColumn jazz;
 
-		case PSTATE_OUT_TIME:
-			if (cursor == ']') {
-				n_item.dim[level]++;
+		jazz.cell_type = jazz_cell_type;
 
-				if (item_hea->dim[level] < 0)
-					item_hea->dim[level] = n_item.dim[level];
-				else {
-					if (item_hea->dim[level] != n_item.dim[level]) return false;
-				};
-				level--;
+		if (arrow_type_of(jazz) && jazz.arrow_type == col.arrow_type
+			&& (col.arrow_type != ARROW_TYPE_INT || (jazz.bit_width == col.bit_width && jazz.is_signed == col.is_signed))
+			&& (col.arrow_type != ARROW_TYPE_FLOATING_POINT || jazz.bit_width == col.bit_width))
+			return jazz_cell_type;
+	}
 
-				if (level == -1) {
-					for (int i = item_hea->rank; i < MAX_TENSOR_RANK; i++)
-						item_hea->dim[i] = 0;
+	switch (col.arrow_type) {
+	case ARROW_TYPE_INT:
+		switch (col.bit_width) {
+		case 8:
+			return col.is_signed ? CELL_TYPE_INT8 : CELL_TYPE_BYTE;
+		case 16:
+			return col.is_signed ? CELL_TYPE_INT16 : CELL_TYPE_UINT16;
+		case 32:
+			return col.is_signed ? CELL_TYPE_INTEGER : CELL_TYPE_UINT32;
+		case 64:
+			return col.is_signed ? CELL_TYPE_LONG_INTEGER : CELL_TYPE_UINT64;
+		}
+		return 0;
 
-					return true;
-				}
-			}
-			break;
+	case ARROW_TYPE_FLOATING_POINT:
+		switch (col.bit_width) {
+		case 0:
+			return CELL_TYPE_FLOAT16;
+		case 1:
+			return CELL_TYPE_SINGLE;
+		case 2:
+			return CELL_TYPE_DOUBLE;
+		}
+		return 0;
 
-		case PSTATE_IN_AUTO:
-		case PSTATE_IN_INT:
-		case PSTATE_IN_REAL:
-		case PSTATE_IN_STRING:
-		case PSTATE_IN_TIME:
-			if (cursor == ',')
-				n_item.dim[level]++;
+	case ARROW_TYPE_TIMESTAMP:
+		return col.bit_width >= 0 && col.bit_width <= 3 ? CELL_TYPE_TIME : 0;
 
-			if (cursor == '[') {
-				level++;
-				if (first_row)
-					item_hea->rank = level + 1;
-				else {
-					if (level >= item_hea->rank) return false;
-				}
-				if (level >= MAX_TENSOR_RANK) return false;
+	case ARROW_TYPE_BOOL:
+		return CELL_TYPE_BYTE_BOOLEAN;
 
-				n_item.dim[level] = 0;
-			};
-			break;
+	case ARROW_TYPE_UTF8:
+		return CELL_TYPE_STRING;
+	}
+	return 0;
+}
 
-		case PSTATE_SEP_INT:
-		case PSTATE_SEP_REAL:
-		case PSTATE_SEP_STRING:
-		case PSTATE_SEP_TIME:
-			if (cursor == ',') {
-				if (level != item_hea->rank - 1) return false;
 
-				n_item.dim[level]++;
-			}
+/** Counts the NA cells of a tensor and, optionally, writes its Arrow validity bitmap.
 
-			first_row = false;
+	\param p_block	The tensor.
+	\param p_bits	If not nullptr, a zero-filled bitmap of (size + 7)/8 bytes to set the bits of the cells that are not NA.
 
-			break;
+	\return The number of NA cells (always 0 for the types that have no NA).
+*/
+int Container::arrow_validity(pBlock p_block, uint8_t *p_bits) {
+	switch (p_block->cell_type) {
+	case CELL_TYPE_BYTE_BOOLEAN:
+		return arrow_nulls<uint8_t, true>(p_block->tensor.cell_byte, p_block->size, 0, p_bits);
 
-		case PSTATE_CONST_STRING_E0:
-			if (*p_in == 'n')
-				item_hea->item_size++;
+	case CELL_TYPE_BOOLEAN:
+		return arrow_nulls<uint32_t, true>(p_block->tensor.cell_uint, p_block->size, 0, p_bits);
 
-		case PSTATE_CONST_STRING_N:
-			item_hea->item_size++;
+	case CELL_TYPE_INTEGER:
+	case CELL_TYPE_FACTOR:
+	case CELL_TYPE_GRADE:
+		return arrow_nulls<int32_t, false>(p_block->tensor.cell_int, p_block->size, INTEGER_NA, p_bits);
 
-			break;
+	case CELL_TYPE_SINGLE:
+		return arrow_nulls<uint32_t, false>(p_block->tensor.cell_uint, p_block->size, SINGLE_NA_UINT32, p_bits);
 
-		case PSTATE_CONST_STRING0:
-			// if (*p_in == '"')
-			// 	this_is_an_empty_string();
-		case PSTATE_CONST_AUTO:
-		case PSTATE_CONST_INT:
-		case PSTATE_CONST_REAL:
-		case PSTATE_CONST_STRING_E1:
-		case PSTATE_CONST_STRING_E2:
-		case PSTATE_CONST_TIME:
-		case PSTATE_NA_INT:
-		case PSTATE_NA_REAL:
-		case PSTATE_NA_STRING:
-		case PSTATE_NA_TIME:
-		case PSTATE_END_STRING:
-			break;
+	case CELL_TYPE_STRING:
+		return arrow_nulls<int32_t, false>(p_block->tensor.cell_int, p_block->size, STRING_NA, p_bits);
 
-		case PSTATE_EMPTY_FILE:		// Only CELL_TYPE_BYTE supports empty files because there is no NA for bytes. syntax is [] (no space)
-			memset(item_hea->dim, 0, sizeof(TensorDim));
-			return (cursor == ']') && (level == 0) && (cell_type == CELL_TYPE_BYTE) && (item_hea->rank == 1) && (item_hea->item_size == 0);
+	case CELL_TYPE_LONG_INTEGER:
+		return arrow_nulls<long long, false>(p_block->tensor.cell_longint, p_block->size, LONG_INTEGER_NA, p_bits);
 
-		default:
-			return false;
-		}
+	case CELL_TYPE_TIME:
+		return arrow_nulls<long long, false>(p_block->tensor.cell_longint, p_block->size, TIME_POINT_NA, p_bits);
+
+	case CELL_TYPE_DOUBLE:
+		return arrow_nulls<uint64_t, false>(p_block->tensor.cell_ulongint, p_block->size, DOUBLE_NA_UINT64, p_bits);
 	}
+	return 0;
 }
 
 
-/** Parse a tensor of CELL_TYPE_STRING by serializing it into a buffer compatible with a new_block(1).p_text
-
-	\param p_in			The input char stream cursor.
-	\param num_bytes	The number of bytes with data above *p_in
-	\param p_out		A pointer to a buffer that has enough size for the serialized output.
-	\param num_cells	The expected number of cell for verification.
-	\param is_NA		An array to store the indices of the NA cells (to be set after the new_block() call).
-	\param hasLN		An array to store the indices of the string containing \n (which is serialized) and to be deserialized later.
+/** Appends a KeyValue table (a metadata entry) to a flatbuffer.
 
-	\return	True on success
+	\param fb		The flatbuffer.
+	\param p_key	The key.
+	\param p_value	The value.
 
-**Note**: Cells are separated by a \\n character (not escaped) which is not confused with a \\n inside the string which becomes escaped.
+	\return The position of the table.
 */
-bool Container::fill_text_buffer(pChar &p_in, int &num_bytes, pChar p_out, int num_cells, int is_NA[], int hasLN[]) {
+int Container::arrow_key_value(FlatBuffer &fb, const char *p_key, const char *p_value) {
+	int size[2] = {4, 4}, pos[2];
 
-	char state = PSTATE_IN_STRING;
+	int kv = fb.table(2, size, pos);
 
-	int level = 0, ix_NA = 0, ix_LN = 0, ix = 0;
+	fb.offset(pos[0], fb.string(p_key));
+	fb.offset(pos[1], fb.string(p_value));
 
-	is_NA[0] = -1;
-	hasLN[0] = -1;
+	return kv;
+}
 
-	while (true) {
-		unsigned char cursor;
 
-		if (num_bytes <= 0)
-			return false;
+/** Appends a Field table (with its type, children and metadata) to a flatbuffer.
 
-		cursor = get_char(p_in, num_bytes);
-		state  = parser_state_switch[state].next[cursor];
+	\param fb		The flatbuffer.
+	\param col		The column.
+	\param is_child	Write the values of a column of rank > 0 (the child of its FixedSizeList). Otherwise, write the column.
 
-		switch (state) {
-		case PSTATE_OUT_STRING:
-			if (cursor == ']') {
-				level--;
+	\return The position of the table.
+*/
+int Container::arrow_field(FlatBuffer &fb, ArrowColumn &col, bool is_child) {
+	bool is_list = col.rank > 0 && !is_child;
 
-				if (level == 0) {
-					*p_out = 0;
+	ArrowColumn jazz;
 
-					return ix == num_cells;
-				}
-			}
+	jazz.cell_type = arrow_cell_type(col, 0);
 
-			break;
+	bool has_meta = is_list || (!is_child && jazz.cell_type != col.cell_type);
 
-		case PSTATE_NA_STRING:
-			if (cursor == 'A') {
-				*(p_out++) = '\n';
+	int size[7] = {4, 1, 1, 4, 0, 4, has_meta ? 4 : 0}, pos[7];
+
+	int field = fb.table(7, size, pos);
+
+	if (fb.failed)
+		return 0;
+
+	fb.offset(pos[0], fb.string(is_child ? "item" : col.name));
+
+	fb.p_buf[pos[1]] = 1;
+	fb.p_buf[pos[2]] = is_list ? ARROW_TYPE_FIXED_SIZE_LIST : col.arrow_type;
 
-				is_NA[ix_NA++] = ix;
-				is_NA[ix_NA]   = -1;
+	int t_size[2] = {0, 0}, t_pos[2], num_t = 0;
 
-				ix++;
-			}
+	switch (is_list ? ARROW_TYPE_FIXED_SIZE_LIST : col.arrow_type) {
+	case ARROW_TYPE_INT:
+		t_size[0] = 4;
+		t_size[1] = 1;
+		num_t	  = 2;
 
-			break;
+		break;
 
-		case PSTATE_IN_STRING:
-			if (cursor == '[')
-				level++;
+	case ARROW_TYPE_FLOATING_POINT:
+	case ARROW_TYPE_TIMESTAMP:
+		t_size[0] = 2;
+		num_t	  = 1;
 
-			break;
+		break;
 
-		case PSTATE_CONST_STRING_E0:
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+	case ARROW_TYPE_FIXED_SIZE_LIST:
+		t_size[0] = 4;
+		num_t	  = 1;
+	}
+	int type = fb.table(num_t, t_size, t_pos);
 
-			switch (cursor) {
-			case 'a':
-				*(p_out++) = '\a';
-				break;
+	fb.offset(pos[3], type);
 
-			case 'b':
-				*(p_out++) = '\b';
-				break;
+	if (!fb.failed) {
+		switch (is_list ? ARROW_TYPE_FIXED_SIZE_LIST : col.arrow_type) {
+		case ARROW_TYPE_INT:
+			*(int32_t *) &fb.p_buf[t_pos[0]] = col.bit_width;
+			fb.p_buf[t_pos[1]]				 = col.is_signed;
 
-			case 't':
-				*(p_out++) = '\t';
-				break;
+			break;
 
-			case 'n':
-				*(p_out++) = '\\';
-				*(p_out++) = 'n';
-				if (hasLN[0] < 0) {
-					hasLN[0] = ix;
-					hasLN[1] = -1;
-				} else if (hasLN[ix_LN] != ix) {
-					ix_LN++;
-					hasLN[ix_LN]	 = ix;
-					hasLN[ix_LN + 1] = -1;
-				}
+		case ARROW_TYPE_FLOATING_POINT:
+		case ARROW_TYPE_TIMESTAMP:
+			*(int16_t *) &fb.p_buf[t_pos[0]] = col.bit_width;
 
-				break;
+			break;
 
-			case 'v':
-				*(p_out++) = '\v';
-				break;
+		case ARROW_TYPE_FIXED_SIZE_LIST:
+			*(int32_t *) &fb.p_buf[t_pos[0]] = col.list_size;
+		}
+	}
 
-			case 'f':
-				*(p_out++) = '\f';
-				break;
+	int children = fb.vector(is_list ? 1 : 0, 4);
 
-			case 'r':
-				*(p_out++) = '\r';
-				break;
+	fb.offset(pos[5], children);
 
-			case '\"':
-				*(p_out++) = '\"';
-				break;
+	if (is_list)
+		fb.offset(children + 4, arrow_field(fb, col, true));
 
-			case '\\':
-				*(p_out++) = '\\';
-				break;
+	if (has_meta) {
+		int meta = fb.vector((is_list ? 2 : 0) + (jazz.cell_type != col.cell_type ? 1 : 0), 4);
 
-			default:
-				int xhi = from_hex(cursor = get_char(p_in, num_bytes));
-				state	= parser_state_switch[state].next[cursor];
+		fb.offset(pos[6], meta);
 
-				int xlo = from_hex(cursor = get_char(p_in, num_bytes));
-				state	= parser_state_switch[state].next[cursor];
+		meta += 4;
 
-				*(p_out++) = (xhi << 4) + xlo;
+		if (is_list) {
+			char shape[MAX_TENSOR_RANK*12 + 16], *p_shape = shape;
 
-				break;
-			}
-			break;
+			p_shape += sprintf(p_shape, "{\"shape\":[");
 
-		case PSTATE_CONST_STRING_N:
-			*(p_out++) = cursor;
+			for (int i = 0; i < col.rank; i++)
+				p_shape += sprintf(p_shape, i ? ",%d" : "%d", col.shape[i]);
 
-			break;
+			sprintf(p_shape, "]}");
 
-		case PSTATE_END_STRING:
-			*(p_out++) = '\n';
-			ix++;
+			fb.offset(meta, arrow_key_value(fb, "ARROW:extension:name", "arrow.fixed_shape_tensor"));
+			fb.offset(meta + 4, arrow_key_value(fb, "ARROW:extension:metadata", shape));
 
-			break;
+			meta += 8;
+		}
+		if (jazz.cell_type != col.cell_type) {
+			char cell_type[16];
 
-		case PSTATE_CONST_STRING0:
-		case PSTATE_CONST_STRING_E1:
-		case PSTATE_CONST_STRING_E2:
-		case PSTATE_SEP_STRING:
-			break;
-#ifndef CATCH_TEST
-		default:			// Only binary corruption of the state table can force this, still better keeping it.
+			sprintf(cell_type, "%d", col.cell_type);
 
-			return false;
-#endif
+			fb.offset(meta, arrow_key_value(fb, "jazz.cell_type", cell_type));
 		}
 	}
+	return fb.failed ? 0 : field;
 }
 
 
-/** Parse a tensor of anything other than CELL_TYPE_STRING into a binary (allocated but not initialized) Block.
+/** Appends the root uoffset, a Message table and its (empty) header table to a flatbuffer.
 
-	\param p_in			The input char stream cursor.
-	\param num_bytes	The number of bytes with data above *p_in
-	\param p_block		The allocated block. Already has anything, (cell type, shape, etc.), except the data.
+	\param fb				The (empty) flatbuffer.
+	\param header_type		ARROW_HEADER_SCHEMA or ARROW_HEADER_RECORD_BATCH.
+	\param body_length		The size of the body following the message.
+	\param header_fields	The number of fields of the header table.
+	\param field_size		The size of each field of the header table (see FlatBuffer.table()).
+	\param field_pos		Returns the position of each field of the header table.
 
-	\return	True on success
+	\return The position of the header table.
 */
-bool Container::fill_tensor(pChar &p_in, int &num_bytes, pBlock p_block) {
+int Container::arrow_message(FlatBuffer &fb, int header_type, int64_t body_length, int header_fields, int field_size[], int field_pos[]) {
+	int size[4] = {2, 1, 4, 8}, pos[4];
 
-#ifdef CATCH_TEST
-	if (debug_trigger_failure & TRIGGER_FAIL_FILL_TENSOR)
-		return false;
-#endif
+	int root = fb.space(4, 4);
+	int msg	 = fb.table(4, size, pos);
 
-	char cell [MAX_SIZE_OF_CELL_AS_TEXT];
+	fb.offset(root, msg);
 
-	pChar p_st = (pChar) &cell, p_end = (pChar) &cell + sizeof(cell) - 1;
+	int header = fb.table(header_fields, field_size, field_pos);
 
-	switch (p_block->cell_type) {
-	case CELL_TYPE_BYTE: {
-		char state = PSTATE_IN_INT;
-		int level = 0;
-		uint8_t *p_out = &p_block->tensor.cell_byte[0];
+	fb.offset(pos[2], header);
 
-		while (true) {
-			unsigned char cursor;
+	if (!fb.failed) {
+		*(int16_t *) &fb.p_buf[pos[0]] = ARROW_METADATA_V5;
+		fb.p_buf[pos[1]]			   = header_type;
+		*(int64_t *) &fb.p_buf[pos[3]] = body_length;
+	}
+	return header;
+}
 
-			if (num_bytes == 0) return false;
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+/** Reads a Field table of a Schema into a column.
 
-			switch (state) {
-			case PSTATE_OUT_INT:
-				if (cursor == ']') {
-					if (p_st != ((pChar) &cell)) {		// Ugly parenthesis required by cppcheck
-						*p_st = 0;
-						p_st  = (pChar) &cell;
+	\param fb		The flatbuffer of the Schema message.
+	\param field	The position of the Field table.
+	\param col		The column to be set: name, cell_type, arrow_type, bit_width, is_signed, rank, shape and list_size.
 
-						if (sscanf(p_st, "%hhu", p_out) != 1) return false;
+	\return SERVICE_NO_ERROR or an error: SERVICE_ERROR_CORRUPTED, SERVICE_ERROR_WRONG_TYPE or SERVICE_ERROR_WRONG_NAME.
+*/
+int Container::arrow_parse_field(FlatBuffer &fb, int field, ArrowColumn &col) {
+	int name = fb.child(field, 0), len = name ? fb.get<uint32_t>(name) : 0;
 
-						p_out++;
-					}
-					level--;
+	if (len < 0 || len > NAME_LENGTH)
+		return len < 0 ? SERVICE_ERROR_CORRUPTED : SERVICE_ERROR_WRONG_NAME;
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_byte[p_block->size];
-				}
-				break;
+	if (len > 0 && fb.valid(name + 4, len))
+		memcpy(col.name, &fb.p_buf[name + 4], len);
 
-			case PSTATE_IN_INT:
-				if (cursor == '[')
-					level++;
+	col.name[len] = 0;
 
-				break;
+	if (fb.field(field, 4) != 0)
+		return SERVICE_ERROR_WRONG_TYPE;		// dictionary encoded
 
-			case PSTATE_SEP_INT:
-				if (cursor == ',') {
-					*p_st = 0;
-					p_st  = (pChar) &cell;
+	int type_type = fb.get<uint8_t>(fb.field(field, 2)), type = fb.child(field, 3), jazz_cell_type = 0;
 
-					if (sscanf(p_st, "%hhu", p_out) != 1) return false;
+	col.rank	  = 0;
+	col.list_size = 1;
 
-					p_out++;
-				}
-				break;
+	int meta = fb.child(field, 6);
 
-			case PSTATE_CONST_INT:
-				if (p_st == p_end) return false;
+	for (int i = 0; i < (meta ? (int) fb.get<uint32_t>(meta) : 0) && !fb.failed; i++) {
+		int kv = fb.deref(meta + 4 + 4*i), key = fb.child(kv, 0), val = fb.child(kv, 1);
+		int key_len = fb.get<uint32_t>(key), val_len = fb.get<uint32_t>(val);
 
-				*(p_st++) = cursor;
+		if (!fb.valid(key + 4, key_len) || !fb.valid(val + 4, val_len) || val_len > 255)
+			return SERVICE_ERROR_CORRUPTED;
 
-				break;
+		char value[256];
 
-			case PSTATE_EMPTY_FILE:
-				return true;
+		memcpy(value, &fb.p_buf[val + 4], val_len);
+		value[val_len] = 0;
 
-#ifndef CATCH_TEST
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+		if (key_len == 14 && memcmp(&fb.p_buf[key + 4], "jazz.cell_type", 14) == 0)
+			jazz_cell_type = atoi(value);
+		else if (key_len == 24 && memcmp(&fb.p_buf[key + 4], "ARROW:extension:metadata", 24) == 0) {
+			pChar p_shape = strstr(value, "\"shape\"");
 
-				return false;
-#endif
+			if (p_shape != nullptr && (p_shape = strchr(p_shape, '[')) != nullptr) {
+				col.rank = 0;
+				p_shape++;
+
+				while (*p_shape != ']' && *p_shape != 0) {
+					if (col.rank == MAX_TENSOR_RANK)
+						return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+					col.shape[col.rank++] = strtol(p_shape, &p_shape, 10);
+
+					while (*p_shape == ',' || *p_shape == ' ')
+						p_shape++;
+				}
 			}
 		}
 	}
-	case CELL_TYPE_INTEGER:
-	case CELL_TYPE_FACTOR:
-	case CELL_TYPE_GRADE: {
-		char state = PSTATE_IN_INT;
-		int level = 0;
-		int *p_out = &p_block->tensor.cell_int[0];
 
-		while (true) {
-			unsigned char cursor;
+	if (type_type == ARROW_TYPE_FIXED_SIZE_LIST) {
+		col.list_size = fb.get<int32_t>(fb.field(type, 0));
 
-			if (num_bytes == 0) return false;
+		int children = fb.child(field, 5);
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+		if (fb.failed || fb.get<uint32_t>(children) != 1)
+			return SERVICE_ERROR_CORRUPTED;
 
-			switch (state) {
-			case PSTATE_OUT_INT:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_int_cell(cell, p_st, p_out)) return false;
+		int child = fb.deref(children + 4);
 
-					level--;
+		if (fb.field(child, 4) != 0 || fb.get<uint8_t>(fb.field(child, 2)) == ARROW_TYPE_FIXED_SIZE_LIST)
+			return SERVICE_ERROR_WRONG_TYPE;
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_int[p_block->size];
-				}
-				break;
+		type_type = fb.get<uint8_t>(fb.field(child, 2));
+		type	  = fb.child(child, 3);
 
-			case PSTATE_NA_INT:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+		int64_t cells = 1;
 
-				break;
+		for (int i = 0; i < col.rank; i++) {
+			if (col.shape[i] < 1 || (cells *= col.shape[i]) > INT_MAX)
+				return SERVICE_ERROR_WRONG_ARGUMENTS;
+		}
 
-			case PSTATE_IN_INT:
-				if (cursor == '[')
-					level++;
+		if (col.rank == 0) {
+			col.rank	 = 1;
+			col.shape[0] = col.list_size;
+		} else if (cells != col.list_size)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
 
-				break;
+		if (col.list_size < 1)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+	} else
+		col.rank = 0;
 
-			case PSTATE_SEP_INT:
-				if (cursor == ',')
-					if (!push_int_cell(cell, p_st, p_out)) return false;
+	col.arrow_type = type_type;
+	col.bit_width  = 0;
+	col.is_signed  = false;
 
-				break;
+	switch (type_type) {
+	case ARROW_TYPE_INT:
+		col.bit_width = fb.get<int32_t>(fb.field(type, 0));
+		col.is_signed = fb.get<uint8_t>(fb.field(type, 1));
 
-			case PSTATE_CONST_INT:
-				if (p_st == p_end) return false;
+		break;
 
-				*(p_st++) = cursor;
+	case ARROW_TYPE_FLOATING_POINT:
+	case ARROW_TYPE_TIMESTAMP:
+		col.bit_width = fb.get<int16_t>(fb.field(type, 0));
+	}
+	if (fb.failed)
+		return SERVICE_ERROR_CORRUPTED;
 
-#ifndef CATCH_TEST
-				break;
+	col.cell_type = arrow_cell_type(col, jazz_cell_type);
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+	return col.cell_type == 0 ? SERVICE_ERROR_WRONG_TYPE : SERVICE_NO_ERROR;
+}
 
-				return false;
-#endif
-			}
-		}
-	}
-	case CELL_TYPE_LONG_INTEGER: {
-		char state = PSTATE_IN_INT;
-		int level = 0;
-		long long *p_out = &p_block->tensor.cell_longint[0];
 
-		while (true) {
-			unsigned char cursor;
+/** Copies the values of a column in a RecordBatch into its tensor (created by new_from_arrow()).
 
-			if (num_bytes == 0) return false;
+	\param fb		The flatbuffer of the RecordBatch message.
+	\param batch	The position of the RecordBatch table.
+	\param p_body	The body of the message.
+	\param body_len	The size of the body.
+	\param col		The column. Its p_block is filled and its null_count increased.
+	\param cell_0	The index of the first cell of the tensor to be written.
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+	\return SERVICE_NO_ERROR or SERVICE_ERROR_CORRUPTED.
+*/
+int Container::arrow_fill(FlatBuffer &fb, int batch, pChar p_body, int64_t body_len, ArrowColumn &col, int64_t cell_0) {
+	int		nodes	= fb.child(batch, 1), buffers = fb.child(batch, 2), i_node = col.node_ix, i_buff = col.buffer_ix;
+	int64_t length	= fb.get<int64_t>(fb.field(batch, 0));
 
-			switch (state) {
-			case PSTATE_OUT_INT:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_int_cell(cell, p_st, p_out)) return false;
+	if (fb.failed || (int64_t) fb.get<uint32_t>(nodes) < i_node + (col.rank > 0 ? 2 : 1)
+		|| (int64_t) fb.get<uint32_t>(buffers) < i_buff + (col.rank > 0 ? 1 : 0) + (col.arrow_type == ARROW_TYPE_UTF8 ? 3 : 2))
+		return SERVICE_ERROR_CORRUPTED;
 
-					level--;
+	int64_t node[2][2], buffer[4][2];
+	int		node_bytes = col.rank > 0 ? 32 : 16, buffer_bytes = 16*((col.rank > 0 ? 1 : 0) + (col.arrow_type == ARROW_TYPE_UTF8 ? 3 : 2));
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_longint[p_block->size];
-				}
-				break;
+	if (!fb.valid(nodes + 4 + 16*i_node, node_bytes) || !fb.valid(buffers + 4 + 16*i_buff, buffer_bytes))
+		return SERVICE_ERROR_CORRUPTED;
 
-			case PSTATE_NA_INT:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+	memcpy(node, &fb.p_buf[nodes + 4 + 16*i_node], node_bytes);
+	memcpy(buffer, &fb.p_buf[buffers + 4 + 16*i_buff], buffer_bytes);
 
-				break;
+	if (col.rank > 0) {
+		if (node[0][0] != length || node[0][1] != 0)
+			return node[0][0] != length ? SERVICE_ERROR_CORRUPTED : SERVICE_ERROR_WRONG_TYPE;	// null tensors are not supported
 
-			case PSTATE_IN_INT:
-				if (cursor == '[')
-					level++;
+		node[0][0] = node[1][0];
+		node[0][1] = node[1][1];
+		memmove(buffer, buffer[1], sizeof(buffer) - 16);
+	}
+	int64_t n = node[0][0];
+	pBlock	p_blk = col.p_block;
 
-				break;
+	if (n != length*col.list_size || n < 0 || cell_0 + n > p_blk->size)
+		return SERVICE_ERROR_CORRUPTED;
 
-			case PSTATE_SEP_INT:
-				if (cursor == ',')
-					if (!push_int_cell(cell, p_st, p_out)) return false;
+	for (int i = 0; i < (col.arrow_type == ARROW_TYPE_UTF8 ? 3 : 2); i++)
+		if (buffer[i][0] < 0 || buffer[i][1] < 0 || buffer[i][0] + buffer[i][1] > body_len)
+			return SERVICE_ERROR_CORRUPTED;
 
-				break;
+	uint8_t *p_valid = nullptr, *p_data = (uint8_t *) &p_body[buffer[1][0]];
 
-			case PSTATE_CONST_INT:
-				if (p_st == p_end) return false;
+	if (node[0][1] > 0 && buffer[0][1] > 0) {
+		if (buffer[0][1] < (n + 7)/8)
+			return SERVICE_ERROR_CORRUPTED;
 
-				*(p_st++) = cursor;
+		p_valid = (uint8_t *) &p_body[buffer[0][0]];
+	}
 
-#ifndef CATCH_TEST
-				break;
+	int cell_size = p_blk->cell_type & 0xff;
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+	switch (col.arrow_type) {
+	case ARROW_TYPE_BOOL:
+		if (buffer[1][1] < (n + 7)/8)
+			return SERVICE_ERROR_CORRUPTED;
 
-				return false;
-#endif
+		for (int64_t i = 0; i < n; i++) {
+			uint32_t v = (p_data[i >> 3] >> (i & 7)) & 1;
+
+			if (p_valid != nullptr && ((p_valid[i >> 3] >> (i & 7)) & 1) == 0) {
+				v = BOOLEAN_NA;
+				col.null_count++;
 			}
+			if (cell_size == 1)
+				p_blk->tensor.cell_byte[cell_0 + i] = v;
+			else
+				p_blk->tensor.cell_uint[cell_0 + i] = v;
 		}
-	}
-	case CELL_TYPE_BYTE_BOOLEAN: {
-		char state = PSTATE_IN_INT;
-		int level = 0;
-		bool *p_out = &p_block->tensor.cell_bool[0];
+		return SERVICE_NO_ERROR;
 
-		while (true) {
-			unsigned char cursor;
+	case ARROW_TYPE_UTF8: {
+		if (buffer[1][1] < 4*(n + 1))
+			return SERVICE_ERROR_CORRUPTED;
 
-			if (num_bytes == 0) return false;
+		int32_t		 *p_offs = (int32_t *) p_data;
+		pChar		  p_str	 = &p_body[buffer[2][0]];
+		pStringBuffer psb	 = p_blk->p_string_buffer();
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+		for (int64_t i = 0; i < n; i++) {
+			int32_t first = p_offs[i], len = p_offs[i + 1] - first;
 
-			switch (state) {
-			case PSTATE_OUT_INT:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_bool_cell(cell, p_st, p_out)) return false;
+			if (first < 0 || len < 0 || first + len > buffer[2][1] || psb->last_idx + len + 1 > psb->buffer_size)
+				return SERVICE_ERROR_CORRUPTED;
+
+			if (p_valid != nullptr && ((p_valid[i >> 3] >> (i & 7)) & 1) == 0) {
+				p_blk->tensor.cell_int[cell_0 + i] = STRING_NA;
+				col.null_count++;
+			} else if (len == 0)
+				p_blk->tensor.cell_int[cell_0 + i] = STRING_EMPTY;
+			else {
+				p_blk->tensor.cell_int[cell_0 + i] = psb->last_idx;
+
+				memcpy(&psb->buffer[psb->last_idx], &p_str[first], len);
+				psb->buffer[psb->last_idx + len] = 0;
 
-					level--;
+				psb->last_idx += len + 1;
+			}
+		}
+		return SERVICE_NO_ERROR; }
+	}
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_bool[p_block->size];
-				}
-				break;
+	if (buffer[1][1] < n*cell_size)
+		return SERVICE_ERROR_CORRUPTED;
 
-			case PSTATE_NA_INT:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+	memcpy(&p_blk->tensor.cell_byte[cell_0*cell_size], p_data, n*cell_size);
 
-				break;
+	if (col.arrow_type == ARROW_TYPE_TIMESTAMP && col.bit_width > 0) {		// Jazz times are seconds (time_t), floored.
+		int64_t scale = col.bit_width == 1 ? 1000 : col.bit_width == 2 ? 1000000 : 1000000000;
 
-			case PSTATE_IN_INT:
-				if (cursor == '[')
-					level++;
+		for (int64_t i = 0; i < n; i++) {
+			int64_t t = p_blk->tensor.cell_longint[cell_0 + i];
 
-				break;
+			p_blk->tensor.cell_longint[cell_0 + i] = t/scale - (t % scale < 0 ? 1 : 0);
+		}
+	}
+	if (p_valid == nullptr)
+		return SERVICE_NO_ERROR;
 
-			case PSTATE_SEP_INT:
-				if (cursor == ',')
-					if (!push_bool_cell(cell, p_st, p_out)) return false;
+	for (int64_t i = 0; i < n; i++) {
+		if (((p_valid[i >> 3] >> (i & 7)) & 1) == 0) {
+			int64_t j = cell_0 + i;
 
+			switch (p_blk->cell_type) {
+			case CELL_TYPE_INTEGER:
+			case CELL_TYPE_FACTOR:
+			case CELL_TYPE_GRADE:
+				p_blk->tensor.cell_int[j] = INTEGER_NA;
 				break;
 
-			case PSTATE_CONST_INT:
-				if (p_st == p_end) return false;
+			case CELL_TYPE_SINGLE:
+				p_blk->tensor.cell_uint[j] = SINGLE_NA_UINT32;
+				break;
 
-				*(p_st++) = cursor;
+			case CELL_TYPE_LONG_INTEGER:
+				p_blk->tensor.cell_longint[j] = LONG_INTEGER_NA;
+				break;
 
-#ifndef CATCH_TEST
+			case CELL_TYPE_TIME:
+				p_blk->tensor.cell_longint[j] = TIME_POINT_NA;
 				break;
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+			case CELL_TYPE_DOUBLE:
+				p_blk->tensor.cell_ulongint[j] = DOUBLE_NA_UINT64;
+				break;
 
-				return false;
-#endif
+			default:
+				continue;						// Types without NA keep the value in the buffer.
 			}
+			col.null_count++;
 		}
 	}
-	case CELL_TYPE_BOOLEAN: {
-		char state = PSTATE_IN_INT;
-		int level = 0;
-		uint32_t *p_out = &p_block->tensor.cell_uint[0];
+	return SERVICE_NO_ERROR;
+}
 
-		while (true) {
-			unsigned char cursor;
 
-			if (num_bytes == 0) return false;
+/** The NumPy dtype (the 'descr' of a .npy header) of a cell_type.
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+	\param cell_type	The cell_type of a tensor.
 
-			switch (state) {
-			case PSTATE_OUT_INT:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_bool_cell(cell, p_st, p_out)) return false;
+	\return	The dtype (e.g. "<f8") or nullptr if the cell_type has no dtype. See the "NumPy" section of the Container documentation.
+*/
+const char *Container::npy_descr(int cell_type) {
 
-					level--;
+	switch (cell_type) {
+	case CELL_TYPE_BYTE:
+		return "|u1";
+	case CELL_TYPE_INT8:
+		return "|i1";
+	case CELL_TYPE_BYTE_BOOLEAN:
+		return "|b1";
+	case CELL_TYPE_INT16:
+		return "<i2";
+	case CELL_TYPE_UINT16:
+		return "<u2";
+	case CELL_TYPE_FLOAT16:
+		return "<f2";
+	case CELL_TYPE_INTEGER:
+	case CELL_TYPE_FACTOR:
+	case CELL_TYPE_GRADE:
+		return "<i4";
+	case CELL_TYPE_BOOLEAN:
+	case CELL_TYPE_UINT32:
+		return "<u4";
+	case CELL_TYPE_SINGLE:
+		return "<f4";
+	case CELL_TYPE_LONG_INTEGER:
+		return "<i8";
+	case CELL_TYPE_UINT64:
+		return "<u8";
+	case CELL_TYPE_DOUBLE:
+		return "<f8";
+	case CELL_TYPE_TIME:
+		return "<M8[s]";			// time_t, seconds since the epoch.
+	}
+	return nullptr;
+}
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_uint[p_block->size];
-				}
-				break;
 
-			case PSTATE_NA_INT:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+/** Writes the preamble (magic, version and header) of a version 1.0 .npy file for a tensor.
 
-				break;
+	\param p_block	The tensor.
+	\param p_dest	Where the preamble is written or nullptr to just compute its length.
 
-			case PSTATE_IN_INT:
-				if (cursor == '[')
-					level++;
+	\return	The length of the preamble (a multiple of NPY_ALIGN, the data follows it) or 0 if the cell_type has no dtype.
+*/
+int Container::npy_header(pBlock p_block, uint8_t *p_dest) {
 
-				break;
+	const char *p_descr = npy_descr(p_block->cell_type);
 
-			case PSTATE_SEP_INT:
-				if (cursor == ',')
-					if (!push_bool_cell(cell, p_st, p_out)) return false;
+	if (p_descr == nullptr)
+		return 0;
 
-				break;
+	char hea[NPY_MAX_HEADER];
+	int	 dim[MAX_TENSOR_RANK];
 
-			case PSTATE_CONST_INT:
-				if (p_st == p_end) return false;
+	p_block->get_dimensions(dim);
 
-				*(p_st++) = cursor;
+	int len = sprintf(hea, "{'descr': '%s', 'fortran_order': False, 'shape': (", p_descr);
 
-#ifndef CATCH_TEST
-				break;
+	for (int i = 0; i < p_block->rank; i++)
+		len += sprintf(&hea[len], i == 0 ? "%d," : " %d,", dim[i]);
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+	if (p_block->rank > 1)
+		len--;								// (3,) for a vector, but (3, 4) for a matrix.
 
-				return false;
-#endif
-			}
-		}
-	}
-	case CELL_TYPE_SINGLE: {
-		char state = PSTATE_IN_REAL;
-		int level = 0;
-		float *p_out = &p_block->tensor.cell_single[0];
+	len += sprintf(&hea[len], "), }");
 
-		while (true) {
-			unsigned char cursor;
+	int total = (10 + len + 1 + NPY_ALIGN - 1)/NPY_ALIGN*NPY_ALIGN;
 
-			if (num_bytes == 0) return false;
+	if (p_dest != nullptr) {
+		memcpy(p_dest, NPY_MAGIC, NPY_MAGIC_LENGTH);
+		p_dest[6] = 1;
+		p_dest[7] = 0;
+		*(uint16_t *) &p_dest[8] = total - 10;
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+		memcpy(&p_dest[10], hea, len);
+		memset(&p_dest[10 + len], ' ', total - 11 - len);
+		p_dest[total - 1] = '\n';
+	}
+	return total;
+}
 
-			switch (state) {
-			case PSTATE_OUT_REAL:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_real_cell(cell, p_st, p_out)) return false;
 
-					level--;
+/** Parses the preamble of a .npy file (any version) into the ItemHeader of the tensor it contains.
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_single[p_block->size];
-				}
-				break;
+	\param item		The ItemHeader to be set: cell_type, rank and dim[] (zero padded).
+	\param p_npy	The .npy file. It must start with NPY_MAGIC.
+	\param size		The size of the whole file in bytes. p_npy must hold (at least) its first min(size, 12 + NPY_MAX_HEADER) bytes.
 
-			case PSTATE_NA_REAL:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+	\return	The offset of the data (the length of the preamble) or an error: SERVICE_ERROR_CORRUPTED (also if the file is shorter than
+			the data), SERVICE_ERROR_WRONG_TYPE, SERVICE_ERROR_WRONG_ARGUMENTS (a shape Jazz cannot hold) or SERVICE_ERROR_BLOCK_TOO_BIG.
 
-				break;
+Channels::get() parses just the preamble of a file with this, before reading the data straight into the tensor.
+*/
+int Container::npy_parse_header(ItemHeader &item, const uint8_t *p_npy, int64_t size) {
 
-			case PSTATE_IN_REAL:
-				if (cursor == '[')
-					level++;
+	if (size < 12)
+		return SERVICE_ERROR_CORRUPTED;
 
-				break;
+	int hea_len, off;
 
-			case PSTATE_SEP_REAL:
-				if (cursor == ',')
-					if (!push_real_cell(cell, p_st, p_out)) return false;
+	switch (p_npy[6]) {
+	case 1:
+		hea_len = *(uint16_t *) &p_npy[8];
+		off		= 10;
 
-				break;
+		break;
 
-			case PSTATE_CONST_REAL:
-				if (p_st == p_end) return false;
+	case 2:
+	case 3:
+		hea_len = *(uint32_t *) &p_npy[8];
+		off		= 12;
 
-				*(p_st++) = cursor;
+		break;
 
-#ifndef CATCH_TEST
-				break;
+	default:
+		return SERVICE_ERROR_WRONG_TYPE;
+	}
+	if (hea_len < 0 || hea_len > NPY_MAX_HEADER || off + hea_len > size)
+		return SERVICE_ERROR_CORRUPTED;
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+	char hea[NPY_MAX_HEADER + 1], descr[16];
 
-				return false;
-#endif
-			}
-		}
-	}
-	case CELL_TYPE_DOUBLE: {
-		char state = PSTATE_IN_REAL;
-		int level = 0;
-		double *p_out = &p_block->tensor.cell_double[0];
+	memcpy(hea, &p_npy[off], hea_len);
+	hea[hea_len] = 0;
 
-		while (true) {
-			unsigned char cursor;
+	pChar p_descr = strstr(hea, "'descr'"), p_fortran = strstr(hea, "'fortran_order'"), p_shape = strstr(hea, "'shape'");
 
-			if (num_bytes == 0) return false;
+	if (p_descr == nullptr || p_fortran == nullptr || p_shape == nullptr || sscanf(p_descr + 7, " : '%15[^']'", descr) != 1)
+		return SERVICE_ERROR_CORRUPTED;
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
+	p_fortran += 15 + strspn(p_fortran + 15, " :");
+	p_shape	  += 7 + strspn(p_shape + 7, " :");
 
-			switch (state) {
-			case PSTATE_OUT_REAL:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_real_cell(cell, p_st, p_out)) return false;
+	if (*p_shape++ != '(')
+		return SERVICE_ERROR_CORRUPTED;
 
-					level--;
+	memset(item.dim, 0, sizeof(item.dim));
+	item.rank = 0;
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_double[p_block->size];
-				}
-				break;
+	int64_t cells = 1;
 
-			case PSTATE_NA_REAL:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+	while (true) {
+		p_shape += strspn(p_shape, " ,");
 
-				break;
+		if (*p_shape == ')')
+			break;
 
-			case PSTATE_IN_REAL:
-				if (cursor == '[')
-					level++;
+		pChar	  p_end;
+		long long dim = strtoll(p_shape, &p_end, 10);
 
-				break;
+		if (p_end == p_shape)
+			return SERVICE_ERROR_CORRUPTED;
 
-			case PSTATE_SEP_REAL:
-				if (cursor == ',')
-					if (!push_real_cell(cell, p_st, p_out)) return false;
+		if (item.rank == MAX_TENSOR_RANK || dim < 1)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
 
-				break;
+		if (dim > MAX_BLOCK_SIZE || (cells *= dim) > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_BLOCK_TOO_BIG;
 
-			case PSTATE_CONST_REAL:
-				if (p_st == p_end) return false;
+		item.dim[item.rank++] = dim;
+		p_shape = p_end + (*p_end == 'L' ? 1 : 0);		// Python 2 long
+	}
+	if (item.rank == 0)
+		item.dim[item.rank++] = 1;			// A 0-dimensional array (a scalar)
 
-				*(p_st++) = cursor;
+	if (strncmp(p_fortran, "True", 4) == 0 && item.rank > 1)
+		return SERVICE_ERROR_WRONG_TYPE;
 
-#ifndef CATCH_TEST
-				break;
+	static const int cell_types[] = {CELL_TYPE_BYTE, CELL_TYPE_INT8, CELL_TYPE_BYTE_BOOLEAN, CELL_TYPE_INT16, CELL_TYPE_UINT16,
+									 CELL_TYPE_FLOAT16, CELL_TYPE_INTEGER, CELL_TYPE_UINT32, CELL_TYPE_SINGLE, CELL_TYPE_LONG_INTEGER,
+									 CELL_TYPE_UINT64, CELL_TYPE_DOUBLE, CELL_TYPE_TIME};
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+	item.cell_type = 0;
 
-				return false;
-#endif
-			}
+	for (int cell_type : cell_types) {
+		const char *p_dt = npy_descr(cell_type);
+
+		if (strcmp(&descr[1], &p_dt[1]) == 0 && (descr[0] == p_dt[0] || descr[0] == '=' || (cell_type & 0xff) == 1)) {
+			item.cell_type = cell_type;
+
+			break;
 		}
 	}
-	case CELL_TYPE_TIME: {
-		char state = PSTATE_IN_TIME;
-		int level = 0;
-		time_t *p_out = &p_block->tensor.cell_time[0];
+	if (item.cell_type == 0)
+		return SERVICE_ERROR_WRONG_TYPE;	// Big-endian, strings, objects, structured dtypes, ...
 
-		while (true) {
-			unsigned char cursor;
+	if (off + hea_len + cells*(item.cell_type & 0xff) > size)
+		return SERVICE_ERROR_CORRUPTED;
 
-			if (num_bytes == 0) return false;
+	return off + hea_len;
+}
 
-			cursor = get_char(p_in, num_bytes);
-			state  = parser_state_switch[state].next[cursor];
 
-			switch (state) {
-			case PSTATE_OUT_TIME:
-				if (cursor == ']') {
-					if (level == p_block->rank && !push_time_cell(cell, p_st, p_out, DEF_FLOAT_TIME)) return false;
+/** Write the cell parsed by a TextStream (in .cell, empty is NA) to its chunks, allocating a new chunk when the last one is full.
 
-					level--;
+	\param p_stream	The TextStream. Its .cell_type must already be CELL_TYPE_INTEGER or CELL_TYPE_DOUBLE.
 
-					if (level == 0)
-						return p_out == &p_block->tensor.cell_time[p_block->size];
-				}
-				break;
+	\return	True on success, false if the cell is not a number or the allocation fails.
 
-			case PSTATE_NA_TIME:
-				if (cursor == 'A')
-					p_st = (pChar) &cell;
+The cell is parsed as the push_int_cell() and push_real_cell() used by fill_tensor() would.
+*/
+bool Container::push_stream_cell(pTextStream p_stream) {
 
-				break;
+	TextStream &ts = *p_stream;
 
-			case PSTATE_IN_TIME:
-				if (cursor == '[')
-					level++;
+	int cell_size = ts.cell_type & 0xf;
+	int ix		  = ts.num_cells % (TEXT_STREAM_CHUNK_BYTES/cell_size);
 
-				break;
+	if (ix == 0) {
+		if (ts.num_chunks == TEXT_STREAM_MAX_CHUNKS)
+			return false;
 
-			case PSTATE_SEP_TIME:
-				if (cursor == ',')
-					if (!push_time_cell(cell, p_st, p_out, DEF_FLOAT_TIME)) return false;
+		if ((ts.p_chunk[ts.num_chunks] = (pChar) malloc(TEXT_STREAM_CHUNK_BYTES)) == nullptr)
+			return false;
 
-				break;
+		ts.num_chunks++;
+	}
+	pChar p_chunk = ts.p_chunk[ts.num_chunks - 1];
 
-			case PSTATE_CONST_TIME:
-				if (p_st == p_end) return false;
+	if (ts.cell_len == 0) {
+		if (ts.cell_type == CELL_TYPE_DOUBLE)
+			reinterpret_cast<double *>(p_chunk)[ix] = DOUBLE_NA;
+		else
+			reinterpret_cast<int *>(p_chunk)[ix] = INTEGER_NA;
+	} else {
+		pChar p_end;
 
-				*(p_st++) = cursor;
+		ts.cell[ts.cell_len] = 0;
 
-#ifndef CATCH_TEST
-				break;
+		if (ts.cell_type == CELL_TYPE_DOUBLE)
+			reinterpret_cast<double *>(p_chunk)[ix] = strtod(ts.cell, &p_end);
+		else
+			reinterpret_cast<int *>(p_chunk)[ix] = strtol(ts.cell, &p_end, 0);	// Like sscanf("%i")
 
-			default:			// Only binary corruption of the state table can force this, still better keeping it.
+		if (p_end == ts.cell)
+			return false;
 
-				return false;
-#endif
-			}
-		}
-	}
-	default:
-		return false;
+		ts.cell_len = 0;
 	}
+	ts.num_cells++;
+
+	return true;
 }
 
 
@@ -3282,10 +6271,13 @@ bool Container::fill_tensor(pChar &p_in, int &num_bytes, pBlock p_block) {
 	\param p_in			The input char stream cursor.
 	\param num_bytes	The number of bytes with data above *p_in
 	\param att			An AttributeMap for the new_block() call.
+	\param p_dest		If not nullptr, a Block of CELL_TYPE_STRING (typically an item of a Tuple created in place) with the shape in
+						item_hea and space for item_hea.item_size plus one byte per cell in its string buffer. The strings are written
+						into it instead of creating a new Block and p_txn is not used.
 
 	\return	StatusCode like a new_block() call
 */
-int Container::new_text_block(pTransaction &p_txn, ItemHeader &item_hea, pChar &p_in, int &num_bytes, AttributeMap *att) {
+int Container::new_text_block(pTransaction &p_txn, ItemHeader &item_hea, pChar &p_in, int &num_bytes, AttributeMap *att, pBlock p_dest) {
 
 #ifdef CATCH_TEST
 	if (debug_trigger_failure & TRIGGER_FAIL_TEXT_BLOCK)
@@ -3316,20 +6308,54 @@ int Container::new_text_block(pTransaction &p_txn, ItemHeader &item_hea, pChar &
 		else {
 			if (!fill_text_buffer(p_in, num_bytes, p_txt, num_cells, p_is_NA, p_hasLN)) ret = PARSE_ERROR_TEXT_FILLING;
 			else {
-				ret = new_block(p_txn, CELL_TYPE_STRING, item_hea.dim, FILL_WITH_TEXTFILE, 0, p_txt, '\n', att);
+				if (p_dest == nullptr) {
+					ret = new_block(p_txn, CELL_TYPE_STRING, item_hea.dim, FILL_WITH_TEXTFILE, 0, p_txt, '\n', att);
+
+					if (ret == SERVICE_NO_ERROR)
+						p_dest = p_txn->p_block;
+				} else {
+					int text_length = 0, num_lines = 0;
+
+					pChar pt = p_txt;
+					while (*pt) {
+						if (*pt == '\n') {
+							if (!pt[1])
+								break;
+
+							num_lines++;
+						}
+						pt++;
+					}
+					text_length = (uintptr_t) pt - (uintptr_t) p_txt - num_lines;
+					num_lines++;
+
+					pStringBuffer psb = p_dest->p_string_buffer();
+
+					if (p_dest->cell_type != CELL_TYPE_STRING || num_lines != p_dest->size)
+						ret = SERVICE_ERROR_NEW_BLOCK_ARGS;
+					else if (text_length + num_lines > psb->buffer_size - psb->last_idx)
+						ret = SERVICE_ERROR_NO_MEM;
+					else {
+						p_dest->has_NA = false;
+
+						fill_text_tensor(p_dest, p_txt, '\n');
+
+						ret = SERVICE_NO_ERROR;
+					}
+				}
 
 				if (ret == SERVICE_NO_ERROR) {
 					for (int i = 0; i < num_cells; i++) {
 						if (p_is_NA[i] < 0)
 							break;
 
-						p_txn->p_block->tensor.cell_int[p_is_NA[i]] = STRING_NA;
+						p_dest->tensor.cell_int[p_is_NA[i]] = STRING_NA;
 					}
 					for (int i = 0; i < num_cells; i++) {
 						if (p_hasLN[i] < 0)
 							break;
 
-						ExpandEscapeSequences(p_txn->p_block->get_string(p_hasLN[i]));
+						ExpandEscapeSequences(p_dest->get_string(p_hasLN[i]));
 					}
 				}
 			}
@@ -89,10 +89,23 @@ namespace jazz_elements
 #define BLOCK_STATUS_READY				  0		///< Transaction.status: p_block-> is safe to use
 #define BLOCK_STATUS_EMPTY				  1		///< Transaction.status: successful new_transaction() and new_block() or get() in progress.
 #define BLOCK_STATUS_DESTROYED			  2		///< Transaction.status: transaction belongs to the container inside the free list.
+#define BLOCK_STATUS_PINNED				  3		///< Transaction.status: destroy_transaction()-ed, the Block is kept until its views are destroyed.
+#define BLOCK_STATUS_VIEW				  4		///< Transaction.status: p_block-> is safe to use, but points inside another Transaction's Block.
 
 /// Thread safety
 #define LOCK_NUM_RETRIES_BEFORE_YIELD	100		///< Number of retries when lock fails before calling this_thread::yield()
 
+/// Multithreaded gather in new_block(3)
+#define GATHER_PARALLEL_KBYTES		   65536	///< Default ONE_SHOT_GATHER_PARALLEL_KBYTES: new_block(3) filters larger tensors with threads.
+#define GATHER_MAX_THREADS				  16	///< The maximum number of threads gathering the rows in new_block(3)
+
+/// Strided views (see StridedView)
+#define STRIDED_VIEW_TILE				  32	///< The side of the tiles in which new_block() (10) copies transposed views.
+
+/// Streaming text parser (see TextStream)
+#define TEXT_STREAM_CHUNK_BYTES		 (1 << 20)	///< The size of each chunk of parsed cells kept by a TextStream
+#define TEXT_STREAM_MAX_CHUNKS			2048	///< The number of chunks that fill the 2 Gb a Block can hold
+
 /// sqrt(2^31) == # simultaneous readers to outweigh a writer == # simultaneous writers to force an overflow
 #define LOCK_WEIGHT_OF_WRITE			46341
 
@@ -118,6 +131,34 @@ namespace jazz_elements
 #define TRIGGER_FAIL_FILL_TENSOR		0x02	///< Trigger a failure in fill_tensor() to test error handling.
 #define TRIGGER_FAIL_NEW_STRING_BLOCK	0x04	///< Trigger a failure in new_block() (1) creating a string.
 
+/// Apache Arrow IPC stream format (see new_arrow() and new_from_arrow())
+
+#define ARROW_CONTINUATION		  0xffffffff	///< The marker starting every encapsulated message of an Arrow IPC stream.
+#define ARROW_METADATA_V5				   4	///< Arrow MetadataVersion.V5, the version written in every Message.
+#define ARROW_HEADER_SCHEMA				   1	///< Arrow MessageHeader union type: Schema.
+#define ARROW_HEADER_RECORD_BATCH		   3	///< Arrow MessageHeader union type: RecordBatch.
+#define ARROW_TYPE_INT					   2	///< Arrow Type union type: Int.
+#define ARROW_TYPE_FLOATING_POINT		   3	///< Arrow Type union type: FloatingPoint.
+#define ARROW_TYPE_UTF8					   5	///< Arrow Type union type: Utf8.
+#define ARROW_TYPE_BOOL					   6	///< Arrow Type union type: Bool.
+#define ARROW_TYPE_TIMESTAMP			  10	///< Arrow Type union type: Timestamp.
+#define ARROW_TYPE_FIXED_SIZE_LIST		  16	///< Arrow Type union type: FixedSizeList.
+#define ARROW_LAYOUT_ROWS				   0	///< One column per item, one row per index of the (common) first dimension of the items.
+#define ARROW_LAYOUT_TENSOR				   1	///< A tensor (not a Tuple) in a single column, one row per index of its first dimension.
+#define ARROW_LAYOUT_ITEMS				   2	///< One column per item, a single row. Each cell is a whole item. (Items of different length.)
+#define ARROW_FLATBUFFER_BYTES			1024	///< The flatbuffer space new_arrow() reserves per column (and for the message itself).
+
+/// NumPy .npy and (uncompressed) .npz files (see new_npy() and new_from_npy())
+
+#define NPY_MAGIC				"\x93NUMPY"	///< The six bytes starting every .npy file.
+#define NPY_MAGIC_LENGTH				   6	///< The length of NPY_MAGIC.
+#define NPY_ALIGN						  64	///< The preamble (magic, version and header) of a .npy file is padded to a multiple of this.
+#define NPY_MAX_HEADER				   16384	///< The longest header new_from_npy() accepts. (NumPy itself refuses headers above 10K.)
+#define ZIP_LOCAL_FILE_SIG		  0x04034b50	///< The signature of a local file header in a .npz (a zip file).
+#define ZIP_CENTRAL_DIR_SIG		  0x02014b50	///< The signature of a central directory header in a .npz.
+#define ZIP_END_OF_CENTRAL_DIR_SIG 0x06054b50	///< The signature of the end of central directory record in a .npz.
+#define ZIP_ZIP64_EXTRA_ID			  0x0001	///< The id of the zip64 extended information extra field (NumPy always writes it).
+
 
 /** \brief A lookup table for all the possible values of a char mapped into an 8-bit state.
 */
@@ -157,6 +198,262 @@ typedef class Container *pContainer;
 typedef std::map<String, pContainer> BaseNames;
 
 
+/** \brief A minimal flatbuffer, written front to back, for the metadata of Arrow IPC messages. Also reads (checking bounds) flatbuffers.
+
+Writing: Every object is written before the objects it points to, so the (forward) uoffsets are patched with offset() once the target is
+written. Space is never reallocated: if cap is exceeded, failed is set and the result must be discarded.
+
+Reading: Any position (including the result of a failed lookup) is checked, an invalid position sets failed and reads as zero.
+*/
+struct FlatBuffer {
+	uint8_t *p_buf;								///< The buffer.
+	int		 size;								///< Writing: the bytes written so far. Reading: the size of the buffer.
+	int		 cap;								///< Writing: the size of the buffer.
+	bool	 failed;							///< Some write did not fit or some read was out of bounds.
+
+	/** Append zero-filled space.
+
+		\param bytes The size.
+		\param align The alignment (a power of 2) of the space.
+
+		\return The position of the space or 0 if it does not fit (which sets failed).
+	*/
+	inline int space(int bytes, int align) {
+		int pos = (size + align - 1) & ~(align - 1);
+
+		if (failed || pos + bytes > cap) {
+			failed = true;
+
+			return 0;
+		}
+		memset(&p_buf[size], 0, pos + bytes - size);
+		size = pos + bytes;
+
+		return pos;
+	}
+
+	/** Append a table (its vtable and its inline fields).
+
+		\param num_fields The number of fields.
+		\param field_size The size of each field (0 for absent fields, 4 for offsets).
+		\param field_pos  Returns the position of each field.
+
+		\return The position of the table.
+	*/
+	inline int table(int num_fields, int field_size[], int field_pos[]) {
+		int vt_bytes = 4 + 2*num_fields, t_bytes = 4, off[8];
+
+		for (int sz = 8; sz > 0; sz >>= 1) {
+			for (int i = 0; i < num_fields; i++) {
+				if (field_size[i] == sz) {
+					t_bytes = (t_bytes + sz - 1) & ~(sz - 1);
+					off[i]	= t_bytes;
+					t_bytes += sz;
+				}
+			}
+		}
+		int vt = space(vt_bytes, 2);
+		int t  = space(t_bytes, 8);
+
+		if (failed)
+			return 0;
+
+		uint16_t *p_vt = (uint16_t *) &p_buf[vt];
+
+		p_vt[0] = vt_bytes;
+		p_vt[1] = t_bytes;
+
+		for (int i = 0; i < num_fields; i++) {
+			p_vt[2 + i]	 = field_size[i] ? off[i] : 0;
+			field_pos[i] = field_size[i] ? t + off[i] : 0;
+		}
+		*(int32_t *) &p_buf[t] = t - vt;
+
+		return t;
+	}
+
+	/** Append a string.
+
+		\param p_str The (zero ended) string.
+
+		\return The position of the string.
+	*/
+	inline int string(const char *p_str) {
+		int len = strlen(p_str), pos = space(5 + len, 4);
+
+		if (!failed) {
+			*(uint32_t *) &p_buf[pos] = len;
+			memcpy(&p_buf[pos + 4], p_str, len);
+		}
+		return pos;
+	}
+
+	/** Append a vector (its length followed by num_elem zero-filled elements).
+
+		\param num_elem  The number of elements.
+		\param elem_size The size of each element: 4 for offsets, 16 for the structs FieldNode and Buffer.
+
+		\return The position of the vector. The elements start at +4.
+	*/
+	inline int vector(int num_elem, int elem_size) {
+		int align = elem_size < 8 ? 4 : 8;
+
+		space((align - (size + 4) % align) % align, 1);
+
+		int pos = space(4 + num_elem*elem_size, 4);
+
+		if (!failed)
+			*(uint32_t *) &p_buf[pos] = num_elem;
+
+		return pos;
+	}
+
+	/** Set an uoffset already written to point to some target written after it.
+
+		\param at	 The position of the uoffset.
+		\param target The position of the target.
+	*/
+	inline void offset(int at, int target) {
+		if (!failed)
+			*(uint32_t *) &p_buf[at] = target - at;
+	}
+
+	/** Check a position before reading.
+
+		\param pos	The position.
+		\param bytes	The number of bytes to be read.
+
+		\return True if pos is valid (and not the result of a previously failed lookup).
+	*/
+	inline bool valid(int64_t pos, int64_t bytes) {
+		if (failed || pos <= 0 || bytes < 0 || pos + bytes > size) {
+			failed = true;
+
+			return false;
+		}
+		return true;
+	}
+
+	/** Read a scalar.
+
+		\param pos The position of the scalar (as returned by field()).
+		\param def The value returned if the field is absent.
+
+		\return The value.
+	*/
+	template <typename T> inline T get(int pos, T def = 0) {
+		if (pos == 0 || !valid(pos, sizeof(T)))
+			return def;
+
+		T ret;
+		memcpy(&ret, &p_buf[pos], sizeof(T));
+
+		return ret;
+	}
+
+	/** Follow an uoffset.
+
+		\param pos The position of the uoffset (as returned by field(), 0 is the root).
+
+		\return The position it points to, or 0 if the field is absent or invalid.
+	*/
+	inline int deref(int pos) {
+		uint32_t off;
+
+		if (pos < 0 || (int64_t) pos + 4 > size) {
+			failed = true;
+
+			return 0;
+		}
+		memcpy(&off, &p_buf[pos], 4);
+
+		if (off == 0 || pos + (int64_t) off >= size) {
+			failed = true;
+
+			return 0;
+		}
+		return pos + off;
+	}
+
+	/** Follow the uoffset of a field of a table.
+
+		\param table The position of the table.
+		\param idx	The index of the field (a table, a vector or a string).
+
+		\return The position of the table, vector or string or 0 if the field is absent or invalid.
+	*/
+	inline int child(int table, int idx) {
+		int pos = field(table, idx);
+
+		return pos == 0 ? 0 : deref(pos);
+	}
+
+	/** Find a field of a table.
+
+		\param table The position of the table.
+		\param idx	The index of the field.
+
+		\return The position of the field or 0 if it is absent.
+	*/
+	inline int field(int table, int idx) {
+		if (!valid(table, 4))
+			return 0;
+
+		int32_t soff;
+		memcpy(&soff, &p_buf[table], 4);
+
+		int64_t vt = (int64_t) table - soff;
+
+		if (vt < 0 || vt + 4 > size) {
+			failed = true;
+
+			return 0;
+		}
+		uint16_t vt_bytes, t_bytes, off;
+		memcpy(&vt_bytes, &p_buf[vt], 2);
+		memcpy(&t_bytes,  &p_buf[vt + 2], 2);
+
+		if (vt + vt_bytes > size || (int64_t) table + t_bytes > size) {
+			failed = true;
+
+			return 0;
+		}
+		if (4 + 2*idx + 2 > vt_bytes)
+			return 0;
+
+		memcpy(&off, &p_buf[vt + 4 + 2*idx], 2);
+
+		if (off >= t_bytes && off != 0) {
+			failed = true;
+
+			return 0;
+		}
+		return off == 0 ? 0 : table + off;
+	}
+};
+typedef FlatBuffer *pFlatBuffer;				///< A pointer to a FlatBuffer
+
+
+/** \brief The metadata of one column (a tensor or an item of a Tuple) of an Arrow IPC stream. Used by new_arrow() and new_from_arrow().
+*/
+struct ArrowColumn {
+	pBlock	p_block;							///< The tensor (or the item of a Tuple) holding the data.
+	Name	name;								///< The name of the column.
+	int		cell_type;							///< The Jazz cell_type.
+	int		arrow_type;							///< The ARROW_TYPE_* of the values.
+	int		bit_width;							///< Int: bitWidth, FloatingPoint: Precision, Timestamp: TimeUnit.
+	bool	is_signed;							///< Int: is_signed.
+	int		rank;								///< The rank of each cell (a fixed_shape_tensor) or 0 for columns of values.
+	int		shape[MAX_TENSOR_RANK];				///< The shape of each cell (if rank > 0).
+	int		list_size;							///< The number of values in each row (1 if rank == 0).
+	int64_t null_count;							///< The number of NA values.
+	int64_t str_bytes;							///< Utf8: The total length of the strings.
+	int		node_ix;							///< The index of the first FieldNode of the column in a RecordBatch.
+	int		buffer_ix;							///< The index of the first Buffer of the column in a RecordBatch.
+};
+typedef ArrowColumn *pArrowColumn;				///< A pointer to an ArrowColumn
+
+
 /** \brief Transaction: A wrapper over a Block that defines the communication of a block with a Container.
 
 This minimalist struc is the only block wrapper across anything. Anything is: file I/O, http client CRUD, http server GET and PUT, shell
@@ -210,6 +507,101 @@ typedef StoredTransaction *pStoredTransaction;		///< A pointer to a StoredTransa
 typedef std::map<String, int>	MapSI;
 
 
+/// An internal map from a view (see Container::new_view()) to the Transaction owning the Block it points into
+typedef std::map<pTransaction, pTransaction> ViewMap;
+
+
+/// An internal map from a Transaction to the number of views pinning its Block
+typedef std::map<pTransaction, int> PinMap;
+
+
+/// The address and length of the mmap() holding a mapped Block (see Container::new_mapped_block())
+struct MappedBlock {
+	void  *p_base;				///< The address returned by mmap()
+	size_t length;				///< The length of the whole mapping
+};
+
+
+/// An internal map from a mapped Block (see Container::new_mapped_block()) to its mapping
+typedef std::map<pBlock, MappedBlock> MappedMap;
+
+
+/** \brief StridedView: A slice and/or transpose of a tensor described by strides, without copying it.
+
+Each dimension of the view selects shape[i] indices of the source p_block, stride[i] cells apart (strides can be negative) starting at
+the cell offset. A Block is always contiguous, so this is not a Block: it is materialized by Container::new_block() (10) when a Block is
+required (e.g., to serialize it).
+*/
+struct StridedView {
+	pBlock	p_block;						///< The tensor the view reads from. It must outlive the view.
+	int		rank;							///< The number of dimensions of the view (the same as the rank of p_block).
+	int		shape [MAX_TENSOR_RANK];		///< The number of indices of each dimension.
+	int		stride[MAX_TENSOR_RANK];		///< The distance, in cells of p_block, between consecutive indices of each dimension.
+	int		offset;							///< The cell of p_block where the view starts.
+};
+
+
+/** \brief TextStream: The state of a text tensor parsed as it arrives, in pieces of any size, by Container::feed_text_stream().
+
+This is what new_block() (5) does in two passes (shape first, then cells), done in one pass over a stream that can be cut anywhere, even
+inside a cell. Only numeric tensors (what new_block() (5) guesses as CELL_TYPE_INTEGER or CELL_TYPE_DOUBLE) are supported: the cells are
+written to TEXT_STREAM_CHUNK_BYTES chunks as they are parsed, since the shape is unknown until the end, and new_block() (11) copies the
+chunks into the final Block.
+*/
+struct TextStream {
+	int		  state;						///< The parser state (a PSTATE_*) after the last byte fed
+	int		  cell_type;					///< CELL_TYPE_UNDEFINED until the first cell decides CELL_TYPE_INTEGER or CELL_TYPE_DOUBLE
+	int		  level;						///< The current nesting level of the brackets (-1 outside the tensor)
+	int		  rank;							///< The rank of the tensor, set by the first row
+	bool	  first_row;					///< True until the first cell separator is found
+	bool	  closed;						///< The last ']' was found, only spaces may follow
+	int		  dim	[MAX_TENSOR_RANK];		///< The shape of the tensor (-1 for the dimensions not closed yet)
+	int		  n_item[MAX_TENSOR_RANK];		///< The number of items found so far in each open dimension
+	int		  cell_len;						///< The number of chars in .cell
+	char	  cell[MAX_SIZE_OF_CELL_AS_TEXT];	///< The text of the cell being parsed (it may span two calls)
+	int		  num_cells;					///< The number of cells already written to the chunks
+	int		  num_chunks;					///< The number of chunks allocated in .p_chunk[]
+	pChar	  p_chunk[TEXT_STREAM_MAX_CHUNKS];	///< The parsed cells
+};
+typedef TextStream *pTextStream;			///< A pointer to a TextStream
+
+
+/** \brief LargeBlockStream: A stream of bytes in the large block format (a LargeBlockHeader followed by the tensor).
+
+Tensors above the 2 Gb limit of a Block never exist in RAM. They move from one Container to another as a stream: the source either
+writes() into a stream opened by the destination or the destination read()s from a stream opened by the source. Whoever opens a stream
+also closes it. E.g., Persisted::get_large() opens a stream to be read by Channels::put_large() and Channels::get_large() writes into a
+stream opened by Persisted::put_large().
+*/
+class LargeBlockStream {
+
+	public:
+
+		virtual ~LargeBlockStream() {}
+
+		/** \brief Read the next bytes of the stream.
+
+			\param p_buff	Where the bytes are written.
+			\param size	The size of p_buff.
+
+			\return	The number of bytes read (less than size only at the end of the stream) or -1 on error.
+		*/
+		virtual int64_t read(pChar p_buff, int64_t size) = 0;
+
+		/** \brief Write the next bytes of the stream.
+
+			\param p_data	The bytes.
+			\param size	The number of bytes.
+
+			\return	False on error (the stream should then be closed without committing).
+		*/
+		virtual bool write(pChar p_data, int64_t size) = 0;
+
+		int64_t stream_bytes = -1;					///< The total size of the stream (header included) or -1 if unknown.
+};
+typedef LargeBlockStream *pLargeBlockStream;		///< A pointer to a LargeBlockStream
+
+
 /** \brief Container: A Service to manage Jazz blocks. All Jazz blocks are managed by this or a descendant of this.
 
 This is the root class for all containers. It is basically an abstract class with some helpful methods but is not instanced as an object.
@@ -270,7 +662,7 @@ functions and mutators.
 new_block()
 -----------
 
-**NOTE** that new_block() has 8 forms. It is always called new_block() to emphasize that what the function does is create a new block (vs.
+**NOTE** that new_block() has 9 forms. It is always called new_block() to emphasize that what the function does is create a new block (vs.
 sharing a pointer to an existing one). Therefore, the container allocates and owns it an requires a destroy_transaction() call when no
 longer needed. The forms cover all the supported ways to do basic operations like filtering and serializing.
 
@@ -282,6 +674,107 @@ longer needed. The forms cover all the supported ways to do basic operations lik
    -# new_block(): Create a Tensor of CELL_TYPE_BYTE of rank == 1 with a text serialization of a Tensor, Kind or Tuple.
    -# new_block(): Create an empty Index block. It is dynamically allocated, an std:map, and is destroy_transaction()-ed like the others.
    -# new_block(): Create a Tuple of (key:STRING[length],value:STRING[length]) with the content of an Index.
+   -# new_block(): Create a Tuple of a Kind, laid out in place, ready to be filled without copying its items.
+
+Form 2 copies its items from existing Blocks. Form 9 (also used by forms 5 and 8) allocates the Tuple first and hands out its items via
+Tuple.get_block() to be filled in place. The caller finishes with Tuple.close_tuple().
+
+Apache Arrow
+------------
+
+new_arrow() serializes a tensor or a Tuple as an Apache Arrow IPC stream (a Schema, a RecordBatch and the end-of-stream marker) in a
+Tensor of CELL_TYPE_BYTE of rank == 1, new_from_arrow() builds a tensor or a Tuple from one (with any number of RecordBatches). No Arrow
+library is required. The mapping is:
+
+   - Numeric types map to Int, FloatingPoint (FLOAT16 is HALF) or Timestamp (seconds, no time zone) for CELL_TYPE_TIME.
+	 Timestamps in other units are floored to seconds when read.
+   - Booleans map to Bool and CELL_TYPE_STRING to Utf8.
+   - NA maps to null (a validity bitmap). Types without NA are never null.
+   - A Tuple is a RecordBatch (one column per item). A tensor is a single column.
+   - Items of rank > 1 are "arrow.fixed_shape_tensor" columns (a FixedSizeList of the values with the shape in the metadata).
+   - If the items of a Tuple do not share their first dimension, the RecordBatch has a single row in which each cell is a whole item.
+   - What Arrow cannot express (FACTOR, GRADE, the 32-bit BOOLEAN) is kept in the field metadata ("jazz.cell_type"), the layout
+	 (tensor or whole items) is kept in the schema metadata ("jazz.layout").
+
+Dictionaries and compressed bodies are not supported by new_from_arrow().
+
+NumPy
+-----
+
+new_npy() serializes a tensor as a .npy file or a Tuple as an uncompressed .npz file (one "<item name>.npy" per item) in a Tensor of
+CELL_TYPE_BYTE of rank == 1, new_from_npy() builds a tensor (from a .npy) or a Tuple (from a .npz) from one. The data is copied with a
+single memcpy() per tensor, both ways. The mapping is:
+
+   - Numeric types map to the dtype of the same size and kind: |u1, |i1, <i2, <u2, <f2, <i4, <u4, <f4, <i8, <u8 and <f8.
+   - CELL_TYPE_BYTE_BOOLEAN is |b1 and CELL_TYPE_TIME (a time_t) is <M8[s]. Other datetime64 units are not supported.
+   - FACTOR and GRADE are exported as <i4 and the 32-bit BOOLEAN as <u4. They are read back as INTEGER and UINT32.
+   - A 0-dimensional array is read as a tensor of rank 1 and size 1.
+   - STRING and BFLOAT16 have no dtype and are not supported. Neither are big-endian dtypes, Fortran order (of rank > 1) or compressed
+	 (deflated) .npz entries.
+
+new_view()
+----------
+
+Unlike new_block(), new_view() does not allocate or copy a Block. It returns a Transaction (with status BLOCK_STATUS_VIEW) whose p_block
+points inside the Block of another Transaction: the whole Block or an item of a Tuple, which is already a valid Block. This makes
+selecting an item of a large Tuple O(1). A view is read-only and is destroy_transaction()-ed like any other Transaction. Anything that
+reads a pBlock (serializing, filtering, put(), ...) accepts it transparently. The view pins its parent: if the parent is
+destroy_transaction()-ed first, its Block is kept (BLOCK_STATUS_PINNED) until the last view on it is destroyed. The pins are kept by the
+Container owning the parent, which also owns the views.
+
+new_fused_filter()
+------------------
+
+A chain of filters (x[f1][f2][f3], each one selecting from the result of the previous one) does not need an intermediate Block per
+filter. new_fused_filter() composes the filters into one (without visiting the data), so a single new_block(3) gathers the rows of x.
+Booleans are AND-ed (a boolean chain stays boolean) and any integer filter in the chain makes the result an integer filter.
+
+Filtering large tensors
+-----------------------
+
+new_block(3) copies the selected rows of tensors of at least ONE_SHOT_GATHER_PARALLEL_KBYTES (an optional config key, 64 Mb by default)
+in up to GATHER_MAX_THREADS chunks run by the Pool (in the calling thread when no Pool is running). A boolean filter is counted per
+chunk first and the prefix sum of the counts is where each chunk writes its rows. (An integer filter already is the list of output
+offsets.) Each chunk then copies its runs of rows. Tensors of strings are gathered as any other tensor: the cells are offsets into the StringBuffer,
+which is copied as a whole, so the offsets in every chunk remain valid without rebuilding it.
+
+Hashing blocks
+--------------
+
+close_block() hashes everything but the header with the scheme in the optional config key ONE_SHOT_BLOCK_HASH_SCHEME and records it in
+the header (.hash_scheme) so check_hash() always knows how to verify it: HASH_SCHEME_MURMUR64A (0, the default), HASH_SCHEME_CRC32C
+(1, the crc32c instruction on two streams, the fastest in one thread) or HASH_SCHEME_TREE (2, MurmurHash64A of 1 Mb chunks hashed by
+several threads, then of the chunk hashes). Blocks stored before .hash_scheme existed verify as MurmurHash64A. The setting is process
+wide (it is read by every Container that starts).
+
+Strided views
+-------------
+
+A StridedView describes a slice (x[::2,10:20], start:stop:step per dimension as in Python) and/or a transpose (x.T, all the dimensions
+reversed) of a tensor only by its shape, strides and offset. new_strided_view(), slice_view() and transpose_view() only update that
+descriptor: a chain of slices and transposes costs nothing until new_block() (10) copies the selected cells, once, into a contiguous
+Block. When the last dimension of the view is not contiguous in the source (a transpose), it copies in STRIDED_VIEW_TILE square tiles so
+that both reading and writing stay in cache. Since a Block cannot have zero-length dimensions, empty slices are an error.
+
+Streaming text parser
+---------------------
+
+new_block() (5) needs the whole text: it finds the shape in a first pass and parses the cells in a second one. A TextStream parses a
+numeric tensor in one pass, as its text arrives (e.g., a PUT while it is still being uploaded). new_text_stream() creates it,
+feed_text_stream() parses the next bytes (which can end anywhere, even inside a cell) and new_block() (11) returns the tensor once the
+last ']' has been fed. The cell type is guessed by the first cell exactly as new_block() (5) does with CELL_TYPE_UNDEFINED. Anything
+else (strings, Tuples, Kinds, ...) makes feed_text_stream() fail before the cell type is decided, so the caller can still fall back to
+new_block() (5) with the whole text.
+
+new_mapped_block()
+------------------
+
+A descendant serving files (see Channels) can create a Block whose tensor is a file mapped with mmap(). The header (and the string buffer
+after the tensor) live in anonymous memory around a private (copy-on-write) mapping of the file, so nothing is ever written to the file.
+The tensor is read straight from the page cache and the Block is not counted in the allocation of the Container. It is
+destroy_transaction()-ed like any other Block, which unmaps it. As with any mmap(), the file must not be truncated while mapped.
+A mapped Block is not hashed (hash64 == 0) and has_NA is true unless it is CELL_TYPE_BYTE, since finding either would read the whole
+file. Anything needing the hash (e.g., serving an ETag or forward_put()) computes it with close_block() at that point.
 
 */
 class Container : public Service {
@@ -358,11 +851,71 @@ class Container : public Service {
 		StatusCode new_block   (pTransaction	   &p_txn,
 								Index			   &index);
 
+		// 9. new_block(): Create a Tuple of a Kind, laid out in place, ready to be filled without copying its items.
+		StatusCode new_block   (pTransaction	   &p_txn,
+								pKind				p_kind,
+								MapSI			   &dims,
+								int					p_str_bytes[]	= nullptr,
+								AttributeMap	   *att				= nullptr);
+
+		// Apache Arrow IPC streams: .new_arrow(), .new_from_arrow()
+
+		StatusCode new_arrow	 (pTransaction	   &p_txn,
+								  pBlock			p_from_raw);
+		StatusCode new_from_arrow(pTransaction	   &p_txn,
+								  pBlock			p_from_arrow,
+								  AttributeMap	   *att = nullptr);
+
+		// NumPy .npy and .npz files: .new_npy(), .new_from_npy()
+
+		StatusCode new_npy		 (pTransaction	   &p_txn,
+								  pBlock			p_from_raw);
+		StatusCode new_from_npy	 (pTransaction	   &p_txn,
+								  pBlock			p_from_npy,
+								  AttributeMap	   *att = nullptr);
+
 		// Support for transactions creation/destruction
 
 		virtual StatusCode new_transaction(pTransaction &p_txn);
 		virtual void destroy_transaction  (pTransaction &p_txn);
 
+		// Zero-copy views: .new_view()
+
+		StatusCode new_view(pTransaction &p_txn,
+							pTransaction  p_parent,
+							pChar		  name = nullptr);
+
+		// Chains of filters: .new_fused_filter()
+
+		StatusCode new_fused_filter(pTransaction &p_txn,
+									pBlock		  p_filter[],
+									int			  num_filters);
+
+		// Strided views: .new_strided_view(), .slice_view(), .transpose_view() and new_block() (10) to materialize them
+
+		bool	   new_strided_view(StridedView	 &view,
+									pBlock		  p_from);
+		bool	   slice_view	   (StridedView	 &view,
+									pChar		  p_slice);
+		void	   transpose_view  (StridedView	 &view);
+
+		// 10. new_block(): Create a Tensor with the cells selected by a StridedView.
+		StatusCode new_block   (pTransaction	   &p_txn,
+								StridedView		   &view);
+
+		// Streaming text parser: .new_text_stream(), .feed_text_stream(), .destroy_text_stream() and new_block() (11) to finish it
+
+		pTextStream new_text_stream	  ();
+		bool		feed_text_stream  (pTextStream	p_stream,
+									   pChar		p_in,
+									   int			num_bytes);
+		void		destroy_text_stream(pTextStream &p_stream);
+
+		// 11. new_block(): Create a Tensor from a TextStream that has been fed a complete tensor.
+		StatusCode new_block   (pTransaction	   &p_txn,
+								pTextStream			p_stream,
+								AttributeMap	   *att = nullptr);
+
 		// Crud: .get(), .header(), .put(), .new_entity(), .remove(), .copy()
 
 		// The "easy" interface: Uses strings instead of locators. Is translated to the native interface by an as_locator() call.
@@ -611,6 +1164,46 @@ class Container : public Service {
 		}
 
 		StatusCode destroy_container();
+		bool	   release_view		(pTransaction &p_txn);
+		StatusCode detach_views		(pTransaction  p_txn);
+		StatusCode new_mapped_block	(pTransaction &p_txn,
+									 int		   fd,
+									 int64_t	   file_size,
+									 int64_t	   offset,
+									 int		   cell_type,
+									 int		  *dim);
+		bool	   release_mapped	(pBlock		   p_block);
+		int		   gather_threads	(int		   tensor_bytes,
+									 int		   filter_size);
+		int		   count_selected	(pBlock		   p_row_filter,
+									 int		   num_threads,
+									 int		   chunk_rows[]);
+		bool	   gather_rows		(u_char		  *p_dest,
+									 u_char		  *p_src,
+									 pBlock		   p_row_filter,
+									 int		   bytes_per_row,
+									 int		   tensor_rows,
+									 int		   num_threads,
+									 int		   chunk_rows[]);
+		bool	   gather_chunk		(u_char		  *p_dest,
+									 u_char		  *p_src,
+									 pBlock		   p_row_filter,
+									 int		   first,
+									 int		   last,
+									 int		   bytes_per_row,
+									 int		   tensor_rows);
+		StatusCode new_tuple_block	(pTransaction &p_txn,
+									 int		   num_items,
+									 ItemHeader	   p_items[],
+									 Name		   p_names[],
+									 int		   p_str_bytes[] = nullptr,
+									 AttributeMap *att			 = nullptr);
+		int		   npy_header		(pBlock		   p_block,
+									 uint8_t	  *p_dest);
+		int		   npy_parse_header (ItemHeader	  &item,
+									 const uint8_t *p_npy,
+									 int64_t		size);
+		bool	   push_stream_cell (pTextStream   p_stream);
 
 		/** Returns the binary value of a hex char assuming it is in range.
 
@@ -625,11 +1218,17 @@ class Container : public Service {
 		uint64_t warn_alloc_bytes;			///< Taken from ONE_SHOT_WARN_BLOCK_KBYTES
 		uint64_t fail_alloc_bytes;			///< Taken from ONE_SHOT_ERROR_BLOCK_KBYTES
 		uint64_t alloc_bytes;				///< The current allocation in bytes
+		uint64_t gather_parallel_bytes = 1024*GATHER_PARALLEL_KBYTES;	///< Taken from ONE_SHOT_GATHER_PARALLEL_KBYTES (optional)
 		pTransaction p_buffer;				///< The buffer for the transactions
 		pTransaction p_free;				///< The free list of transactions
 		bool alloc_warning_issued;			///< True if a warning was issued for over-allocation
 		Lock32 _lock_;						///< A lock for the deque of transactions
 		int log_error_level = LOG_ERROR;	///< The log level for LMDB errors made a variable to silence it in tests
+		ViewMap views;						///< The views (owned by this Container) and the Transactions they point into
+		PinMap pins;						///< The Transactions (owned by this Container) pinned by some views
+		std::atomic<int32_t> num_views = {0};	///< The number of views, to skip release_view() when there are none
+		MappedMap mapped;					///< The mapped Blocks (see new_mapped_block()) and their mappings
+		std::atomic<int32_t> num_mapped = {0};	///< The number of mapped Blocks, to skip release_mapped() when there are none
 
 #ifndef CATCH_TEST
 	private:
@@ -948,7 +1547,25 @@ class Container : public Service {
 		bool fill_text_buffer	 (pChar &p_in, int &num_bytes, pChar p_out, int num_cells, int is_NA[], int hasLN[]);
 		bool fill_tensor		 (pChar &p_in, int &num_bytes, pBlock p_block);
 
-		int new_text_block		 (pTransaction &p_txn, ItemHeader &item_hea, pChar &p_in, int &num_bytes, AttributeMap *att = nullptr);
+		int new_text_block		 (pTransaction &p_txn,
+								  ItemHeader   &item_hea,
+								  pChar		   &p_in,
+								  int		   &num_bytes,
+								  AttributeMap *att	   = nullptr,
+								  pBlock		p_dest = nullptr);
+
+		void fill_text_tensor	 (pBlock p_block, const char *p_text, char eol);
+
+		bool arrow_type_of		 (ArrowColumn &col);
+		int	 arrow_cell_type	 (ArrowColumn &col, int jazz_cell_type);
+		int	 arrow_validity		 (pBlock p_block, uint8_t *p_bits);
+		int	 arrow_key_value	 (FlatBuffer &fb, const char *p_key, const char *p_value);
+		int	 arrow_field		 (FlatBuffer &fb, ArrowColumn &col, bool is_child);
+		int	 arrow_message		 (FlatBuffer &fb, int header_type, int64_t body_length, int header_fields, int field_size[], int field_pos[]);
+		int	 arrow_parse_field	 (FlatBuffer &fb, int field, ArrowColumn &col);
+		int	 arrow_fill			 (FlatBuffer &fb, int batch, pChar p_body, int64_t body_len, ArrowColumn &col, int64_t cell_0);
+
+		const char *npy_descr	 (int cell_type);
 
 		int tensor_int_as_text	 (pBlock p_block, pChar p_dest, pChar p_fmt);
 		int tensor_bool_as_text	 (pBlock p_block, pChar p_dest);
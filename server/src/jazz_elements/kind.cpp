@@ -59,7 +59,8 @@ int Kind::audit() {
 		return MIXED_TYPE_INVALID;
 	}
 
-	std::set <int> items;
+	if (size > MAX_ITEMS_IN_KIND)
+		return MIXED_TYPE_INVALID;
 
 	for (int i = 0; i < size; i++) {
 		ItemHeader *p_it_hea = &tensor.cell_item[i];
@@ -68,15 +69,15 @@ int Kind::audit() {
 		    || p_it_hea->name <= STRING_EMPTY || p_it_hea->data_start != 0)
 				return MIXED_TYPE_INVALID;
 
-		if (items.find(p_it_hea->name) != items.end())
-			return MIXED_TYPE_INVALID;
-
-		items.insert(p_it_hea->name);
-
 		if (!valid_name(&p_string_buffer()->buffer[p_it_hea->name]))
 			return MIXED_TYPE_INVALID;
 	}
 
+	ItemNameTable names;
+
+	if (names.build(this) >= 0)
+		return MIXED_TYPE_INVALID;
+
 	for (int i = 0; i < size; i++) {
 		ItemHeader *p_it_hea = &tensor.cell_item[i];
 
@@ -51,6 +51,72 @@
 namespace jazz_elements
 {
 
+#define ITEM_NAME_TABLE_SLOTS	128		///< The slots in an ItemNameTable (a power of 2, at least twice MAX_ITEMS_IN_KIND).
+
+
+/** \brief ItemNameTable: A hash table of the item names of a Kind or a Tuple.
+
+Blocks are immutable and have no room for an index of their names, so .index() is a linear search (of at most MAX_ITEMS_IN_KIND
+strcmp()). Code finding many names in the same Kind or Tuple (or checking them all for duplicates) builds an ItemNameTable once, on the
+stack, and finds each name in O(1). The table points into the Block, so it is only valid as long as the Block is.
+*/
+struct ItemNameTable {
+	pBlock p_block;							///< The Kind or Tuple whose item names are indexed.
+	int8_t slot[ITEM_NAME_TABLE_SLOTS];		///< The index of the item in each slot or -1 for an empty slot.
+
+	/** Builds the table for the items of a Kind or a Tuple.
+
+		\param p_kind_or_tuple	The Block of CELL_TYPE_TUPLE_KIND, CELL_TYPE_BLOCK_KIND or CELL_TYPE_TUPLE.
+
+		\return	The index of the first item whose name repeats the name of a previous one, -1 if the names are unique.
+	*/
+	inline int build(pBlock p_kind_or_tuple) {
+		p_block = p_kind_or_tuple;
+
+		memset(slot, -1, sizeof(slot));
+
+		for (int idx = 0; idx < p_block->size && idx < MAX_ITEMS_IN_KIND; idx++) {
+			pChar name = item_name(idx);
+			int	  i	   = find_slot(name);
+
+			if (slot[i] >= 0)
+				return idx;
+
+			slot[i] = idx;
+		}
+
+		return -1;
+	}
+
+	/** Get the index for an item by name.
+
+		\param name The name of the item.
+
+		\return A valid index or -1 for "not found".
+	*/
+	inline int index(pChar name) {
+		return slot[find_slot(name)];
+	}
+
+	/** The name of an item of the Block (without checking the index range).
+	*/
+	inline pChar item_name(int idx) {
+		return reinterpret_cast<pChar>(&p_block->p_string_buffer()->buffer[p_block->tensor.cell_item[idx].name]);
+	}
+
+	/** The slot of a name: where it is or the empty slot where it would be inserted (linear probing).
+	*/
+	inline int find_slot(pChar name) {
+		int i = MurmurHash64A(name, strlen(name)) & (ITEM_NAME_TABLE_SLOTS - 1);
+
+		while (slot[i] >= 0 && strcmp(item_name(slot[i]), name) != 0)
+			i = (i + 1) & (ITEM_NAME_TABLE_SLOTS - 1);
+
+		return i;
+	}
+};
+
+
 /** \brief Kind: A type definition for Jazz Blocks and Tuples.
 
 Kind objects contain the metadata only. A Tuple is a data object of a Kind. Kinds define more complex types than (raw) Blocks, even if
@@ -117,6 +183,8 @@ class Kind : public Block {
 			\param name The name of the item.
 
 			\return A invalid index or -1 for "not found".
+
+			NOTE: This is a linear search. To find many names in the same Kind, build an ItemNameTable.
 		*/
 		inline int index(pChar name) {
 			for (int idx = 0; idx < size; idx++) {
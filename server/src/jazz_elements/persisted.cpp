@@ -33,16 +33,163 @@
 
 
 #include <sys/stat.h>
+#include <zlib.h>
 
 
 #include "src/jazz_elements/persisted.h"
 
 namespace jazz_elements
 {
+/*	-----------------------------------------------
+	 Bit and byte level helpers for the codecs
+--------------------------------------------------- */
+
+/// Writes fields of 1 to 64 bits (least significant first) into a byte buffer, a 64-bit word at a time.
+struct BitWriter {
+	uint8_t *p_out;						///< The next byte to be written
+	uint64_t acc;						///< The bits not yet written
+	int		 n_bits;					///< The number of bits in acc
+
+	/// Append the lowest width bits of value (0 < width <= 64, value < 2^width).
+	inline void put(uint64_t value, int width) {
+		acc |= value << n_bits;
+
+		if (n_bits + width >= 64) {
+			memcpy(p_out, &acc, 8);
+			p_out += 8;
+
+			acc		= n_bits == 0 ? 0 : value >> (64 - n_bits);
+			n_bits += width - 64;
+		} else
+			n_bits += width;
+	}
+
+	/// Write the remaining bits (as few bytes as possible) and return the end of the output.
+	inline uint8_t *flush() {
+		for (; n_bits > 0; n_bits -= 8) {
+			*p_out++ = (uint8_t) acc;
+			acc >>= 8;
+		}
+		n_bits = 0;
+
+		return p_out;
+	}
+};
+
+
+/// Reads fields of 1 to 64 bits written by a BitWriter. Reading past the end returns zeroes, bits_read allows checking that.
+struct BitReader {
+	uint8_t *p_in;						///< The next byte to be read
+	uint8_t *p_end;						///< The end of the input
+	uint64_t acc;						///< The bits already read, not yet returned
+	int		 n_bits;					///< The number of bits in acc
+	int64_t	 bits_read;					///< The total number of bits returned
+
+	/// Return the next width bits (0 < width <= 64).
+	inline uint64_t get(int width) {
+		bits_read += width;
+
+		uint64_t mask = width == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << width) - 1;
+
+		if (n_bits >= width) {
+			uint64_t value = acc & mask;
+
+			acc		 = width == 64 ? 0 : acc >> width;
+			n_bits	-= width;
+
+			return value;
+		}
+
+		uint64_t word = 0;
+		int		 n	  = std::max(0, std::min(8, (int) (p_end - p_in)));
+
+		memcpy(&word, p_in, n);
+		p_in += n;
+
+		uint64_t value = (acc | (word << n_bits)) & mask;
+		int		 taken = width - n_bits;
+
+		acc	   = taken == 64 ? 0 : word >> taken;
+		n_bits = 64 - taken;
+
+		return value;
+	}
+};
+
+
+/** \brief Write an LZ sequence (literals + match) in the format described in Persisted::lz_compress().
+
+	\return	The new output position or -1 if the sequence does not fit in dest_size.
+*/
+inline int lz_put_sequence(uint8_t *p_lit, int lit_len, int offset, int match_len, uint8_t *p_dest, int op, int dest_size) {
+
+	if (op + lit_len + lit_len/255 + match_len/255 + 5 > dest_size)
+		return -1;
+
+	int match_code = match_len == 0 ? 0 : match_len - LZ_CODEC_MIN_MATCH;
+
+	p_dest[op++] = (std::min(lit_len, 15) << 4) | std::min(match_code, 15);
+
+	if (lit_len >= 15) {
+		int n = lit_len - 15;
+
+		for (; n >= 255; n -= 255)
+			p_dest[op++] = 255;
+
+		p_dest[op++] = n;
+	}
+
+	memcpy(p_dest + op, p_lit, lit_len);
+
+	op += lit_len;
+
+	if (match_len == 0)
+		return op;
+
+	p_dest[op++] = offset & 0xff;
+	p_dest[op++] = offset >> 8;
+
+	if (match_code >= 15) {
+		int n = match_code - 15;
+
+		for (; n >= 255; n -= 255)
+			p_dest[op++] = 255;
+
+		p_dest[op++] = n;
+	}
+
+	return op;
+}
+
+
+/** \brief Read the continuation of an LZ length (the nibble was 15) in the format described in Persisted::lz_compress().
+
+	\return	The complete length or -1 if the input ends before the length does.
+*/
+inline int lz_get_length(uint8_t *p_src, int &ip, int src_size, int len) {
+
+	int byte;
+
+	do {
+		if (ip >= src_size)
+			return -1;
+
+		byte = p_src[ip++];
+		len += byte;
+	} while (byte == 255);
+
+	return len;
+}
+
+
 /*	-----------------------------------------------
 	 Persisted : I m p l e m e n t a t i o n
 --------------------------------------------------- */
 
+/// The transaction of the snapshot read by the current thread inside snapshot_get() (or nullptr). See begin_read().
+static thread_local pMDB_txn snapshot_tx = nullptr;
+
+
 /** Initialize the Persisted Container without starting it.
 
 	\param a_logger		A pointer to a Logger object.
@@ -132,7 +279,8 @@ StatusCode Persisted::start() {
 					+ MDB_MAPASYNC*mapasync
 					+ MDB_NOLOCK*nolock
 					+ MDB_NORDAHEAD*noreadahead
-					+ MDB_NOMEMINIT*nomeminit;
+					+ MDB_NOMEMINIT*nomeminit
+					+ MDB_NOTLS;	// Snapshots are read by any thread.
 
 	if (lmdb_opt.env_set_maxdbs > MAX_POSSIBLE_SOURCES) {
 		log(log_error_level, "Persisted::start() failed. The number of databases cannot exceed MAX_POSSIBLE_SOURCES");
@@ -140,6 +288,29 @@ StatusCode Persisted::start() {
 		return SERVICE_ERROR_BAD_CONFIG;
 	}
 
+	String codec_name;
+
+	if (get_conf_key("MDB_COMPRESSION", codec_name)) {
+		if ((default_codec = codec_by_name(codec_name)) < 0) {
+			log(log_error_level, "Persisted::start() failed. Invalid MDB_COMPRESSION.");
+
+			return SERVICE_ERROR_BAD_CONFIG;
+		}
+	} else
+		default_codec = PERSISTED_CODEC_NONE;
+
+	if (!get_conf_key("MDB_SNAPSHOT_MAX_SECONDS", snapshot_max_seconds))
+		snapshot_max_seconds = PERSISTED_SNAPSHOT_MAX_SECONDS;
+
+	if (!get_conf_key("MDB_SNAPSHOT_MAX_COUNT", snapshot_max_count))
+		snapshot_max_count = PERSISTED_SNAPSHOT_MAX_COUNT;
+
+	if (snapshot_max_seconds <= 0 || snapshot_max_count <= 0 || snapshot_max_count >= lmdb_opt.env_set_maxreaders) {
+		log(log_error_level, "Persisted::start() failed. Invalid MDB_SNAPSHOT_MAX_SECONDS or MDB_SNAPSHOT_MAX_COUNT.");
+
+		return SERVICE_ERROR_BAD_CONFIG;
+	}
+
 	strcpy(lmdb_opt.path, db_path.c_str());
 
 	struct stat st;
@@ -189,6 +360,22 @@ StatusCode Persisted::start() {
 		return SERVICE_ERROR_STARTING;
 	}
 
+	entity_codec.clear();
+
+	for (DBImap::iterator it = source_dbi.begin(); it != source_dbi.end(); ++it)
+		load_compression((pChar) it->first.c_str());
+
+	if (open_dedup(false) != SERVICE_NO_ERROR) {
+		log(log_error_level, "Persisted::start() failed: open_dedup() failed.");
+
+		return SERVICE_ERROR_STARTING;
+	}
+
+	dedup_entity.clear();
+
+	for (DBImap::iterator it = source_dbi.begin(); it != source_dbi.end(); ++it)
+		load_dedup((pChar) it->first.c_str());
+
 	return SERVICE_NO_ERROR;
 }
 
@@ -201,6 +388,8 @@ StatusCode Persisted::start() {
 StatusCode Persisted::shut_down() {
 
 	if (lmdb_env != nullptr) {
+		expire_snapshots(true);
+
 		log(LOG_INFO, "Closing all LMDB databases.");
 
 		close_all_databases();
@@ -216,6 +405,9 @@ StatusCode Persisted::shut_down() {
 		lmdb_env = nullptr;
 	}
 
+	entity_codec.clear();
+	dedup_entity.clear();
+
 	return Container::shut_down();	// Closes the one-shot functionality.
 }
 
@@ -234,8 +426,9 @@ be destroy_transaction()-ed when the caller is done.
 StatusCode Persisted::get(pTransaction &p_txn, Locator &what) {
 
 	pMDB_txn p_l_txn;
+	int		 stored_size;
 
-	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn, &stored_size);
 
 	if (p_blx == nullptr) {
 		p_txn = nullptr;
@@ -243,6 +436,14 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what) {
 		return SERVICE_ERROR_BLOCK_NOT_FOUND;
 	}
 
+	if (p_blx->cell_type == CELL_TYPE_LONG_INTEGER && is_series(p_blx, stored_size)) {
+		StatusCode ret = series_get(p_txn, p_l_txn, source_dbi[what.entity], what, p_blx, nullptr, 0, -1);
+
+		done_pointer_to_block(p_l_txn);
+
+		return ret;
+	}
+
 	StatusCode ret = new_transaction(p_txn);
 
 	if (ret != SERVICE_NO_ERROR) {
@@ -260,7 +461,18 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what) {
 		return SERVICE_ERROR_NO_MEM;
 	}
 
-	memcpy(p_txn->p_block, p_blx, p_blx->total_bytes);
+	if (stored_size == p_blx->total_bytes)
+		memcpy(p_txn->p_block, p_blx, p_blx->total_bytes);
+
+	else if (!decode_block(p_blx, stored_size, p_txn->p_block)) {
+		done_pointer_to_block(p_l_txn);
+
+		log_printf(log_error_level, "Decompression failed for //%s/%s/%s", what.base, what.entity, what.key);
+
+		destroy_transaction(p_txn);
+
+		return SERVICE_ERROR_CORRUPTED;
+	}
 
 	done_pointer_to_block(p_l_txn);
 
@@ -293,8 +505,9 @@ be destroy_transaction()-ed when the caller is done.
 StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pBlock p_row_filter) {
 
 	pMDB_txn p_l_txn;
+	int		 stored_size;
 
-	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn, &stored_size), p_unpacked = nullptr;
 
 	if (p_blx == nullptr) {
 		p_txn = nullptr;
@@ -302,9 +515,35 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pBlock p_row_filte
 		return SERVICE_ERROR_BLOCK_NOT_FOUND;
 	}
 
+	if (is_series(p_blx, stored_size)) {
+		StatusCode ret = series_get(p_txn, p_l_txn, source_dbi[what.entity], what, p_blx, p_row_filter, 0, -1);
+
+		done_pointer_to_block(p_l_txn);
+
+		return ret;
+	}
+
+	if (stored_size != p_blx->total_bytes) {
+		StatusCode ret = unpack_block(p_blx, stored_size, p_unpacked);
+
+		done_pointer_to_block(p_l_txn);
+
+		if (ret != SERVICE_NO_ERROR) {
+			p_txn = nullptr;
+
+			return ret;
+		}
+		p_blx = p_unpacked;
+	}
+
 	StatusCode ret = new_block(p_txn, p_blx, p_row_filter);
 
-	done_pointer_to_block(p_l_txn);
+	if (p_unpacked == nullptr)
+		done_pointer_to_block(p_l_txn);
+	else {
+		alloc_bytes -= p_unpacked->total_bytes;
+		free(p_unpacked);
+	}
 
 	return ret;
 }
@@ -320,13 +559,17 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pBlock p_row_filte
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
 Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
+be destroy_transaction()-ed when the caller is done. If the Tuple is compressed, the Transaction is a view (see new_view()) of the
+item inside the decompressed Tuple. Otherwise, only the item is copied out of the LMDB map: a view cannot point into it, since the
+pages are only valid until the read transaction ends.
 */
 StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pChar name) {
 
 	pMDB_txn p_l_txn;
+	int		 stored_size;
 
-	pTuple p_blx = (pTuple) lock_pointer_to_block(what, p_l_txn);
+	pTuple p_blx = (pTuple) lock_pointer_to_block(what, p_l_txn, &stored_size);
+	pBlock p_unpacked;
 
 	if (p_blx == nullptr) {
 		p_txn = nullptr;
@@ -334,6 +577,39 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pChar name) {
 		return SERVICE_ERROR_BLOCK_NOT_FOUND;
 	}
 
+	if (stored_size != p_blx->total_bytes) {
+		StatusCode ret = unpack_block(p_blx, stored_size, p_unpacked);
+
+		done_pointer_to_block(p_l_txn);
+
+		if (ret != SERVICE_NO_ERROR) {
+			p_txn = nullptr;
+
+			return ret;
+		}
+
+		// The decompressed Tuple is already a private copy: return a view of the item instead of copying it again.
+
+		pTransaction p_tuple;
+
+		if ((ret = new_transaction(p_tuple)) != SERVICE_NO_ERROR) {
+			alloc_bytes -= p_unpacked->total_bytes;
+			free(p_unpacked);
+
+			p_txn = nullptr;
+
+			return ret;
+		}
+		p_tuple->p_block = p_unpacked;
+		p_tuple->status	 = BLOCK_STATUS_READY;
+
+		ret = new_view(p_txn, p_tuple, name);
+
+		destroy_transaction(p_tuple);
+
+		return ret;
+	}
+
 	StatusCode ret = new_block(p_txn, p_blx, name);
 
 	done_pointer_to_block(p_l_txn);
@@ -342,399 +618,5015 @@ StatusCode Persisted::get(pTransaction &p_txn, Locator &what, pChar name) {
 }
 
 
-/** Native (Persistence) interface **metadata of a Block** retrieval.
+/** "Easy" interface **complete Block** retrieval extended with key scans.
 
-	\param hea	A StaticBlockHeader structure that will receive the metadata.
-	\param what	Some Locator to the block. E.g. //lmdb/entity/key
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param p_what	Either something that as_locator() can parse (E.g. //lmdb/entity/key), a key scan
+					(E.g. //lmdb/entity/~from:k1~to:k2~limit:100, see parse_scan()), an index lookup
+					(E.g. //lmdb/entity/~index:url~eq:/index.html, see parse_lookup()), a block-log dump or restore
+					(E.g. //lmdb/entity/~dump:entity.log, see parse_log() and log_path()) returning an Index with the number of "blocks"
+					or a snapshot (E.g. //lmdb/entity/~snapshot:new or ~snapshot:17~key:k, see parse_snapshot()). Creating or
+					releasing a snapshot returns an Index with its id as "snapshot".
 
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-This is a faster, not involving RAM allocation version of the other form of header. For a tensor, is will be the only thing you need, but
-for a Kind or a Tuple, you probably want the types of all its items and need to pass a pTransaction to hold the data.
+Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
+be destroy_transaction()-ed when the caller is done.
 */
-StatusCode Persisted::header(StaticBlockHeader &hea, Locator &what) {
+StatusCode Persisted::get(pTransaction &p_txn, pChar p_what) {
 
-	pMDB_txn p_l_txn;
+	Locator	   loc;
+	KeyScan	   range;
+	IndexQuery query;
+	int		   codec;
+	pChar	   p_path;
+	bool	   is_restore;
+	int64_t	   id;
+	String	   url;
 
-	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+	switch (StatusCode ret = parse_snapshot(loc, p_what, id, url)) {
+	case SERVICE_NO_ERROR: {
+		if (!url.empty())
+			return snapshot_get(p_txn, id, (pChar) url.c_str());
 
-	if (p_blx == nullptr)
-		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+		ret = id == 0 ? new_snapshot(id) : release_snapshot(id);
 
-	memcpy(&hea, p_blx, sizeof(StaticBlockHeader));
+		if (ret != SERVICE_NO_ERROR) {
+			p_txn = nullptr;
 
-	done_pointer_to_block(p_l_txn);
+			return ret;
+		}
+		Index idx = {};
 
-	return SERVICE_NO_ERROR;
+		idx["snapshot"] = std::to_string(id);
+
+		return new_block(p_txn, idx); }
+
+	case SERVICE_ERROR_PARSING_COMMAND:
+		p_txn = nullptr;
+
+		return ret;
+	}
+
+	switch (StatusCode ret = parse_log(loc, p_what, codec, p_path, is_restore)) {
+	case SERVICE_NO_ERROR: {
+		int64_t num_blocks;
+
+		String path;
+
+		if ((ret = log_path(p_path, is_restore, path)) != SERVICE_NO_ERROR) {
+			p_txn = nullptr;
+
+			return ret;
+		}
+		p_path = (pChar) path.c_str();
+
+		ret = is_restore ? restore(p_path, loc.entity, num_blocks) : dump(p_path, loc.entity, codec, num_blocks);
+
+		if (ret != SERVICE_NO_ERROR) {
+			p_txn = nullptr;
+
+			return ret;
+		}
+		Index idx = {};
+
+		idx["blocks"] = std::to_string(num_blocks);
+
+		return new_block(p_txn, idx); }
+
+	case SERVICE_ERROR_PARSING_COMMAND:
+		p_txn = nullptr;
+
+		return ret;
+	}
+
+	switch (StatusCode ret = parse_lookup(loc, query, p_what)) {
+	case SERVICE_NO_ERROR:
+		return lookup(p_txn, loc, query);
+
+	case SERVICE_ERROR_PARSING_COMMAND:
+		p_txn = nullptr;
+
+		return ret;
+	}
+
+	switch (StatusCode ret = parse_scan(loc, range, p_what)) {
+	case SERVICE_NO_ERROR:
+		return scan(p_txn, loc, range);
+
+	case SERVICE_ERROR_PARSING_COMMAND:
+		p_txn = nullptr;
+
+		return ret;
+	}
+	return Container::get(p_txn, p_what);
 }
 
 
-/** Native (Persistence) interface **metadata of a Block** retrieval.
+/** Read the keys (and optionally the blocks) of a range of keys in an entity in order.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container with a Tuple. (See below.)
+	\param what		A Locator with the entity. (The key is ignored.)
+	\param range	The range of keys. (See KeyScan.)
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+The Tuple has the items:
+
+- "key": A CELL_TYPE_STRING vector with the keys in LMDB order. (The segments of a series, keys with a "~", are not listed.)
+- "offset": (Only if range.blocks) A CELL_TYPE_LONG_INTEGER vector with the offset of each block in "blocks".
+- "blocks": (Only if range.blocks) A CELL_TYPE_BYTE vector with all the blocks (decompressed) each one aligned to 8 bytes.
+- "next": A CELL_TYPE_STRING with one element. If not empty, there are more keys in the range and the scan can be continued with
+  range.from = next and range.after = true.
+
+All the keys are read with one cursor in one read transaction, the values are never copied until the result is built and compressed
+blocks are decoded straight into the result. A scan with blocks stops before exceeding PERSISTED_SCAN_MAX_BYTES (returning a "next").
+*/
+StatusCode Persisted::scan(pTransaction &p_txn, Locator &what, KeyScan &range) {
+
+	p_txn = nullptr;
+
+	if (range.limit <= 0 || range.limit > PERSISTED_SCAN_MAX_LIMIT)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	DBImap::iterator it = source_dbi.find(what.entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = begin_read(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::scan().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	StatusCode ret = SERVICE_ERROR_IO_ERROR;
+
+	MDB_dbi		hh = it->second;
+	MDB_cursor *cursor;
+	MDB_val		l_key, l_data;
+
+	std::vector<MDB_val> keys, values;
+
+	int	 lmdb_err, bytes_keys = 0, bytes_blocks = 0, len_from = strlen(range.from), len_to = strlen(range.to),
+		 len_prefix = strlen(range.prefix), cmp_from;
+	bool more = false, exclusive = range.after;
+
+	pTransaction p_key = nullptr, p_next = nullptr, p_offset = nullptr, p_blocks = nullptr;
+
+	if (hh == INVALID_MDB_DBI) {
+		if ((lmdb_err = mdb_dbi_open(lm_tx, what.entity, MDB_CREATE, &hh))) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::scan().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi [what.entity] = hh;
+	}
+
+	if ((lmdb_err = mdb_cursor_open(lm_tx, hh, &cursor))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::scan().");
+
+		goto release_txn_and_fail;
+	}
+
+	cmp_from = memcmp(range.from, range.prefix, std::min(len_from, len_prefix));
+
+	if (cmp_from < 0 || (cmp_from == 0 && len_from < len_prefix)) {
+		l_key.mv_size = len_prefix;		// The prefix is after .from, start at the prefix.
+		l_key.mv_data = &range.prefix[0];
+		exclusive	  = false;
+	} else {
+		l_key.mv_size = len_from;
+		l_key.mv_data = &range.from[0];
+	}
+
+	if (l_key.mv_size == 0)
+		lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_FIRST);
+	else {
+		MDB_val start = l_key;
+
+		lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_SET_RANGE);
+
+		if (lmdb_err == 0 && exclusive && l_key.mv_size == start.mv_size && memcmp(l_key.mv_data, start.mv_data, start.mv_size) == 0)
+			lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT);
+	}
+
+	while (lmdb_err == 0) {
+		if (len_prefix > 0 && (l_key.mv_size < (size_t) len_prefix || memcmp(l_key.mv_data, range.prefix, len_prefix) != 0))
+			break;
+
+		if (len_to > 0) {
+			int cmp = memcmp(l_key.mv_data, range.to, std::min((int) l_key.mv_size, len_to));
+
+			if (cmp > 0 || (cmp == 0 && (int) l_key.mv_size > len_to))
+				break;
+		}
+
+		if (   (l_key.mv_size == 1 && *(pChar) l_key.mv_data == '.')	// The placeholder written by new_database() is not a block,
+			|| memchr(l_key.mv_data, '~', l_key.mv_size) != nullptr) {	// neither are the segments of a series.
+			lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT);
+
+			continue;
+		}
+
+		if (resolve_ref(lm_tx, l_data) != 0 || l_data.mv_size < sizeof(StaticBlockHeader) || l_key.mv_size > NAME_LENGTH) {
+			ret = SERVICE_ERROR_CORRUPTED;
+
+			goto release_cursor_and_fail;
+		}
+
+		int block_bytes = range.blocks ? (((pBlock) l_data.mv_data)->total_bytes + 7) & ~7 : 0;
+
+		if ((int) keys.size() == range.limit || (!keys.empty() && bytes_blocks + (int64_t) block_bytes > PERSISTED_SCAN_MAX_BYTES)) {
+			more = true;
+
+			break;
+		}
+
+		keys.push_back(l_key);
+		values.push_back(l_data);
+
+		bytes_keys	 += l_key.mv_size;
+		bytes_blocks += block_bytes;
+
+		lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT);
+	}
+
+	if (lmdb_err != 0 && lmdb_err != MDB_NOTFOUND) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_get() failed in Persisted::scan().");
+
+		goto release_cursor_and_fail;
+	}
+
+	{	int num_keys = keys.size();
+		int dim[MAX_TENSOR_RANK] = {num_keys, 0, 0, 0, 0, 0};
+
+		Name key;
+
+		ret = new_block(p_key, CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, bytes_keys + 2*num_keys);
+
+		if (ret != SERVICE_NO_ERROR)
+			goto release_cursor_and_fail;
+
+		for (int i = 0; i < num_keys; i++) {
+			memcpy(key, keys[i].mv_data, keys[i].mv_size);
+			key[keys[i].mv_size] = 0;
+
+			p_key->p_block->set_string(i, key);
+		}
+
+		if (!more)
+			key[0] = 0;
+
+		dim[0] = 1;
+
+		if ((ret = new_block(p_next, CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, strlen(key) + 2)) != SERVICE_NO_ERROR)
+			goto release_cursor_and_fail;
+
+		p_next->p_block->set_string(0, key);
+
+		if (range.blocks) {
+			dim[0] = num_keys;
+
+			if ((ret = new_block(p_offset, CELL_TYPE_LONG_INTEGER, dim, FILL_NEW_DONT_FILL)) != SERVICE_NO_ERROR)
+				goto release_cursor_and_fail;
+
+			dim[0] = bytes_blocks;
+
+			if ((ret = new_block(p_blocks, CELL_TYPE_BYTE, dim, FILL_NEW_DONT_FILL)) != SERVICE_NO_ERROR)
+				goto release_cursor_and_fail;
+
+			int offset = 0;
+
+			for (int i = 0; i < num_keys; i++) {
+				pBlock p_blx  = (pBlock) values[i].mv_data;
+				pBlock p_dest = (pBlock) &p_blocks->p_block->tensor.cell_byte[offset];
+				int	   size	  = p_blx->total_bytes, padded = (size + 7) & ~7;
+
+				if ((int) values[i].mv_size == size)
+					memcpy(p_dest, p_blx, size);
+
+				else if (!decode_block(p_blx, values[i].mv_size, p_dest)) {
+					ret = SERVICE_ERROR_CORRUPTED;
+
+					goto release_cursor_and_fail;
+				}
+
+				if (!p_dest->check_hash()) {
+					ret = SERVICE_ERROR_CORRUPTED;
+
+					goto release_cursor_and_fail;
+				}
+				memset((pChar) p_dest + size, 0, padded - size);
+
+				p_offset->p_block->tensor.cell_longint[i] = offset;
+
+				offset += padded;
+			}
+		}
+	}
+
+	mdb_cursor_close(cursor);
+
+	done_pointer_to_block(lm_tx);
+
+	{	StaticBlockHeader hea[4];
+		Name			  name[4] = {"key", "offset", "blocks", "next"};
+		pBlock			  block[4];
+		pTransaction	  item[4] = {p_key, p_offset, p_blocks, p_next};
+
+		int num_items = range.blocks ? 4 : 2;
+
+		if (!range.blocks) {
+			strcpy(name[1], "next");
+			item[1] = p_next;
+		}
+
+		for (int i = 0; i < num_items; i++) {
+			block[i] = item[i]->p_block;
+
+			memcpy(&hea[i], block[i], sizeof(StaticBlockHeader));
+
+			hea[i].range.dim[0] = block[i]->size;
+		}
+
+		ret = new_block(p_txn, num_items, hea, name, block);
+	}
+
+	destroy_transaction(p_key);
+	destroy_transaction(p_next);
+
+	if (range.blocks) {
+		destroy_transaction(p_offset);
+		destroy_transaction(p_blocks);
+	}
+
+	return ret;
+
+release_cursor_and_fail:
+
+	mdb_cursor_close(cursor);
+
+release_txn_and_fail:
+
+	abort_read(lm_tx);
+
+	if (p_key != nullptr)	 destroy_transaction(p_key);
+	if (p_next != nullptr)	 destroy_transaction(p_next);
+	if (p_offset != nullptr) destroy_transaction(p_offset);
+	if (p_blocks != nullptr) destroy_transaction(p_blocks);
+
+	if (ret == SERVICE_ERROR_CORRUPTED)
+		log_printf(log_error_level, "Persisted::scan(): Corrupted block in //%s/%s", what.base, what.entity);
+
+	return ret;
+}
+
+
+/** Find the keys of the blocks whose attribute is equal to a value or in a range of values using a secondary index.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container with a Tuple. (See below.)
+	\param what		A Locator with the entity. (The key is ignored.)
+	\param query	The attribute and the range of values. (See IndexQuery.)
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+The result is a Tuple of a "key" (the keys of the blocks) and a "value" (their attribute values), both CELL_TYPE_STRING in value order
+(and key order for the same value). At most query.limit keys are returned. An equality lookup is a range with query.low == query.high.
+The whole lookup is read from one cursor on the index, so it is logarithmic in the size of the entity, not a scan of its blocks.
+*/
+StatusCode Persisted::lookup(pTransaction &p_txn, Locator &what, IndexQuery &query) {
+
+	p_txn = nullptr;
+
+	if (query.limit <= 0 || query.limit > PERSISTED_SCAN_MAX_LIMIT)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	char name[2*NAME_SIZE], low[PERSISTED_INDEX_MAX_VALUE], high[PERSISTED_INDEX_MAX_VALUE];
+
+	int len_low	 = query.low[0]	 == 0 ? 0 : query_value(query.attribute, query.low, low),
+		len_high = query.high[0] == 0 ? 0 : query_value(query.attribute, query.high, high);
+
+	if (len_low < 0 || len_high < 0)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	index_name(name, what.entity, query.attribute);
+
+	IndexDBImap::iterator it = index_dbi.find(name);
+
+	if (it == index_dbi.end())
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = begin_read(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::lookup().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	MDB_dbi		ih = it->second;
+	MDB_cursor *cursor;
+	MDB_val		l_value, l_key;
+
+	std::vector<String> keys, values;
+
+	int lmdb_err, bytes_keys = 0, bytes_values = 0;
+
+	if (ih == INVALID_MDB_DBI) {
+		if ((lmdb_err = mdb_dbi_open(lm_tx, name, MDB_CREATE | MDB_DUPSORT, &ih))) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::lookup().");
+
+			goto release_txn_and_fail;
+		}
+		index_dbi[name] = ih;
+	}
+
+	if ((lmdb_err = mdb_cursor_open(lm_tx, ih, &cursor))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::lookup().");
+
+		goto release_txn_and_fail;
+	}
+
+	if (len_low == 0)
+		lmdb_err = mdb_cursor_get(cursor, &l_value, &l_key, MDB_FIRST);
+	else {
+		l_value.mv_size = len_low;
+		l_value.mv_data = low;
+
+		lmdb_err = mdb_cursor_get(cursor, &l_value, &l_key, MDB_SET_RANGE);
+	}
+
+	while (lmdb_err == 0 && (int) keys.size() < query.limit) {
+		if (len_high > 0) {
+			int cmp = memcmp(l_value.mv_data, high, std::min((int) l_value.mv_size, len_high));
+
+			if (cmp > 0 || (cmp == 0 && (int) l_value.mv_size > len_high))
+				break;
+		}
+
+		keys.push_back(String((pChar) l_key.mv_data, l_key.mv_size));
+
+		if (query.attribute == PERSISTED_INDEX_CREATED) {
+			uint64_t u = 0;
+
+			for (int i = 0; i < 8; i++)
+				u = (u << 8) | ((uint8_t *) l_value.mv_data)[i];
+
+			values.push_back(std::to_string((int64_t) (u ^ 0x8000000000000000ULL)));
+		} else
+			values.push_back(String((pChar) l_value.mv_data, l_value.mv_size));
+
+		bytes_keys	 += keys.back().length();
+		bytes_values += values.back().length();
+
+		lmdb_err = mdb_cursor_get(cursor, &l_value, &l_key, MDB_NEXT);
+	}
+
+	mdb_cursor_close(cursor);
+
+	if (lmdb_err != 0 && lmdb_err != MDB_NOTFOUND) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_get() failed in Persisted::lookup().");
+
+		goto release_txn_and_fail;
+	}
+
+	done_pointer_to_block(lm_tx);
+
+	{	int num_keys = keys.size();
+		int dim[MAX_TENSOR_RANK] = {num_keys, 0, 0, 0, 0, 0};
+
+		StaticBlockHeader hea[2];
+		Name			  names[2] = {"key", "value"};
+		pBlock			  block[2];
+		pTransaction	  item[2] = {nullptr, nullptr};
+
+		std::vector<String> *p_strings[2] = {&keys, &values};
+
+		StatusCode ret = new_block(item[0], CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, bytes_keys + 2*num_keys);
+
+		if (ret == SERVICE_NO_ERROR)
+			ret = new_block(item[1], CELL_TYPE_STRING, dim, FILL_NEW_DONT_FILL, bytes_values + 2*num_keys);
+
+		if (ret == SERVICE_NO_ERROR) {
+			for (int i = 0; i < 2; i++) {
+				block[i] = item[i]->p_block;
+
+				for (int j = 0; j < num_keys; j++)
+					block[i]->set_string(j, (*p_strings[i])[j].c_str());
+
+				memcpy(&hea[i], block[i], sizeof(StaticBlockHeader));
+
+				hea[i].range.dim[0] = num_keys;
+			}
+			ret = new_block(p_txn, 2, hea, names, block);
+		}
+
+		for (int i = 0; i < 2; i++)
+			if (item[i] != nullptr)
+				destroy_transaction(item[i]);
+
+		return ret;
+	}
+
+release_txn_and_fail:
+
+	abort_read(lm_tx);
+
+	return SERVICE_ERROR_IO_ERROR;
+}
+
+
+/** Native (Persistence) interface **metadata of a Block** retrieval.
+
+	\param hea	A StaticBlockHeader structure that will receive the metadata.
+	\param what	Some Locator to the block. E.g. //lmdb/entity/key
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+This is a faster, not involving RAM allocation version of the other form of header. For a tensor, is will be the only thing you need, but
+for a Kind or a Tuple, you probably want the types of all its items and need to pass a pTransaction to hold the data.
+*/
+StatusCode Persisted::header(StaticBlockHeader &hea, Locator &what) {
+
+	pMDB_txn p_l_txn;
+
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+
+	if (p_blx == nullptr)
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	memcpy(&hea, p_blx, sizeof(StaticBlockHeader));
+
+	done_pointer_to_block(p_l_txn);
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Native (Persistence) interface **metadata of a Block** retrieval.
+
+	\param p_txn A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+				 Transaction inside the Container.
+	\param what	 Some Locator to the block. E.g. //lmdb/entity/key
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+
+Unlike its faster form, this allocates a Block and therefore, it is equivalent to a new_block() call. On success, it will return a
+Transaction that belongs to the Container and must be destroy_transaction()-ed when the caller is done.
+
+For Tensors it will allocate a block that only has the StaticBlockHeader (What you can more efficiently get from the other form.)
+For Kinds, the metadata of all the items is exactly the same a .get() call returns.
+For Tuples, it does what you expect: returning a Block with the metadata of all the items without the data.
+*/
+StatusCode Persisted::header(pTransaction &p_txn, Locator &what) {
+
+	pMDB_txn p_l_txn;
+
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+
+	if (p_blx == nullptr) {
+		p_txn = nullptr;
+
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+	}
+
+	StatusCode ret = new_transaction(p_txn);
+
+	if (ret != SERVICE_NO_ERROR) {
+		done_pointer_to_block(p_l_txn);
+
+		return ret;
+	}
+
+	int hea_size = sizeof(StaticBlockHeader);
+
+	switch (p_blx->cell_type) {
+	case CELL_TYPE_TUPLE:
+	case CELL_TYPE_TUPLE_KIND:
+		hea_size += p_blx->size*sizeof(ItemHeader);
+	}
+
+	p_txn->p_block = block_malloc(hea_size);
+
+	if (p_txn->p_block == nullptr) {
+		done_pointer_to_block(p_l_txn);
+		destroy_transaction(p_txn);
+
+		return SERVICE_ERROR_NO_MEM;
+	}
+
+	memcpy(p_txn->p_block, p_blx, hea_size);
+
+	p_txn->p_block->total_bytes = hea_size;
+
+	p_txn->status = BLOCK_STATUS_READY;
+
+	done_pointer_to_block(p_l_txn);
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Native (Persistence) interface for **Block storing**
+
+	\param where	Some **destination** parsed by as_locator()
+	\param p_block	The Block to be stored in Persistence. The Block hash and dated will be updated by this call!!
+	\param mode		Some writing restriction, either WRITE_ONLY_IF_EXISTS or WRITE_ONLY_IF_NOT_EXISTS. WRITE_TENSOR_DATA returns
+					the error SERVICE_ERROR_WRONG_ARGUMENTS
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+**NOTE**: This updates the calling block's creation time and hash64.
+
+If the entity has a codec (see set_compression()), the block is stored compressed when that saves space.
+*/
+StatusCode Persisted::put(Locator &where, pBlock p_block, int mode) {
+
+	pMDB_txn lm_tx;
+
+	mode = mode == WRITE_AS_BASE_DEFAULT ? WRITE_AS_FULL_BLOCK : mode;
+
+	if ((mode & WRITE_AS_FULL_BLOCK) == 0)
+		return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+	expire_snapshots();
+
+	if (mode & WRITE_ANY_RESTRICTION) {
+		pBlock p_blx = lock_pointer_to_block(where, lm_tx);
+
+		bool already_exists = p_blx != nullptr;
+
+		if (already_exists) {
+			done_pointer_to_block(lm_tx);
+
+			if (mode & WRITE_ONLY_IF_NOT_EXISTS)
+				return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+		} else if (mode & WRITE_ONLY_IF_EXISTS)
+			return SERVICE_ERROR_WRITE_FORBIDDEN;
+	}
+
+	if (p_block->hash64 == 0)
+		p_block->close_block();
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end()) {
+		log(LOG_MISS, "Invalid source in Persisted::put().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	MDB_dbi hh = it->second;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::put().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::put().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	if (   remove_segments(lm_tx, hh, where) != SERVICE_NO_ERROR
+		|| store_block(lm_tx, hh, where, p_block, compression(where.entity)) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::put().");
+
+		goto release_txn_and_fail;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return SERVICE_ERROR_WRITE_FAILED;
+}
+
+
+/** Native (Persistence) interface for **creating databases**
+
+	\param where	The name of the LMDB database to be created. E.g. //lmdb/entity compiled.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+*/
+StatusCode Persisted::new_entity(Locator &where) {
+
+	if (where.key[0] != 0)
+		return SERVICE_ERROR_PARSING_COMMAND;
+
+	return new_database(where.entity);
+}
+
+
+/** Native (Persistence) interface for **deleting databases and blocks**:
+
+	\param where	Some Locator to the block or database to be removed. E.g. //lmdb/entity/key or //lmdb/entity compiled.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+*/
+StatusCode Persisted::remove(Locator &where) {
+
+	if (where.key[0] == 0)
+		return remove_database(where.entity);
+
+	expire_snapshots();
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end()) {
+		log(LOG_MISS, "Invalid source in Persisted::remove().");
+
+		return SERVICE_ERROR_REMOVE_FAILED;
+	}
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::remove().");
+
+		return SERVICE_ERROR_REMOVE_FAILED;
+	}
+
+	MDB_dbi hh = it->second;
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::remove().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	if (remove_segments(lm_tx, hh, where) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
+	if (StatusCode ret = delete_block(lm_tx, hh, where)) {
+		mdb_txn_abort(lm_tx);
+
+		return ret;
+	}
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::remove().");
+
+		goto release_txn_and_fail;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return SERVICE_ERROR_REMOVE_FAILED;
+}
+
+
+/** Native (Persistence) interface for **Block copying** (inside the Persistence).
+
+	\param where	Some **destination** parsed by as_locator()
+	\param what		Some Locator to the block. E.g. //lmdb/entity/key
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+*/
+StatusCode Persisted::copy(Locator &where, Locator &what) {
+
+	pMDB_txn p_l_txn;
+	int		 stored_size;
+
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn, &stored_size), p_unpacked = nullptr;
+
+	if (p_blx == nullptr)
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	if (is_series(p_blx, stored_size)) {
+		pTransaction p_series;
+
+		StatusCode ret = series_get(p_series, p_l_txn, source_dbi[what.entity], what, p_blx, nullptr, 0, -1);
+
+		done_pointer_to_block(p_l_txn);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		ret = put(where, p_series->p_block);
+
+		destroy_transaction(p_series);
+
+		return ret;
+	}
+
+	if (stored_size != p_blx->total_bytes) {
+		StatusCode ret = unpack_block(p_blx, stored_size, p_unpacked);
+
+		done_pointer_to_block(p_l_txn);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		p_blx = p_unpacked;
+	}
+
+	StatusCode ret = put(where, p_blx);
+
+	if (p_unpacked == nullptr)
+		done_pointer_to_block(p_l_txn);
+	else {
+		alloc_bytes -= p_unpacked->total_bytes;
+		free(p_unpacked);
+	}
+
+	return ret;
+}
+
+
+/** Add the base names for this Container.
+
+	\param base_names	A BaseNames map passed by reference to which the base names of this object are added by this call.
+
+	The Persisted object has used-defined databases containing anything, these databases can have any names as long as they do not
+interfere with existing base names. The API object will forward names that do not match any base names to Persisted in case they
+are the name of a database (and will fail otherwise).
+
+	Besides these user-defined names, there is a number of reserved databases that keep track of things and are found in the configuration.
+"static" is a database of objects with attributes BLOCK_ATTRIB_URL and BLOCK_ATTRIB_MIMETYPE exposed via the / API.
+*/
+void Persisted::base_names(BaseNames &base_names) {
+
+	base_names["lmdb"] = this;		// Provides LMDB block persistence for any movable (Tensor, Kind or Tuple).
+}
+
+
+/** \brief Check the internal std::map to see if a (dbi) database name exists.
+
+	\param dbi_name	The location of a Block inside LMDB.
+
+	\return	True if exists.
+*/
+bool Persisted::dbi_exists(Name dbi_name) {
+
+	return source_dbi.find(dbi_name) != source_dbi.end();
+}
+
+
+/** \brief Set the codec used by put() for all the blocks written to an entity from now on.
+
+	\param entity	The name of an existing entity (an LMDB database).
+	\param codec	Any PERSISTED_CODEC_*.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_ENTITY_NOT_FOUND or SERVICE_ERROR_WRONG_ARGUMENTS.
+
+The blocks already stored in the entity are not rewritten. Since each stored value records its codec, they remain readable.
+*/
+StatusCode Persisted::set_compression(pChar entity, int codec) {
+
+	if (codec < PERSISTED_CODEC_NONE || codec >= PERSISTED_NUM_CODECS)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	if (!dbi_exists(entity))
+		return SERVICE_ERROR_ENTITY_NOT_FOUND;
+
+	lock_container();
+
+	entity_codec[entity] = codec;
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Return the codec used by put() for an entity.
+
+	\param entity	The name of the entity.
+
+	\return	The PERSISTED_CODEC_* of the entity (set by MDB_COMPRESSION_<entity> or set_compression()) or the default (MDB_COMPRESSION).
+*/
+int Persisted::compression(pChar entity) {
+
+	lock_container();
+
+	EntityCodecs::iterator it = entity_codec.find(entity);
+
+	int codec = it == entity_codec.end() ? default_codec : it->second;
+
+	unlock_container();
+
+	return codec;
+}
+
+
+/** \brief Set if put() deduplicates the blocks of an entity.
+
+	\param entity	The name of an existing entity (an LMDB database).
+	\param dedup	True to store identical blocks only once.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_ENTITY_NOT_FOUND or SERVICE_ERROR_CREATE_FAILED (PERSISTED_DEDUP_DBI).
+
+The blocks already stored in the entity are not rewritten. Turning dedup off keeps the existing references readable.
+*/
+StatusCode Persisted::set_dedup(pChar entity, bool dedup) {
+
+	if (!dbi_exists(entity))
+		return SERVICE_ERROR_ENTITY_NOT_FOUND;
+
+	if (dedup && open_dedup(true) != SERVICE_NO_ERROR)
+		return SERVICE_ERROR_CREATE_FAILED;
+
+	lock_container();
+
+	if (dedup)
+		dedup_entity.insert(entity);
+	else
+		dedup_entity.erase(entity);
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Check if put() deduplicates the blocks of an entity.
+
+	\param entity	The name of the entity.
+
+	\return	True if set by MDB_DEDUP_<entity> or set_dedup().
+*/
+bool Persisted::is_dedup(pChar entity) {
+
+	lock_container();
+
+	bool dedup = dedup_entity.find(entity) != dedup_entity.end();
+
+	unlock_container();
+
+	return dedup;
+}
+
+
+/** \brief Return the statistics of all the deduplicated blocks.
+
+	\param stats	Returns the number of bodies, the references to them, their stored size and the bytes saved.
+
+	\return	SERVICE_NO_ERROR on success or SERVICE_ERROR_IO_ERROR.
+
+The bytes saved are the stored sizes of the bodies multiplied by the number of references to them minus one. The counts are read with
+one cursor inside one read transaction.
+*/
+StatusCode Persisted::dedup_stats(DedupStats &stats) {
+
+	stats = {};
+
+	if (dedup_dbi == INVALID_MDB_DBI)
+		return SERVICE_NO_ERROR;
+
+	pMDB_txn	lm_tx;
+	MDB_cursor *cursor;
+	MDB_val		l_key, l_data;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, MDB_RDONLY, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::dedup_stats().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	if (int lmdb_err = mdb_cursor_open(lm_tx, dedup_dbi, &cursor)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::dedup_stats().");
+
+		mdb_txn_abort(lm_tx);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	int lmdb_err;
+
+	while ((lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT)) == 0) {
+		if (l_key.mv_size != sizeof(DedupKey) || ((DedupKey *) l_key.mv_data)->what != PERSISTED_DEDUP_COUNT)
+			continue;
+
+		pDedupCount p_count = (pDedupCount) l_data.mv_data;
+
+		stats.bodies++;
+		stats.refs		   += p_count->refs;
+		stats.stored_bytes += p_count->stored_size;
+		stats.bytes_saved  += (p_count->refs - 1)*p_count->stored_size;
+	}
+
+	mdb_cursor_close(cursor);
+	mdb_txn_abort(lm_tx);
+
+	if (lmdb_err != MDB_NOTFOUND) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_get() failed in Persisted::dedup_stats().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Open a snapshot: a read-only transaction kept open under an id for the reads of snapshot_get().
+
+	\param id		Returns the id of the snapshot (always above 0).
+	\param seconds	The lifetime of the snapshot. 0 (or anything above MDB_SNAPSHOT_MAX_SECONDS) is MDB_SNAPSHOT_MAX_SECONDS.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_NOT_APPLICABLE (MDB_NOLOCK = 1), SERVICE_ERROR_WRONG_ARGUMENTS,
+			SERVICE_ERROR_NOT_READY (MDB_SNAPSHOT_MAX_COUNT snapshots are already open) or SERVICE_ERROR_IO_ERROR.
+
+The snapshot must be released by release_snapshot() as soon as possible: while it is open, writers cannot reuse the pages it sees and the
+database grows. If it is not, it is aborted when it expires.
+*/
+StatusCode Persisted::new_snapshot(int64_t &id, int seconds) {
+
+	if (lmdb_opt.flags & MDB_NOLOCK) {
+		log(LOG_MISS, "Persisted::new_snapshot() requires MDB_NOLOCK = 0.");
+
+		return SERVICE_ERROR_NOT_APPLICABLE;
+	}
+
+	if (seconds < 0)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	if (seconds == 0 || seconds > snapshot_max_seconds)
+		seconds = snapshot_max_seconds;
+
+	expire_snapshots();
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, MDB_RDONLY, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::new_snapshot().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	Snapshot snapshot = {lm_tx, std::chrono::steady_clock::now() + std::chrono::seconds(seconds), false};
+
+	lock_container();
+
+	bool full = (int) snapshots.size() >= snapshot_max_count;
+
+	if (!full) {
+		id = ++last_snapshot;
+		snapshots[id] = snapshot;
+	}
+
+	unlock_container();
+
+	if (full) {
+		mdb_txn_abort(lm_tx);
+
+		log(LOG_MISS, "Persisted::new_snapshot() failed: MDB_SNAPSHOT_MAX_COUNT snapshots are open.");
+
+		return SERVICE_ERROR_NOT_READY;
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Release a snapshot opened by new_snapshot(), aborting its transaction.
+
+	\param id	The id of the snapshot.
+
+	\return	SERVICE_NO_ERROR on success or SERVICE_ERROR_WRONG_ARGUMENTS if there is no such snapshot (or it already expired).
+
+If the snapshot is being read by another thread, it is aborted when that thread is done.
+*/
+StatusCode Persisted::release_snapshot(int64_t id) {
+
+	pMDB_txn lm_tx = nullptr;
+
+	lock_container();
+
+	Snapshots::iterator it = snapshots.find(id);
+
+	bool found = it != snapshots.end();
+
+	if (found) {
+		if (it->second.busy)
+			it->second.expires = TimePoint();	// leave_snapshot() aborts it
+
+		else {
+			lm_tx = it->second.lm_tx;
+			snapshots.erase(it);
+		}
+	}
+
+	unlock_container();
+
+	if (lm_tx != nullptr)
+		mdb_txn_abort(lm_tx);
+
+	return found ? SERVICE_NO_ERROR : SERVICE_ERROR_WRONG_ARGUMENTS;
+}
+
+
+/** \brief A get() (of any kind, including key scans and index lookups) inside the transaction of a snapshot.
+
+	\param p_txn	A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+					Transaction inside the Container.
+	\param id		The id of a snapshot returned by new_snapshot().
+	\param p_what	Anything that get() accepts except snapshots, dumps and restores. (E.g. //lmdb/entity/key or
+					//lmdb/entity/~from:k1~limit:100)
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), SERVICE_ERROR_WRONG_ARGUMENTS if there is no such snapshot (or it
+			expired) or whatever get() returns.
+
+All the reads of the same snapshot (of any entity) see the database as it was when new_snapshot() was called. If another thread is
+reading the same snapshot, this waits until it is done.
+*/
+StatusCode Persisted::snapshot_get(pTransaction &p_txn, int64_t id, pChar p_what) {
+
+	p_txn = nullptr;
+
+	Locator	loc;
+	int		codec;
+	pChar	p_path;
+	bool	is_restore;
+	int64_t	inner_id;
+	String	url;
+
+	if (   parse_log(loc, p_what, codec, p_path, is_restore) != SERVICE_ERROR_PARSING_NAMES
+		|| parse_snapshot(loc, p_what, inner_id, url) != SERVICE_ERROR_PARSING_NAMES)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	pMDB_txn lm_tx;
+
+	StatusCode ret = enter_snapshot(id, lm_tx);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	snapshot_tx = lm_tx;
+
+	ret = get(p_txn, p_what);
+
+	snapshot_tx = nullptr;
+
+	leave_snapshot(id);
+
+	return ret;
+}
+
+
+/** \brief Create a secondary index on an attribute of the blocks of an entity.
+
+	\param entity		The name of an existing entity (an LMDB database).
+	\param attribute	The attribute id (E.g., BLOCK_ATTRIB_URL) or PERSISTED_INDEX_CREATED to index the .created time.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_ENTITY_NOT_FOUND, SERVICE_ERROR_WRONG_ARGUMENTS,
+			SERVICE_ERROR_WRITE_FORBIDDEN (the index already exists) or SERVICE_ERROR_WRITE_FAILED.
+
+The blocks already in the entity are indexed in the same write transaction that creates the index. From then on, put() and remove()
+keep it updated. Blocks without the attribute are not in the index.
+*/
+StatusCode Persisted::new_index(pChar entity, int attribute) {
+
+	if (attribute < PERSISTED_INDEX_CREATED)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	if (!dbi_exists(entity))
+		return SERVICE_ERROR_ENTITY_NOT_FOUND;
+
+	char name[2*NAME_SIZE], value[PERSISTED_INDEX_MAX_VALUE];
+
+	index_name(name, entity, attribute);
+
+	if (index_dbi.find(name) != index_dbi.end())
+		return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+	lock_container();
+
+	pMDB_txn	lm_tx;
+	MDB_dbi		hh = source_dbi[entity], ih;
+	MDB_cursor *cursor;
+	MDB_val		l_key, l_data, l_value;
+
+	int lmdb_err;
+
+	if ((lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::new_index().");
+
+		goto release_lock_and_fail;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if ((lmdb_err = mdb_dbi_open(lm_tx, entity, MDB_CREATE, &hh))) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::new_index().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[entity] = hh;
+	}
+
+	if ((lmdb_err = mdb_dbi_open(lm_tx, name, MDB_CREATE | MDB_DUPSORT, &ih))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed in Persisted::new_index().");
+
+		goto release_txn_and_fail;
+	}
+
+	if ((lmdb_err = mdb_cursor_open(lm_tx, hh, &cursor))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::new_index().");
+
+		goto release_txn_and_fail;
+	}
+
+	while ((lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT)) == 0) {
+		if (l_key.mv_size == 1 && *(pChar) l_key.mv_data == '.')		// The placeholder written by new_database() is not a block.
+			continue;
+
+		if ((lmdb_err = resolve_ref(lm_tx, l_data))) {
+			log_lmdb_err(log_error_level, lmdb_err, "resolve_ref() failed in Persisted::new_index().");
+
+			break;
+		}
+
+		pBlock p_blk = (pBlock) l_data.mv_data, p_unpacked = nullptr;
+
+		if (attribute != PERSISTED_INDEX_CREATED && (int) l_data.mv_size != p_blk->total_bytes) {
+			if (unpack_block(p_blk, l_data.mv_size, p_unpacked) != SERVICE_NO_ERROR)
+				break;
+
+			p_blk = p_unpacked;
+		}
+
+		int len = index_value(p_blk, attribute, value);
+
+		if (p_unpacked != nullptr) {
+			alloc_bytes -= p_unpacked->total_bytes;
+			free(p_unpacked);
+		}
+
+		if (len < 0)
+			continue;
+
+		l_value.mv_size = len;
+		l_value.mv_data = value;
+
+		if ((lmdb_err = mdb_put(lm_tx, ih, &l_value, &l_key, MDB_NODUPDATA)) && lmdb_err != MDB_KEYEXIST) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed in Persisted::new_index().");
+
+			break;
+		}
+	}
+
+	mdb_cursor_close(cursor);
+
+	if (lmdb_err != MDB_NOTFOUND)
+		goto release_txn_and_fail;
+
+	if ((lmdb_err = mdb_txn_commit(lm_tx))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::new_index().");
+
+		goto release_txn_and_fail;
+	}
+
+	index_dbi[name] = ih;
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+release_lock_and_fail:
+
+	unlock_container();
+
+	return SERVICE_ERROR_WRITE_FAILED;
+}
+
+
+/** \brief Remove a secondary index created by new_index().
+
+	\param entity		The name of the entity.
+	\param attribute	The attribute id (or PERSISTED_INDEX_CREATED) of the index.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_ENTITY_NOT_FOUND (no such index) or SERVICE_ERROR_REMOVE_FAILED.
+*/
+StatusCode Persisted::remove_index(pChar entity, int attribute) {
+
+	char name[2*NAME_SIZE];
+
+	index_name(name, entity, attribute);
+
+	if (index_dbi.find(name) == index_dbi.end())
+		return SERVICE_ERROR_ENTITY_NOT_FOUND;
+
+	lock_container();
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 ih = index_dbi[name];
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::remove_index().");
+
+		goto release_lock_and_fail;
+	}
+
+	if (ih == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, name, MDB_CREATE | MDB_DUPSORT, &ih)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed in Persisted::remove_index().");
+
+			goto release_txn_and_fail;
+		}
+	}
+
+	if (int lmdb_err = mdb_drop(lm_tx, ih, 1)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_drop() failed in Persisted::remove_index().");
+
+		goto release_txn_and_fail;
+	}
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::remove_index().");
+
+		goto release_txn_and_fail;
+	}
+
+	index_dbi.erase(name);
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+release_lock_and_fail:
+
+	unlock_container();
+
+	return SERVICE_ERROR_REMOVE_FAILED;
+}
+
+
+/** \brief Create an empty segmented series (a tensor that grows by appending rows).
+
+	\param where		The locator of the series (E.g. //lmdb/entity/key). The key cannot be longer than PERSISTED_SERIES_MAX_KEY.
+	\param cell_type	The cell_type of the series. Any type of fixed size (not CELL_TYPE_STRING, a Tuple or a Kind).
+	\param dim			The shape of the series as in new_block(). dim[0] (the rows) is ignored, the rest is the shape of a row.
+	\param segment_rows	The rows in a full segment or 0 for PERSISTED_SERIES_DEFAULT_ROWS.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_WRONG_ARGUMENTS, SERVICE_ERROR_WRITE_FORBIDDEN (the key exists) or
+			SERVICE_ERROR_WRITE_FAILED.
+*/
+StatusCode Persisted::new_series(Locator &where, int cell_type, int *dim, int segment_rows) {
+
+	int cell_size = cell_type & 0xff;
+
+	if (   (cell_size != 1 && cell_size != 4 && cell_size != 8) || cell_type == CELL_TYPE_STRING || cell_type == CELL_TYPE_OBJECT_KIND
+		|| segment_rows < 0 || strlen(where.key) == 0 || strlen(where.key) > PERSISTED_SERIES_MAX_KEY || strchr(where.key, '~') != nullptr)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	SeriesHead	   head = {};
+	SeriesSegments segments;
+
+	head.cell_type	  = cell_type;
+	head.segment_rows = segment_rows == 0 ? PERSISTED_SERIES_DEFAULT_ROWS : segment_rows;
+
+	for (int i = 1; i < MAX_TENSOR_RANK && dim[i] > 0; i++)
+		head.dim[i] = dim[i];
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_WRITE_FAILED;
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 hh = it->second;
+	MDB_val	 l_key, l_data;
+
+	StatusCode ret = SERVICE_ERROR_WRITE_FAILED;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::new_series().");
+
+		return ret;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::new_series().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	if (mdb_get(lm_tx, hh, &l_key, &l_data) != MDB_NOTFOUND) {
+		ret = SERVICE_ERROR_WRITE_FORBIDDEN;
+
+		goto release_txn_and_fail;
+	}
+
+	if (write_manifest(lm_tx, hh, where, head, segments) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::new_series().");
+
+		goto release_txn_and_fail;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return ret;
+}
+
+
+/** \brief Append rows to a segmented series.
+
+	\param where	The locator of the series.
+	\param p_rows	A tensor with the cell_type and the row shape of the series. All its rows are appended.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_BLOCK_NOT_FOUND (not a series), SERVICE_ERROR_WRONG_ARGUMENTS or
+			SERVICE_ERROR_WRITE_FAILED.
+
+The rows are stored as new segments of at most segment_rows rows. The existing segments are not read or rewritten, except when the series
+has more than PERSISTED_SERIES_MAX_SMALL small segments and they are merged. (See compact().) Everything happens in one write transaction.
+*/
+StatusCode Persisted::append(Locator &where, pBlock p_rows) {
+
+	int dim[MAX_TENSOR_RANK];
+
+	if (p_rows == nullptr || p_rows->size <= 0)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	p_rows->get_dimensions(dim);
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 hh = it->second;
+	MDB_val	 l_key, l_data;
+
+	SeriesHead	   head;
+	SeriesSegments segments;
+	SeriesSegment  segment;
+
+	StatusCode ret = SERVICE_ERROR_WRITE_FAILED;
+
+	int64_t rows = dim[0], done = 0;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::append().");
+
+		return ret;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::append().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	if (mdb_get(lm_tx, hh, &l_key, &l_data) != 0 || !is_series((pBlock) l_data.mv_data, l_data.mv_size)) {
+		ret = SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+		goto release_txn_and_fail;
+	}
+
+	if (!read_manifest((pBlock) l_data.mv_data, head, segments)) {
+		ret = SERVICE_ERROR_CORRUPTED;
+
+		goto release_txn_and_fail;
+	}
+
+	if (p_rows->cell_type != head.cell_type) {
+		ret = SERVICE_ERROR_WRONG_ARGUMENTS;
+
+		goto release_txn_and_fail;
+	}
+
+	for (int i = 1; i < MAX_TENSOR_RANK; i++) {
+		if (dim[i] != head.dim[i]) {
+			ret = SERVICE_ERROR_WRONG_ARGUMENTS;
+
+			goto release_txn_and_fail;
+		}
+	}
+
+	while (done < rows) {
+		int64_t seg_rows = std::min(rows - done, head.segment_rows);
+
+		if ((ret = new_segment(lm_tx, hh, where, head, p_rows, done, seg_rows, segment)) != SERVICE_NO_ERROR)
+			goto release_txn_and_fail;
+
+		segments.push_back(segment);
+
+		done += seg_rows;
+	}
+
+	if (   (ret = compact_series(lm_tx, hh, where, head, segments, PERSISTED_SERIES_MAX_SMALL)) != SERVICE_NO_ERROR
+		|| (ret = write_manifest(lm_tx, hh, where, head, segments)) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::append().");
+
+		ret = SERVICE_ERROR_WRITE_FAILED;
+
+		goto release_txn_and_fail;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return ret;
+}
+
+
+/** \brief Read a range of rows of a segmented series.
+
+	\param p_txn		A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
+						Transaction inside the Container with a Tensor.
+	\param what			The locator of the series.
+	\param first_row	The first row.
+	\param num_rows		The number of rows.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_txn), SERVICE_ERROR_BLOCK_NOT_FOUND (not a series) or some negative value (error).
+
+Only the segments containing the rows are read.
+*/
+StatusCode Persisted::get_rows(pTransaction &p_txn, Locator &what, int first_row, int num_rows) {
+
+	pMDB_txn p_l_txn;
+	int		 stored_size;
+
+	p_txn = nullptr;
+
+	pBlock p_blx = lock_pointer_to_block(what, p_l_txn, &stored_size);
+
+	if (p_blx == nullptr)
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	StatusCode ret = SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	if (is_series(p_blx, stored_size))
+		ret = num_rows < 0 ? SERVICE_ERROR_WRONG_ARGUMENTS
+						   : series_get(p_txn, p_l_txn, source_dbi[what.entity], what, p_blx, nullptr, first_row, num_rows);
+
+	done_pointer_to_block(p_l_txn);
+
+	return ret;
+}
+
+
+/** \brief Merge all the runs of consecutive segments of a series below segment_rows into the fewest possible segments.
+
+	\param where	The locator of the series.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_BLOCK_NOT_FOUND (not a series) or some negative value (error).
+
+append() does this automatically when a series has too many small segments. This can be called, e.g., from a maintenance thread to
+keep the reads of a slowly growing series fast.
+*/
+StatusCode Persisted::compact(Locator &where) {
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 hh = it->second;
+	MDB_val	 l_key, l_data;
+
+	SeriesHead	   head;
+	SeriesSegments segments;
+
+	StatusCode ret = SERVICE_ERROR_WRITE_FAILED;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::compact().");
+
+		return ret;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::compact().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	if (mdb_get(lm_tx, hh, &l_key, &l_data) != 0 || !is_series((pBlock) l_data.mv_data, l_data.mv_size)) {
+		ret = SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+		goto release_txn_and_fail;
+	}
+
+	if (!read_manifest((pBlock) l_data.mv_data, head, segments)) {
+		ret = SERVICE_ERROR_CORRUPTED;
+
+		goto release_txn_and_fail;
+	}
+
+	if (   (ret = compact_series(lm_tx, hh, where, head, segments, 1)) != SERVICE_NO_ERROR
+		|| (ret = write_manifest(lm_tx, hh, where, head, segments)) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::compact().");
+
+		ret = SERVICE_ERROR_WRITE_FAILED;
+
+		goto release_txn_and_fail;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return ret;
+}
+
+
+/** \brief Open a stream to read a tensor in the large block format.
+
+	\param p_stream	Returns a stream (a PersistedLargeStream) to be read and then closed by close_large().
+	\param what		The locator of a series or a regular tensor of cells of a fixed size.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_stream), SERVICE_ERROR_BLOCK_NOT_FOUND, SERVICE_ERROR_WRONG_TYPE (no large format
+			for the block) or SERVICE_ERROR_CORRUPTED.
+
+The stream reads a LargeBlockHeader followed by the tensor, one segment at a time, inside one read transaction. Its .stream_bytes is known.
+Since LMDB binds the read transaction to the thread, the thread must close_large() before reading from this Persisted again.
+*/
+StatusCode Persisted::get_large(pLargeBlockStream &p_stream, Locator &what) {
+
+	p_stream = nullptr;
+
+	pMDB_txn lm_tx;
+	int		 stored_size;
+
+	pBlock p_blx = lock_pointer_to_block(what, lm_tx, &stored_size);
+
+	if (p_blx == nullptr)
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	pPersistedLargeStream p_large = new PersistedLargeStream();
+
+	p_large->p_owner = this;
+	p_large->writing = false;
+	p_large->failed	 = false;
+	p_large->where	 = what;
+	p_large->lm_tx	 = lm_tx;
+	p_large->hh		 = source_dbi[what.entity];
+
+	p_stream = p_large;
+
+	LargeBlockHeader &hea = p_large->head;
+
+	if (is_series(p_blx, stored_size)) {
+		if (!read_manifest(p_blx, p_large->series, p_large->segments)) {
+			close_large(p_stream);
+
+			return SERVICE_ERROR_CORRUPTED;
+		}
+		hea.cell_type = p_large->series.cell_type;
+		hea.rank	  = 1;
+
+		for (int i = 0; i < MAX_TENSOR_RANK && p_large->series.dim[i] > 0; i++)
+			hea.rank = i + 1;
+
+		for (int i = 0; i < hea.rank; i++)
+			hea.dim[i] = p_large->series.dim[i];
+
+	} else {
+		if (stored_size == p_blx->total_bytes)
+			p_large->p_block = p_blx;
+		else if (unpack_block(p_blx, stored_size, p_large->p_unpacked) == SERVICE_NO_ERROR)
+			p_large->p_block = p_large->p_unpacked;
+
+		if (p_large->p_block == nullptr || !p_large->p_block->check_hash()) {
+			close_large(p_stream);
+
+			return SERVICE_ERROR_CORRUPTED;
+		}
+		int dim[MAX_TENSOR_RANK];
+
+		p_large->p_block->get_dimensions(dim);
+
+		hea.cell_type = p_large->p_block->cell_type;
+		hea.rank	  = p_large->p_block->rank;
+
+		for (int i = 0; i < hea.rank; i++)
+			hea.dim[i] = dim[i];
+	}
+
+	int cell_size = hea.cell_type & 0xff;
+
+	hea.size = 1;
+
+	for (int i = 0; i < hea.rank; i++)
+		hea.size *= hea.dim[i];
+
+	if (   hea.size <= 0 || (cell_size != 1 && cell_size != 2 && cell_size != 4 && cell_size != 8) || (hea.cell_type & 0xf0) != 0
+		|| hea.cell_type == CELL_TYPE_STRING || hea.cell_type == CELL_TYPE_OBJECT_KIND) {
+		close_large(p_stream);
+
+		return SERVICE_ERROR_WRONG_TYPE;
+	}
+
+	hea.cell_type	|= LARGE_BLOCK_FLAG;
+	hea.version		 = LARGE_BLOCK_VERSION;
+	hea.tensor_bytes = hea.size*cell_size;
+
+	p_large->stream_bytes = sizeof(LargeBlockHeader) + hea.tensor_bytes;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Open a stream to write a tensor in the large block format.
+
+	\param p_stream	Returns a stream (a PersistedLargeStream) to be written and then closed by close_large().
+	\param where	The locator where the tensor is stored (as a series). The key cannot be longer than PERSISTED_SERIES_MAX_KEY.
+
+	\return	SERVICE_NO_ERROR on success (and a valid p_stream), SERVICE_ERROR_WRONG_ARGUMENTS or SERVICE_ERROR_WRITE_FAILED.
+
+The first bytes written must be a valid LargeBlockHeader. The tensor is stored as a series of segments of PERSISTED_LARGE_CHUNK_BYTES (or
+less, whatever makes whole rows) as it arrives, so only one segment is kept in RAM. Everything, including removing what was stored at
+the key, is done in one write transaction committed by close_large(). LMDB serializes the writers: other writes wait until then.
+*/
+StatusCode Persisted::put_large(pLargeBlockStream &p_stream, Locator &where) {
+
+	p_stream = nullptr;
+
+	if (strlen(where.key) == 0 || strlen(where.key) > PERSISTED_SERIES_MAX_KEY || strchr(where.key, '~') != nullptr)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	DBImap::iterator it = source_dbi.find(where.entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_WRITE_FAILED;
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 hh = it->second;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::put_large().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::put_large().");
+
+			mdb_txn_abort(lm_tx);
+
+			return SERVICE_ERROR_WRITE_FAILED;
+		}
+		source_dbi[where.entity] = hh;
+	}
+
+	if (remove_segments(lm_tx, hh, where) != SERVICE_NO_ERROR) {
+		mdb_txn_abort(lm_tx);
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	pPersistedLargeStream p_large = new PersistedLargeStream();
+
+	p_large->p_owner = this;
+	p_large->writing = true;
+	p_large->failed	 = false;
+	p_large->where	 = where;
+	p_large->lm_tx	 = lm_tx;
+	p_large->hh		 = hh;
+
+	p_stream = p_large;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Close a stream opened by get_large() or put_large().
+
+	\param p_stream	The stream (set to nullptr when closed).
+	\param commit	For a put_large() stream, false aborts the write transaction (it is ignored when reading).
+
+	\return	SERVICE_NO_ERROR on success or SERVICE_ERROR_WRITE_FAILED when committing a put_large() stream that failed or is incomplete.
+*/
+StatusCode Persisted::close_large(pLargeBlockStream &p_stream, bool commit) {
+
+	pPersistedLargeStream p_large = (pPersistedLargeStream) p_stream;
+
+	StatusCode ret = SERVICE_NO_ERROR;
+
+	if (p_large->writing) {
+		if (commit) {
+			ret = SERVICE_ERROR_WRITE_FAILED;
+
+			if (   !p_large->failed && p_large->position == (int64_t) sizeof(LargeBlockHeader) + p_large->head.tensor_bytes
+				&& write_manifest(p_large->lm_tx, p_large->hh, p_large->where, p_large->series, p_large->segments) == SERVICE_NO_ERROR) {
+				int lmdb_err = mdb_txn_commit(p_large->lm_tx);
+
+				p_large->lm_tx = nullptr;
+
+				if (lmdb_err)
+					log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::close_large().");
+				else
+					ret = SERVICE_NO_ERROR;
+			}
+		}
+		if (p_large->lm_tx != nullptr)
+			mdb_txn_abort(p_large->lm_tx);
+
+		if (p_large->p_chunk != nullptr)
+			destroy_transaction(p_large->p_chunk);
+
+	} else {
+		if (p_large->p_unpacked != nullptr) {
+			alloc_bytes -= p_large->p_unpacked->total_bytes;
+			free(p_large->p_unpacked);
+		}
+		done_pointer_to_block(p_large->lm_tx);
+	}
+
+	delete p_large;
+
+	p_stream = nullptr;
+
+	return ret;
+}
+
+
+/** Append all the blocks of an entity to a block-log file.
+
+	\param path			The path of the block-log file. It is created if it does not exist, otherwise the frames are appended.
+	\param entity		The name of the entity.
+	\param codec		A PERSISTED_CODEC_* to compress the blocks stored uncompressed or PERSISTED_CODEC_NONE. Compressed blocks are
+						written as they are stored.
+	\param num_blocks	Returns the number of blocks written.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+All the blocks are read with one cursor inside one read transaction and written as LogFrameHeader, entity, key and value. The "." key
+created with each entity is not a block and is not written. See "Dump and restore" in the description of Persisted.
+*/
+StatusCode Persisted::dump(pChar path, pChar entity, int codec, int64_t &num_blocks) {
+
+	num_blocks = 0;
+
+	if (codec < 0 || codec >= PERSISTED_NUM_CODECS)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	DBImap::iterator it = source_dbi.find(entity);
+
+	if (it == source_dbi.end())
+		return SERVICE_ERROR_ENTITY_NOT_FOUND;
+
+	FILE *fp = fopen(path, "ab");
+
+	if (fp == nullptr)
+		return SERVICE_ERROR_IO_ERROR;
+
+	setvbuf(fp, nullptr, _IOFBF, PERSISTED_LOG_BUFFER_BYTES);
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, MDB_RDONLY, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::dump().");
+
+		fclose(fp);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	StatusCode ret = SERVICE_ERROR_IO_ERROR;
+
+	MDB_dbi		hh = it->second;
+	MDB_cursor *cursor;
+	MDB_val		l_key, l_data;
+	int			lmdb_err;
+
+	LogFrameHeader frame;
+
+	frame.magic		 = PERSISTED_LOG_MAGIC;
+	frame.entity_len = strlen(entity);
+
+	if (hh == INVALID_MDB_DBI) {
+		if ((lmdb_err = mdb_dbi_open(lm_tx, entity, MDB_CREATE, &hh))) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::dump().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi[entity] = hh;
+	}
+
+	if ((lmdb_err = mdb_cursor_open(lm_tx, hh, &cursor))) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::dump().");
+
+		goto release_txn_and_fail;
+	}
+
+	lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_FIRST);
+
+	while (lmdb_err == 0) {
+		if ((lmdb_err = resolve_ref(lm_tx, l_data)))
+			break;
+
+		pBlock p_blx	   = (pBlock) l_data.mv_data;
+		int	   stored_size = l_data.mv_size;
+
+		if (stored_size >= (int) sizeof(StaticBlockHeader)) {
+			pChar p_packed = nullptr;
+
+			if (stored_size == p_blx->total_bytes && !is_series(p_blx, stored_size))
+				p_packed = encode_block(p_blx, codec, stored_size);
+
+			pChar p_value = p_packed == nullptr ? (pChar) p_blx : p_packed;
+
+			frame.key_len	  = l_key.mv_size;
+			frame.stored_size = stored_size;
+			frame.crc32		  = crc32(0L, (Bytef *) entity, frame.entity_len);
+			frame.crc32		  = crc32(frame.crc32, (Bytef *) l_key.mv_data, frame.key_len);
+			frame.crc32		  = crc32(frame.crc32, (Bytef *) p_value, stored_size);
+
+			bool write_ok =	   fwrite(&frame, sizeof(LogFrameHeader), 1, fp) == 1
+							&& fwrite(entity, 1, frame.entity_len, fp) == (size_t) frame.entity_len
+							&& fwrite(l_key.mv_data, 1, frame.key_len, fp) == (size_t) frame.key_len
+							&& fwrite(p_value, 1, stored_size, fp) == (size_t) stored_size;
+
+			if (p_packed != nullptr) {
+				alloc_bytes -= p_blx->total_bytes;
+				free(p_packed);
+			}
+
+			if (!write_ok)
+				break;
+
+			num_blocks++;
+		}
+		lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT);
+	}
+
+	mdb_cursor_close(cursor);
+
+	if (lmdb_err == MDB_NOTFOUND)
+		ret = SERVICE_NO_ERROR;
+	else if (lmdb_err != 0)
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_get() failed in Persisted::dump().");
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	if (fclose(fp) != 0)
+		ret = SERVICE_ERROR_IO_ERROR;
+
+	return ret;
+}
+
+
+/** Write the blocks in a block-log file (written by dump()) into their entities.
+
+	\param path			The path of the block-log file.
+	\param entity		The name of the entity to be restored or nullptr to restore all the entities in the file.
+	\param num_blocks	Returns the number of blocks written.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error).
+
+The frames are read in batches (see read_frames()), verified and decompressed by several threads (see decode_frames()) and each batch is
+written in one write transaction (see write_frames()). See "Dump and restore" in the description of Persisted.
+*/
+StatusCode Persisted::restore(pChar path, pChar entity, int64_t &num_blocks) {
+
+	num_blocks = 0;
+
+	FILE *fp = fopen(path, "rb");
+
+	if (fp == nullptr)
+		return SERVICE_ERROR_IO_ERROR;
+
+	setvbuf(fp, nullptr, _IOFBF, PERSISTED_LOG_BUFFER_BYTES);
+
+	LogFrames  frames;
+	StatusCode ret;
+
+	while ((ret = read_frames(fp, entity, frames)) == SERVICE_NO_ERROR && frames.size() > 0) {
+		if ((ret = decode_frames(frames)) == SERVICE_NO_ERROR)
+			ret = write_frames(frames);
+
+		if (ret == SERVICE_NO_ERROR)
+			num_blocks += frames.size();
+
+		free_frames(frames);
+
+		if (ret != SERVICE_NO_ERROR)
+			break;
+	}
+	free_frames(frames);
+
+	fclose(fp);
+
+	return ret;
+}
+
+
+/** \brief Locates a block doing an mdb_get() leaving the transaction open.
+
+	\param what			The location of a Block inside LMDB.
+	\param lm_tx		the transcation created by a lock_pointer_to_block() call.
+	\param p_stored_size	(Optional) returns the size of the stored value. If it is below .total_bytes, the value is compressed and
+						the block is only valid up to the ItemHeaders. (See decode_block().)
+
+	\return	The pointer to the block (can **only** be read and **requires** a done_pointer_to_block() to close the transaction) or
+			nullptr (+ log INFO) on error.
+
+NOTE: This requires a subsequent done_pointer_to_block() call.
+*/
+pBlock Persisted::lock_pointer_to_block(Locator &what, pMDB_txn &lm_tx, int *p_stored_size) {
+
+	DBImap::iterator it = source_dbi.find(what.entity);
+
+	if (it == source_dbi.end()) {
+		log(LOG_MISS, "Invalid source in Persisted::lock_pointer_to_block().");
+
+		return nullptr;
+	}
+
+	if (int lmdb_err = begin_read(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::lock_pointer_to_block().");
+
+		return nullptr;
+	}
+
+	MDB_dbi hh = it->second;
+
+	if (hh == INVALID_MDB_DBI) {
+		if (int lmdb_err = mdb_dbi_open(lm_tx, what.entity, MDB_CREATE, &hh)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::lock_pointer_to_block().");
+
+			goto release_txn_and_fail;
+		}
+		source_dbi [what.entity] = hh;
+	}
+
+	MDB_val l_key, l_data;
+
+	l_key.mv_size = strlen(what.key);
+	l_key.mv_data = &what.key[0];
+
+	if (int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data)) {
+		if (lmdb_err != MDB_NOTFOUND)
+			log_lmdb_err(LOG_MISS, lmdb_err, "mdb_get() failed in Persisted::lock_pointer_to_block() with a code other than MDB_NOTFOUND.");
+
+		goto release_txn_and_fail;
+	}
+
+	if (int lmdb_err = resolve_ref(lm_tx, l_data)) {
+		log_lmdb_err(log_error_level, lmdb_err, "resolve_ref() failed in Persisted::lock_pointer_to_block().");
+
+		goto release_txn_and_fail;
+	}
+
+	if (p_stored_size != nullptr)
+		*p_stored_size = l_data.mv_size;
+
+	return (pBlock) l_data.mv_data;
+
+release_txn_and_fail:
+
+	abort_read(lm_tx);
+
+	return nullptr;
+}
+
+
+/** \brief Completes the transaction started by lock_pointer_to_block() doing a mdb_txn_commit() which invalidates the pointer.
+
+	\param lm_tx the transcation created by a lock_pointer_to_block() call.
+*/
+void Persisted::done_pointer_to_block(pMDB_txn &lm_tx) {
+
+	if (lm_tx != snapshot_tx) {
+		if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::done_pointer_to_block().");
+
+			mdb_txn_abort(lm_tx);
+		}
+	}
+
+	lm_tx = nullptr;
+}
+
+
+/** \brief Begins the read-only transaction of a read or, inside snapshot_get(), returns the transaction of the snapshot.
+
+	\param lm_tx	Returns the transaction. It must be ended with done_pointer_to_block() or abort_read().
+
+	\return	MDB_SUCCESS or the lmdb error of mdb_txn_begin().
+*/
+int Persisted::begin_read(pMDB_txn &lm_tx) {
+
+	if (snapshot_tx != nullptr) {
+		lm_tx = snapshot_tx;
+
+		return MDB_SUCCESS;
+	}
+
+	return mdb_txn_begin(lmdb_env, NULL, MDB_RDONLY, &lm_tx);
+}
+
+
+/** \brief Aborts a transaction started by begin_read() (unless it is the transaction of a snapshot, which stays open).
+
+	\param lm_tx	The transaction.
+*/
+void Persisted::abort_read(pMDB_txn &lm_tx) {
+
+	if (lm_tx != snapshot_tx)
+		mdb_txn_abort(lm_tx);
+
+	lm_tx = nullptr;
+}
+
+
+/** \brief Parse an url as a key scan (E.g., //lmdb/entity/~from:k1~to:k2~limit:100).
+
+	\param what		Returns the base and the entity (the key is empty).
+	\param range	Returns the arguments of the scan.
+	\param p_what	The url.
+
+	\return	SERVICE_NO_ERROR if it is a valid scan, SERVICE_ERROR_PARSING_COMMAND if it is a scan with invalid arguments or
+			SERVICE_ERROR_PARSING_NAMES if it is not a scan at all (and should be parsed by as_locator()).
+
+The key part is a sequence of ~from:key, ~after:key, ~to:key, ~prefix:text, ~limit:number or ~blocks in any order. It must contain at
+least one ':' to be a scan (a key like ~blocks is just a key). Since ~ separates the arguments, keys containing ~ cannot be scanned.
+*/
+StatusCode Persisted::parse_scan(Locator &what, KeyScan &range, pChar p_what) {
+
+	if (p_what[0] != '/' || p_what[1] != '/')
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	pChar p_ent = strchr(p_what + 2, '/');
+	pChar p_key = p_ent == nullptr ? nullptr : strchr(p_ent + 1, '/');
+
+	if (p_key == nullptr || p_key[1] != '~' || strchr(p_key, ':') == nullptr)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	int len_base = p_ent - p_what - 2, len_ent = p_key - p_ent - 1;
+
+	if (len_base <= 0 || len_base >= SHORT_NAME_SIZE || len_ent <= 0 || len_ent >= NAME_SIZE)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	memcpy(what.base, p_what + 2, len_base);
+	what.base[len_base] = 0;
+
+	memcpy(what.entity, p_ent + 1, len_ent);
+	what.entity[len_ent] = 0;
+
+	what.key[0]	 = 0;
+	what.p_extra = nullptr;
+
+	range		= {};
+	range.limit = PERSISTED_SCAN_DEFAULT_LIMIT;
+
+	p_key++;
+
+	while (*p_key == '~') {
+		pChar p_arg = ++p_key;
+
+		while (*p_key != 0 && *p_key != '~' && *p_key != ':')
+			p_key++;
+
+		int len_arg = p_key - p_arg;
+
+		if (len_arg == 6 && strncmp(p_arg, "blocks", 6) == 0 && *p_key != ':') {
+			range.blocks = true;
+
+			continue;
+		}
+
+		if (*(p_key++) != ':')
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		pChar p_val = p_key;
+
+		while (*p_key != 0 && *p_key != '~')
+			p_key++;
+
+		int len_val = p_key - p_val;
+
+		if (len_val >= NAME_SIZE)
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		pChar p_dest;
+
+		if (len_arg == 4 && strncmp(p_arg, "from", 4) == 0) {
+			p_dest		= range.from;
+			range.after = false;
+		} else if (len_arg == 5 && strncmp(p_arg, "after", 5) == 0) {
+			p_dest		= range.from;
+			range.after = true;
+		} else if (len_arg == 2 && strncmp(p_arg, "to", 2) == 0)
+			p_dest = range.to;
+		else if (len_arg == 6 && strncmp(p_arg, "prefix", 6) == 0)
+			p_dest = range.prefix;
+		else if (len_arg == 5 && strncmp(p_arg, "limit", 5) == 0) {
+			char *p_end;
+
+			range.limit = strtol(p_val, &p_end, 10);
+
+			if (p_end != p_key || range.limit <= 0 || range.limit > PERSISTED_SCAN_MAX_LIMIT)
+				return SERVICE_ERROR_PARSING_COMMAND;
+
+			continue;
+		} else
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		memcpy(p_dest, p_val, len_val);
+		p_dest[len_val] = 0;
+	}
+
+	return *p_key == 0 ? SERVICE_NO_ERROR : SERVICE_ERROR_PARSING_COMMAND;
+}
+
+
+/** \brief Parse an url as a secondary index lookup (E.g., //lmdb/entity/~index:url~eq:/index.html).
+
+	\param what		Returns the base and the entity (the key is empty).
+	\param query	Returns the arguments of the lookup.
+	\param p_what	The url.
+
+	\return	SERVICE_NO_ERROR if it is a valid lookup, SERVICE_ERROR_PARSING_COMMAND if it is a lookup with invalid arguments or
+			SERVICE_ERROR_PARSING_NAMES if it is not a lookup at all.
+
+The key part starts with ~index:attribute (created, url, mimetype or a number) followed by ~eq:value or ~from:value and/or ~to:value
+and optionally ~limit:number. Values run until the next ~ or the end of the url.
+*/
+StatusCode Persisted::parse_lookup(Locator &what, IndexQuery &query, pChar p_what) {
+
+	if (p_what[0] != '/' || p_what[1] != '/')
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	pChar p_ent = strchr(p_what + 2, '/');
+	pChar p_key = p_ent == nullptr ? nullptr : strchr(p_ent + 1, '/');
+
+	if (p_key == nullptr || strncmp(p_key, "/~index:", 8) != 0)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	int len_base = p_ent - p_what - 2, len_ent = p_key - p_ent - 1;
+
+	if (len_base <= 0 || len_base >= SHORT_NAME_SIZE || len_ent <= 0 || len_ent >= NAME_SIZE)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	memcpy(what.base, p_what + 2, len_base);
+	what.base[len_base] = 0;
+
+	memcpy(what.entity, p_ent + 1, len_ent);
+	what.entity[len_ent] = 0;
+
+	what.key[0]	 = 0;
+	what.p_extra = nullptr;
+
+	query		= {};
+	query.limit = PERSISTED_SCAN_DEFAULT_LIMIT;
+
+	bool has_index = false;
+
+	p_key++;
+
+	while (*p_key == '~') {
+		pChar p_arg = ++p_key;
+
+		while (*p_key != 0 && *p_key != '~' && *p_key != ':')
+			p_key++;
+
+		int len_arg = p_key - p_arg;
+
+		if (*(p_key++) != ':')
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		pChar p_val = p_key;
+
+		while (*p_key != 0 && *p_key != '~')
+			p_key++;
+
+		int len_val = p_key - p_val;
+
+		if (len_val >= PERSISTED_INDEX_MAX_VALUE)
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		char value[PERSISTED_INDEX_MAX_VALUE];
+
+		memcpy(value, p_val, len_val);
+		value[len_val] = 0;
+
+		if (len_arg == 5 && strncmp(p_arg, "index", 5) == 0) {
+			if (!index_attribute(value, query.attribute))
+				return SERVICE_ERROR_PARSING_COMMAND;
+
+			has_index = true;
+		} else if (len_arg == 2 && strncmp(p_arg, "eq", 2) == 0) {
+			strcpy(query.low, value);
+			strcpy(query.high, value);
+		} else if (len_arg == 4 && strncmp(p_arg, "from", 4) == 0)
+			strcpy(query.low, value);
+		else if (len_arg == 2 && strncmp(p_arg, "to", 2) == 0)
+			strcpy(query.high, value);
+		else if (len_arg == 5 && strncmp(p_arg, "limit", 5) == 0) {
+			char *p_end;
+
+			query.limit = strtol(value, &p_end, 10);
+
+			if (*p_end != 0 || query.limit <= 0 || query.limit > PERSISTED_SCAN_MAX_LIMIT)
+				return SERVICE_ERROR_PARSING_COMMAND;
+		} else
+			return SERVICE_ERROR_PARSING_COMMAND;
+	}
+
+	return *p_key == 0 && has_index ? SERVICE_NO_ERROR : SERVICE_ERROR_PARSING_COMMAND;
+}
+
+
+/** \brief Convert the name of an indexed attribute (created, url, mimetype or an attribute id as a number) into its id.
+
+	\param p_name		The name.
+	\param attribute	Returns the attribute id or PERSISTED_INDEX_CREATED.
+
+	\return	True if the name is valid.
+*/
+bool Persisted::index_attribute(pChar p_name, int &attribute) {
+
+	if (strcmp(p_name, "created") == 0)
+		attribute = PERSISTED_INDEX_CREATED;
+
+	else if (strcmp(p_name, "url") == 0)
+		attribute = BLOCK_ATTRIB_URL;
+
+	else if (strcmp(p_name, "mimetype") == 0)
+		attribute = BLOCK_ATTRIB_MIMETYPE;
+
+	else {
+		char *p_end;
+
+		attribute = strtol(p_name, &p_end, 10);
+
+		return p_end != p_name && *p_end == 0 && attribute >= 0;
+	}
+
+	return true;
+}
+
+
+/** \brief The name of the LMDB database of a secondary index: entity~created or entity~<attribute id>.
+
+	\param p_dest		A buffer of at least 2*NAME_SIZE chars.
+	\param entity		The name of the entity.
+	\param attribute	The attribute id or PERSISTED_INDEX_CREATED.
+
+Since ~ is not valid in an entity name, these databases are never confused with entities by open_all_databases().
+*/
+void Persisted::index_name(pChar p_dest, pChar entity, int attribute) {
+
+	if (attribute == PERSISTED_INDEX_CREATED)
+		snprintf(p_dest, 2*NAME_SIZE, "%s~created", entity);
+	else
+		snprintf(p_dest, 2*NAME_SIZE, "%s~%d", entity, attribute);
+}
+
+
+/** \brief The value under which a block is stored in a secondary index.
+
+	\param p_block		The (uncompressed unless attribute == PERSISTED_INDEX_CREATED) block.
+	\param attribute	The attribute id or PERSISTED_INDEX_CREATED.
+	\param p_dest		A buffer of PERSISTED_INDEX_MAX_VALUE chars.
+
+	\return	The length of the value or -1 if the block does not have the attribute.
+
+The .created time is stored as 8 big endian bytes (with the sign bit flipped) of microseconds, so that LMDB's byte order is time order.
+Attribute values are stored as they are, up to PERSISTED_INDEX_MAX_VALUE - 1 bytes.
+*/
+int Persisted::index_value(pBlock p_block, int attribute, pChar p_dest) {
+
+	if (attribute == PERSISTED_INDEX_CREATED) {
+		int64_t	 micros = std::chrono::duration_cast<std::chrono::microseconds>(p_block->created.time_since_epoch()).count();
+		uint64_t u		= (uint64_t) micros ^ 0x8000000000000000ULL;
+
+		for (int i = 0; i < 8; i++)
+			p_dest[i] = u >> (56 - 8*i);
+
+		return 8;
+	}
+
+	pChar p_att = p_block->get_attribute(attribute);
+
+	if (p_att == nullptr)
+		return -1;
+
+	int len = std::min((int) strlen(p_att), PERSISTED_INDEX_MAX_VALUE - 1);
+
+	memcpy(p_dest, p_att, len);
+
+	return len;
+}
+
+
+/** \brief Convert a value in a lookup (as in IndexQuery) into the value stored in the index. (See index_value().)
+
+	\param attribute	The attribute id or PERSISTED_INDEX_CREATED.
+	\param p_value		The value as a string (microseconds for PERSISTED_INDEX_CREATED).
+	\param p_dest		A buffer of PERSISTED_INDEX_MAX_VALUE chars.
+
+	\return	The length of the value or -1 if it is not valid.
+*/
+int Persisted::query_value(int attribute, pChar p_value, pChar p_dest) {
+
+	if (attribute == PERSISTED_INDEX_CREATED) {
+		char *p_end;
+
+		int64_t micros = strtoll(p_value, &p_end, 10);
+
+		if (p_end == p_value || *p_end != 0)
+			return -1;
+
+		uint64_t u = (uint64_t) micros ^ 0x8000000000000000ULL;
+
+		for (int i = 0; i < 8; i++)
+			p_dest[i] = u >> (56 - 8*i);
+
+		return 8;
+	}
+
+	int len = std::min((int) strlen(p_value), PERSISTED_INDEX_MAX_VALUE - 1);
+
+	memcpy(p_dest, p_value, len);
+
+	return len;
+}
+
+
+/** \brief Check if an entity has any secondary index.
+
+	\param entity	The name of the entity.
+
+	\return	True if it has at least one.
+*/
+bool Persisted::has_indexes(pChar entity) {
+
+	String start = String(entity) + "~";
+
+	IndexDBImap::iterator it = index_dbi.lower_bound(start);
+
+	return it != index_dbi.end() && it->first.compare(0, start.length(), start) == 0;
+}
+
+
+/** \brief Find the values of a block in all the secondary indexes of its entity.
+
+	\param lm_tx		An open LMDB transaction (to open the index handles not yet opened).
+	\param entity		The name of the entity.
+	\param p_stored		The block as stored (possibly compressed) or a block.
+	\param stored_size	The size of the stored value (== p_stored->total_bytes if it is not compressed).
+	\param entries		Returns the (index handle, value) pairs. Indexes on attributes the block does not have are skipped.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_NO_MEM, SERVICE_ERROR_CORRUPTED or SERVICE_ERROR_IO_ERROR.
+
+The values are copied, so they remain valid after the transaction modifies the database.
+*/
+StatusCode Persisted::index_entries(pMDB_txn lm_tx, pChar entity, pBlock p_stored, int stored_size, IndexEntries &entries) {
+
+	entries.clear();
+
+	String start = String(entity) + "~";
+	pBlock p_blk = p_stored, p_unpacked = nullptr;
+
+	char value[PERSISTED_INDEX_MAX_VALUE];
+
+	StatusCode ret = SERVICE_NO_ERROR;
+
+	for (IndexDBImap::iterator it = index_dbi.lower_bound(start); it != index_dbi.end(); ++it) {
+		if (it->first.compare(0, start.length(), start) != 0)
+			break;
+
+		int attribute;
+
+		index_attribute((pChar) it->first.c_str() + start.length(), attribute);
+
+		if (attribute != PERSISTED_INDEX_CREATED && p_unpacked == nullptr && stored_size != p_stored->total_bytes) {
+			if ((ret = unpack_block(p_stored, stored_size, p_unpacked)) != SERVICE_NO_ERROR)
+				return ret;
+
+			p_blk = p_unpacked;
+		}
+
+		int len = index_value(p_blk, attribute, value);
+
+		if (len < 0)
+			continue;
+
+		if (it->second == INVALID_MDB_DBI) {
+			if (int lmdb_err = mdb_dbi_open(lm_tx, it->first.c_str(), MDB_CREATE | MDB_DUPSORT, &it->second)) {
+				log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed in Persisted::index_entries().");
+
+				it->second = INVALID_MDB_DBI;
+				ret		   = SERVICE_ERROR_IO_ERROR;
+
+				break;
+			}
+		}
+		entries.push_back(std::make_pair(it->second, String(value, len)));
+	}
+
+	if (p_unpacked != nullptr) {
+		alloc_bytes -= p_unpacked->total_bytes;
+		free(p_unpacked);
+	}
+
+	return ret;
+}
+
+
+/** \brief Update the secondary indexes of an entity when a block is written or removed.
+
+	\param lm_tx	The write transaction of put() or remove() (the indexes are updated in the same transaction).
+	\param hh		The handle of the entity.
+	\param where	The locator of the block.
+	\param p_new	The new block or nullptr if the block is being removed.
+	\param new_size	The stored size of p_new (when it is a stored value) or 0 when it is a regular block.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (the caller aborts the transaction).
+
+The values of the block currently stored under the key (if any) are removed from the indexes and the values of p_new are added.
+*/
+StatusCode Persisted::update_indexes(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, pBlock p_new, int new_size) {
+
+	IndexEntries old_entries, new_entries;
+
+	MDB_val l_key, l_data, l_value;
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	StatusCode ret;
+
+	int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data);
+
+	if (lmdb_err == 0 && (lmdb_err = resolve_ref(lm_tx, l_data)) == 0) {
+		if ((ret = index_entries(lm_tx, where.entity, (pBlock) l_data.mv_data, l_data.mv_size, old_entries)) != SERVICE_NO_ERROR)
+			return ret;
+
+	} else if (lmdb_err != MDB_NOTFOUND) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed in Persisted::update_indexes().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	if (p_new != nullptr) {
+		if ((ret = index_entries(lm_tx, where.entity, p_new, new_size > 0 ? new_size : p_new->total_bytes, new_entries)) != SERVICE_NO_ERROR)
+			return ret;
+	}
+
+	for (IndexEntries::iterator it = old_entries.begin(); it != old_entries.end(); ++it) {
+		l_value.mv_size = it->second.length();
+		l_value.mv_data = (pChar) it->second.data();
+
+		if ((lmdb_err = mdb_del(lm_tx, it->first, &l_value, &l_key)) && lmdb_err != MDB_NOTFOUND) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_del() failed in Persisted::update_indexes().");
+
+			return SERVICE_ERROR_IO_ERROR;
+		}
+	}
+
+	for (IndexEntries::iterator it = new_entries.begin(); it != new_entries.end(); ++it) {
+		l_value.mv_size = it->second.length();
+		l_value.mv_data = (pChar) it->second.data();
+
+		if ((lmdb_err = mdb_put(lm_tx, it->first, &l_value, &l_key, MDB_NODUPDATA)) && lmdb_err != MDB_KEYEXIST) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed in Persisted::update_indexes().");
+
+			return SERVICE_ERROR_IO_ERROR;
+		}
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Parse an url as a block-log dump or restore (E.g., //lmdb/entity/~dump:entity.log).
+
+	\param what			Returns the base and the entity (the key is empty).
+	\param p_what		The url.
+	\param codec		Returns the codec of a dump (PERSISTED_CODEC_NONE unless it starts with ~codec:name).
+	\param p_path		Returns a pointer to the path (inside p_what).
+	\param is_restore	Returns true for a restore.
+
+	\return	SERVICE_NO_ERROR if it is a valid dump or restore, SERVICE_ERROR_PARSING_COMMAND if it is one with invalid arguments or
+			SERVICE_ERROR_PARSING_NAMES if it is not a dump or restore at all.
+
+The key part is ~dump:path, ~codec:name~dump:path or ~restore:path. The path runs until the end of the url.
+*/
+StatusCode Persisted::parse_log(Locator &what, pChar p_what, int &codec, pChar &p_path, bool &is_restore) {
+
+	if (p_what[0] != '/' || p_what[1] != '/')
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	pChar p_ent = strchr(p_what + 2, '/');
+	pChar p_key = p_ent == nullptr ? nullptr : strchr(p_ent + 1, '/');
+
+	if (	p_key == nullptr
+		|| (strncmp(p_key, "/~dump:", 7) != 0 && strncmp(p_key, "/~codec:", 8) != 0 && strncmp(p_key, "/~restore:", 10) != 0))
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	int len_base = p_ent - p_what - 2, len_ent = p_key - p_ent - 1;
+
+	if (len_base <= 0 || len_base >= SHORT_NAME_SIZE || len_ent <= 0 || len_ent >= NAME_SIZE)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	memcpy(what.base, p_what + 2, len_base);
+	what.base[len_base] = 0;
+
+	memcpy(what.entity, p_ent + 1, len_ent);
+	what.entity[len_ent] = 0;
+
+	what.key[0]	 = 0;
+	what.p_extra = nullptr;
+
+	codec	   = PERSISTED_CODEC_NONE;
+	is_restore = strncmp(p_key, "/~restore:", 10) == 0;
+
+	if (is_restore)
+		p_path = p_key + 10;
+	else {
+		pChar p_arg = p_key + 1;
+
+		if (strncmp(p_arg, "~codec:", 7) == 0) {
+			pChar p_name = p_arg + 7;
+
+			if ((p_arg = strchr(p_name, '~')) == nullptr || (codec = codec_by_name(String(p_name, p_arg - p_name))) < 0)
+				return SERVICE_ERROR_PARSING_COMMAND;
+		}
+		if (strncmp(p_arg, "~dump:", 6) != 0)
+			return SERVICE_ERROR_PARSING_COMMAND;
+
+		p_path = p_arg + 6;
+	}
+
+	return *p_path == 0 ? SERVICE_ERROR_PARSING_COMMAND : SERVICE_NO_ERROR;
+}
+
+
+/** \brief Resolve the path of a dump or restore requested via get() inside the configured MDB_LOG_PATH.
+
+	\param p_path		The path as parsed by parse_log().
+	\param is_restore	True for a restore (reading the file), false for a dump (appending to it).
+	\param path			Returns the path to the file inside MDB_LOG_PATH.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_BASE_FORBIDDEN if MDB_LOG_PATH is not set or ENABLE_FILE_LEVEL does not allow it
+			or SERVICE_ERROR_PARSING_COMMAND if the path is absolute or contains "..".
+
+Dumps and restores via the API are disabled unless MDB_LOG_PATH is set. They follow the same ENABLE_FILE_LEVEL as the //file base of
+Channels: a restore requires 1 (read), a dump 2 (but it cannot append to an existing file) or 3. The command line dump and restore
+(see jazz_main) are not restricted.
+*/
+StatusCode Persisted::log_path(pChar p_path, bool is_restore, String &path) {
+
+	String log_dir;
+	int	   file_lev;
+
+	if (!get_conf_key("MDB_LOG_PATH", log_dir) || log_dir.empty() || !get_conf_key("ENABLE_FILE_LEVEL", file_lev))
+		return SERVICE_ERROR_BASE_FORBIDDEN;
+
+	if (p_path[0] == '/' || strstr(p_path, "..") != nullptr)
+		return SERVICE_ERROR_PARSING_COMMAND;
+
+	path = log_dir;
+
+	if (path.back() != '/')
+		path.push_back('/');
+
+	path += p_path;
+
+	if (is_restore)
+		return file_lev < 1 ? SERVICE_ERROR_BASE_FORBIDDEN : SERVICE_NO_ERROR;
+
+	if (file_lev < 2)
+		return SERVICE_ERROR_BASE_FORBIDDEN;
+
+	struct stat st;
+
+	if (file_lev == 2 && stat(path.c_str(), &st) == 0)
+		return SERVICE_ERROR_BASE_FORBIDDEN;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Read the next batch of frames from a block-log file.
+
+	\param fp		The file.
+	\param entity	Only the frames of this entity are returned (the others are skipped) or nullptr for all of them.
+	\param frames	Returns the frames with their values allocated (see free_frames()). Empty at the end of the file.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_CORRUPTED, SERVICE_ERROR_NO_MEM or SERVICE_ERROR_IO_ERROR.
+
+A batch ends after PERSISTED_LOG_BATCH_FRAMES frames or when its blocks (decompressed) exceed PERSISTED_LOG_BATCH_BYTES. The crc32 is
+not verified here (see decode_frames()).
+*/
+StatusCode Persisted::read_frames(FILE *fp, pChar entity, LogFrames &frames) {
+
+	frames.clear();
+
+	int64_t		   batch_bytes = 0;
+	LogFrameHeader hea;
+
+	while (frames.size() < PERSISTED_LOG_BATCH_FRAMES && batch_bytes < PERSISTED_LOG_BATCH_BYTES) {
+		size_t len = fread(&hea, 1, sizeof(LogFrameHeader), fp);
+
+		if (len == 0)
+			return ferror(fp) ? SERVICE_ERROR_IO_ERROR : SERVICE_NO_ERROR;
+
+		if (   len != sizeof(LogFrameHeader) || hea.magic != PERSISTED_LOG_MAGIC || hea.entity_len <= 0 || hea.entity_len >= NAME_SIZE
+			|| hea.key_len <= 0 || hea.key_len >= NAME_SIZE || hea.stored_size < (int) sizeof(StaticBlockHeader))
+			return SERVICE_ERROR_CORRUPTED;
+
+		LogFrame frame = {};
+
+		if (   fread(frame.where.entity, 1, hea.entity_len, fp) != (size_t) hea.entity_len
+			|| fread(frame.where.key, 1, hea.key_len, fp) != (size_t) hea.key_len)
+			return SERVICE_ERROR_CORRUPTED;
+
+		frame.where.entity[hea.entity_len] = 0;
+		frame.where.key[hea.key_len]	   = 0;
+
+		if (entity != nullptr && strcmp(entity, frame.where.entity) != 0) {
+			if (fseek(fp, hea.stored_size, SEEK_CUR) != 0)
+				return SERVICE_ERROR_CORRUPTED;
+
+			continue;
+		}
+
+		strcpy(frame.where.base, "lmdb");
+
+		frame.crc32		  = hea.crc32;
+		frame.stored_size = hea.stored_size;
+
+		if ((frame.p_stored = (pBlock) malloc(hea.stored_size)) == nullptr)
+			return SERVICE_ERROR_NO_MEM;
+
+		frames.push_back(frame);
+
+		if (fread(frame.p_stored, 1, hea.stored_size, fp) != (size_t) hea.stored_size)
+			return SERVICE_ERROR_CORRUPTED;
+
+		batch_bytes += frame.p_stored->total_bytes;		// The decompressed size, the value is never larger.
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Verify the crc32 of a batch of frames and decompress the compressed values using several threads.
+
+	\param frames	The frames returned by read_frames(). Their .p_block is set to the decoded block.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_NO_MEM or SERVICE_ERROR_CORRUPTED.
+
+The buffers for the decompressed blocks are allocated first (since .alloc_bytes is not atomic), then up to PERSISTED_LOG_MAX_THREADS
+parts, run by the Pool, verify and decode a share of the frames each.
+*/
+StatusCode Persisted::decode_frames(LogFrames &frames) {
+
+	for (LogFrames::iterator it = frames.begin(); it != frames.end(); ++it) {
+		if (it->stored_size > it->p_stored->total_bytes)
+			return SERVICE_ERROR_CORRUPTED;
+
+		if (it->stored_size == it->p_stored->total_bytes)
+			it->p_block = it->p_stored;
+		else if ((it->p_block = (pBlock) malloc(it->p_stored->total_bytes)) == nullptr)
+			return SERVICE_ERROR_NO_MEM;
+	}
+
+	int num_threads = std::min(Pool::num_threads(), PERSISTED_LOG_MAX_THREADS);
+
+	num_threads = std::max(1, std::min(num_threads, (int) frames.size()));
+
+	std::atomic<bool> ok = {true};
+
+	auto decode = [this, &frames, &ok, num_threads](int first) {
+		for (size_t i = first; i < frames.size() && ok; i += num_threads) {
+			LogFrame &frame = frames[i];
+
+			uint32_t crc = crc32(0L, (Bytef *) frame.where.entity, strlen(frame.where.entity));
+
+			crc = crc32(crc, (Bytef *) frame.where.key, strlen(frame.where.key));
+			crc = crc32(crc, (Bytef *) frame.p_stored, frame.stored_size);
+
+			if (   crc != frame.crc32
+				|| (frame.p_block != frame.p_stored && !decode_block(frame.p_stored, frame.stored_size, frame.p_block)))
+				ok = false;
+		}
+	};
+
+	Pool::parallel_for(0, num_threads, decode);
+
+	return ok ? SERVICE_NO_ERROR : SERVICE_ERROR_CORRUPTED;
+}
+
+
+/** \brief Write a batch of decoded frames in one write transaction.
+
+	\param frames	The frames after decode_frames().
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error). On error, nothing in the batch is written.
+
+The entities that do not exist are created first. The blocks are stored as put() does (with the codec of the entity and updating its
+indexes), except that the manifests of series are never compressed and hash64 and .created are kept.
+*/
+StatusCode Persisted::write_frames(LogFrames &frames) {
+
+	for (LogFrames::iterator it = frames.begin(); it != frames.end(); ++it) {
+		if (source_dbi.find(it->where.entity) == source_dbi.end()) {
+			if (StatusCode ret = new_database(it->where.entity))
+				return ret;
+		}
+	}
+
+	pMDB_txn lm_tx;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::write_frames().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	for (LogFrames::iterator it = frames.begin(); it != frames.end(); ++it) {
+		MDB_dbi hh = source_dbi[it->where.entity];
+
+		if (hh == INVALID_MDB_DBI) {
+			if (int lmdb_err = mdb_dbi_open(lm_tx, it->where.entity, MDB_CREATE, &hh)) {
+				log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed in Persisted::write_frames().");
+
+				goto release_txn_and_fail;
+			}
+			source_dbi[it->where.entity] = hh;
+		}
+
+		int codec = is_series(it->p_block, it->p_block->total_bytes) ? PERSISTED_CODEC_NONE : compression(it->where.entity);
+
+		if (   remove_segments(lm_tx, hh, it->where) != SERVICE_NO_ERROR
+			|| store_block(lm_tx, hh, it->where, it->p_block, codec) != SERVICE_NO_ERROR)
+			goto release_txn_and_fail;
+	}
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::write_frames().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	return SERVICE_NO_ERROR;
+
+release_txn_and_fail:
+
+	mdb_txn_abort(lm_tx);
+
+	return SERVICE_ERROR_WRITE_FAILED;
+}
+
+
+/** \brief Free the values (and the decompressed blocks) of a batch of frames.
+
+	\param frames	The frames returned by read_frames(). It is empty after the call.
+*/
+void Persisted::free_frames(LogFrames &frames) {
+
+	for (LogFrames::iterator it = frames.begin(); it != frames.end(); ++it) {
+		if (it->p_block != nullptr && it->p_block != it->p_stored) {
+			alloc_bytes -= it->p_stored->total_bytes;
+			free(it->p_block);
+		}
+		alloc_bytes -= it->stored_size;
+		free(it->p_stored);
+	}
+	frames.clear();
+}
+
+
+/** \brief Set if an entity is deduplicated from the configuration key MDB_DEDUP_<entity> (if that key exists).
+
+	\param entity	The name of the entity.
+
+	\return	False (and log(LOG_MISS)) if the key exists, but is not 0 or 1 or PERSISTED_DEDUP_DBI cannot be created.
+
+NOTE: This does not lock the Container. It is called by start() and by new_database() which already holds the lock.
+*/
+bool Persisted::load_dedup(pChar entity) {
+
+	String key("MDB_DEDUP_");
+	int	   dedup;
+
+	key += entity;
+
+	dedup_entity.erase(entity);
+
+	if (!get_conf_key(key.c_str(), dedup))
+		return true;
+
+	if ((dedup & 0xfffffffe) != 0) {
+		log_printf(LOG_MISS, "Persisted: invalid %s ignored.", key.c_str());
+
+		return false;
+	}
+
+	if (dedup == 0)
+		return true;
+
+	if (open_dedup(true) != SERVICE_NO_ERROR) {
+		log_printf(LOG_MISS, "Persisted: %s ignored, the database %s could not be created.", key.c_str(), PERSISTED_DEDUP_DBI);
+
+		return false;
+	}
+
+	dedup_entity.insert(entity);
+
+	return true;
+}
+
+
+/** \brief Open the database PERSISTED_DEDUP_DBI in its own transaction.
+
+	\param create	Create the database if it does not exist.
+
+	\return	SERVICE_NO_ERROR on success (also when !create and it does not exist, leaving .dedup_dbi invalid) or SERVICE_ERROR_IO_ERROR.
+*/
+StatusCode Persisted::open_dedup(bool create) {
+
+	if (dedup_dbi != INVALID_MDB_DBI)
+		return SERVICE_NO_ERROR;
+
+	pMDB_txn lm_tx;
+	MDB_dbi	 hh;
+
+	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, create ? 0 : MDB_RDONLY, &lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::open_dedup().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	if (int lmdb_err = mdb_dbi_open(lm_tx, PERSISTED_DEDUP_DBI, create ? MDB_CREATE : 0, &hh)) {
+		mdb_txn_abort(lm_tx);
+
+		if (lmdb_err == MDB_NOTFOUND && !create)
+			return SERVICE_NO_ERROR;
+
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed in Persisted::open_dedup().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::open_dedup().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	dedup_dbi = hh;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief If a stored value is a DedupRef, replace it by the body it references.
+
+	\param lm_tx	The transaction in which the value was read.
+	\param l_data	The value. Returns the body (as stored, possibly compressed) if it was a reference, else it is unchanged.
+
+	\return	0 on success or an lmdb error code (MDB_CORRUPTED if the body does not exist).
+*/
+int Persisted::resolve_ref(pMDB_txn lm_tx, MDB_val &l_data) {
+
+	if (!is_ref(l_data))
+		return 0;
+
+	if (dedup_dbi == INVALID_MDB_DBI)
+		return MDB_CORRUPTED;
+
+	pDedupRef p_ref = (pDedupRef) l_data.mv_data;
+	DedupKey  key	= {p_ref->hash64, p_ref->total_bytes, PERSISTED_DEDUP_BODY};
+	MDB_val	  l_key;
+
+	l_key.mv_size = sizeof(DedupKey);
+	l_key.mv_data = &key;
+
+	int lmdb_err = mdb_get(lm_tx, dedup_dbi, &l_key, &l_data);
+
+	return lmdb_err == MDB_NOTFOUND ? MDB_CORRUPTED : lmdb_err;
+}
+
+
+/** \brief Find the stored body of a block in PERSISTED_DEDUP_DBI and check it is the same block.
+
+	\param lm_tx	The write transaction.
+	\param p_block	The (closed) block.
+	\param l_body	Returns the stored body (valid until the transaction writes).
+
+	\return	SERVICE_NO_ERROR if found, SERVICE_ERROR_BLOCK_NOT_FOUND, SERVICE_ERROR_WRITE_FORBIDDEN if a different block is stored with
+			the same hash64 or some other negative value (error).
+
+Everything but .created is compared: the header fields and (after decompressing the body if necessary) the rest of the block. The
+.created of the stored body is the one the new reference will be read with (see store_block()).
+*/
+StatusCode Persisted::find_body(pMDB_txn lm_tx, pBlock p_block, MDB_val &l_body) {
+
+	if (dedup_dbi == INVALID_MDB_DBI)
+		return SERVICE_ERROR_IO_ERROR;
+
+	DedupKey key = {p_block->hash64, p_block->total_bytes, PERSISTED_DEDUP_BODY};
+	MDB_val	 l_key;
+
+	l_key.mv_size = sizeof(DedupKey);
+	l_key.mv_data = &key;
+
+	if (int lmdb_err = mdb_get(lm_tx, dedup_dbi, &l_key, &l_body)) {
+		if (lmdb_err == MDB_NOTFOUND)
+			return SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed in Persisted::find_body().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	pBlock p_body = (pBlock) l_body.mv_data;
+
+	if (   p_body->cell_type != p_block->cell_type || p_body->size != p_block->size || p_body->rank != p_block->rank
+		|| p_body->num_attributes != p_block->num_attributes || p_body->has_NA != p_block->has_NA
+		|| memcmp(&p_body->range, &p_block->range, sizeof(TensorDim)) != 0)
+		return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+	int head_size = (pChar) &p_block->tensor - (pChar) p_block;
+
+	if ((int) l_body.mv_size == p_body->total_bytes)
+		return memcmp(&p_body->tensor, &p_block->tensor, p_block->total_bytes - head_size) == 0 ? SERVICE_NO_ERROR
+																								: SERVICE_ERROR_WRITE_FORBIDDEN;
+	pBlock p_unpacked;
+
+	if (unpack_block(p_body, l_body.mv_size, p_unpacked) != SERVICE_NO_ERROR)
+		return SERVICE_ERROR_CORRUPTED;
+
+	bool same = memcmp(&p_unpacked->tensor, &p_block->tensor, p_block->total_bytes - head_size) == 0;
+
+	alloc_bytes -= p_unpacked->total_bytes;
+	free(p_unpacked);
+
+	return same ? SERVICE_NO_ERROR : SERVICE_ERROR_WRITE_FORBIDDEN;
+}
+
+
+/** \brief Add a reference to a body in PERSISTED_DEDUP_DBI inside a write transaction.
+
+	\param lm_tx		The write transaction.
+	\param ref			The reference.
+	\param p_body		The body as stored (possibly compressed) if it is new or nullptr if find_body() found it.
+	\param stored_size	The size of p_body.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (the caller aborts the transaction).
+*/
+StatusCode Persisted::add_ref(pMDB_txn lm_tx, DedupRef &ref, pChar p_body, int stored_size) {
+
+	DedupKey   key	 = {ref.hash64, ref.total_bytes, PERSISTED_DEDUP_BODY};
+	DedupCount count = {1, stored_size};
+	MDB_val	   l_key, l_data;
+
+	l_key.mv_size = sizeof(DedupKey);
+	l_key.mv_data = &key;
+
+	if (p_body != nullptr) {
+		l_data.mv_size = stored_size;
+		l_data.mv_data = p_body;
+
+		if (int lmdb_err = mdb_put(lm_tx, dedup_dbi, &l_key, &l_data, 0)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed on a body in Persisted::add_ref().");
+
+			return SERVICE_ERROR_WRITE_FAILED;
+		}
+		key.what = PERSISTED_DEDUP_COUNT;
+
+	} else {
+		key.what = PERSISTED_DEDUP_COUNT;
+
+		if (int lmdb_err = mdb_get(lm_tx, dedup_dbi, &l_key, &l_data)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed on a count in Persisted::add_ref().");
+
+			return SERVICE_ERROR_CORRUPTED;
+		}
+		count = *(pDedupCount) l_data.mv_data;
+
+		count.refs++;
+	}
+
+	l_data.mv_size = sizeof(DedupCount);
+	l_data.mv_data = &count;
+
+	if (int lmdb_err = mdb_put(lm_tx, dedup_dbi, &l_key, &l_data, 0)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed on a count in Persisted::add_ref().");
+
+		return SERVICE_ERROR_WRITE_FAILED;
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Release a reference to a body in PERSISTED_DEDUP_DBI inside a write transaction, deleting the body when it is the last one.
+
+	\param lm_tx	The write transaction.
+	\param ref		The reference (a copy, not a pointer into the database).
+
+	\return	SERVICE_NO_ERROR on success or some negative value (the caller aborts the transaction).
+*/
+StatusCode Persisted::release_ref(pMDB_txn lm_tx, DedupRef &ref) {
+
+	DedupKey key = {ref.hash64, ref.total_bytes, PERSISTED_DEDUP_COUNT};
+	MDB_val	 l_key, l_data;
+
+	l_key.mv_size = sizeof(DedupKey);
+	l_key.mv_data = &key;
+
+	if (int lmdb_err = mdb_get(lm_tx, dedup_dbi, &l_key, &l_data)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed on a count in Persisted::release_ref().");
+
+		return SERVICE_ERROR_CORRUPTED;
+	}
+
+	DedupCount count = *(pDedupCount) l_data.mv_data;
+
+	if (--count.refs > 0) {
+		l_data.mv_size = sizeof(DedupCount);
+		l_data.mv_data = &count;
+
+		if (int lmdb_err = mdb_put(lm_tx, dedup_dbi, &l_key, &l_data, 0)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed on a count in Persisted::release_ref().");
+
+			return SERVICE_ERROR_WRITE_FAILED;
+		}
+		return SERVICE_NO_ERROR;
+	}
+
+	for (int what = PERSISTED_DEDUP_BODY; what <= PERSISTED_DEDUP_COUNT; what++) {
+		key.what = what;
+
+		if (int lmdb_err = mdb_del(lm_tx, dedup_dbi, &l_key, NULL)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_del() failed in Persisted::release_ref().");
+
+			return SERVICE_ERROR_REMOVE_FAILED;
+		}
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Release all the references stored in an entity inside the write transaction that drops it.
+
+	\param lm_tx	The write transaction.
+	\param hh		The handle of the entity.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (the caller aborts the transaction).
+*/
+StatusCode Persisted::release_refs(pMDB_txn lm_tx, MDB_dbi hh) {
+
+	MDB_cursor *cursor;
+	MDB_val		l_key, l_data;
+
+	if (int lmdb_err = mdb_cursor_open(lm_tx, hh, &cursor)) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_open() failed in Persisted::release_refs().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	StatusCode ret = SERVICE_NO_ERROR;
+	int		   lmdb_err;
+
+	while (ret == SERVICE_NO_ERROR && (lmdb_err = mdb_cursor_get(cursor, &l_key, &l_data, MDB_NEXT)) == 0) {
+		if (is_ref(l_data)) {
+			DedupRef ref = *(pDedupRef) l_data.mv_data;
+
+			ret = release_ref(lm_tx, ref);
+		}
+	}
+
+	mdb_cursor_close(cursor);
+
+	if (ret == SERVICE_NO_ERROR && lmdb_err != MDB_NOTFOUND) {
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_cursor_get() failed in Persisted::release_refs().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	return ret;
+}
+
+
+/** \brief Parse an url as a snapshot (E.g., //lmdb/entity/~snapshot:new or //lmdb/entity/~snapshot:17~key:k).
+
+	\param what		Returns the base and the entity (the key is empty).
+	\param p_what	The url.
+	\param id		Returns the id of the snapshot or 0 for ~snapshot:new.
+	\param url		Returns the url to be read inside the snapshot or an empty string for ~snapshot:new and ~snapshot:id~release.
+
+	\return	SERVICE_NO_ERROR if it is a valid snapshot, SERVICE_ERROR_PARSING_COMMAND if it is one with invalid arguments or
+			SERVICE_ERROR_PARSING_NAMES if it is not a snapshot at all.
+
+The key part is ~snapshot:new, ~snapshot:id~release, ~snapshot:id~key:k (reads //base/entity/k) or ~snapshot:id followed by the key
+part of a key scan or an index lookup (E.g. ~snapshot:17~from:k1~limit:100 reads //base/entity/~from:k1~limit:100).
+*/
+StatusCode Persisted::parse_snapshot(Locator &what, pChar p_what, int64_t &id, String &url) {
+
+	if (p_what[0] != '/' || p_what[1] != '/')
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	pChar p_ent = strchr(p_what + 2, '/');
+	pChar p_key = p_ent == nullptr ? nullptr : strchr(p_ent + 1, '/');
+
+	if (p_key == nullptr || strncmp(p_key, "/~snapshot:", 11) != 0)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	int len_base = p_ent - p_what - 2, len_ent = p_key - p_ent - 1;
+
+	if (len_base <= 0 || len_base >= SHORT_NAME_SIZE || len_ent <= 0 || len_ent >= NAME_SIZE)
+		return SERVICE_ERROR_PARSING_NAMES;
+
+	memcpy(what.base, p_what + 2, len_base);
+	what.base[len_base] = 0;
+
+	memcpy(what.entity, p_ent + 1, len_ent);
+	what.entity[len_ent] = 0;
+
+	what.key[0]	 = 0;
+	what.p_extra = nullptr;
+
+	url.clear();
+
+	pChar p_arg = p_key + 11;
+
+	if (strcmp(p_arg, "new") == 0) {
+		id = 0;
+
+		return SERVICE_NO_ERROR;
+	}
+
+	pChar p_end;
+
+	id = strtoll(p_arg, &p_end, 10);
+
+	if (p_end == p_arg || id <= 0)
+		return SERVICE_ERROR_PARSING_COMMAND;
+
+	if (strcmp(p_end, "~release") == 0)
+		return SERVICE_NO_ERROR;
+
+	if (strncmp(p_end, "~key:", 5) == 0 && p_end[5] != 0)
+		p_end += 5;
+
+	else if (p_end[0] != '~' || strchr(p_end, ':') == nullptr)
+		return SERVICE_ERROR_PARSING_COMMAND;
+
+	url = String(p_what, p_key + 1 - p_what) + p_end;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Mark a snapshot as busy (waiting while another thread reads it) and return its transaction.
+
+	\param id		The id of the snapshot.
+	\param lm_tx	Returns the transaction of the snapshot.
+
+	\return	SERVICE_NO_ERROR on success or SERVICE_ERROR_WRONG_ARGUMENTS if there is no such snapshot or it expired.
+
+NOTE: This requires a subsequent leave_snapshot() call.
+*/
+StatusCode Persisted::enter_snapshot(int64_t id, pMDB_txn &lm_tx) {
+
+	while (true) {
+		lock_container();
+
+		Snapshots::iterator it = snapshots.find(id);
+
+		if (it == snapshots.end() || std::chrono::steady_clock::now() >= it->second.expires) {
+			unlock_container();
+
+			expire_snapshots();
+
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+		}
+
+		if (!it->second.busy) {
+			it->second.busy = true;
+			lm_tx = it->second.lm_tx;
+
+			unlock_container();
+
+			return SERVICE_NO_ERROR;
+		}
+
+		unlock_container();
+
+		std::this_thread::yield();
+	}
+}
+
+
+/** \brief Complete the enter_snapshot() call, aborting the snapshot if it expired (or was released) meanwhile.
+
+	\param id	The id of the snapshot.
+*/
+void Persisted::leave_snapshot(int64_t id) {
+
+	pMDB_txn lm_tx = nullptr;
+
+	lock_container();
+
+	Snapshots::iterator it = snapshots.find(id);
+
+	if (it != snapshots.end()) {
+		it->second.busy = false;
+
+		if (std::chrono::steady_clock::now() >= it->second.expires) {
+			lm_tx = it->second.lm_tx;
+			snapshots.erase(it);
+		}
+	}
+
+	unlock_container();
+
+	if (lm_tx != nullptr)
+		mdb_txn_abort(lm_tx);
+}
+
+
+/** \brief Abort the transactions of the expired snapshots that are not busy.
+
+	\param all	Abort all the snapshots that are not busy (expired or not).
+
+NOTE: This locks the Container. Do not call it while holding the lock.
+*/
+void Persisted::expire_snapshots(bool all) {
+
+	if (lmdb_opt.flags & MDB_NOLOCK)
+		return;		// new_snapshot() is disabled, there are none.
+
+	std::vector<pMDB_txn> expired;
+
+	TimePoint now = std::chrono::steady_clock::now();
+
+	lock_container();
+
+	for (Snapshots::iterator it = snapshots.begin(); it != snapshots.end();) {
+		if (!it->second.busy && (all || now >= it->second.expires)) {
+			expired.push_back(it->second.lm_tx);
+			it = snapshots.erase(it);
+		} else
+			++it;
+	}
+
+	unlock_container();
+
+	for (std::vector<pMDB_txn>::iterator it = expired.begin(); it != expired.end(); ++it)
+		mdb_txn_abort(*it);
+}
+
+
+/** \brief Write a block inside a write transaction: compress it, update the secondary indexes and mdb_put() it.
+
+	\param lm_tx	The write transaction.
+	\param hh		The handle of the entity.
+	\param where	The locator of the block.
+	\param p_block	The (closed) block.
+	\param codec	The PERSISTED_CODEC_* to store it with.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (the caller aborts the transaction).
+
+In an entity with dedup (see set_dedup()), the block is stored as a DedupRef to a body that is written only if it is not already stored.
+The reference previously stored under the key (if any) is released after writing the new one. A DedupRef does not keep the .created of
+the block: when the body is found, every read of the key (and the ~index:created of the entity) sees the .created of the block that
+first stored the body. This is the time since when that content exists in the database, not the time of this put().
+*/
+StatusCode Persisted::store_block(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, pBlock p_block, int codec) {
+
+	MDB_val	 l_key, l_data, l_body;
+	DedupRef old_ref, new_ref;
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	bool has_old_ref = false;
+
+	if (dedup_dbi != INVALID_MDB_DBI) {
+		int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data);
+
+		if (lmdb_err == 0 && is_ref(l_data)) {
+			old_ref		= *(pDedupRef) l_data.mv_data;
+			has_old_ref = true;
+
+		} else if (lmdb_err != 0 && lmdb_err != MDB_NOTFOUND) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed in Persisted::store_block().");
+
+			return SERVICE_ERROR_IO_ERROR;
+		}
+	}
+
+	bool	   dedup = p_block->total_bytes >= PERSISTED_DEDUP_MIN_BYTES && !is_series(p_block, p_block->total_bytes) && is_dedup(where.entity);
+	StatusCode found = SERVICE_ERROR_BLOCK_NOT_FOUND;
+
+	if (dedup) {
+		found = find_body(lm_tx, p_block, l_body);
+
+		if (found == SERVICE_ERROR_WRITE_FORBIDDEN)		// Same hash64, different block: stored as it is.
+			dedup = false;
+		else if (found != SERVICE_NO_ERROR && found != SERVICE_ERROR_BLOCK_NOT_FOUND)
+			return found;
+	}
+
+	StatusCode ret = SERVICE_NO_ERROR;
+
+	if (has_indexes(where.entity)) {
+		if (found == SERVICE_NO_ERROR)
+			ret = update_indexes(lm_tx, hh, where, (pBlock) l_body.mv_data, l_body.mv_size);
+		else
+			ret = update_indexes(lm_tx, hh, where, p_block);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+	}
+
+	int	  stored_size = p_block->total_bytes;
+	pChar p_packed	  = found == SERVICE_NO_ERROR ? nullptr : encode_block(p_block, codec, stored_size);
+
+	l_data.mv_size = stored_size;
+	l_data.mv_data = p_packed == nullptr ? (pChar) p_block : p_packed;
+
+	if (dedup) {
+		new_ref.magic		= PERSISTED_DEDUP_MAGIC;
+		new_ref.total_bytes = p_block->total_bytes;
+		new_ref.hash64		= p_block->hash64;
+
+		ret = add_ref(lm_tx, new_ref, found == SERVICE_NO_ERROR ? nullptr : (pChar) l_data.mv_data, stored_size);
+
+		l_data.mv_size = sizeof(DedupRef);
+		l_data.mv_data = &new_ref;
+	}
+
+	if (ret == SERVICE_NO_ERROR) {
+		if (int lmdb_err = mdb_put(lm_tx, hh, &l_key, &l_data, 0)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed in Persisted::store_block().");
+
+			ret = SERVICE_ERROR_WRITE_FAILED;
+		}
+	}
+
+	if (ret == SERVICE_NO_ERROR && has_old_ref)
+		ret = release_ref(lm_tx, old_ref);
+
+	if (p_packed != nullptr) {
+		alloc_bytes -= p_block->total_bytes;
+		free(p_packed);
+	}
+
+	return ret;
+}
+
+
+/** \brief Delete a block inside a write transaction updating the secondary indexes.
+
+	\param lm_tx	The write transaction.
+	\param hh		The handle of the entity.
+	\param where	The locator of the block.
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_BLOCK_NOT_FOUND or SERVICE_ERROR_REMOVE_FAILED.
+
+If the key holds a DedupRef, the reference is released in the same transaction.
+*/
+StatusCode Persisted::delete_block(pMDB_txn lm_tx, MDB_dbi hh, Locator &where) {
+
+	MDB_val	 l_key, l_data;
+	DedupRef old_ref;
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	bool has_old_ref = false;
+
+	if (dedup_dbi != INVALID_MDB_DBI && mdb_get(lm_tx, hh, &l_key, &l_data) == 0 && is_ref(l_data)) {
+		old_ref		= *(pDedupRef) l_data.mv_data;
+		has_old_ref = true;
+	}
+
+	if (has_indexes(where.entity) && update_indexes(lm_tx, hh, where, nullptr) != SERVICE_NO_ERROR)
+		return SERVICE_ERROR_REMOVE_FAILED;
+
+	if (int lmdb_err = mdb_del(lm_tx, hh, &l_key, NULL)) {
+		if (lmdb_err != MDB_NOTFOUND)
+			log_lmdb_err(LOG_MISS, lmdb_err, "mdb_del() failed in Persisted::delete_block().");
+
+		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+	}
+
+	if (has_old_ref && release_ref(lm_tx, old_ref) != SERVICE_NO_ERROR)
+		return SERVICE_ERROR_REMOVE_FAILED;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Read a block inside an open transaction, decompressing it if necessary.
+
+	\param lm_tx		The transaction.
+	\param hh			The handle of the entity.
+	\param what			The locator of the block.
+	\param p_unpacked	Returns nullptr or a decompressed copy that the caller must free() (decreasing .alloc_bytes by its .total_bytes).
+
+	\return	The block (valid until the transaction writes or ends, or p_unpacked) or nullptr if not found or corrupted.
+*/
+pBlock Persisted::block_in_txn(pMDB_txn lm_tx, MDB_dbi hh, Locator &what, pBlock &p_unpacked) {
+
+	MDB_val l_key, l_data;
+
+	p_unpacked = nullptr;
+
+	l_key.mv_size = strlen(what.key);
+	l_key.mv_data = &what.key[0];
+
+	if (int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data)) {
+		if (lmdb_err != MDB_NOTFOUND)
+			log_lmdb_err(LOG_MISS, lmdb_err, "mdb_get() failed in Persisted::block_in_txn().");
+
+		return nullptr;
+	}
+
+	if (int lmdb_err = resolve_ref(lm_tx, l_data)) {
+		log_lmdb_err(log_error_level, lmdb_err, "resolve_ref() failed in Persisted::block_in_txn().");
+
+		return nullptr;
+	}
+
+	pBlock p_blx = (pBlock) l_data.mv_data;
+
+	if ((int) l_data.mv_size == p_blx->total_bytes)
+		return p_blx;
+
+	if (unpack_block(p_blx, l_data.mv_size, p_unpacked) != SERVICE_NO_ERROR)
+		return nullptr;
+
+	return p_unpacked;
+}
+
+
+/** \brief Check if a stored value is the manifest of a segmented series.
+
+	\param p_block		The value.
+	\param stored_size	The size of the value. (Manifests are never compressed.)
+
+	\return	True if it is a manifest.
+*/
+bool Persisted::is_series(pBlock p_block, int stored_size) {
+
+	if (   stored_size < (int) sizeof(StaticBlockHeader) || p_block->cell_type != CELL_TYPE_LONG_INTEGER || p_block->rank != 1
+		|| p_block->num_attributes != 1 || stored_size != p_block->total_bytes)
+		return false;
+
+	pChar p_att = p_block->get_attribute(BLOCK_ATTRIB_BLOCKTYPE);
+
+	return p_att != nullptr && strcmp(p_att, PERSISTED_SERIES_BLOCKTYPE) == 0;
+}
+
+
+/** \brief The locator of a segment of a series: the same base and entity and the key key~id.
+
+	\param segment	Returns the locator of the segment.
+	\param series	The locator of the series.
+	\param id		The id of the segment.
+*/
+void Persisted::segment_locator(Locator &segment, Locator &series, int64_t id) {
+
+	strcpy(segment.base, series.base);
+	strcpy(segment.entity, series.entity);
+	snprintf(segment.key, NAME_SIZE, "%s~%lld", series.key, (long long) id);
+
+	segment.p_extra = nullptr;
+}
+
+
+/** \brief Copy the head and the segments of a manifest.
+
+	\param p_manifest	The manifest. (See is_series().)
+	\param head			Returns the head.
+	\param segments		Returns the segments.
+
+	\return	False if the manifest is corrupted.
+*/
+bool Persisted::read_manifest(pBlock p_manifest, SeriesHead &head, SeriesSegments &segments) {
+
+	int64_t bytes = (int64_t) p_manifest->size*sizeof(int64_t);
+
+	if (bytes < (int64_t) sizeof(SeriesHead))
+		return false;
+
+	pSeriesHead p_head = (pSeriesHead) &p_manifest->tensor.cell_longint[0];
+
+	if (p_head->num_segments < 0 || sizeof(SeriesHead) + p_head->num_segments*sizeof(SeriesSegment) > (uint64_t) bytes)
+		return false;
+
+	head = *p_head;
+
+	pSeriesSegment p_seg = (pSeriesSegment) &p_head[1];
+
+	segments.assign(p_seg, p_seg + head.num_segments);
+
+	return true;
+}
+
+
+/** \brief Write the manifest of a series inside a write transaction.
+
+	\param lm_tx	The write transaction.
+	\param hh		The handle of the entity.
+	\param where	The locator of the series.
+	\param head		The head (.num_segments is set here).
+	\param segments	The segments.
+
+	\return	SERVICE_NO_ERROR on success or some negative value.
+*/
+StatusCode Persisted::write_manifest(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, SeriesSegments &segments) {
+
+	head.num_segments = segments.size();
+
+	int dim[MAX_TENSOR_RANK] = {(int) ((sizeof(SeriesHead) + segments.size()*sizeof(SeriesSegment))/sizeof(int64_t)), 0, 0, 0, 0, 0};
+
+	AttributeMap att;
+	pTransaction p_manifest;
+
+	att[BLOCK_ATTRIB_BLOCKTYPE] = PERSISTED_SERIES_BLOCKTYPE;
+
+	StatusCode ret = new_block(p_manifest, CELL_TYPE_LONG_INTEGER, dim, FILL_NEW_DONT_FILL, 0, nullptr, '\n', &att);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	pSeriesHead p_head = (pSeriesHead) &p_manifest->p_block->tensor.cell_longint[0];
+
+	*p_head = head;
+
+	if (segments.size() > 0)
+		memcpy(&p_head[1], segments.data(), segments.size()*sizeof(SeriesSegment));
+
+	p_manifest->p_block->close_block();
+
+	ret = store_block(lm_tx, hh, where, p_manifest->p_block, PERSISTED_CODEC_NONE);
+
+	destroy_transaction(p_manifest);
+
+	return ret;
+}
+
+
+/** \brief Store some rows of a tensor as a new segment of a series inside a write transaction.
+
+	\param lm_tx		The write transaction.
+	\param hh			The handle of the entity.
+	\param where		The locator of the series.
+	\param head			The head of the series (.next_segment and the rows in .dim[0] are updated).
+	\param p_rows		The tensor with the rows.
+	\param first_row	The first row of p_rows in the segment.
+	\param rows			The number of rows.
+	\param segment		Returns the new segment (to be added to the manifest).
+
+	\return	SERVICE_NO_ERROR on success or some negative value.
+*/
+StatusCode Persisted::new_segment(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, pBlock p_rows, int64_t first_row,
+								  int64_t rows, SeriesSegment &segment) {
+
+	int dim[MAX_TENSOR_RANK];
+
+	for (int i = 0; i < MAX_TENSOR_RANK; i++)
+		dim[i] = head.dim[i];
+
+	dim[0] = rows;
+
+	pTransaction p_segment;
+
+	StatusCode ret = new_block(p_segment, head.cell_type, dim, FILL_NEW_DONT_FILL);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	int row_bytes = (p_rows->cell_type & 0xff)*p_rows->range.dim[0];
+
+	memcpy(&p_segment->p_block->tensor, (pChar) &p_rows->tensor + first_row*row_bytes, rows*row_bytes);
+
+	p_segment->p_block->close_block();
+
+	segment.id		  = head.next_segment++;
+	segment.first_row = head.dim[0];
+	segment.rows	  = rows;
+
+	Locator loc;
+
+	segment_locator(loc, where, segment.id);
+
+	ret = store_block(lm_tx, hh, loc, p_segment->p_block, compression(where.entity));
+
+	destroy_transaction(p_segment);
+
+	head.dim[0] += rows;
+
+	return ret;
+}
+
+
+/** \brief Merge the runs of consecutive small segments of a series inside a write transaction.
+
+	\param lm_tx		The write transaction.
+	\param hh			The handle of the entity.
+	\param where		The locator of the series.
+	\param head			The head of the series (.next_segment is updated).
+	\param segments		The segments (updated on success).
+	\param max_small	Do nothing unless the series has more than this number of segments with less than .segment_rows rows.
+
+	\return	SERVICE_NO_ERROR on success or some negative value.
+
+A run of consecutive segments below .segment_rows is merged into one segment as long as the result does not exceed .segment_rows.
+*/
+StatusCode Persisted::compact_series(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, SeriesSegments &segments,
+									 int max_small) {
+
+	int num_small = 0;
+
+	for (size_t i = 0; i < segments.size(); i++)
+		if (segments[i].rows < head.segment_rows)
+			num_small++;
+
+	if (num_small <= max_small)
+		return SERVICE_NO_ERROR;
+
+	int dim[MAX_TENSOR_RANK];
+
+	for (int i = 0; i < MAX_TENSOR_RANK; i++)
+		dim[i] = head.dim[i];
+
+	int64_t row_cells = 1;
+
+	for (int i = 1; i < MAX_TENSOR_RANK && head.dim[i] > 0; i++)
+		row_cells *= head.dim[i];
+
+	int64_t row_bytes = (head.cell_type & 0xff)*row_cells;
+
+	SeriesSegments merged;
+	Locator		   loc;
+	StatusCode	   ret;
+
+	size_t i = 0;
+
+	while (i < segments.size()) {
+		size_t	j	 = i;
+		int64_t rows = 0;
+
+		while (j < segments.size() && segments[j].rows < head.segment_rows && rows + segments[j].rows <= head.segment_rows)
+			rows += segments[j++].rows;
+
+		if (j - i < 2) {
+			merged.push_back(segments[i++]);
+
+			continue;
+		}
+
+		pTransaction p_segment;
+
+		dim[0] = rows;
+
+		if ((ret = new_block(p_segment, head.cell_type, dim, FILL_NEW_DONT_FILL)) != SERVICE_NO_ERROR)
+			return ret;
+
+		pChar p_dest = (pChar) &p_segment->p_block->tensor;
+
+		for (size_t k = i; k < j; k++) {
+			pBlock p_unpacked;
+
+			segment_locator(loc, where, segments[k].id);
+
+			pBlock p_blx = block_in_txn(lm_tx, hh, loc, p_unpacked);
+
+			bool ok = p_blx != nullptr && p_blx->size == segments[k].rows*row_cells && p_blx->check_hash();
+
+			if (ok)
+				memcpy(p_dest, &p_blx->tensor, segments[k].rows*row_bytes);
+
+			if (p_unpacked != nullptr) {
+				alloc_bytes -= p_unpacked->total_bytes;
+				free(p_unpacked);
+			}
+
+			if (!ok) {
+				log_printf(log_error_level, "Persisted::compact_series(): Corrupted segment //%s/%s/%s", loc.base, loc.entity, loc.key);
+
+				destroy_transaction(p_segment);
+
+				return SERVICE_ERROR_CORRUPTED;
+			}
+			p_dest += segments[k].rows*row_bytes;
+		}
+
+		for (size_t k = i; k < j; k++) {
+			segment_locator(loc, where, segments[k].id);
+
+			if ((ret = delete_block(lm_tx, hh, loc)) != SERVICE_NO_ERROR) {
+				destroy_transaction(p_segment);
+
+				return ret;
+			}
+		}
+
+		SeriesSegment segment = {head.next_segment++, segments[i].first_row, rows};
+
+		p_segment->p_block->close_block();
+
+		segment_locator(loc, where, segment.id);
+
+		ret = store_block(lm_tx, hh, loc, p_segment->p_block, compression(where.entity));
+
+		destroy_transaction(p_segment);
+
+		if (ret != SERVICE_NO_ERROR)
+			return ret;
+
+		merged.push_back(segment);
+
+		i = j;
+	}
+
+	segments = merged;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief If a key holds the manifest of a series, delete all its segments inside a write transaction.
+
+	\param lm_tx	The write transaction.
+	\param hh		The handle of the entity.
+	\param where	The locator of the block that put() or remove() is about to overwrite or delete.
+
+	\return	SERVICE_NO_ERROR on success (including when the key does not exist or is not a series) or some negative value.
+*/
+StatusCode Persisted::remove_segments(pMDB_txn lm_tx, MDB_dbi hh, Locator &where) {
+
+	MDB_val l_key, l_data;
+
+	l_key.mv_size = strlen(where.key);
+	l_key.mv_data = &where.key[0];
+
+	if (int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data)) {
+		if (lmdb_err == MDB_NOTFOUND)
+			return SERVICE_NO_ERROR;
+
+		log_lmdb_err(log_error_level, lmdb_err, "mdb_get() failed in Persisted::remove_segments().");
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	if (!is_series((pBlock) l_data.mv_data, l_data.mv_size))
+		return SERVICE_NO_ERROR;
+
+	SeriesHead	   head;
+	SeriesSegments segments;
+
+	if (!read_manifest((pBlock) l_data.mv_data, head, segments))
+		return SERVICE_ERROR_CORRUPTED;
+
+	Locator loc;
+
+	for (size_t i = 0; i < segments.size(); i++) {
+		segment_locator(loc, where, segments[i].id);
+
+		if (delete_block(lm_tx, hh, loc) == SERVICE_ERROR_REMOVE_FAILED)
+			return SERVICE_ERROR_REMOVE_FAILED;
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Assemble rows of a series from its segments inside a read transaction.
+
+	\param p_txn		Returns a Transaction with the Tensor.
+	\param lm_tx		The transaction in which the manifest was read.
+	\param hh			The handle of the entity.
+	\param what			The locator of the series.
+	\param p_manifest	The manifest.
+	\param p_row_filter	A filter (as in new_block(3) for a tensor with the rows of the series) or nullptr to select a range of rows.
+	\param first_row	The first row of the range (when p_row_filter == nullptr).
+	\param num_rows		The number of rows of the range or -1 for all the rows from first_row.
+
+	\return	SERVICE_NO_ERROR on success or some negative value.
+
+Only the segments containing selected rows are read (and decompressed).
+*/
+StatusCode Persisted::series_get(pTransaction &p_txn, pMDB_txn lm_tx, MDB_dbi hh, Locator &what, pBlock p_manifest,
+								 pBlock p_row_filter, int64_t first_row, int64_t num_rows) {
+
+	p_txn = nullptr;
+
+	SeriesHead	   head;
+	SeriesSegments segments;
+
+	if (!read_manifest(p_manifest, head, segments))
+		return SERVICE_ERROR_CORRUPTED;
+
+	int64_t total_rows = head.dim[0], row_cells = 1, selected = 0;
+
+	for (int i = 1; i < MAX_TENSOR_RANK && head.dim[i] > 0; i++)
+		row_cells *= head.dim[i];
+
+	int64_t row_bytes = (head.cell_type & 0xff)*row_cells;
+
+	if (num_rows < 0)
+		num_rows = total_rows - first_row;
+
+	if (p_row_filter == nullptr) {
+		if (first_row < 0 || first_row + num_rows > total_rows)
+			return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+		selected = num_rows;
+
+	} else {
+		if (p_row_filter->rank != 1)
+			return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+		switch (p_row_filter->cell_type) {
+		case CELL_TYPE_BYTE_BOOLEAN:
+			if (p_row_filter->size != total_rows)
+				return SERVICE_ERROR_NEW_BLOCK_ARGS;
+
+			for (int i = 0; i < p_row_filter->size; i++)
+				if (p_row_filter->tensor.cell_bool[i])
+					selected++;
+
+			break;
+
+		case CELL_TYPE_INTEGER:
+			for (int i = 0; i < p_row_filter->size; i++) {
+				int row = p_row_filter->tensor.cell_int[i];
+
+				if (row < 0 || row >= total_rows || (i > 0 && row < p_row_filter->tensor.cell_int[i - 1]))
+					return SERVICE_ERROR_NEW_BLOCK_ARGS;
+			}
+			selected = p_row_filter->size;
+
+			break;
+
+		default:
+			return SERVICE_ERROR_NEW_BLOCK_ARGS;
+		}
+	}
+
+	if (selected*row_bytes > (int64_t) INT_MAX - (int64_t) sizeof(StaticBlockHeader) - 1024)
+		return SERVICE_ERROR_NO_MEM;
+
+	int dim[MAX_TENSOR_RANK];
+
+	for (int i = 0; i < MAX_TENSOR_RANK; i++)
+		dim[i] = head.dim[i];
+
+	dim[0] = selected;
+
+	StatusCode ret = new_block(p_txn, head.cell_type, dim, FILL_NEW_DONT_FILL);
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	pChar	p_dest	  = (pChar) &p_txn->p_block->tensor;
+	int64_t range_end = first_row + num_rows, ix = 0;
+
+	for (size_t s = 0; s < segments.size(); s++) {
+		int64_t seg_first = segments[s].first_row, seg_end = seg_first + segments[s].rows;
+
+		bool needed = false;
+
+		if (p_row_filter == nullptr)
+			needed = seg_end > first_row && seg_first < range_end;
+
+		else if (p_row_filter->cell_type == CELL_TYPE_INTEGER)
+			needed = ix < p_row_filter->size && p_row_filter->tensor.cell_int[ix] < seg_end;
+
+		else
+			for (int64_t row = seg_first; row < seg_end && !needed; row++)
+				needed = p_row_filter->tensor.cell_bool[row];
+
+		if (!needed)
+			continue;
+
+		Locator loc;
+		pBlock	p_unpacked;
+
+		segment_locator(loc, what, segments[s].id);
+
+		pBlock p_seg = block_in_txn(lm_tx, hh, loc, p_unpacked);
+
+		if (   p_seg == nullptr || p_seg->cell_type != head.cell_type || p_seg->size != segments[s].rows*row_cells
+			|| !p_seg->check_hash()) {
+			log_printf(log_error_level, "Persisted::series_get(): Corrupted segment //%s/%s/%s", loc.base, loc.entity, loc.key);
+
+			if (p_unpacked != nullptr) {
+				alloc_bytes -= p_unpacked->total_bytes;
+				free(p_unpacked);
+			}
+			destroy_transaction(p_txn);
+
+			return SERVICE_ERROR_CORRUPTED;
+		}
+
+		pChar p_src = (pChar) &p_seg->tensor;
+
+		if (p_row_filter == nullptr) {
+			int64_t from = std::max(first_row, seg_first), to = std::min(range_end, seg_end);
+
+			memcpy(p_dest, p_src + (from - seg_first)*row_bytes, (to - from)*row_bytes);
+
+			p_dest += (to - from)*row_bytes;
+
+		} else if (p_row_filter->cell_type == CELL_TYPE_INTEGER) {
+			for (; ix < p_row_filter->size && p_row_filter->tensor.cell_int[ix] < seg_end; ix++) {
+				memcpy(p_dest, p_src + (p_row_filter->tensor.cell_int[ix] - seg_first)*row_bytes, row_bytes);
+
+				p_dest += row_bytes;
+			}
+		} else {
+			for (int64_t row = seg_first; row < seg_end; row++) {
+				if (p_row_filter->tensor.cell_bool[row]) {
+					memcpy(p_dest, p_src + (row - seg_first)*row_bytes, row_bytes);
+
+					p_dest += row_bytes;
+				}
+			}
+		}
+
+		if (p_unpacked != nullptr) {
+			alloc_bytes -= p_unpacked->total_bytes;
+			free(p_unpacked);
+		}
+	}
+
+	p_txn->p_block->close_block();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Read the next bytes of a get_large() stream.
+
+	\param p_stream	The stream.
+	\param p_buff	Where the bytes are written.
+	\param size		The size of p_buff.
+
+	\return	The number of bytes read (less than size only at the end of the stream) or -1 on error.
+*/
+int64_t Persisted::read_large(pPersistedLargeStream p_stream, pChar p_buff, int64_t size) {
+
+	if (p_stream->writing || p_stream->failed || size < 0)
+		return -1;
+
+	int64_t done = 0;
+
+	while (done < size && p_stream->position < p_stream->stream_bytes) {
+		int64_t n;
+
+		if (p_stream->position < (int64_t) sizeof(LargeBlockHeader)) {
+			n = std::min(size - done, (int64_t) sizeof(LargeBlockHeader) - p_stream->position);
+
+			memcpy(p_buff + done, (pChar) &p_stream->head + p_stream->position, n);
+
+		} else {
+			if (p_stream->p_block == nullptr && !next_large_block(p_stream)) {
+				p_stream->failed = true;
+
+				return -1;
+			}
+			int64_t block_bytes = (int64_t) p_stream->p_block->size*(p_stream->p_block->cell_type & 0xff);
+
+			n = std::min(size - done, block_bytes - p_stream->block_pos);
+
+			memcpy(p_buff + done, (pChar) &p_stream->p_block->tensor + p_stream->block_pos, n);
+
+			p_stream->block_pos += n;
+
+			if (p_stream->block_pos == block_bytes && p_stream->position + n < p_stream->stream_bytes) {
+				if (p_stream->p_unpacked != nullptr) {
+					alloc_bytes -= p_stream->p_unpacked->total_bytes;
+					free(p_stream->p_unpacked);
+
+					p_stream->p_unpacked = nullptr;
+				}
+				p_stream->p_block = nullptr;
+			}
+		}
+		p_stream->position += n;
+		done			   += n;
+	}
+
+	return done;
+}
+
+
+/** \brief Write the next bytes of a put_large() stream, storing each segment as soon as it is complete.
+
+	\param p_stream	The stream.
+	\param p_data	The bytes.
+	\param size		The number of bytes.
+
+	\return	False on error (wrong header, more bytes than the header declares or a failed write).
+*/
+bool Persisted::write_large(pPersistedLargeStream p_stream, pChar p_data, int64_t size) {
+
+	if (!p_stream->writing || p_stream->failed || size < 0)
+		return false;
+
+	while (size > 0) {
+		int64_t n;
+
+		if (p_stream->position < (int64_t) sizeof(LargeBlockHeader)) {
+			n = std::min(size, (int64_t) sizeof(LargeBlockHeader) - p_stream->position);
+
+			memcpy((pChar) &p_stream->head + p_stream->position, p_data, n);
+
+			if (p_stream->position + n == (int64_t) sizeof(LargeBlockHeader) && !start_large(p_stream)) {
+				p_stream->failed = true;
+
+				return false;
+			}
+
+		} else {
+			if (p_stream->position + size > (int64_t) sizeof(LargeBlockHeader) + p_stream->head.tensor_bytes) {
+				p_stream->failed = true;
+
+				return false;
+			}
+
+			if (p_stream->p_chunk == nullptr) {
+				int dim[MAX_TENSOR_RANK];
+
+				for (int i = 0; i < MAX_TENSOR_RANK; i++)
+					dim[i] = p_stream->series.dim[i];
+
+				dim[0] = std::min(p_stream->series.segment_rows, p_stream->head.dim[0] - p_stream->series.dim[0]);
+
+				if (new_block(p_stream->p_chunk, p_stream->series.cell_type, dim, FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+					p_stream->p_chunk = nullptr;
+					p_stream->failed  = true;
+
+					return false;
+				}
+				p_stream->chunk_pos = 0;
+			}
+			pBlock p_blx = p_stream->p_chunk->p_block;
+
+			int64_t chunk_bytes = (int64_t) p_blx->size*(p_blx->cell_type & 0xff);
+
+			n = std::min(size, chunk_bytes - p_stream->chunk_pos);
+
+			memcpy((pChar) &p_blx->tensor + p_stream->chunk_pos, p_data, n);
+
+			p_stream->chunk_pos += n;
+
+			if (p_stream->chunk_pos == chunk_bytes && flush_large(p_stream) != SERVICE_NO_ERROR) {
+				p_stream->failed = true;
+
+				return false;
+			}
+		}
+		p_stream->position += n;
+		p_data			   += n;
+		size			   -= n;
+	}
+
+	return true;
+}
+
+
+/** \brief Validate the LargeBlockHeader of a put_large() stream and set up the head of the series storing it.
+
+	\param p_stream	The stream with a complete .head.
+
+	\return	False if the header is not valid or a row of the tensor is bigger than PERSISTED_LARGE_CHUNK_BYTES.
+*/
+bool Persisted::start_large(pPersistedLargeStream p_stream) {
+
+	LargeBlockHeader &hea = p_stream->head;
+
+	int cell_type = hea.cell_type & ~LARGE_BLOCK_FLAG, cell_size = cell_type & 0xff;
+
+	if (   (hea.cell_type & LARGE_BLOCK_FLAG) == 0 || hea.version != LARGE_BLOCK_VERSION || hea.rank < 1 || hea.rank > MAX_TENSOR_RANK
+		|| (cell_size != 1 && cell_size != 2 && cell_size != 4 && cell_size != 8) || (cell_type & 0xf0) != 0
+		|| cell_type == CELL_TYPE_STRING || cell_type == CELL_TYPE_OBJECT_KIND)
+		return false;
+
+	int64_t size = 1;
+
+	for (int i = 0; i < MAX_TENSOR_RANK; i++) {
+		if (i >= hea.rank) {
+			if (hea.dim[i] != 0)
+				return false;
+
+			continue;
+		}
+		if (hea.dim[i] <= 0 || (i > 0 && hea.dim[i] > INT_MAX) || hea.dim[i] > INT64_MAX/cell_size/size)
+			return false;
+
+		size *= hea.dim[i];
+	}
+
+	int64_t row_bytes = size/hea.dim[0]*cell_size;
+
+	if (size != hea.size || hea.tensor_bytes != size*cell_size || row_bytes > PERSISTED_LARGE_CHUNK_BYTES)
+		return false;
+
+	SeriesHead &series = p_stream->series;
+
+	series = {};
+
+	series.cell_type	= cell_type;
+	series.segment_rows = PERSISTED_LARGE_CHUNK_BYTES/row_bytes;
+
+	for (int i = 1; i < hea.rank; i++)
+		series.dim[i] = hea.dim[i];
+
+	return true;
+}
+
+
+/** \brief Make the next segment of a series (or the regular tensor) the block read by a get_large() stream.
+
+	\param p_stream	The stream.
+
+	\return	False if the segment does not exist or is corrupted.
+*/
+bool Persisted::next_large_block(pPersistedLargeStream p_stream) {
+
+	if (p_stream->segment_ix >= p_stream->segments.size())
+		return false;
+
+	SeriesSegment &segment = p_stream->segments[p_stream->segment_ix++];
+
+	int64_t row_cells = 1;
+
+	for (int i = 1; i < MAX_TENSOR_RANK && p_stream->series.dim[i] > 0; i++)
+		row_cells *= p_stream->series.dim[i];
+
+	Locator loc;
+
+	segment_locator(loc, p_stream->where, segment.id);
+
+	pBlock p_blx = block_in_txn(p_stream->lm_tx, p_stream->hh, loc, p_stream->p_unpacked);
+
+	if (p_blx == nullptr || p_blx->size != segment.rows*row_cells || !p_blx->check_hash()) {
+		log_printf(log_error_level, "Persisted::next_large_block(): Corrupted segment //%s/%s/%s", loc.base, loc.entity, loc.key);
+
+		return false;
+	}
+	p_stream->p_block	= p_blx;
+	p_stream->block_pos = 0;
+
+	return true;
+}
+
+
+/** \brief Store the (complete) segment being filled by a put_large() stream inside its write transaction.
+
+	\param p_stream	The stream.
+
+	\return	SERVICE_NO_ERROR on success or some negative value.
+*/
+StatusCode Persisted::flush_large(pPersistedLargeStream p_stream) {
+
+	pBlock p_blx = p_stream->p_chunk->p_block;
+
+	p_blx->close_block();
+
+	int64_t rows = p_blx->size/p_blx->range.dim[0];
+
+	SeriesSegment segment = {p_stream->series.next_segment++, p_stream->series.dim[0], rows};
+
+	Locator loc;
+
+	segment_locator(loc, p_stream->where, segment.id);
+
+	StatusCode ret = store_block(p_stream->lm_tx, p_stream->hh, loc, p_blx, compression(p_stream->where.entity));
+
+	destroy_transaction(p_stream->p_chunk);
+
+	p_stream->p_chunk = nullptr;
+
+	if (ret != SERVICE_NO_ERROR)
+		return ret;
+
+	p_stream->series.dim[0] += rows;
+
+	p_stream->segments.push_back(segment);
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** \brief Read the next bytes of the stream. (See Persisted::read_large().)
+
+	\param p_buff	Where the bytes are written.
+	\param size	The size of p_buff.
+
+	\return	The number of bytes read (less than size only at the end of the stream) or -1 on error.
+*/
+int64_t PersistedLargeStream::read(pChar p_buff, int64_t size) {
+
+	return p_owner->read_large(this, p_buff, size);
+}
+
+
+/** \brief Write the next bytes of the stream. (See Persisted::write_large().)
+
+	\param p_data	The bytes.
+	\param size	The number of bytes.
+
+	\return	False on error.
+*/
+bool PersistedLargeStream::write(pChar p_data, int64_t size) {
+
+	return p_owner->write_large(this, p_data, size);
+}
+
+
+/** \brief Convert a codec name as used in the configuration (none, lz, deflate, delta, xor or auto) into a PERSISTED_CODEC_*.
+
+	\param codec_name	The name of the codec.
+
+	\return	The PERSISTED_CODEC_* or -1 if the name is not valid.
+*/
+int Persisted::codec_by_name(String codec_name) {
+
+	static const char *names[PERSISTED_NUM_CODECS] = {"none", "lz", "deflate", "delta", "xor", "auto"};
+
+	for (int i = 0; i < PERSISTED_NUM_CODECS; i++)
+		if (codec_name == names[i])
+			return i;
+
+	return -1;
+}
+
+
+/** \brief Set the codec of an entity from the configuration key MDB_COMPRESSION_<entity> (if that key exists).
+
+	\param entity	The name of the entity.
+
+	\return	False (and log(LOG_MISS)) if the key exists, but is not a valid codec name. The entity will use the default codec.
+
+NOTE: This does not lock the Container. It is called by start() and by new_database() which already holds the lock.
+*/
+bool Persisted::load_compression(pChar entity) {
+
+	String key("MDB_COMPRESSION_"), codec_name;
+
+	key += entity;
+
+	entity_codec.erase(entity);
+
+	if (!get_conf_key(key.c_str(), codec_name))
+		return true;
+
+	int codec = codec_by_name(codec_name);
+
+	if (codec < 0) {
+		log_printf(LOG_MISS, "Persisted: invalid %s ignored.", key.c_str());
+
+		return false;
+	}
+
+	entity_codec[entity] = codec;
+
+	return true;
+}
+
+
+/** \brief The size of the part of a block that is always stored uncompressed.
+
+	\param p_block	The block.
+
+	\return	The size of the StaticBlockHeader plus, for Tuples and Kinds, the size of the ItemHeaders.
+
+This is exactly what header() needs, so header() never has to decompress anything.
+*/
+int Persisted::stored_head_size(pBlock p_block) {
+
+	switch (p_block->cell_type) {
+	case CELL_TYPE_TUPLE:
+	case CELL_TYPE_TUPLE_KIND:
+		return sizeof(StaticBlockHeader) + p_block->size*sizeof(ItemHeader);
+	}
+
+	return sizeof(StaticBlockHeader);
+}
+
+
+/** \brief Build the compressed value of a block as put() stores it.
+
+	\param p_block		The (closed) block to be stored.
+	\param codec		The PERSISTED_CODEC_* of the entity.
+	\param stored_size	Returns the size of the value when the call returns a buffer. Unmodified otherwise.
+
+	\return	A buffer of size p_block->total_bytes (owned by the caller, accounted in .alloc_bytes) or nullptr if the block must be
+			stored as it is.
+
+Returning nullptr is not an error: it happens when the codec is PERSISTED_CODEC_NONE, the block is small, the compressed value would not
+be smaller than the block or there is no RAM for the buffer. PERSISTED_CODEC_AUTO tries the type aware codec of the cell_type (if any)
+and PERSISTED_CODEC_LZ and keeps the smaller. PERSISTED_CODEC_DELTA and PERSISTED_CODEC_XOR fall back to PERSISTED_CODEC_LZ for the cell
+types they do not support.
+*/
+pChar Persisted::encode_block(pBlock p_block, int codec, int &stored_size) {
+
+	if (codec == PERSISTED_CODEC_NONE || p_block->total_bytes < MIN_SIZE_TO_COMPRESS_BLOCK)
+		return nullptr;
+
+	int cell_type = p_block->cell_type;
+
+	bool is_delta = cell_type == CELL_TYPE_TIME || cell_type == CELL_TYPE_LONG_INTEGER || cell_type == CELL_TYPE_UINT64;
+	bool is_xor	  = cell_type == CELL_TYPE_DOUBLE || cell_type == CELL_TYPE_SINGLE;
+
+	bool also_lz  = codec == PERSISTED_CODEC_AUTO && (is_delta || is_xor);
+
+	if (codec == PERSISTED_CODEC_AUTO)
+		codec = is_delta ? PERSISTED_CODEC_DELTA : is_xor ? PERSISTED_CODEC_XOR : PERSISTED_CODEC_LZ;
+
+	else if ((codec == PERSISTED_CODEC_DELTA && !is_delta) || (codec == PERSISTED_CODEC_XOR && !is_xor))
+		codec = PERSISTED_CODEC_LZ;
+
+	int head_size = stored_head_size(p_block);
+	int data_size = p_block->total_bytes - head_size;
+	int room	  = data_size - sizeof(CodecHeader) - 1;
+
+	if (room <= 0)
+		return nullptr;
+
+	pChar p_out = (pChar) malloc(p_block->total_bytes);
+
+	if (p_out == nullptr)
+		return nullptr;
+
+	memcpy(p_out, p_block, head_size);
+
+	pCodecHeader p_hea	= (pCodecHeader) (p_out + head_size);
+	uint8_t		*p_src	= (uint8_t *) p_block + head_size;
+	uint8_t		*p_dest = (uint8_t *) p_hea + sizeof(CodecHeader);
+
+	int size = 0, cell_bytes = 0;
+
+	switch (codec) {
+	case PERSISTED_CODEC_LZ:
+		size = lz_compress(p_src, data_size, p_dest, room);
+
+		break;
+
+	case PERSISTED_CODEC_DEFLATE: {
+		uLongf dest_len = room;
+
+		if (compress2(p_dest, &dest_len, p_src, data_size, 1) == Z_OK)
+			size = dest_len;
+
+		break; }
+
+	default:
+		if (codec == PERSISTED_CODEC_DELTA)
+			cell_bytes = delta_encode((uint64_t *) p_src, p_block->size, p_dest, room);
+		else
+			cell_bytes = xor_encode(p_src, p_block->size, 8*(cell_type & 0xff), p_dest, room);
+
+		int raw_cells = p_block->size*(cell_type & 0xff), tail = data_size - raw_cells;
+
+		if (cell_bytes > 0 && cell_bytes + tail <= room) {
+			memcpy(p_dest + cell_bytes, p_src + raw_cells, tail);
+
+			size = cell_bytes + tail;
+		}
+	}
+
+	uint8_t *p_scratch;
+
+	if (also_lz && (p_scratch = (uint8_t *) malloc(room)) != nullptr) {
+		int lz_size = lz_compress(p_src, data_size, p_scratch, size > 0 ? size - 1 : room);
+
+		if (lz_size > 0) {
+			memcpy(p_dest, p_scratch, lz_size);
+
+			codec	   = PERSISTED_CODEC_LZ;
+			size	   = lz_size;
+			cell_bytes = 0;
+		}
+		alloc_bytes -= room;
+		free(p_scratch);
+	}
+
+	if (size <= 0) {
+		alloc_bytes -= p_block->total_bytes;
+		free(p_out);
+
+		return nullptr;
+	}
+
+	p_hea->magic		 = PERSISTED_CODEC_MAGIC;
+	p_hea->codec		 = codec;
+	p_hea->payload_bytes = size;
+	p_hea->cell_bytes	 = cell_bytes;
+
+	stored_size = head_size + sizeof(CodecHeader) + size;
+
+	return p_out;
+}
+
+
+/** \brief Decompress a value stored by put() straight into a destination block.
+
+	\param p_stored		The value as found in LMDB (its size is below p_stored->total_bytes).
+	\param stored_size	The size of the value.
+	\param p_dest		A block with (at least) p_stored->total_bytes allocated bytes.
+
+	\return	True on success, false if the value is not a valid compressed value.
+
+The hash64 of the result is not checked here. get() always does it.
+*/
+bool Persisted::decode_block(pBlock p_stored, int stored_size, pBlock p_dest) {
+
+	if (stored_size < (int) sizeof(StaticBlockHeader))
+		return false;
+
+	int head_size = stored_head_size(p_stored);
+	int data_size = p_stored->total_bytes - head_size;
+
+	if (data_size < 0 || stored_size < head_size + (int) sizeof(CodecHeader))
+		return false;
+
+	pCodecHeader p_hea = (pCodecHeader) ((pChar) p_stored + head_size);
+
+	if (p_hea->magic != PERSISTED_CODEC_MAGIC || p_hea->payload_bytes != stored_size - head_size - (int) sizeof(CodecHeader))
+		return false;
+
+	memcpy(p_dest, p_stored, head_size);
+
+	uint8_t *p_src = (uint8_t *) p_hea + sizeof(CodecHeader);
+	uint8_t *p_out = (uint8_t *) p_dest + head_size;
 
-	\param p_txn A pointer to a Transaction passed by reference. If successful, the Container will return a pointer to a
-				 Transaction inside the Container.
-	\param what	 Some Locator to the block. E.g. //lmdb/entity/key
+	switch (p_hea->codec) {
+	case PERSISTED_CODEC_LZ:
+		return lz_decompress(p_src, p_hea->payload_bytes, p_out, data_size);
 
-	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
+	case PERSISTED_CODEC_DEFLATE: {
+		uLongf dest_len = data_size;
 
-Unlike its faster form, this allocates a Block and therefore, it is equivalent to a new_block() call. On success, it will return a
-Transaction that belongs to the Container and must be destroy_transaction()-ed when the caller is done.
+		return uncompress(p_out, &dest_len, p_src, p_hea->payload_bytes) == Z_OK && dest_len == (uLongf) data_size; }
 
-For Tensors it will allocate a block that only has the StaticBlockHeader (What you can more efficiently get from the other form.)
-For Kinds, the metadata of all the items is exactly the same a .get() call returns.
-For Tuples, it does what you expect: returning a Block with the metadata of all the items without the data.
-*/
-StatusCode Persisted::header(pTransaction &p_txn, Locator &what) {
+	case PERSISTED_CODEC_DELTA:
+	case PERSISTED_CODEC_XOR: {
+		int cell_size = p_stored->cell_type & 0xff, raw_cells = p_stored->size*cell_size, tail = data_size - raw_cells;
 
-	pMDB_txn p_l_txn;
+		if (   p_hea->cell_bytes < 0 || tail < 0 || p_hea->cell_bytes + tail != p_hea->payload_bytes
+			|| (p_hea->codec == PERSISTED_CODEC_DELTA ? cell_size != 8 : cell_size != 8 && cell_size != 4))
+			return false;
 
-	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+		memcpy(p_out + raw_cells, p_src + p_hea->cell_bytes, tail);
 
-	if (p_blx == nullptr) {
-		p_txn = nullptr;
+		if (p_hea->codec == PERSISTED_CODEC_DELTA)
+			return delta_decode(p_src, p_hea->cell_bytes, (uint64_t *) p_out, p_stored->size);
 
-		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+		return xor_decode(p_src, p_hea->cell_bytes, p_out, p_stored->size, 8*cell_size); }
 	}
 
-	StatusCode ret = new_transaction(p_txn);
+	return false;
+}
 
-	if (ret != SERVICE_NO_ERROR) {
-		done_pointer_to_block(p_l_txn);
 
-		return ret;
-	}
+/** \brief Decompress a value stored by put() into a new (non Transaction) block.
 
-	int hea_size = sizeof(StaticBlockHeader);
+	\param p_stored		The value as found in LMDB (its size is below p_stored->total_bytes).
+	\param stored_size	The size of the value.
+	\param p_unpacked	Returns the decompressed block. The caller must free() it and decrease .alloc_bytes by its .total_bytes.
 
-	switch (p_blx->cell_type) {
-	case CELL_TYPE_TUPLE:
-	case CELL_TYPE_TUPLE_KIND:
-		hea_size += p_blx->size*sizeof(ItemHeader);
-	}
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_NO_MEM or SERVICE_ERROR_CORRUPTED.
 
-	p_txn->p_block = block_malloc(hea_size);
+This is for the get() forms that select from the block and for copy(). A full get() decompresses straight into the Transaction.
+*/
+StatusCode Persisted::unpack_block(pBlock p_stored, int stored_size, pBlock &p_unpacked) {
 
-	if (p_txn->p_block == nullptr) {
-		done_pointer_to_block(p_l_txn);
-		destroy_transaction(p_txn);
+	p_unpacked = (pBlock) malloc(p_stored->total_bytes);
 
+	if (p_unpacked == nullptr)
 		return SERVICE_ERROR_NO_MEM;
-	}
 
-	memcpy(p_txn->p_block, p_blx, hea_size);
+	if (!decode_block(p_stored, stored_size, p_unpacked)) {
+		log(log_error_level, "Persisted::unpack_block(): invalid compressed value.");
 
-	p_txn->p_block->total_bytes = hea_size;
+		alloc_bytes -= p_stored->total_bytes;
+		free(p_unpacked);
 
-	p_txn->status = BLOCK_STATUS_READY;
+		p_unpacked = nullptr;
 
-	done_pointer_to_block(p_l_txn);
+		return SERVICE_ERROR_CORRUPTED;
+	}
 
 	return SERVICE_NO_ERROR;
 }
 
 
-/** Native (Persistence) interface for **Block storing**
+/** \brief Compress a buffer with the built-in LZ codec (PERSISTED_CODEC_LZ).
 
-	\param where	Some **destination** parsed by as_locator()
-	\param p_block	The Block to be stored in Persistence. The Block hash and dated will be updated by this call!!
-	\param mode		Some writing restriction, either WRITE_ONLY_IF_EXISTS or WRITE_ONLY_IF_NOT_EXISTS. WRITE_TENSOR_DATA returns
-					the error SERVICE_ERROR_WRONG_ARGUMENTS
+	\param p_src		The data to be compressed.
+	\param src_size		The size of the data.
+	\param p_dest		The output buffer.
+	\param dest_size	The size of the output buffer.
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+	\return	The size of the compressed data or 0 if it does not fit in dest_size.
 
-**NOTE**: This updates the calling block's creation time and hash64.
+The format is a sequence of: a token (the high nibble is the number of literals, the low nibble the match length - LZ_CODEC_MIN_MATCH, 15
+meaning "continued in the next bytes" as a sum of bytes ending in a byte below 255), the literals, the match offset as two bytes and the
+continuation of the match length. The last sequence has only literals. It is the same idea as LZ4 with a simpler (single probe) parser.
 */
-StatusCode Persisted::put(Locator &where, pBlock p_block, int mode) {
+int Persisted::lz_compress(uint8_t *p_src, int src_size, uint8_t *p_dest, int dest_size) {
 
-	pMDB_txn lm_tx;
+	int last_pos[1 << LZ_CODEC_HASH_BITS];
 
-	mode = mode == WRITE_AS_BASE_DEFAULT ? WRITE_AS_FULL_BLOCK : mode;
+	memset(last_pos, 0xff, sizeof(last_pos));
 
-	if ((mode & WRITE_AS_FULL_BLOCK) == 0)
-		return SERVICE_ERROR_WRITE_FORBIDDEN;
+	int ip = 0, anchor = 0, op = 0, limit = src_size - LZ_CODEC_MIN_MATCH;
 
-	if (mode & WRITE_ANY_RESTRICTION) {
-		pBlock p_blx = lock_pointer_to_block(where, lm_tx);
+	while (ip <= limit) {
+		uint32_t seq, ref_seq;
 
-		bool already_exists = p_blx != nullptr;
+		memcpy(&seq, p_src + ip, 4);
 
-		if (already_exists) {
-			done_pointer_to_block(lm_tx);
+		int hash = (seq*2654435761u) >> (32 - LZ_CODEC_HASH_BITS);
+		int ref	 = last_pos[hash];
 
-			if (mode & WRITE_ONLY_IF_NOT_EXISTS)
-				return SERVICE_ERROR_WRITE_FORBIDDEN;
+		last_pos[hash] = ip;
 
-		} else if (mode & WRITE_ONLY_IF_EXISTS)
-			return SERVICE_ERROR_WRITE_FORBIDDEN;
-	}
+		if (ref >= 0 && ip - ref <= LZ_CODEC_MAX_OFFSET)
+			memcpy(&ref_seq, p_src + ref, 4);
+		else
+			ref_seq = ~seq;
 
-	if (p_block->hash64 == 0)
-		p_block->close_block();
+		if (ref_seq != seq) {
+			ip += 1 + ((ip - anchor) >> 6);		// Accelerate on incompressible data.
 
-	DBImap::iterator it = source_dbi.find(where.entity);
+			continue;
+		}
 
-	if (it == source_dbi.end()) {
-		log(LOG_MISS, "Invalid source in Persisted::put().");
+		int len = LZ_CODEC_MIN_MATCH;
 
-		return SERVICE_ERROR_WRITE_FAILED;
-	}
+		while (ip + len < src_size && p_src[ref + len] == p_src[ip + len])
+			len++;
 
-	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::put().");
+		if ((op = lz_put_sequence(p_src + anchor, ip - anchor, ip - ref, len, p_dest, op, dest_size)) < 0)
+			return 0;
 
-		return SERVICE_ERROR_WRITE_FAILED;
+		ip	  += len;
+		anchor = ip;
 	}
 
-	MDB_dbi hh = it->second;
-
-	if (hh == INVALID_MDB_DBI) {
-		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
-			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::put().");
+	if ((op = lz_put_sequence(p_src + anchor, src_size - anchor, 0, 0, p_dest, op, dest_size)) < 0)
+		return 0;
 
-			goto release_txn_and_fail;
-		}
-		source_dbi[where.entity] = hh;
-	}
+	return op;
+}
 
-	MDB_val l_key, l_data;
 
-	l_key.mv_size  = strlen(where.key);
-	l_key.mv_data  = &where.key[0];
-	l_data.mv_size = p_block->total_bytes;
-	l_data.mv_data = p_block;
+/** \brief Decompress a buffer compressed by lz_compress() straight into its destination.
 
-	if (int lmdb_err = mdb_put(lm_tx, hh, &l_key, &l_data, 0)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_put() failed in Persisted::put().");
+	\param p_src		The compressed data.
+	\param src_size		The size of the compressed data.
+	\param p_dest		The output buffer.
+	\param dest_size	The exact size of the uncompressed data.
 
-		goto release_txn_and_fail;
-	}
+	\return	True on success, false if the compressed data is not valid or does not decompress to exactly dest_size bytes.
+*/
+bool Persisted::lz_decompress(uint8_t *p_src, int src_size, uint8_t *p_dest, int dest_size) {
 
-	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::put().");
+	int ip = 0, op = 0;
 
-		goto release_txn_and_fail;
-	}
+	while (ip < src_size) {
+		int token = p_src[ip++], len = token >> 4;
 
-	return SERVICE_NO_ERROR;
+		if (len == 15 && (len = lz_get_length(p_src, ip, src_size, len)) < 0)
+			return false;
 
-release_txn_and_fail:
+		if (len > src_size - ip || len > dest_size - op)
+			return false;
 
-	mdb_txn_abort(lm_tx);
+		if (len <= 16 && src_size - ip >= 16 && dest_size - op >= 16)
+			memcpy(p_dest + op, p_src + ip, 16);	// Fixed size copies are much faster, the extra bytes are overwritten later.
+		else
+			memcpy(p_dest + op, p_src + ip, len);
 
-	return SERVICE_ERROR_WRITE_FAILED;
-}
+		ip += len;
+		op += len;
 
+		if (ip == src_size)
+			break;
 
-/** Native (Persistence) interface for **creating databases**
+		if (src_size - ip < 2)
+			return false;
 
-	\param where	The name of the LMDB database to be created. E.g. //lmdb/entity compiled.
+		int offset = p_src[ip] | (p_src[ip + 1] << 8);
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
-*/
-StatusCode Persisted::new_entity(Locator &where) {
+		ip += 2;
+		len = token & 15;
 
-	if (where.key[0] != 0)
-		return SERVICE_ERROR_PARSING_COMMAND;
+		if (len == 15 && (len = lz_get_length(p_src, ip, src_size, len)) < 0)
+			return false;
 
-	return new_database(where.entity);
-}
+		len += LZ_CODEC_MIN_MATCH;
 
+		if (offset == 0 || offset > op || len > dest_size - op)
+			return false;
 
-/** Native (Persistence) interface for **deleting databases and blocks**:
+		uint8_t *p_match = p_dest + op - offset, *p_out = p_dest + op;
 
-	\param where	Some Locator to the block or database to be removed. E.g. //lmdb/entity/key or //lmdb/entity compiled.
+		if (len <= 16 && offset >= 16 && dest_size - op >= 16)
+			memcpy(p_out, p_match, 16);
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
-*/
-StatusCode Persisted::remove(Locator &where) {
+		else if (offset >= len)
+			memcpy(p_out, p_match, len);
 
-	if (where.key[0] == 0)
-		return remove_database(where.entity);
+		else if (offset >= 8 && dest_size - op >= len + 8) {
+			for (int i = 0; i < len; i += 8)
+				memcpy(p_out + i, p_match + i, 8);
+		} else
+			for (int i = 0; i < len; i++)
+				p_out[i] = p_match[i];
 
-	DBImap::iterator it = source_dbi.find(where.entity);
+		op += len;
+	}
 
-	if (it == source_dbi.end()) {
-		log(LOG_MISS, "Invalid source in Persisted::remove().");
+	return op == dest_size;
+}
 
-		return SERVICE_ERROR_REMOVE_FAILED;
-	}
 
-	pMDB_txn lm_tx;
+/** \brief Encode 64-bit cells with zigzag deltas bitpacked in frames of DELTA_CODEC_FRAME_CELLS cells (PERSISTED_CODEC_DELTA).
 
-	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, 0, &lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::remove().");
+	\param p_src		The cells (CELL_TYPE_TIME, CELL_TYPE_LONG_INTEGER or CELL_TYPE_UINT64).
+	\param num_cells	The number of cells.
+	\param p_dest		The output buffer.
+	\param dest_size	The size of the output buffer.
 
-		return SERVICE_ERROR_REMOVE_FAILED;
-	}
+	\return	The size of the encoded cells or 0 if it does not fit in dest_size.
 
-	MDB_dbi hh = it->second;
+Each frame is a byte with the bit width of the largest zigzag delta in the frame followed by all the deltas using that width. Sorted or
+regular series (timestamps, counters, ids) need a few bits per cell, a constant series needs one byte per frame.
+*/
+int Persisted::delta_encode(uint64_t *p_src, int num_cells, uint8_t *p_dest, int dest_size) {
 
-	if (hh == INVALID_MDB_DBI) {
-		if (int lmdb_err = mdb_dbi_open(lm_tx, where.entity, MDB_CREATE, &hh)) {
-			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::remove().");
+	uint64_t prev = 0, zigzag[DELTA_CODEC_FRAME_CELLS];
 
-			goto release_txn_and_fail;
-		}
-		source_dbi[where.entity] = hh;
-	}
+	int op = 0;
 
-	MDB_val l_key;
+	for (int i = 0; i < num_cells; i += DELTA_CODEC_FRAME_CELLS) {
+		int		 n	 = std::min(DELTA_CODEC_FRAME_CELLS, num_cells - i);
+		uint64_t all = 0;
 
-	l_key.mv_size = strlen(where.key);
-	l_key.mv_data = &where.key[0];
+		for (int j = 0; j < n; j++) {
+			uint64_t delta = p_src[i + j] - prev;
 
-	if (int lmdb_err = mdb_del(lm_tx, hh, &l_key, NULL)) {
-		if (lmdb_err != MDB_NOTFOUND)
-			log_lmdb_err(LOG_MISS, lmdb_err, "mdb_del() failed in Persisted::remove().");
+			prev = p_src[i + j];
 
-		mdb_txn_abort(lm_tx);
+			zigzag[j] = (delta << 1) ^ (uint64_t) ((int64_t) delta >> 63);
+			all		 |= zigzag[j];
+		}
 
-		return SERVICE_ERROR_BLOCK_NOT_FOUND;
-	}
+		int width		= all == 0 ? 0 : 64 - __builtin_clzll(all);
+		int frame_bytes = (n*width + 7) >> 3;
 
-	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::remove().");
+		if (op + 1 + frame_bytes > dest_size)
+			return 0;
 
-		goto release_txn_and_fail;
-	}
+		p_dest[op++] = width;
 
-	return SERVICE_NO_ERROR;
+		if (width > 0) {
+			BitWriter bw = {p_dest + op, 0, 0};
 
-release_txn_and_fail:
+			for (int j = 0; j < n; j++)
+				bw.put(zigzag[j], width);
 
-	mdb_txn_abort(lm_tx);
+			bw.flush();
+		}
+		op += frame_bytes;
+	}
 
-	return SERVICE_ERROR_REMOVE_FAILED;
+	return op;
 }
 
 
-/** Native (Persistence) interface for **Block copying** (inside the Persistence).
+/** \brief Decode cells encoded by delta_encode() straight into the destination block.
 
-	\param where	Some **destination** parsed by as_locator()
-	\param what		Some Locator to the block. E.g. //lmdb/entity/key
+	\param p_src		The encoded cells.
+	\param src_size		The size of the encoded cells.
+	\param p_dest		The destination cells.
+	\param num_cells	The number of cells.
 
-	\return	SERVICE_NO_ERROR on success or some negative value (error).
+	\return	True on success, false if the encoded data is not valid.
 */
-StatusCode Persisted::copy(Locator &where, Locator &what) {
+bool Persisted::delta_decode(uint8_t *p_src, int src_size, uint64_t *p_dest, int num_cells) {
 
-	pMDB_txn p_l_txn;
+	uint64_t prev = 0;
 
-	pBlock p_blx = lock_pointer_to_block(what, p_l_txn);
+	int ip = 0;
 
-	if (p_blx == nullptr)
-		return SERVICE_ERROR_BLOCK_NOT_FOUND;
+	for (int i = 0; i < num_cells; i += DELTA_CODEC_FRAME_CELLS) {
+		int n = std::min(DELTA_CODEC_FRAME_CELLS, num_cells - i);
 
-	StatusCode ret = put(where, p_blx);
+		if (ip >= src_size)
+			return false;
 
-	done_pointer_to_block(p_l_txn);
+		int width = p_src[ip++];
 
-	return ret;
-}
+		if (width > 64)
+			return false;
 
+		int frame_bytes = (n*width + 7) >> 3;
 
-/** Add the base names for this Container.
+		if (frame_bytes > src_size - ip)
+			return false;
 
-	\param base_names	A BaseNames map passed by reference to which the base names of this object are added by this call.
+		if (width == 0) {
+			for (int j = 0; j < n; j++)
+				p_dest[i + j] = prev;
+		} else {
+			BitReader br = {p_src + ip, p_src + ip + frame_bytes, 0, 0, 0};
 
-	The Persisted object has used-defined databases containing anything, these databases can have any names as long as they do not
-interfere with existing base names. The API object will forward names that do not match any base names to Persisted in case they
-are the name of a database (and will fail otherwise).
+			for (int j = 0; j < n; j++) {
+				uint64_t zigzag = br.get(width);
 
-	Besides these user-defined names, there is a number of reserved databases that keep track of things and are found in the configuration.
-"static" is a database of objects with attributes BLOCK_ATTRIB_URL and BLOCK_ATTRIB_MIMETYPE exposed via the / API.
-*/
-void Persisted::base_names(BaseNames &base_names) {
+				prev		 += (zigzag >> 1) ^ (0 - (zigzag & 1));
+				p_dest[i + j] = prev;
+			}
+		}
+		ip += frame_bytes;
+	}
 
-	base_names["lmdb"] = this;		// Provides LMDB block persistence for any movable (Tensor, Kind or Tuple).
+	return ip == src_size;
 }
 
 
-/** \brief Check the internal std::map to see if a (dbi) database name exists.
-
-	\param dbi_name	The location of a Block inside LMDB.
+/** \brief Encode floating point cells with the XOR of consecutive values as in Facebook's Gorilla (PERSISTED_CODEC_XOR).
 
-	\return	True if exists.
-*/
-bool Persisted::dbi_exists(Name dbi_name) {
+	\param p_src		The cells (CELL_TYPE_DOUBLE or CELL_TYPE_SINGLE).
+	\param num_cells	The number of cells.
+	\param cell_bits	64 or 32.
+	\param p_dest		The output buffer.
+	\param dest_size	The size of the output buffer.
 
-	return source_dbi.find(dbi_name) != source_dbi.end();
-}
+	\return	The size of the encoded cells or 0 if it does not fit in dest_size.
 
+A repeated value is one bit. Otherwise, the meaningful bits of the XOR are written either inside the window of the previous one (2 bits +
+the window) or with a new window (2 bits + leading zeros + length, 6 bits each for double, 5 for single + the meaningful bits).
+*/
+int Persisted::xor_encode(void *p_src, int num_cells, int cell_bits, uint8_t *p_dest, int dest_size) {
 
-/** \brief Locates a block doing an mdb_get() leaving the transaction open.
+	BitWriter bw = {p_dest, 0, 0};
 
-	\param what	 The location of a Block inside LMDB.
-	\param lm_tx the transcation created by a lock_pointer_to_block() call.
+	uint64_t prev = 0;
 
-	\return	The pointer to the block (can **only** be read and **requires** a done_pointer_to_block() to close the transaction) or
-			nullptr (+ log INFO) on error.
+	int field_bits = cell_bits == 64 ? 6 : 5, p_lead = -1, p_trail = 0;
 
-NOTE: This requires a subsequent done_pointer_to_block() call.
-*/
-pBlock Persisted::lock_pointer_to_block(Locator &what, pMDB_txn &lm_tx) {
+	for (int i = 0; i < num_cells; i++) {
+		if (bw.p_out - p_dest > dest_size - 24)		// A value never takes more than 2 words and flush() adds one.
+			return 0;
 
-	DBImap::iterator it = source_dbi.find(what.entity);
+		uint64_t x = cell_bits == 64 ? ((uint64_t *) p_src)[i] : ((uint32_t *) p_src)[i];
+		uint64_t xr = x ^ prev;
 
-	if (it == source_dbi.end()) {
-		log(LOG_MISS, "Invalid source in Persisted::lock_pointer_to_block().");
+		prev = x;
 
-		return nullptr;
-	}
+		if (xr == 0) {
+			bw.put(0, 1);
 
-	if (int lmdb_err = mdb_txn_begin(lmdb_env, NULL, MDB_RDONLY, &lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_begin() failed in Persisted::lock_pointer_to_block().");
+			continue;
+		}
 
-		return nullptr;
-	}
+		int lead  = cell_bits == 64 ? __builtin_clzll(xr) : __builtin_clz((uint32_t) xr);
+		int trail = __builtin_ctzll(xr);
 
-	MDB_dbi hh = it->second;
+		if (p_lead >= 0 && lead >= p_lead && trail >= p_trail) {
+			bw.put(1, 2);
+			bw.put(xr >> p_trail, cell_bits - p_lead - p_trail);
+		} else {
+			int len = cell_bits - lead - trail;
 
-	if (hh == INVALID_MDB_DBI) {
-		if (int lmdb_err = mdb_dbi_open(lm_tx, what.entity, MDB_CREATE, &hh)) {
-			log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an already invalid handle in Persisted::lock_pointer_to_block().");
+			bw.put(3, 2);
+			bw.put(lead, field_bits);
+			bw.put(len - 1, field_bits);
+			bw.put(xr >> trail, len);
 
-			goto release_txn_and_fail;
+			p_lead	= lead;
+			p_trail = trail;
 		}
-		source_dbi [what.entity] = hh;
 	}
 
-	MDB_val l_key, l_data;
-
-	l_key.mv_size = strlen(what.key);
-	l_key.mv_data = &what.key[0];
+	return bw.flush() - p_dest;
+}
 
-	if (int lmdb_err = mdb_get(lm_tx, hh, &l_key, &l_data)) {
-		if (lmdb_err != MDB_NOTFOUND)
-			log_lmdb_err(LOG_MISS, lmdb_err, "mdb_get() failed in Persisted::lock_pointer_to_block() with a code other than MDB_NOTFOUND.");
 
-		goto release_txn_and_fail;
-	}
+/** \brief Decode cells encoded by xor_encode() straight into the destination block.
 
-	return (pBlock) l_data.mv_data;
+	\param p_src		The encoded cells.
+	\param src_size		The size of the encoded cells.
+	\param p_dest		The destination cells.
+	\param num_cells	The number of cells.
+	\param cell_bits	64 or 32.
 
-release_txn_and_fail:
+	\return	True on success, false if the encoded data is not valid.
+*/
+bool Persisted::xor_decode(uint8_t *p_src, int src_size, void *p_dest, int num_cells, int cell_bits) {
 
-	mdb_txn_abort(lm_tx);
+	BitReader br = {p_src, p_src + src_size, 0, 0, 0};
 
-	lm_tx = nullptr;
+	uint64_t prev = 0;
 
-	return nullptr;
-}
+	int field_bits = cell_bits == 64 ? 6 : 5, p_lead = -1, p_trail = 0;
 
+	for (int i = 0; i < num_cells; i++) {
+		if (br.get(1) != 0) {
+			if (br.get(1) == 0) {
+				if (p_lead < 0)
+					return false;
 
-/** \brief Completes the transaction started by lock_pointer_to_block() doing a mdb_txn_commit() which invalidates the pointer.
+				prev ^= br.get(cell_bits - p_lead - p_trail) << p_trail;
+			} else {
+				int lead  = br.get(field_bits);
+				int len	  = br.get(field_bits) + 1;
+				int trail = cell_bits - lead - len;
 
-	\param lm_tx the transcation created by a lock_pointer_to_block() call.
-*/
-void Persisted::done_pointer_to_block(pMDB_txn &lm_tx) {
+				if (trail < 0)
+					return false;
 
-	if (int lmdb_err = mdb_txn_commit(lm_tx)) {
-		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::done_pointer_to_block().");
+				prev ^= br.get(len) << trail;
 
-		mdb_txn_abort(lm_tx);
+				p_lead	= lead;
+				p_trail = trail;
+			}
+		}
+		if (cell_bits == 64)
+			((uint64_t *) p_dest)[i] = prev;
+		else
+			((uint32_t *) p_dest)[i] = (uint32_t) prev;
 	}
 
-	lm_tx = nullptr;
+	return br.bits_read <= 8*(int64_t) src_size;
 }
 
 
@@ -771,7 +5663,10 @@ bool Persisted::open_all_databases() {
 	while (!mdb_cursor_get(cursor, &key, &data, MDB_NEXT)) {
 		String name((pChar) key.mv_data);
 
-		source_dbi[name] = INVALID_MDB_DBI;
+		if (name.find('~') == String::npos)
+			source_dbi[name] = INVALID_MDB_DBI;
+		else if (name != PERSISTED_DEDUP_DBI)
+			index_dbi[name] = INVALID_MDB_DBI;
 	}
 
 	mdb_cursor_close(cursor);
@@ -815,7 +5710,17 @@ void Persisted::close_all_databases() {
 		if (it->second != INVALID_MDB_DBI)
 			mdb_dbi_close(lmdb_env, it->second);
 
+	for (IndexDBImap::iterator it = index_dbi.begin(); it != index_dbi.end(); ++it)
+		if (it->second != INVALID_MDB_DBI)
+			mdb_dbi_close(lmdb_env, it->second);
+
+	if (dedup_dbi != INVALID_MDB_DBI)
+		mdb_dbi_close(lmdb_env, dedup_dbi);
+
 	source_dbi.clear();
+	index_dbi.clear();
+
+	dedup_dbi = INVALID_MDB_DBI;
 
 	mdb_env_sync(lmdb_env, true);
 
@@ -890,6 +5795,9 @@ StatusCode Persisted::new_database(pChar name) {
 
 	source_dbi[name] = hh;
 
+	load_compression(name);
+	load_dedup(name);
+
 	unlock_container();
 
 	return SERVICE_NO_ERROR;
@@ -917,16 +5825,23 @@ release_lock_and_fail:
 
 	\return	SERVICE_NO_ERROR on success or some negative value and log(LOG_MISS, "further details") on failure.
 
+	The secondary indexes of the source are dropped in the same transaction.
+
 	NOTE: kill_source() is EXTREMELY not thread safe! Indices to ALL sources may change.
 */
 StatusCode Persisted::remove_database(pChar name) {
 
+	String				  start;
+	IndexDBImap::iterator it;
+
 	if (source_dbi.find(name) == source_dbi.end()) {
 		log(LOG_MISS, "Persisted::remove_database(): source does not exist.");
 
 		return SERVICE_ERROR_ENTITY_NOT_FOUND;
 	}
 
+	expire_snapshots(true);	// mdb_drop() closes the handle, the snapshots could not use it.
+
 	lock_container();
 
 	MDB_txn * txn;
@@ -947,12 +5862,35 @@ StatusCode Persisted::remove_database(pChar name) {
 		source_dbi [name] = hh;
 	}
 
+	if (dedup_dbi != INVALID_MDB_DBI && release_refs(txn, source_dbi[name]) != SERVICE_NO_ERROR)
+		goto release_txn_and_fail;
+
 	if (int lmdb_err = mdb_drop(txn, source_dbi[name], 1)) {
 		log_lmdb_err(log_error_level, lmdb_err, "mdb_drop() failed in Persisted::remove_database().");
 
 		goto release_txn_and_fail;
 	}
 
+	start = String(name) + "~";
+
+	for (it = index_dbi.lower_bound(start); it != index_dbi.end() && it->first.compare(0, start.length(), start) == 0; ++it) {
+		MDB_dbi ih = it->second;
+
+		if (ih == INVALID_MDB_DBI) {
+			if (int lmdb_err = mdb_dbi_open(txn, it->first.c_str(), MDB_CREATE | MDB_DUPSORT, &ih)) {
+				log_lmdb_err(log_error_level, lmdb_err, "mdb_dbi_open() failed on an index in Persisted::remove_database().");
+
+				goto release_txn_and_fail;
+			}
+		}
+
+		if (int lmdb_err = mdb_drop(txn, ih, 1)) {
+			log_lmdb_err(log_error_level, lmdb_err, "mdb_drop() failed on an index in Persisted::remove_database().");
+
+			goto release_txn_and_fail;
+		}
+	}
+
 	if (int lmdb_err = mdb_txn_commit(txn)) {
 		log_lmdb_err(log_error_level, lmdb_err, "mdb_txn_commit() failed in Persisted::remove_database().");
 
@@ -960,6 +5898,11 @@ StatusCode Persisted::remove_database(pChar name) {
 	}
 
 	source_dbi.erase(name);
+	entity_codec.erase(name);
+	dedup_entity.erase(name);
+
+	while ((it = index_dbi.lower_bound(start)) != index_dbi.end() && it->first.compare(0, start.length(), start) == 0)
+		index_dbi.erase(it);
 
 	unlock_container();
 
@@ -58,6 +58,48 @@ namespace jazz_elements
 #define LMDB_UNIX_FILE_PERMISSIONS	      0664				///< The file permissions (as in chmod) for the database files
 #define INVALID_MDB_DBI				0xefefEFEF				///< A constant to flag invalid MDB_dbi handle values
 
+#define PERSISTED_CODEC_NONE				 0				///< Blocks are stored as they are (the default).
+#define PERSISTED_CODEC_LZ					 1				///< A fast, dependency-free, byte oriented LZ77 (LZ4-like format).
+#define PERSISTED_CODEC_DEFLATE				 2				///< zlib deflate at a fast level. Better ratio than LZ, slower.
+#define PERSISTED_CODEC_DELTA				 3				///< Zigzag delta + bitpacking for CELL_TYPE_TIME, LONG_INTEGER and UINT64.
+#define PERSISTED_CODEC_XOR					 4				///< Gorilla-style XOR of consecutive cells for CELL_TYPE_DOUBLE and SINGLE.
+#define PERSISTED_CODEC_AUTO				 5				///< The smaller of LZ and DELTA or XOR (when the cell_type allows it).
+#define PERSISTED_NUM_CODECS				 6				///< The number of PERSISTED_CODEC_* values.
+#define PERSISTED_CODEC_MAGIC		0x5a7a4363				///< The first field of a CodecHeader (to detect corruption).
+#define MIN_SIZE_TO_COMPRESS_BLOCK		   512				///< Blocks (total_bytes) below this size are always stored as they are.
+#define DELTA_CODEC_FRAME_CELLS			   128				///< The number of cells sharing a bit width in PERSISTED_CODEC_DELTA
+#define LZ_CODEC_HASH_BITS					12				///< The size (as a power of 2) of the table of previous positions in the LZ codec
+#define LZ_CODEC_MIN_MATCH					 4				///< The shortest match encoded by the LZ codec
+#define LZ_CODEC_MAX_OFFSET				 65535				///< The longest distance to a match in the LZ codec
+
+#define PERSISTED_SCAN_DEFAULT_LIMIT	  1000				///< The maximum number of keys returned by a scan without ~limit:
+#define PERSISTED_SCAN_MAX_LIMIT		100000				///< The largest ~limit: accepted by a scan
+#define PERSISTED_SCAN_MAX_BYTES	 (1 << 28)				///< A scan with ~blocks stops (returning a paging token) before this size
+
+#define PERSISTED_INDEX_CREATED			    -1				///< The pseudo attribute id of an index on StaticBlockHeader.created
+#define PERSISTED_INDEX_MAX_VALUE		   256				///< Attribute values are indexed by their first PERSISTED_INDEX_MAX_VALUE - 1 bytes
+
+#define PERSISTED_SERIES_DEFAULT_ROWS	 65536				///< The rows in a segment of a series when new_series() is called with segment_rows == 0
+#define PERSISTED_SERIES_MAX_SMALL			16				///< append() compacts a series having more segments below segment_rows than this
+#define PERSISTED_SERIES_MAX_KEY			20				///< The longest key of a series (segments are stored as key~id)
+#define PERSISTED_SERIES_BLOCKTYPE	  "series"				///< The BLOCK_ATTRIB_BLOCKTYPE of the manifest of a series
+#define PERSISTED_LARGE_CHUNK_BYTES	 (1 << 26)				///< The size of the segments of a tensor written by put_large() (64 Mb)
+
+#define PERSISTED_LOG_MAGIC			0x474f4c4a				///< The first field of a LogFrameHeader (to detect corruption).
+#define PERSISTED_LOG_BUFFER_BYTES	 (1 << 20)				///< The stdio buffer of the block-log file in dump() and restore()
+#define PERSISTED_LOG_BATCH_BYTES	 (1 << 26)				///< restore() writes a batch of frames of about this size per write transaction
+#define PERSISTED_LOG_BATCH_FRAMES		  4096				///< The maximum number of frames in a batch of restore()
+#define PERSISTED_LOG_MAX_THREADS			 8				///< The maximum number of threads decoding a batch in restore()
+
+#define PERSISTED_DEDUP_DBI			  "~dedup"				///< The LMDB database (shared by all the entities) with the deduplicated bodies
+#define PERSISTED_DEDUP_MAGIC		0x50554444				///< The first field of a DedupRef (stored under the key instead of the block).
+#define PERSISTED_DEDUP_MIN_BYTES		   512				///< Blocks (total_bytes) below this size are never deduplicated.
+#define PERSISTED_DEDUP_BODY				 0				///< The DedupKey.what of the stored body of a block
+#define PERSISTED_DEDUP_COUNT				 1				///< The DedupKey.what of the DedupCount of a body
+
+#define PERSISTED_SNAPSHOT_MAX_SECONDS		30				///< The default lifetime of a snapshot (configuration key MDB_SNAPSHOT_MAX_SECONDS)
+#define PERSISTED_SNAPSHOT_MAX_COUNT		 4				///< The default maximum of open snapshots (configuration key MDB_SNAPSHOT_MAX_COUNT)
+
 
 // Bit masks to trigger LMDB failures in Persisted wrappers during tests.
 #define TRIGGER_FAIL_MDB_ENV_CREATE			(1u << 0)		///< Trigger a failure in mdb_env_create() to test error handling.
@@ -90,9 +132,182 @@ struct JazzLmdbOptions {
 
 
 typedef std::map <String, MDB_dbi> DBImap;	///< The lmdb MDB_dbi handles for each source.
+typedef std::map <String, int> EntityCodecs;///< The PERSISTED_CODEC_* used by put() for each source.
+typedef std::set <String> DedupEntities;	///< The sources whose blocks are deduplicated by put().
+typedef std::map <String, MDB_dbi> IndexDBImap;		///< The lmdb MDB_dbi handles for each secondary index (named entity~attribute).
+typedef std::vector <std::pair <MDB_dbi, String>> IndexEntries;	///< The (index, value) pairs of a block in the indexes of its entity.
 typedef MDB_txn *pMDB_txn;					///< A pointer to a MDB_txn structure which is what mdb_txn_begin() returns.
 
 
+/** \brief The head of the manifest of a segmented series. (See Persisted::new_series().)
+
+The manifest is a Tensor of CELL_TYPE_LONG_INTEGER with attribute BLOCK_ATTRIB_BLOCKTYPE == PERSISTED_SERIES_BLOCKTYPE containing this
+head followed by .num_segments SeriesSegment structures in row order.
+*/
+struct SeriesHead {
+	int64_t cell_type;						///< The cell_type of the series
+	int64_t dim[MAX_TENSOR_RANK];			///< The shape of the series. dim[0] is the number of rows, the rest is the shape of a row.
+	int64_t segment_rows;					///< The number of rows in a full segment
+	int64_t next_segment;					///< The id of the next segment to be created
+	int64_t num_segments;					///< The number of segments
+};
+typedef SeriesHead *pSeriesHead;			///< A pointer to a SeriesHead
+
+
+/** \brief A segment of a series in its manifest.
+*/
+struct SeriesSegment {
+	int64_t id;								///< The segment is stored as the block key~id in the same entity
+	int64_t first_row;						///< The first row of the series stored in the segment
+	int64_t rows;							///< The number of rows in the segment
+};
+typedef SeriesSegment *pSeriesSegment;		///< A pointer to a SeriesSegment
+typedef std::vector <SeriesSegment> SeriesSegments;	///< The segments of a series (as read from its manifest)
+
+
+class Persisted;
+
+/** \brief PersistedLargeStream: The LargeBlockStream returned by Persisted::get_large() and Persisted::put_large().
+
+It keeps the LMDB transaction open (read-only for get_large(), write for put_large()) until Persisted::close_large().
+*/
+class PersistedLargeStream : public LargeBlockStream {
+
+	public:
+
+		int64_t read (pChar p_buff, int64_t size);
+		bool	write(pChar p_data, int64_t size);
+
+		Persisted		*p_owner;				///< The Persisted that opened the stream
+		bool			 writing;				///< True if opened by put_large()
+		bool			 failed;				///< A previous read() or write() failed
+		Locator			 where;					///< The locator of the tensor
+		pMDB_txn		 lm_tx;					///< The transaction open while the stream is
+		MDB_dbi			 hh;					///< The handle of the entity
+		LargeBlockHeader head;					///< The header of the stream
+		int64_t			 position;				///< The number of bytes read or written so far (header included)
+		SeriesHead		 series;				///< The head of the series with the tensor (unless reading a regular tensor)
+		SeriesSegments	 segments;				///< The segments of the series
+		size_t			 segment_ix;			///< get_large(): The index in .segments of the next segment to be read
+		pBlock			 p_block;				///< get_large(): The block being read (a segment or a regular tensor)
+		pBlock			 p_unpacked;			///< get_large(): A decompressed copy of .p_block (or nullptr)
+		int64_t			 block_pos;				///< get_large(): The bytes of the tensor of .p_block already read
+		pTransaction	 p_chunk;				///< put_large(): The next segment, being filled (or nullptr)
+		int64_t			 chunk_pos;				///< put_large(): The bytes of the tensor of .p_chunk already filled
+};
+typedef PersistedLargeStream *pPersistedLargeStream;	///< A pointer to a PersistedLargeStream
+
+
+/** \brief The header stored between the uncompressed part of a Block and its compressed payload.
+
+A compressed value is: the StaticBlockHeader (and the ItemHeaders of a Tuple or Kind) as they are, this CodecHeader and the payload.
+Since compression is only stored when it saves space, a value is compressed if and only if its size is below .total_bytes.
+*/
+struct CodecHeader {
+	uint32_t magic;							///< Always PERSISTED_CODEC_MAGIC
+	int		 codec;							///< The PERSISTED_CODEC_* used (never PERSISTED_CODEC_AUTO)
+	int		 payload_bytes;					///< The size of the payload following this header
+	int		 cell_bytes;					///< For DELTA and XOR, the size of the encoded cells. The rest of the Block follows verbatim.
+};
+typedef CodecHeader *pCodecHeader;			///< A pointer to a CodecHeader
+
+
+/** \brief The header of a frame in a block-log file. (See Persisted::dump().)
+
+A frame is this header, the entity name, the key and the value as put() stores it (possibly compressed). The crc32 covers everything
+after the header.
+*/
+struct LogFrameHeader {
+	uint32_t magic;							///< Always PERSISTED_LOG_MAGIC
+	uint32_t crc32;							///< The zlib crc32() of the entity name, the key and the value
+	int		 entity_len;					///< The length of the entity name (without a terminating zero)
+	int		 key_len;						///< The length of the key (without a terminating zero)
+	int		 stored_size;					///< The size of the value
+};
+
+
+/** \brief A frame of a block-log read by Persisted::restore().
+*/
+struct LogFrame {
+	Locator	 where;							///< The entity and key of the block
+	uint32_t crc32;							///< The crc32 in the LogFrameHeader
+	int		 stored_size;					///< The size of the value
+	pBlock	 p_stored;						///< The value as read from the file (owned by restore())
+	pBlock	 p_block;						///< The decoded block: .p_stored itself or a decompressed copy (owned by restore())
+};
+typedef std::vector <LogFrame> LogFrames;	///< A batch of frames read by Persisted::restore()
+
+
+/** \brief The value stored under the key of a deduplicated block. (See "Deduplication" in the description of Persisted.)
+*/
+struct DedupRef {
+	uint32_t magic;							///< Always PERSISTED_DEDUP_MAGIC
+	int		 total_bytes;					///< The .total_bytes of the block
+	uint64_t hash64;						///< The .hash64 of the block
+};
+typedef DedupRef *pDedupRef;				///< A pointer to a DedupRef
+
+
+/** \brief The key in the PERSISTED_DEDUP_DBI database of the body of a block and of its DedupCount.
+*/
+struct DedupKey {
+	uint64_t hash64;						///< The .hash64 of the block
+	int		 total_bytes;					///< The .total_bytes of the block
+	int		 what;							///< PERSISTED_DEDUP_BODY or PERSISTED_DEDUP_COUNT
+};
+
+
+/** \brief The number of keys referencing a deduplicated body.
+*/
+struct DedupCount {
+	int64_t refs;							///< The number of DedupRef values pointing to the body
+	int64_t stored_size;					///< The size of the stored (possibly compressed) body
+};
+typedef DedupCount *pDedupCount;			///< A pointer to a DedupCount
+
+
+/** \brief The statistics of the deduplicated blocks returned by Persisted::dedup_stats().
+*/
+struct DedupStats {
+	int64_t bodies;							///< The number of different bodies stored
+	int64_t refs;							///< The number of keys (in all the entities) referencing them
+	int64_t stored_bytes;					///< The size of the bodies as stored
+	int64_t bytes_saved;					///< The size of the bodies that would be stored again without deduplication
+};
+
+
+/** \brief A read transaction pinned by Persisted::new_snapshot() under an id until it is released or expires.
+*/
+struct Snapshot {
+	pMDB_txn  lm_tx;						///< The read-only transaction
+	TimePoint expires;						///< When the transaction is aborted (it is never aborted while .busy)
+	bool	  busy;							///< A thread is reading inside the transaction (LMDB transactions are not shareable)
+};
+typedef std::map <int64_t, Snapshot> Snapshots;	///< The open snapshots by id.
+
+
+/** \brief The arguments of a key scan (E.g., //lmdb/entity/~from:k1~to:k2~limit:100) as parsed by Persisted::parse_scan().
+*/
+struct KeyScan {
+	Name from;								///< The first key (inclusive, or exclusive if .after). Empty starts at the first key.
+	Name to;								///< The last key (inclusive). Empty means no upper bound.
+	Name prefix;							///< Only keys starting with this. Empty means any key.
+	int	 limit;								///< The maximum number of keys returned.
+	bool after;								///< .from is exclusive (it is the paging token "next" returned by a previous scan).
+	bool blocks;							///< Also return the blocks (not just the keys).
+};
+
+
+/** \brief The arguments of a secondary index lookup (E.g., //lmdb/entity/~index:url~eq:/index.html) as parsed by Persisted::parse_lookup().
+*/
+struct IndexQuery {
+	int	 attribute;							///< The attribute id (or PERSISTED_INDEX_CREATED) of the index.
+	char low [PERSISTED_INDEX_MAX_VALUE];	///< The lowest value (inclusive). Empty starts at the first value.
+	char high[PERSISTED_INDEX_MAX_VALUE];	///< The highest value (inclusive). Empty means no upper bound.
+	int	 limit;								///< The maximum number of keys returned.
+};
+
+
 /** \brief Persisted: A Service to manage data objects in LMDB.
 
 This Container implements the full crud (.get(), .header(), .put(), .new_entity(), .remove(), .copy()) interface storing blocks
@@ -107,6 +322,87 @@ For reference:
 4. For how LMDB is used, see http://www.lmdb.tech/doc/ for coding reference.
 5. For specific details, that may be experimented with, see the config file: server/config/jazz_config.ini
 
+Key scans:
+----------
+
+The keys of an entity are sorted (as LMDB does, byte by byte) and can be read in order by scan() or via the API with a "key" made of
+arguments: //lmdb/entity/~from:k1~to:k2~limit:100 (also ~after:key, ~prefix:p and ~blocks). All the arguments are optional, but the url
+must contain at least one ':' to be a scan. The result is a Tuple with the "key"s found, their "offset"s in "blocks" (only with ~blocks)
+and "next", a paging token to continue with ~after:next (empty when the scan is complete). The whole scan is read from one cursor inside
+one read transaction, so it is a consistent snapshot.
+
+Secondary indexes:
+------------------
+
+An entity can have indexes on any block attribute (E.g., BLOCK_ATTRIB_URL) and on the .created time of the blocks. Each index is an
+LMDB database with MDB_DUPSORT named entity~attribute mapping the attribute value to the keys of the blocks having it. put() and remove()
+update the indexes in the same write transaction as the blocks, so they are always consistent. new_index() builds an index from the
+blocks already in the entity. lookup() (or the API with //lmdb/entity/~index:url~eq:value or ~index:created~from:t1~to:t2) returns a
+Tuple with the "key"s and the "value"s found in value order. The values of .created are the microseconds of the block's TimePoint.
+
+Segmented series:
+-----------------
+
+A series is a tensor that grows by appending rows (like a time series) without rewriting it. new_series() creates an empty one: a small
+manifest stored at the key. append() stores the new rows as new segments (blocks stored at key~id) and updates the manifest, both in one
+write transaction, so its cost depends on the rows appended, not on the size of the series. When append() leaves more than
+PERSISTED_SERIES_MAX_SMALL segments below segment_rows, it merges consecutive small segments (compact() does it on demand). get(), get()
+with a row filter and get_rows() assemble the rows from the segments they need only, inside one read transaction. header() returns the
+header of the manifest. remove() removes the segments too and copy() copies the series as a regular tensor.
+
+Large tensors:
+--------------
+
+A Block cannot exceed 2 Gb. Tensors above that never exist in RAM: they move as a LargeBlockStream (a LargeBlockHeader followed by the
+tensor data). put_large() opens a stream that stores whatever is written into it as a series of segments of about
+PERSISTED_LARGE_CHUNK_BYTES, all in one write transaction committed by close_large(). get_large() opens a stream that reads a series
+or a regular tensor in the same format, inside one read transaction. get_rows() reads any part of it as a regular tensor.
+
+Dump and restore:
+-----------------
+
+dump() appends all the blocks of an entity to a block-log file: a sequence of frames (see LogFrameHeader), each one with the entity, the
+key and the value as stored (compressed blocks are not decompressed, uncompressed ones can be compressed with any codec) and a crc32.
+Since frames are only appended, a log can hold several entities. All the blocks are read with one cursor inside one read transaction, so
+the dump is a consistent snapshot of the entity. restore() reads the frames (of one entity or all of them) in batches of up to
+PERSISTED_LOG_BATCH_BYTES. Each batch is verified and decompressed by up to PERSISTED_LOG_MAX_THREADS threads of the Pool and written in one write
+transaction (creating the entities that do not exist, compressing with their codecs and updating their indexes). The blocks keep their
+hash64 and creation time. A corrupted or truncated frame stops restore() with SERVICE_ERROR_CORRUPTED (the previous batches are already
+committed). Via the API: //lmdb/entity/~dump:path (or ~codec:lz~dump:path) and //lmdb/entity/~restore:path. These are only enabled
+when MDB_LOG_PATH is set, the path is relative to it (without "..") and ENABLE_FILE_LEVEL applies as in the //file base of Channels.
+
+Deduplication:
+--------------
+
+An entity can store identical blocks (same header except .created and same content) only once. This is set by the configuration key
+MDB_DEDUP_<entity> = 1 or by set_dedup(). put() stores the blocks of these entities (above PERSISTED_DEDUP_MIN_BYTES) in the database
+PERSISTED_DEDUP_DBI, shared by all the entities, under their hash64 (and total_bytes) with a count of the keys referencing them. The key
+only stores a DedupRef. The counts are updated in the same write transaction that writes or removes the key. A block with the same
+hash64 as a different stored block is stored under the key as usual. All the reads resolve the references transparently (even after
+dedup is turned off), so a deduplicated block is read (and indexed by ~index:created) with the .created of the first block stored
+with that content, not the time it was put() under its key. dedup_stats() returns the bytes saved.
+
+Snapshots:
+----------
+
+Each get() reads inside its own read transaction, so two gets may see different versions of the database. new_snapshot() opens a read
+transaction that stays open (at most MDB_SNAPSHOT_MAX_SECONDS) under an id. snapshot_get() does a get(), a key scan or an index lookup
+of any entity inside it, so all the reads of the same snapshot see the same version, no matter what was written in between. The
+transaction is aborted by release_snapshot() or, once expired, by the next snapshot call, put() or remove(). Removing an entity aborts
+all the snapshots that are not in use. A snapshot is used by one
+thread at a time (the others wait). Via the API: //lmdb/entity/~snapshot:new returns an Index with the "snapshot" id, then
+//lmdb/entity/~snapshot:id~key:k, //lmdb/entity/~snapshot:id~from:k1~limit:100 (or any scan or lookup) and
+//lmdb/entity/~snapshot:id~release. Since pinned pages cannot be reused by writers, the number of open snapshots is limited to
+MDB_SNAPSHOT_MAX_COUNT. Snapshots require MDB_NOLOCK = 0: without the lock table, LMDB does not know which pages the readers use.
+
+Compression:
+------------
+
+Each entity can have a codec (see PERSISTED_CODEC_*) set by the configuration keys MDB_COMPRESSION (the default for all entities) and
+MDB_COMPRESSION_<entity> or by set_compression(). put() stores the StaticBlockHeader (and the ItemHeaders) uncompressed, so header() is
+unaffected, and only keeps the compressed form when it is smaller. get() decompresses straight into the Block it returns. Changing the
+codec of an entity does not rewrite its blocks: all the codecs are always readable.
+
 */
 class Persisted : public Container {
 
@@ -139,6 +435,8 @@ class Persisted : public Container {
 		virtual StatusCode get		 (pTransaction		&p_txn,
 							  		  Locator			&what,
 							  		  pChar				 name);
+		virtual StatusCode get		 (pTransaction		&p_txn,
+									  pChar				 p_what);
 		virtual StatusCode header	 (StaticBlockHeader	&hea,
 									  Locator			&what);
 		virtual StatusCode header	 (pTransaction		&p_txn,
@@ -156,6 +454,76 @@ class Persisted : public Container {
 		void base_names(BaseNames &base_names);
 		bool dbi_exists(Name	   dbi_name);
 
+		// Key scans
+
+		StatusCode scan(pTransaction &p_txn,
+						Locator		 &what,
+						KeyScan		 &range);
+
+		// Secondary indexes
+
+		StatusCode new_index   (pChar		   entity,
+								int			   attribute);
+		StatusCode remove_index(pChar		   entity,
+								int			   attribute);
+		StatusCode lookup	   (pTransaction &p_txn,
+								Locator		 &what,
+								IndexQuery	 &query);
+
+		// Segmented series
+
+		StatusCode new_series(Locator		 &where,
+							  int			  cell_type,
+							  int			 *dim,
+							  int			  segment_rows = 0);
+		StatusCode append	 (Locator		 &where,
+							  pBlock		  p_rows);
+		StatusCode get_rows	 (pTransaction &p_txn,
+							  Locator		 &what,
+							  int			  first_row,
+							  int			  num_rows);
+		StatusCode compact	 (Locator		 &where);
+
+		// Large tensors
+
+		StatusCode get_large  (pLargeBlockStream &p_stream,
+							   Locator			 &what);
+		StatusCode put_large  (pLargeBlockStream &p_stream,
+							   Locator			 &where);
+		StatusCode close_large(pLargeBlockStream &p_stream,
+							   bool				  commit = true);
+
+		// Block-log dump and restore
+
+		StatusCode dump	  (pChar	path,
+						   pChar	entity,
+						   int		codec,
+						   int64_t &num_blocks);
+		StatusCode restore(pChar	path,
+						   pChar	entity,
+						   int64_t &num_blocks);
+
+		// Per entity compression
+
+		StatusCode set_compression(pChar entity, int codec);
+		int		   compression	  (pChar entity);
+		int		   codec_by_name  (String codec_name);
+
+		// Per entity deduplication
+
+		StatusCode set_dedup  (pChar entity, bool dedup);
+		bool	   is_dedup	  (pChar entity);
+		StatusCode dedup_stats(DedupStats &stats);
+
+		// Snapshots
+
+		StatusCode new_snapshot	   (int64_t		 &id,
+									int			  seconds = 0);
+		StatusCode release_snapshot(int64_t		  id);
+		StatusCode snapshot_get	   (pTransaction &p_txn,
+									int64_t		  id,
+									pChar		  p_what);
+
 		/**	\brief Check if the service is running.
 
 			\return True if the service is running.
@@ -170,8 +538,103 @@ class Persisted : public Container {
 
 		// Hot LMDB get
 
-		pBlock lock_pointer_to_block(Locator &what, pMDB_txn &p_txn);
+		pBlock lock_pointer_to_block(Locator &what, pMDB_txn &p_txn, int *p_stored_size = nullptr);
 		void   done_pointer_to_block(pMDB_txn &p_txn);
+		int	   begin_read			(pMDB_txn &lm_tx);
+		void   abort_read			(pMDB_txn &lm_tx);
+
+		// Block compression
+
+		bool   load_compression(pChar entity);
+		StatusCode parse_scan  (Locator &what, KeyScan &range, pChar p_what);
+		int	   stored_head_size(pBlock p_block);
+		pChar  encode_block	   (pBlock p_block, int codec, int &stored_size);
+		bool   decode_block	   (pBlock p_stored, int stored_size, pBlock p_dest);
+		StatusCode unpack_block(pBlock p_stored, int stored_size, pBlock &p_unpacked);
+
+		int	   lz_compress	   (uint8_t *p_src, int src_size, uint8_t *p_dest, int dest_size);
+		bool   lz_decompress   (uint8_t *p_src, int src_size, uint8_t *p_dest, int dest_size);
+		int	   delta_encode	   (uint64_t *p_src, int num_cells, uint8_t *p_dest, int dest_size);
+		bool   delta_decode	   (uint8_t *p_src, int src_size, uint64_t *p_dest, int num_cells);
+		int	   xor_encode	   (void *p_src, int num_cells, int cell_bits, uint8_t *p_dest, int dest_size);
+		bool   xor_decode	   (uint8_t *p_src, int src_size, void *p_dest, int num_cells, int cell_bits);
+
+		// Secondary indexes
+
+		StatusCode parse_lookup	 (Locator &what, IndexQuery &query, pChar p_what);
+		bool	   index_attribute(pChar p_name, int &attribute);
+		void	   index_name	 (pChar p_dest, pChar entity, int attribute);
+		int		   index_value	 (pBlock p_block, int attribute, pChar p_dest);
+		int		   query_value	 (int attribute, pChar p_value, pChar p_dest);
+		bool	   has_indexes	 (pChar entity);
+		StatusCode index_entries (pMDB_txn lm_tx, pChar entity, pBlock p_stored, int stored_size, IndexEntries &entries);
+		StatusCode update_indexes(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, pBlock p_new, int new_size = 0);
+
+		// Block-log dump and restore
+
+		StatusCode parse_log	 (Locator &what, pChar p_what, int &codec, pChar &p_path, bool &is_restore);
+		StatusCode log_path		 (pChar p_path, bool is_restore, String &path);
+		StatusCode read_frames	 (FILE *fp, pChar entity, LogFrames &frames);
+		StatusCode decode_frames (LogFrames &frames);
+		StatusCode write_frames	 (LogFrames &frames);
+		void	   free_frames	 (LogFrames &frames);
+
+		// Block deduplication
+
+		bool	   load_dedup	(pChar entity);
+		StatusCode open_dedup	(bool create);
+		int		   resolve_ref	(pMDB_txn lm_tx, MDB_val &l_data);
+		StatusCode find_body	(pMDB_txn lm_tx, pBlock p_block, MDB_val &l_body);
+		StatusCode add_ref		(pMDB_txn lm_tx, DedupRef &ref, pChar p_body, int stored_size);
+		StatusCode release_ref	(pMDB_txn lm_tx, DedupRef &ref);
+		StatusCode release_refs	(pMDB_txn lm_tx, MDB_dbi hh);
+
+		/**	\brief Check if a stored value is a DedupRef.
+
+			\param l_data	The value.
+
+			\return True if it is a reference to a deduplicated body.
+		*/
+		inline bool is_ref(MDB_val &l_data) {
+			return l_data.mv_size == sizeof(DedupRef) && ((pDedupRef) l_data.mv_data)->magic == PERSISTED_DEDUP_MAGIC;
+		}
+
+		// Snapshots
+
+		StatusCode parse_snapshot  (Locator &what, pChar p_what, int64_t &id, String &url);
+		StatusCode enter_snapshot  (int64_t id, pMDB_txn &lm_tx);
+		void	   leave_snapshot  (int64_t id);
+		void	   expire_snapshots(bool all = false);
+
+		// Writing inside a transaction
+
+		StatusCode store_block (pMDB_txn lm_tx, MDB_dbi hh, Locator &where, pBlock p_block, int codec);
+		StatusCode delete_block(pMDB_txn lm_tx, MDB_dbi hh, Locator &where);
+		pBlock	   block_in_txn(pMDB_txn lm_tx, MDB_dbi hh, Locator &what, pBlock &p_unpacked);
+
+		// Segmented series
+
+		bool	   is_series		(pBlock p_block, int stored_size);
+		void	   segment_locator	(Locator &segment, Locator &series, int64_t id);
+		bool	   read_manifest	(pBlock p_manifest, SeriesHead &head, SeriesSegments &segments);
+		StatusCode write_manifest	(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, SeriesSegments &segments);
+		StatusCode new_segment		(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, pBlock p_rows, int64_t first_row,
+									 int64_t rows, SeriesSegment &segment);
+		StatusCode compact_series	(pMDB_txn lm_tx, MDB_dbi hh, Locator &where, SeriesHead &head, SeriesSegments &segments,
+									 int max_small);
+		StatusCode remove_segments	(pMDB_txn lm_tx, MDB_dbi hh, Locator &where);
+		StatusCode series_get		(pTransaction &p_txn, pMDB_txn lm_tx, MDB_dbi hh, Locator &what, pBlock p_manifest,
+									 pBlock p_row_filter, int64_t first_row, int64_t num_rows);
+
+		// Large tensors
+
+		friend class PersistedLargeStream;
+
+		int64_t	   read_large		(pPersistedLargeStream p_stream, pChar p_buff, int64_t size);
+		bool	   write_large		(pPersistedLargeStream p_stream, pChar p_data, int64_t size);
+		bool	   start_large		(pPersistedLargeStream p_stream);
+		bool	   next_large_block	(pPersistedLargeStream p_stream);
+		StatusCode flush_large		(pPersistedLargeStream p_stream);
 
 		// Internal dbi management
 
@@ -236,6 +699,15 @@ class Persisted : public Container {
 #endif
 
 		DBImap			 source_dbi = {};		///< The lmdb MDB_dbi handles for each source.
+		IndexDBImap		 index_dbi = {};		///< The lmdb MDB_dbi handles for each secondary index.
+		EntityCodecs	 entity_codec = {};		///< The codec of the sources not using the default_codec.
+		DedupEntities	 dedup_entity = {};		///< The sources whose blocks are deduplicated.
+		MDB_dbi			 dedup_dbi = INVALID_MDB_DBI;	///< The lmdb MDB_dbi handle of PERSISTED_DEDUP_DBI (if it exists).
+		Snapshots		 snapshots = {};		///< The open snapshots by id.
+		int64_t			 last_snapshot = 0;		///< The id of the last snapshot created.
+		int				 snapshot_max_seconds = PERSISTED_SNAPSHOT_MAX_SECONDS;	///< The longest life of a snapshot (MDB_SNAPSHOT_MAX_SECONDS)
+		int				 snapshot_max_count = PERSISTED_SNAPSHOT_MAX_COUNT;		///< The maximum of open snapshots (MDB_SNAPSHOT_MAX_COUNT)
+		int				 default_codec = PERSISTED_CODEC_NONE;	///< The codec for sources not in entity_codec (MDB_COMPRESSION)
 		JazzLmdbOptions  lmdb_opt;				///< The LMDB options
 		MDB_env		    *lmdb_env = nullptr;	///< The LMDB environment
 };
@@ -38,6 +38,91 @@
 namespace jazz_elements
 {
 
+static std::atomic<uint64_t> is_a_cache[IS_A_CACHE_SLOTS] = {};		///< The (kind, tuple) keys (see is_a_key()) of successful is_a() checks
+
+
+/** The key of a pair (Kind, Tuple) in is_a_cache[], 0 if any of them has no hash64.
+*/
+inline uint64_t is_a_key(uint64_t kind_hash, uint64_t tuple_hash) {
+	if (kind_hash == 0 || tuple_hash == 0)
+		return 0;
+
+	uint64_t key = kind_hash ^ (tuple_hash*0x9e3779b97f4a7c15ULL + (kind_hash >> 17));
+
+	return key == 0 ? 1 : key;
+}
+
+
+/** Verifies if a Tuple is of a Kind.
+
+	\param kind		 The possibly matching Kind.
+	\param use_cache If true, the caller guarantees the hash64 of both blocks is the hash of their current content (the blocks were
+					 close_block()-ed after the last change or passed check_hash()) and successful checks are looked up and kept in a
+					 cache keyed by both hashes. Otherwise (the default), the full check is always done.
+
+	\return True if the Tuple can be linked to a Kind (regardless of BLOCK_ATTRIB_KIND)
+
+The cache is small and lock-free (direct-mapped, a newer pair simply overwrites its slot). It is opt-in because a block edited in place
+keeps its old hash64, and a cache hit on a stale hash would approve a Tuple without checking what it is now.
+*/
+bool Tuple::is_a(pKind kind, bool use_cache) {
+	if (kind->cell_type != CELL_TYPE_TUPLE_KIND || kind->size != size || size > MAX_ITEMS_IN_KIND)
+		return false;
+
+	uint64_t key = use_cache ? is_a_key(kind->hash64, hash64) : 0;
+
+	if (key != 0 && is_a_cache[key & (IS_A_CACHE_SLOTS - 1)].load(std::memory_order_relaxed) == key)
+		return true;
+
+	struct {
+		int	  name;
+		int	  value;
+	} dimension[MAX_ITEMS_IN_KIND*MAX_TENSOR_RANK];
+
+	int num_dimensions = 0;
+
+	for (int i = 0; i < size; i++) {
+		if (  kind->tensor.cell_item[i].cell_type != tensor.cell_item[i].cell_type
+			|| kind->tensor.cell_item[i].rank	  != tensor.cell_item[i].rank)
+			return false;
+
+		if (strcmp(kind->item_name(i), item_name(i)))
+			return false;
+
+		for (int j = 0; j < tensor.cell_item[i].rank; j++) {
+			int d_k = kind->tensor.cell_item[i].dim[j];
+
+			if (d_k < 0) {
+				pChar dim_name = reinterpret_cast<pChar>(&kind->p_string_buffer()->buffer[-d_k]);
+
+				int k = 0;
+
+				while (   k < num_dimensions && dimension[k].name != -d_k		// Names are usually stored once: compare offsets first
+					   && strcmp(reinterpret_cast<pChar>(&kind->p_string_buffer()->buffer[dimension[k].name]), dim_name) != 0)
+					k++;
+
+				if (k < num_dimensions) {
+					if (dimension[k].value != tensor.cell_item[i].dim[j])
+						return false;
+				} else {
+					dimension[num_dimensions].name	= -d_k;
+					dimension[num_dimensions].value = tensor.cell_item[i].dim[j];
+					num_dimensions++;
+				}
+			} else {
+				if (d_k != tensor.cell_item[i].dim[j])
+					return false;
+			}
+		}
+	}
+
+	if (key != 0)
+		is_a_cache[key & (IS_A_CACHE_SLOTS - 1)].store(key, std::memory_order_relaxed);
+
+	return true;
+}
+
+
 /** Check the internal validity of a Tuple (item structure, dimensions, etc.)
 
 	\return MIXED_TYPE_INVALID on error or MIXED_TYPE_TUPLE if every check passes ok.
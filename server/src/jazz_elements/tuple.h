@@ -33,6 +33,7 @@
 
 
 #include <map>
+#include <atomic>
 
 
 #include "src/jazz_elements/kind.h"
@@ -54,6 +55,8 @@
 namespace jazz_elements
 {
 
+#define IS_A_CACHE_SLOTS		256		///< The slots in the cache of successful Tuple::is_a() checks (a power of 2).
+
 /** \brief Tuple: A Jazz Block with multiple Tensors.
 
 Can be simplified as "An instance of a **Kind**" although that is not exactly what it is. It is an array of Tensors and it can match
@@ -79,6 +82,9 @@ Creating Tuples
 More advanced Tuple functionalities (including other ways of creating tuples) can be done by Containers. This class, has a minimum
 functionality to build Tuples: new_tuple() to do the basic building. It does not includes creating Tuples from other Tuples by appending the names.
 
+new_tuple() has two forms: one copies existing Blocks into the Tuple, the other lays out the items from an array of ItemHeader and leaves
+them ready to be filled in place (via get_block()) and closed with close_tuple(). The latter avoids building every item twice.
+
 Using Tuples
 ------------
 
@@ -86,7 +92,8 @@ Like any Block, it is a moveable structure that can be edited by this class. Cha
 just a Block. Note:
 
 - It has a new method, .block(item), that returns the address of an item.
-- It has an is_a() method that verifies if it satisfies a Kind.
+- It has an is_a() method that verifies if it satisfies a Kind. Callers that know the hash64 of both blocks matches their content (just
+close_block()-ed or check_hash()-ed) can opt in to a cache of successful checks, so validating the same pair again is free.
 - It has an audit() method to check validity.
 - Besides that, it is just a "big Block" whose header has a **total_bytes** that includes all the metadata and data.
 
@@ -181,6 +188,134 @@ class Tuple : public Block {
 			return SERVICE_NO_ERROR;
 		}
 
+		/** Initializes a Tuple object in place: Lays out the items without copying any tensor.
+
+			\param num_items	 The number of items the Tuple will have == size of the p_items-> and p_names->
+			\param p_items	 An array of ItemHeader with the cell_type, rank and (human-readable) dim of each item.
+			\param p_names	 An array of Name by which the items will go.
+			\param p_str_bytes An (optional) array with the size of the string buffer reserved for each item (see item_total_bytes()).
+			\param num_bytes	 The size in bytes allocated. Should be enough for all names, items, ItemHeaders and attributes.
+			\param att		 The attributes for the Tuple. Set "as is", without adding BLOCK_ATTRIB_BLOCKTYPE or anything.
+
+			\return			 0, SERVICE_ERROR_NO_MEM, SERVICE_ERROR_WRONG_TYPE, SERVICE_ERROR_WRONG_NAME, SERVICE_ERROR_WRONG_ARGUMENTS
+
+			Unlike the other new_tuple(), this does not require the items to exist as Blocks. Each item is initialized, like new_block()
+			with FILL_NEW_DONT_FILL would do, at its final place in the Tuple. The caller fills the tensors (and the string buffers via
+			Block.set_string()) through get_block() and finishes with close_tuple().
+		*/
+		inline StatusCode new_tuple(int			  num_items,
+									ItemHeader	  p_items[],
+									Name		  p_names[],
+									int			  p_str_bytes[],
+									int			  num_bytes,
+									AttributeMap *att = nullptr) {
+
+			if (num_items < 1 || num_items > MAX_ITEMS_IN_KIND)
+				return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+			int rq_sz = sizeof(BlockHeader) + sizeof(StringBuffer) + num_items*sizeof(ItemHeader) + 2*num_items;
+
+			if (att != nullptr)
+				rq_sz += 2*att->size();
+
+			if (num_bytes < rq_sz)
+				return SERVICE_ERROR_NO_MEM;
+
+			memset(&cell_type, 0, rq_sz);
+
+			cell_type	 = CELL_TYPE_TUPLE;
+			rank		 = 1;
+			range.dim[0] = 1;
+			size		 = num_items;
+			total_bytes	 = num_bytes;
+
+			set_attributes(att);
+
+			pStringBuffer psb = p_string_buffer();
+
+			for (int i = 0; i < num_items; i++) {
+				ItemHeader *p_it_hea = &tensor.cell_item[i];
+
+				if ((p_items[i].cell_type & 0xff) > 8 || (p_items[i].cell_type & 0xff) == 0)
+					return SERVICE_ERROR_WRONG_TYPE;
+
+				pChar p_name = (pChar) &p_names[i];
+
+				if (!valid_name(p_name))
+					return SERVICE_ERROR_WRONG_NAME;
+
+				p_it_hea->cell_type = p_items[i].cell_type;
+				p_it_hea->name		= get_string_offset(psb, p_name);
+
+				if (p_it_hea->name <= STRING_EMPTY)
+					return SERVICE_ERROR_NO_MEM;
+			}
+
+			int *p_dest = align64bit((uintptr_t) &psb->buffer[psb->last_idx]);
+
+			psb->buffer_size = (uintptr_t) p_dest - ((uintptr_t) &psb->buffer[0]);
+
+			for (int i = 0; i < num_items; i++) {
+				ItemHeader *p_it_hea = &tensor.cell_item[i];
+
+				p_it_hea->data_start = (uintptr_t) p_dest - (uintptr_t) &tensor;
+
+				int item_bytes = item_total_bytes(p_items[i].cell_type, p_items[i].dim, p_str_bytes == nullptr ? 0 : p_str_bytes[i]);
+
+				if ((uintptr_t) p_dest - (uintptr_t) &cell_type + item_bytes > num_bytes)
+					return SERVICE_ERROR_NO_MEM;
+
+				pBlock p_block = (pBlock) p_dest;
+
+				memset(p_block, 0, sizeof(BlockHeader));
+
+				p_block->cell_type = p_items[i].cell_type;
+				p_block->set_dimensions(p_items[i].dim);
+				p_block->total_bytes = item_bytes;
+				p_block->has_NA		 = p_block->cell_type != CELL_TYPE_BYTE;
+
+				p_block->set_attributes(nullptr);
+
+				p_it_hea->rank = p_block->rank;
+				p_block->get_dimensions((int *) &p_it_hea->dim);
+
+				p_dest = align64bit((uintptr_t) p_dest + item_bytes);
+			}
+
+			return SERVICE_NO_ERROR;
+		}
+
+		/** The total_bytes of an item Block (without attributes) as the in-place new_tuple() lays it out.
+
+			\param cell_type	 The cell type of the item.
+			\param p_dim		 The (human-readable) dimensions of the item.
+			\param str_bytes	 The size of the string buffer to reserve (beyond its 4 initial bytes) for the item.
+
+			\return			 The size in bytes, exactly what new_block() would allocate for an item created with stringbuff_size.
+		*/
+		static inline int item_total_bytes(int cell_type, int *p_dim, int str_bytes = 0) {
+			StaticBlockHeader hea;
+
+			hea.cell_type	   = cell_type;
+			hea.num_attributes = 0;
+
+			reinterpret_cast<pBlock>(&hea)->set_dimensions(p_dim);
+
+			return (uintptr_t) reinterpret_cast<pBlock>(&hea)->p_string_buffer() - (uintptr_t) (&hea) + sizeof(StringBuffer) + 4
+				   + str_bytes;
+		}
+
+		/** Closes a Tuple created in place: Calls close_block() on all the items and on the Tuple itself.
+
+			\param set_has_NA	The set_has_NA argument forwarded to the close_block() of each item.
+		*/
+		inline void close_tuple(int set_has_NA = SET_HAS_NA_FALSE) {
+			for (int i = 0; i < size; i++)
+				get_block(i)->close_block(set_has_NA);
+
+			close_block();
+		}
+
 		/** Get the name for an item of a Tuple by index without checking index range.
 
 			\param idx The index of the item.
@@ -201,6 +336,8 @@ class Tuple : public Block {
 			\param name The name of the item.
 
 			\return A invalid index or -1 for "not found".
+
+			NOTE: This is a linear search. To find many names in the same Tuple, build an ItemNameTable.
 		*/
 		inline int index(pChar name) {
 			for (int idx = 0; idx < size; idx++)
@@ -227,47 +364,7 @@ class Tuple : public Block {
 
 	// Tuple/Kind specific methods:
 
-		/** Verifies if a Tuple is of a Kind.
-
-			\param kind The possibly matching Kind.
-
-			\return True if the Tuple can be linked to a Kind (regardless of BLOCK_ATTRIB_KIND)
-		*/
-		inline bool is_a(pKind kind) {
-			if (kind->cell_type != CELL_TYPE_TUPLE_KIND || kind->size != size)
-				return false;
-
-			std::map<String, int> dimension;
-
-			for (int i = 0; i < size; i++) {
-				if (  kind->tensor.cell_item[i].cell_type != tensor.cell_item[i].cell_type
-					|| kind->tensor.cell_item[i].rank	  != tensor.cell_item[i].rank)
-					return false;
-
-				if (strcmp(kind->item_name(i), item_name(i)))
-					return false;
-
-				for (int j = 0; j < tensor.cell_item[i].rank; j++) {
-					int d_k = kind->tensor.cell_item[i].dim[j];
-
-					if (d_k < 0) {
-						String dim_name(reinterpret_cast<char *>(&kind->p_string_buffer()->buffer[-d_k]));
-						if (dimension.count(dim_name)) {
-							if (dimension[dim_name] != tensor.cell_item[i].dim[j])
-								return false;
-						} else {
-							dimension[dim_name] = tensor.cell_item[i].dim[j];
-						}
-					} else {
-						if (d_k != tensor.cell_item[i].dim[j])
-							return false;
-					}
-				}
-			}
-
-			return true;
-		}
-
+		bool is_a(pKind kind, bool use_cache = false);
 		int audit();
 };
 typedef Tuple *pTuple;		///< A pointer to a Tuple object
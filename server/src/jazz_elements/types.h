@@ -160,6 +160,7 @@ at [host]/develop/rfc2/jazz_actor_model.html
 #define BLOCK_ATTRIB_MIMETYPE		4		///< HTTP static API: The mime type (can be anything. E.g., "Adobe PhotoShop Image")
 #define BLOCK_ATTRIB_URL			5		///< HTTP static API: A url for the server to expose the file by.
 #define BLOCK_ATTRIB_LANGUAGE		6		///< HTTP static API: An http language identifier that will be returned in an API GET call.
+#define BLOCK_ATTRIB_CACHE_CTRL		7		///< HTTP API: A Cache-Control value overriding the configured default of the base.
 
 #define BLOCK_ATTRIB_BASE_BOP	  100		///< Base for block attributes in the namespace jazz_bebop. (Defined outside jazz_elements.)
 #define BLOCK_ATTRIB_BASE_MODELS  200		///< Base for block attributes in the namespace jazz_models. (Defined outside jazz_elements.)
@@ -172,6 +173,24 @@ at [host]/develop/rfc2/jazz_actor_model.html
 #define SET_HAS_NA_TRUE			1			///< Set to true without checking
 #define SET_HAS_NA_AUTO			2			///< Check if there are and set accordingly (slowest option when closing, best later)
 
+/// Values for BlockHeader.hash_scheme: how close_block() computed the hash64 that check_hash() verifies
+
+#define HASH_SCHEME_
+
+#define HASH_SCHEME_MURMUR64A	0			///< MurmurHash64A() of everything but the header (the default and what older blocks have)
+#define HASH_SCHEME_CRC32C		1			///< Crc32cHash64(): Two CRC32C, computed by the crc32c instruction (SSE4.2 or ARMv8) if any
+#define HASH_SCHEME_TREE		2			///< TreeHash64(): A hash of the hashes of chunks, computed by several threads
+
+#define HASH_TREE_CHUNK_BYTES	(1 << 20)	///< The chunk size of TreeHash64(). (The hash does not depend on the number of threads.)
+#define HASH_TREE_MAX_THREADS	16			///< The maximum number of threads used by TreeHash64()
+
+/// The large block format (see LargeBlockHeader)
+
+#define LARGE_BLOCK_
+
+#define LARGE_BLOCK_FLAG	  0x10000		///< Set in LargeBlockHeader.cell_type. No Block has a cell_type with this bit.
+#define LARGE_BLOCK_VERSION		1			///< The current value of LargeBlockHeader.version
+
 
 typedef std::chrono::steady_clock::time_point TimePoint;	///< A time point stored as 8 bytes
 
@@ -255,6 +274,7 @@ struct BlockHeader {
 			int num_attributes;			///< Number of elements in the JazzAttributesMap
 			int total_bytes;			///< Total size of the block everything included
 			bool has_NA;				///< If true, at least one value in the tensor is a NA and block requires NA-aware arithmetic
+			uint8_t hash_scheme;		///< How hash64 was computed. See HASH_SCHEME_* (uses the padding before hash64)
 			uint64_t hash64;			///< Hash of everything but the header
 
 			Tensor tensor;				///< A tensor for type cell_type and dimensions set by Block.set_dimensions()
@@ -276,6 +296,7 @@ struct StaticBlockHeader {
 	int num_attributes;					///< Number of elements in the JazzAttributesMap
 	int total_bytes;					///< Total size of the block everything included
 	bool has_NA;						///< If true, at least one value is a NA and block requires NA-aware arithmetic
+	uint8_t hash_scheme;				///< How hash64 was computed. See HASH_SCHEME_* (uses the padding before hash64)
 	uint64_t hash64;					///< Hash of everything but the header
 
 	Tensor tensor;						///< A tensor for type cell_type and dimensions set by Block.set_dimensions()
@@ -294,6 +315,25 @@ struct StringBuffer {
 typedef StringBuffer *pStringBuffer;	///< A pointer to a StringBuffer
 
 
+/** \brief The header of a tensor in the large block format, used to move tensors above the 2 Gb limit of a Block.
+
+A large block is this header followed by .tensor_bytes of tensor data (in the same order as a Block). Its first field is at the same
+offset as StaticBlockHeader.cell_type but has LARGE_BLOCK_FLAG set, so the first four bytes tell both formats apart and existing blocks
+are read as they always were. Only tensors of cells of a fixed size (no strings, Tuples, Kinds or Index) have a large format.
+See Persisted::get_large() and Channels::get_large().
+*/
+struct LargeBlockHeader {
+	int		cell_type;					///< The cell_type of the tensor | LARGE_BLOCK_FLAG
+	int		version;					///< LARGE_BLOCK_VERSION
+	int		rank;						///< The number of dimensions
+	int		reserved;					///< Always zero
+	int64_t	dim[MAX_TENSOR_RANK];		///< The shape of the tensor. (dim[rank] .. are zero.)
+	int64_t	size;						///< The total number of cells in the tensor
+	int64_t	tensor_bytes;				///< The number of bytes following the header: .size*(cell_type & 0xff)
+};
+typedef LargeBlockHeader *pLargeBlockHeader;	///< A pointer to a LargeBlockHeader
+
+
 extern float  F_NA;				///< NaN in single
 extern double R_NA;				///< NaN in double (binary R-compatible)
 
@@ -32,6 +32,17 @@
 */
 
 
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+
 #include "src/jazz_elements/utils.h"
 
 
@@ -289,6 +300,150 @@ uint64_t MurmurHash64A(const void *key, int len) {
 }
 
 
+/// The CRC32C (Castagnoli, reflected polynomial 0x82F63B78) table used when the cpu has no crc32c instruction.
+uint32_t crc32c_lut[256];
+
+
+/** Fill crc32c_lut[] and detect if the cpu has a crc32c instruction (SSE4.2 or ARMv8 CRC).
+
+	\return True if Crc32cHash64() can use the instruction.
+*/
+bool crc32c_init() {
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+
+		for (int k = 0; k < 8; k++)
+			c = (c >> 1) ^ (0x82F63B78 & (0 - (c & 1)));
+
+		crc32c_lut[i] = c;
+	}
+
+#if defined(__x86_64__)
+	return __builtin_cpu_supports("sse4.2");
+#elif defined(__aarch64__)
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+	return false;
+#endif
+}
+
+
+bool crc32c_has_hardware = crc32c_init();	///< The cpu has a crc32c instruction (also: crc32c_lut[] is ready).
+
+
+/** The crc32c of two buffers of the same size in one loop, 8 bytes at a time (exactly as the table driven loop in Crc32cHash64()).
+
+	\param crc_a	The crc of the first buffer, updated.
+	\param crc_b	The crc of the second buffer, updated.
+	\param p_a		The first buffer (of n*8 bytes).
+	\param p_b		The second buffer (of n*8 bytes).
+	\param n		The number of uint64_t in each buffer.
+*/
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) void crc32c_hw(uint64_t &crc_a, uint64_t &crc_b, const uint64_t *p_a, const uint64_t *p_b, int n) {
+	uint64_t a = crc_a, b = crc_b;
+
+	for (int i = 0; i < n; i++) {
+		a = _mm_crc32_u64(a, p_a[i]);
+		b = _mm_crc32_u64(b, p_b[i]);
+	}
+	crc_a = a;
+	crc_b = b;
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crc"))) void crc32c_hw(uint64_t &crc_a, uint64_t &crc_b, const uint64_t *p_a, const uint64_t *p_b, int n) {
+	uint32_t a = crc_a, b = crc_b;
+
+	for (int i = 0; i < n; i++) {
+		a = __crc32cd(a, p_a[i]);
+		b = __crc32cd(b, p_b[i]);
+	}
+	crc_a = a;
+	crc_b = b;
+}
+#endif
+
+
+/** \brief A 64-bit checksum made of two CRC32C of the two halves of a buffer.
+
+	The halves are computed in the same loop as two independent streams. The crc32c instruction has a latency of three cycles but
+	a throughput of one per cycle, so two streams run at almost twice the speed of one. When the cpu has no crc32c instruction
+	(or use_hardware is false), the same values are computed with a table.
+
+	\param key			The address of the memory block to hash.
+	\param len			The number of bytes to hash.
+	\param use_hardware	(optional) False forces the table driven version (used for testing).
+
+	\return	The crc32c of the first half in the high 32 bits, the crc32c of the rest in the low 32 bits.
+
+This is what HASH_SCHEME_CRC32C stores in the hash64 of a Block. It detects corruption as well as a hash, but it is not a hash.
+*/
+uint64_t Crc32cHash64(const void *key, int len, bool use_hardware) {
+	int		  n_half = len >> 4;
+	uint64_t  crc_a	 = 0xffffffff, crc_b = 0xffffffff;
+	const uint64_t *p_a = reinterpret_cast<const uint64_t *>(key), *p_b = p_a + n_half;
+
+#if defined(__x86_64__) || defined(__aarch64__)
+	if (use_hardware && crc32c_has_hardware) {
+		crc32c_hw(crc_a, crc_b, p_a, p_b, n_half);
+	} else
+#endif
+	{
+		const uint8_t *p_ba = reinterpret_cast<const uint8_t *>(p_a), *p_bb = reinterpret_cast<const uint8_t *>(p_b);
+
+		for (int i = 0; i < 8*n_half; i++) {
+			crc_a = (crc_a >> 8) ^ crc32c_lut[(crc_a ^ p_ba[i]) & 0xff];
+			crc_b = (crc_b >> 8) ^ crc32c_lut[(crc_b ^ p_bb[i]) & 0xff];
+		}
+	}
+
+	const uint8_t *p_tail = reinterpret_cast<const uint8_t *>(p_b + n_half);
+
+	for (int i = 16*n_half; i < len; i++)
+		crc_b = (crc_b >> 8) ^ crc32c_lut[(crc_b ^ *(p_tail++)) & 0xff];
+
+	return ((crc_a ^ 0xffffffff) << 32) | (crc_b ^ 0xffffffff);
+}
+
+
+/** \brief A tree hash: The MurmurHash64A of the MurmurHash64A of the HASH_TREE_CHUNK_BYTES chunks of a buffer.
+
+	\param key			The address of the memory block to hash.
+	\param len			The number of bytes to hash.
+	\param num_threads	(optional) The number of parts the chunks are split in. The default (0) is Pool::num_threads() up to
+						HASH_TREE_MAX_THREADS.
+
+	\return	 The 64-bit hash. It does not depend on the number of threads.
+
+This is what HASH_SCHEME_TREE stores in the hash64 of a Block. The parts are hashed by the running Pool (in the calling thread if none
+is running). Buffers of one chunk are hashed in the calling thread.
+*/
+uint64_t TreeHash64(const void *key, int len, int num_threads) {
+	int num_chunks = (len + HASH_TREE_CHUNK_BYTES - 1)/HASH_TREE_CHUNK_BYTES;
+
+	std::vector<uint64_t> chunk_hash(num_chunks);
+
+	if (num_threads <= 0)
+		num_threads = std::min(Pool::num_threads(), HASH_TREE_MAX_THREADS);
+
+	num_threads = std::max(1, std::min(num_threads, num_chunks));
+
+	auto hash_chunks = [&](int t) {
+		int i_end = (int) (((int64_t) num_chunks*(t + 1))/num_threads);
+
+		for (int i = (int) (((int64_t) num_chunks*t)/num_threads); i < i_end; i++) {
+			int offset = i*HASH_TREE_CHUNK_BYTES;
+
+			chunk_hash[i] = MurmurHash64A((const uint8_t *) key + offset, std::min(HASH_TREE_CHUNK_BYTES, len - offset));
+		}
+	};
+
+	Pool::parallel_for(0, num_threads, hash_chunks);
+
+	return MurmurHash64A(chunk_hash.data(), num_chunks*sizeof(uint64_t));
+}
+
+
 /** \brief Remove quotes and (space and tab) outside quotes from a string.
 
 	Removes space and tab characters except inside a string declared with a double quote '"'. After doing that,
@@ -698,6 +853,387 @@ StatusCode Service::shut_down() {
 	return SERVICE_NOT_IMPLEMENTED;
 }
 
+/*	-----------------------------------------------
+	 TaskGroup : I m p l e m e n t a t i o n
+--------------------------------------------------- */
+
+/** Submit a task to the running Pool.
+
+	\param work	The task. It runs in the calling thread when no Pool is running or the Pool has no workers.
+*/
+void TaskGroup::run(const std::function<void()> &work) {
+
+	if (p_pool == nullptr)
+		p_pool = Pool::p_running;
+
+	if (p_pool != nullptr)
+		p_pool->check_fork();
+
+	if (p_pool == nullptr || p_pool->num_workers == 0) {
+		work();
+
+		return;
+	}
+
+	PoolTask task = {work, this};
+
+	pending++;
+
+	p_pool->submit(task);
+}
+
+
+/** Wait until all the tasks submitted by run() are done, running tasks of the Pool meanwhile.
+*/
+void TaskGroup::wait() {
+
+	while (pending > 0) {
+		if (!p_pool->run_one())
+			std::this_thread::yield();
+	}
+}
+
+/*	-----------------------------------------------
+	 Pool : I m p l e m e n t a t i o n
+--------------------------------------------------- */
+
+std::atomic<pPool> Pool::p_running = {nullptr};
+thread_local int   Pool::worker_index = -1;
+
+
+/** Initialize the Pool without starting it.
+
+	\param a_logger	A Logger.
+	\param a_config A ConfigFile (where POOL_NUM_THREADS is optional) or nullptr for the defaults.
+*/
+Pool::Pool(pLogger a_logger, pConfigFile a_config) : Service(a_logger, a_config) {
+	queued	 = 0;
+	stopping = false;
+}
+
+
+Pool::~Pool() {
+	if (num_workers > 0)
+		shut_down();
+}
+
+
+/** Return object ID.
+
+	\return A string identifying the object that is especially useful to track uplifts and versions.
+*/
+pChar const Pool::id() {
+    static char arr[] = "Pool from Jazz-" JAZZ_VERSION;
+    return arr;
+}
+
+
+/** Start the worker threads and make this the Pool running the parallel parts of all requests.
+
+	\return SERVICE_NO_ERROR if successful, SERVICE_ERROR_BAD_CONFIG for a wrong POOL_NUM_THREADS or SERVICE_ERROR_STARTING if
+			another Pool is already running.
+
+	POOL_NUM_THREADS (optional) is the number of workers from 1 to JAZZ_MAX_NUM_THREADS. The default (0) is the number of cores
+	minus one.
+*/
+StatusCode Pool::start() {
+
+	int num = 0;
+
+	get_conf_key("POOL_NUM_THREADS", num);
+
+	if (num < 0 || num > JAZZ_MAX_NUM_THREADS) {
+		log_printf(LOG_ERROR, "Pool::start() POOL_NUM_THREADS = %i is out of range.", num);
+
+		return SERVICE_ERROR_BAD_CONFIG;
+	}
+
+	if (p_running == this)
+		shut_down();
+	else if (p_running != nullptr) {
+		log(LOG_ERROR, "Pool::start() failed: another Pool is already running.");
+
+		return SERVICE_ERROR_STARTING;
+	}
+
+	if (num == 0)
+		num = std::max(0, std::min((int) std::thread::hardware_concurrency() - 1, JAZZ_MAX_NUM_THREADS));
+
+	static std::once_flag at_fork;
+
+	std::call_once(at_fork, []() { pthread_atfork(&Pool::fork_prepare, &Pool::fork_parent, &Pool::fork_child); });
+
+	num_workers = num;
+
+	start_workers();
+
+	p_running = this;
+
+	log_printf(LOG_INFO, "Pool started with %i worker threads.", num_workers);
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Stop the worker threads once all the queued tasks are done.
+
+	\return SERVICE_NO_ERROR.
+
+	Tasks submitted after this (by groups that still point to this Pool) are run by the threads waiting for them.
+*/
+StatusCode Pool::shut_down() {
+
+	pPool p_this = this;
+
+	p_running.compare_exchange_strong(p_this, nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_lock);
+
+		stopping = true;
+	}
+	wake_up.notify_all();
+
+	for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+		it->join();
+
+	workers.clear();
+	num_workers = 0;
+	owner_pid	= 0;
+
+	log(LOG_INFO, "Pool stopped.");
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** The number of threads available for the parallel parts of a request.
+
+	\return	The number of workers of the running Pool plus one (the calling thread), 1 when no Pool is running.
+*/
+int Pool::num_threads() {
+
+	pPool p_pool = p_running;
+
+	if (p_pool == nullptr)
+		return 1;
+
+	p_pool->check_fork();
+
+	return p_pool->num_workers + 1;
+}
+
+
+/** Call body(i) for all i in [first, last) splitting the range in parts run by the Pool.
+
+	\param first	The first index.
+	\param last		The index after the last one.
+	\param body		The function called for each index. Different parts run concurrently, it must be thread safe.
+	\param grain	(optional) The minimum number of indices in a part.
+
+The range is split in up to num_threads() contiguous parts of similar size. The calling thread runs the first one and returns when all
+are done. Without a running Pool, it is a plain loop.
+*/
+void Pool::parallel_for(int first, int last, const std::function<void(int)> &body, int grain) {
+
+	int size = last - first;
+
+	if (size <= 0)
+		return;
+
+	grain = std::max(1, grain);
+
+	int num_parts = std::min(num_threads(), (size + grain - 1)/grain);
+
+	auto run_part = [first, size, num_parts, &body](int part) {
+		int i_end = first + (int) ((int64_t) size*(part + 1)/num_parts);
+
+		for (int i = first + (int) ((int64_t) size*part/num_parts); i < i_end; i++)
+			body(i);
+	};
+
+	TaskGroup group;
+
+	for (int part = 1; part < num_parts; part++)
+		group.run([&run_part, part]() { run_part(part); });
+
+	run_part(0);
+
+	group.wait();
+}
+
+
+/** Push a task in the queue of the calling thread and wake up a worker.
+
+	\param task	The task (moved into the queue).
+*/
+void Pool::submit(PoolTask &task) {
+
+	PoolQueue &own = queue[worker_index >= 0 ? worker_index : JAZZ_MAX_NUM_THREADS];
+
+	queued++;
+	{
+		std::lock_guard<std::mutex> lock(own.lock);
+
+		own.tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_lock);
+	}
+	wake_up.notify_one();
+}
+
+
+/** Run one queued task: the newest of the own queue, else the oldest of the shared queue, else one stolen from another worker.
+
+	\return	False if all the queues were empty.
+*/
+bool Pool::run_one() {
+
+	PoolTask task;
+	bool	 found = false;
+	int		 self  = worker_index;
+	int		 num   = num_workers;
+
+	if (self >= 0) {
+		std::lock_guard<std::mutex> lock(queue[self].lock);
+
+		if ((found = !queue[self].tasks.empty())) {
+			task = std::move(queue[self].tasks.back());
+			queue[self].tasks.pop_back();
+		}
+	}
+
+	for (int k = -1; !found && k < num; k++) {
+		int victim = k < 0 ? JAZZ_MAX_NUM_THREADS : (std::max(self, 0) + k) % num;
+
+		if (victim == self)
+			continue;
+
+		std::lock_guard<std::mutex> lock(queue[victim].lock);
+
+		if ((found = !queue[victim].tasks.empty())) {
+			task = std::move(queue[victim].tasks.front());
+			queue[victim].tasks.pop_front();
+		}
+	}
+
+	if (!found)
+		return false;
+
+	queued--;
+
+	task.work();
+
+	task.p_group->pending--;
+
+	return true;
+}
+
+
+/** Start num_workers worker threads owned by the calling process (unless they are already running in it).
+*/
+void Pool::start_workers() {
+
+	std::lock_guard<std::mutex> lock(spawn_lock);
+
+	if (owner_pid == getpid())
+		return;
+
+	stopping = false;
+
+	for (int i = 0; i < num_workers; i++)
+		workers.push_back(std::thread(&Pool::worker, this, i));
+
+	owner_pid = getpid();
+}
+
+
+/** Called by fork() in the parent before forking: take all the locks of the running Pool so the child gets consistent queues.
+*/
+void Pool::fork_prepare() {
+
+	pPool p_pool = p_running;
+
+	if (p_pool == nullptr)
+		return;
+
+	p_pool->spawn_lock.lock();
+	p_pool->sleep_lock.lock();
+
+	for (int i = 0; i <= JAZZ_MAX_NUM_THREADS; i++)
+		p_pool->queue[i].lock.lock();
+}
+
+
+/** Called by fork() in the parent after forking: release the locks taken by fork_prepare().
+*/
+void Pool::fork_parent() {
+
+	pPool p_pool = p_running;
+
+	if (p_pool == nullptr)
+		return;
+
+	for (int i = JAZZ_MAX_NUM_THREADS; i >= 0; i--)
+		p_pool->queue[i].lock.unlock();
+
+	p_pool->sleep_lock.unlock();
+	p_pool->spawn_lock.unlock();
+}
+
+
+/** Called by fork() in the child: forget the workers of the parent, which do not exist in this process.
+
+The handles of the threads are moved to a vector that is never destroyed (joining or detaching them is undefined). The queued tasks
+belong to groups waited for by threads of the parent, they are dropped. The condition variable is rebuilt since its state counts the
+workers of the parent sleeping on it. The workers of the child are started by check_fork().
+*/
+void Pool::fork_child() {
+
+	pPool p_pool = p_running;
+
+	if (p_pool == nullptr)
+		return;
+
+	new std::vector<std::thread>(std::move(p_pool->workers));
+
+	p_pool->workers.clear();
+
+	for (int i = JAZZ_MAX_NUM_THREADS; i >= 0; i--) {
+		p_pool->queue[i].tasks.clear();
+		p_pool->queue[i].lock.unlock();
+	}
+	p_pool->queued = 0;
+
+	new (&p_pool->wake_up) std::condition_variable();
+
+	p_pool->sleep_lock.unlock();
+	p_pool->spawn_lock.unlock();
+}
+
+
+/** The loop of a worker thread: run tasks while there are any, sleep when there are none, exit when stopping with no tasks.
+
+	\param self	The index of the worker (and its PoolQueue).
+*/
+void Pool::worker(int self) {
+
+	worker_index = self;
+
+	while (true) {
+		if (run_one())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleep_lock);
+
+		wake_up.wait(lock, [this]() { return stopping || queued > 0; });
+
+		if (stopping && queued == 0)
+			return;
+	}
+}
+
 } // namespace jazz_elements
 
 #ifdef CATCH_TEST
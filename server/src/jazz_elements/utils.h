@@ -32,10 +32,17 @@
 */
 
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <string.h>
 
@@ -146,6 +153,8 @@ bool		 FileExists			  (const char* file_name);
 char		*ExpandEscapeSequences(char *buff);
 pid_t		 FindProcessIdByName  (const char *name);
 uint64_t	 MurmurHash64A		  (const void *key, int len);
+uint64_t	 Crc32cHash64		  (const void *key, int len, bool use_hardware = true);
+uint64_t	 TreeHash64			  (const void *key, int len, int num_threads = 0);
 String		 CleanConfigArgument  (String s);
 
 
@@ -362,6 +371,135 @@ class Service {
 };
 typedef Service *pService;		///< A pointer to a Service object
 
+
+class Pool;
+typedef Pool *pPool;			///< A pointer to a Pool object
+
+
+/** \brief A set of tasks submitted to the running Pool that can be waited for as a whole.
+
+	run() submits a task to the running Pool (or just runs it when no Pool is running) and wait() returns when all the tasks submitted
+	by the group are done. The thread that waits does not sleep: it runs tasks from the Pool meanwhile, so tasks can create groups of
+	their own and wait for them without deadlocks. The destructor waits, a group never outlives its tasks.
+*/
+class TaskGroup {
+
+	public:
+
+		 TaskGroup() { p_pool = nullptr; pending = 0; }
+		~TaskGroup() { wait(); }
+
+		void run (const std::function<void()> &work);
+		void wait();
+
+	private:
+
+		friend class Pool;
+
+		pPool			 p_pool;	///< The Pool running the tasks of this group (the running Pool when the first task was submitted)
+		std::atomic<int> pending;	///< The number of tasks submitted and not yet done
+};
+typedef TaskGroup *pTaskGroup;	///< A pointer to a TaskGroup object
+
+
+/// A task waiting in a PoolQueue
+struct PoolTask {
+	std::function<void()> work;		///< The task
+	pTaskGroup			  p_group;	///< The TaskGroup waiting for it
+};
+
+
+/// The queue of tasks owned by a worker thread of a Pool
+struct PoolQueue {
+	std::mutex			 lock;		///< Taken by the owner and the thieves
+	std::deque<PoolTask> tasks;		///< The owner pushes and pops at the back, thieves steal from the front
+};
+
+
+/** \brief The Service running the parallel parts of all the requests on a fixed set of threads.
+
+	There is one Pool running in a Jazz server (POOL in jazz_main). It is the first service started and the last one stopped. Rather
+	than creating threads of its own, code that splits its work in parallel parts (gathering the rows of large tensors, hashing large
+	blocks, decoding the frames of a persistence log, ...) runs those parts on the Pool with parallel_for() or a TaskGroup.
+
+Work stealing
+-------------
+
+Each worker thread owns a PoolQueue. Tasks submitted from a worker (a task that splits itself again) go to the back of its own queue and
+are popped from the back (the most recent, still in cache, first). Tasks submitted from other threads (the MHD threads serving the http
+requests) go to a shared queue. An idle worker takes from its own queue, then from the shared queue and then steals from the front
+(the oldest, usually the biggest part) of the queues of the other workers. When there is nothing to do, the workers sleep.
+
+No oversubscription
+-------------------
+
+The number of threads doing parallel work is fixed at start(): POOL_NUM_THREADS (an optional config key) workers, by default the number
+of cores minus one, since the thread calling parallel_for() always runs a part itself. However many MHD threads split their requests at
+the same time, they share the same workers instead of creating cores*requests threads. A thread waiting for its parts never blocks a
+core: it runs pending tasks (its own first) until its group is done.
+
+Fork
+----
+
+The Jazz server forks after starting its services (see HttpServer::start()) and the child process has none of the worker threads of
+the parent. The Pool registers pthread_atfork() handlers: the child drops the handles of the threads it does not have (without joining
+them), empties the queues and starts its own workers the first time it needs them. shut_down() in the child only joins those.
+
+When no Pool is running (as in most unit tests), num_threads() is 1 and parallel_for() and TaskGroup run everything in the calling
+thread, so the code using them is correct (serial) without any Pool.
+*/
+class Pool : public Service {
+
+	public:
+
+		 Pool(pLogger	  a_logger,
+			  pConfigFile a_config);
+		~Pool();
+
+		virtual pChar const id();
+
+		StatusCode start	();
+		StatusCode shut_down();
+
+		static int	num_threads	 ();
+		static void parallel_for (int first, int last, const std::function<void(int)> &body, int grain = 1);
+
+#ifndef CATCH_TEST
+	private:
+#endif
+
+		friend class TaskGroup;
+
+		void submit		  (PoolTask &task);
+		bool run_one	  ();
+		void worker		  (int self);
+		void start_workers();
+
+		/** \brief Start the workers of this process if they were started by another one (this is a forked child).
+		*/
+		inline void check_fork() {
+			if (owner_pid != getpid())
+				start_workers();
+		}
+
+		static void fork_prepare();
+		static void fork_parent ();
+		static void fork_child	();
+
+		static std::atomic<pPool> p_running;		///< The Pool running the tasks (only one Pool can be running)
+		static thread_local int	  worker_index;		///< The index of the worker in a Pool thread, -1 in any other thread
+
+		int						 num_workers = 0;	///< The number of worker threads
+		std::vector<std::thread> workers;			///< The worker threads
+		pid_t					 owner_pid = 0;		///< The process that started the workers
+		std::mutex				 spawn_lock;		///< Serializes start_workers() in a forked child
+		PoolQueue				 queue[JAZZ_MAX_NUM_THREADS + 1];	///< One per worker + (the last) the queue for other threads
+		std::atomic<int>		 queued;			///< The number of tasks in all the queues
+		std::atomic<bool>		 stopping;			///< Set by shut_down() to stop the workers once the queues are empty
+		std::mutex				 sleep_lock;		///< The lock of wake_up
+		std::condition_variable	 wake_up;			///< Where idle workers sleep
+};
+
 } // namespace jazz_elements
 
 #endif // ifndef INCLUDED_JAZZ_ELEMENTS_UTILS
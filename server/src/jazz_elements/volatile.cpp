@@ -32,8 +32,12 @@
 */
 
 
+#include <sys/stat.h>
+
+
 #include "src/jazz_elements/volatile.h"
 
+
 namespace jazz_elements
 {
 
@@ -95,7 +99,22 @@ StatusCode Volatile::start() {
 	}
 	fail_alloc_bytes = 1024; fail_alloc_bytes *= i;
 
-	return new_volatile();
+	StatusCode ret = new_volatile();
+
+	if (ret != SERVICE_NO_ERROR) return ret;
+
+	String state_file;
+	struct stat st;
+
+	if (get_conf_key("VOLATILE_STATE_FILE", state_file) && !state_file.empty() && stat(state_file.c_str(), &st) == 0) {
+		if (load_state((pChar) state_file.c_str()) == SERVICE_NO_ERROR) {
+			log_printf(LOG_INFO, "Volatile state restored from \"%s\".", (pChar) state_file.c_str());
+
+			::remove(state_file.c_str());
+		}
+	}
+
+	return SERVICE_NO_ERROR;
 }
 
 
@@ -105,6 +124,11 @@ StatusCode Volatile::start() {
 */
 StatusCode Volatile::shut_down() {
 
+	String state_file;
+
+	if (p_buffer != nullptr && get_conf_key("VOLATILE_STATE_FILE", state_file) && !state_file.empty())
+		save_state((pChar) state_file.c_str());
+
 	return destroy_volatile();
 }
 
@@ -165,6 +189,19 @@ StatusCode Volatile::destroy_volatile() {
 		}
 		free(p_buffer);
 	}
+	views.clear();
+	pins.clear();
+	num_views = 0;
+
+	name.clear();
+	queue_ent.clear();
+	deque_ent.clear();
+	tree_ent.clear();
+	index_ent.clear();
+	deque_key.clear();
+	queue_key.clear();
+	tree_key.clear();
+
 	alloc_bytes = 0;
 	p_buffer = p_free = nullptr;
 	_lock_ = 0;
@@ -173,6 +210,433 @@ StatusCode Volatile::destroy_volatile() {
 }
 
 
+/** Write a string to a state file as an int32_t length followed by the chars.
+
+	\param fp	The file.
+	\param str	The string.
+
+	\return	True on success.
+*/
+inline bool write_state_string(FILE *fp, const String &str) {
+	int32_t len = str.size();
+
+	return fwrite(&len, sizeof(len), 1, fp) == 1 && fwrite(str.c_str(), 1, len, fp) == (size_t) len;
+}
+
+
+/** Read a string written by write_state_string().
+
+	\param fp	The file.
+	\param str	The string.
+
+	\return	True on success.
+*/
+inline bool read_state_string(FILE *fp, String &str) {
+	int32_t len;
+
+	if (fread(&len, sizeof(len), 1, fp) != 1 || len < 0 || len > MAX_BLOCK_SIZE) return false;
+
+	str.resize(len);
+
+	return fread(&str[0], 1, len, fp) == (size_t) len;
+}
+
+
+/** Write all the entities to a file that load_state() can restore.
+
+	\param path	The path of the file. (It is overwritten if it exists.)
+
+	\return	SERVICE_NO_ERROR on success, SERVICE_ERROR_NOT_READY (Volatile not running) or SERVICE_ERROR_IO_ERROR.
+
+The nodes are written walking the key maps (so load_state() finds them in order) with their links as slots (See VolatileStateNode). The
+header is written twice: first as a placeholder without the magic (so an incomplete file is never accepted) and finally with the counts.
+*/
+StatusCode Volatile::save_state(pChar path) {
+
+	if (p_buffer == nullptr) return SERVICE_ERROR_NOT_READY;
+
+	FILE *fp = fopen(path, "wb");
+
+	if (fp == nullptr) {
+		log_printf(LOG_MISS, "Volatile::save_state() cannot create \"%s\".", path);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	setvbuf(fp, nullptr, _IOFBF, VOLATILE_STATE_BUFFER);
+
+	VolatileStateHeader head = {};
+	head.key_seed = key_seed;
+
+	bool ok = fwrite(&head, sizeof(head), 1, fp) == 1;
+
+	for (HashNameUseMap::iterator it = name.begin(); ok && it != name.end(); ++it) {
+		VolatileStateName rec = {it->first, it->second.use, (int32_t) strnlen(it->second.name, NAME_SIZE - 1)};
+
+		ok = fwrite(&rec, sizeof(rec), 1, fp) == 1 && fwrite(it->second.name, 1, rec.len, fp) == (size_t) rec.len;
+
+		head.num_names++;
+	}
+
+	EntKeyVolXctMap *key_map[3] = {&deque_key, &queue_key, &tree_key};
+	int32_t key_base[3] = {BASE_DEQUE_10BIT, BASE_QUEUE_10BIT, BASE_TREE_10BIT};
+
+	for (int i = 0; i < 3; i++) {
+		for (EntKeyVolXctMap::iterator it = key_map[i]->begin(); ok && it != key_map[i]->end(); ++it) {
+			pVolatileTransaction p_node = it->second;
+			VolatileStateNode rec = {};
+
+			rec.ent_hash	= it->first.ent_hash;
+			rec.key_hash	= it->first.key_hash;
+			rec.base		= key_base[i];
+			rec.slot		= state_slot(p_node);
+			rec.prev		= state_slot(p_node->p_prev);
+			rec.next		= state_slot(p_node->p_next);
+			rec.level		= p_node->level;
+			rec.times_used	= p_node->times_used;
+			rec.total_bytes = p_node->p_block->total_bytes;
+
+			switch (rec.base) {
+			case BASE_QUEUE_10BIT:
+				rec.priority = p_node->priority;
+				break;
+			case BASE_TREE_10BIT:
+				rec.child = state_slot(p_node->p_child);
+				break;
+			default:
+				rec.child = VOLATILE_STATE_NO_LINK;
+			}
+
+			ok = fwrite(&rec, sizeof(rec), 1, fp) == 1 && fwrite(p_node->p_block, 1, rec.total_bytes, fp) == (size_t) rec.total_bytes;
+
+			head.num_nodes++;
+			head.max_slot = std::max(head.max_slot, rec.slot + 1);
+		}
+	}
+
+	HashVolXctMap *ent_map[3] = {&deque_ent, &tree_ent, &index_ent};
+	int32_t ent_base[3] = {BASE_DEQUE_10BIT, BASE_TREE_10BIT, BASE_INDEX_10BIT};
+
+	for (int i = 0; i < 3; i++) {
+		for (HashVolXctMap::iterator it = ent_map[i]->begin(); ok && it != ent_map[i]->end(); ++it) {
+			VolatileStateEnt rec = {it->first, ent_base[i], 0, 0, 0};
+
+			if (rec.base != BASE_INDEX_10BIT) {
+				rec.root = state_slot(it->second);
+
+				ok = fwrite(&rec, sizeof(rec), 1, fp) == 1;
+			} else {
+				Index &index = it->second->p_hea->index;
+				rec.root = index.size();
+
+				ok = fwrite(&rec, sizeof(rec), 1, fp) == 1;
+
+				for (Index::iterator it_idx = index.begin(); ok && it_idx != index.end(); ++it_idx)
+					ok = write_state_string(fp, it_idx->first) && write_state_string(fp, it_idx->second);
+			}
+			head.num_entities++;
+		}
+	}
+
+	for (HashQueueEntMap::iterator it = queue_ent.begin(); ok && it != queue_ent.end(); ++it) {
+		VolatileStateEnt rec = {it->first, BASE_QUEUE_10BIT, state_slot(it->second.p_root), it->second.queue_size, it->second.queue_use};
+
+		ok = fwrite(&rec, sizeof(rec), 1, fp) == 1;
+
+		head.num_entities++;
+	}
+
+	if (ok) {
+		head.magic = VOLATILE_STATE_MAGIC;
+
+		ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(&head, sizeof(head), 1, fp) == 1;
+	}
+
+	if (fclose(fp) != 0 || !ok) {
+		::remove(path);
+
+		log_printf(LOG_MISS, "Volatile::save_state() failed writing \"%s\".", path);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Restore all the entities from a file written by save_state().
+
+	\param path	The path of the file.
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error). On error, Volatile is left empty.
+
+This must be called on a started and empty Volatile (before it is used by other threads). Each node is restored to the same slot of the
+buffer of transactions it had, so the links (of the deques, the AA trees of the queues and the trees) are just pointers to the same slots
+and nothing is re-inserted. VOLATILE_MAX_TRANSACTIONS must be large enough for all the slots.
+*/
+StatusCode Volatile::load_state(pChar path) {
+
+	if (p_buffer == nullptr) return SERVICE_ERROR_NOT_READY;
+
+	if (   !name.empty() || !queue_ent.empty() || !deque_ent.empty() || !tree_ent.empty() || !index_ent.empty()
+		|| !deque_key.empty() || !queue_key.empty() || !tree_key.empty())
+		return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+	FILE *fp = fopen(path, "rb");
+
+	if (fp == nullptr) {
+		log_printf(LOG_MISS, "Volatile::load_state() cannot open \"%s\".", path);
+
+		return SERVICE_ERROR_IO_ERROR;
+	}
+
+	setvbuf(fp, nullptr, _IOFBF, VOLATILE_STATE_BUFFER);
+
+	std::vector<int> slots;
+
+	StatusCode ret = read_state(fp, slots);
+
+	fclose(fp);
+
+	if (ret != SERVICE_NO_ERROR) {
+		clear_state(slots);
+
+		log_printf(LOG_MISS, "Volatile::load_state() failed reading \"%s\".", path);
+	}
+
+	return ret;
+}
+
+
+/** The body of load_state(): read the content of a state file.
+
+	\param fp		The open file.
+	\param slots	A vector to return the slots of all the restored nodes (so clear_state() can free them on failure).
+
+	\return	SERVICE_NO_ERROR on success or some negative value (error). On error, clear_state() must be called.
+*/
+StatusCode Volatile::read_state(FILE *fp, std::vector<int> &slots) {
+
+	VolatileStateHeader head;
+
+	if (   fread(&head, sizeof(head), 1, fp) != 1 || head.magic != VOLATILE_STATE_MAGIC || head.max_slot < 0 || head.num_names < 0
+		|| head.num_nodes < 0 || head.num_nodes > head.max_slot || head.num_entities < 0)
+		return SERVICE_ERROR_CORRUPTED;
+
+	if (head.max_slot > max_transactions) {
+		log_printf(LOG_MISS, "Volatile::load_state() needs VOLATILE_MAX_TRANSACTIONS >= %i.", head.max_slot);
+
+		return SERVICE_ERROR_NO_MEM;
+	}
+
+	for (int64_t i = 0; i < head.num_names; i++) {
+		VolatileStateName rec;
+		NameUse nu = {};
+
+		if (   fread(&rec, sizeof(rec), 1, fp) != 1 || rec.use <= 0 || rec.len < 0 || rec.len >= NAME_SIZE
+			|| fread(nu.name, 1, rec.len, fp) != (size_t) rec.len)
+			return SERVICE_ERROR_CORRUPTED;
+
+		nu.use = rec.use;
+
+		name.emplace_hint(name.end(), rec.hash, nu);
+	}
+
+	std::vector<int32_t> slot_base(head.max_slot, 0);
+	pVolatileTransaction p_base = (pVolatileTransaction) p_buffer;
+
+	auto valid_slot = [&head](int64_t slot) { return slot == VOLATILE_STATE_NO_LINK || (slot >= 0 && slot < head.max_slot); };
+
+	slots.reserve(head.num_nodes);
+
+	for (int64_t i = 0; i < head.num_nodes; i++) {
+		VolatileStateNode rec;
+
+		if (   fread(&rec, sizeof(rec), 1, fp) != 1 || rec.slot < 0 || rec.slot >= head.max_slot || slot_base[rec.slot] != 0
+			|| !valid_slot(rec.prev) || !valid_slot(rec.next) || (rec.base == BASE_TREE_10BIT && !valid_slot(rec.child))
+			|| rec.total_bytes < (int) sizeof(StaticBlockHeader) || rec.total_bytes > MAX_BLOCK_SIZE)
+			return SERVICE_ERROR_CORRUPTED;
+
+		EntKeyVolXctMap *p_key_map;
+
+		switch (rec.base) {
+		case BASE_DEQUE_10BIT:
+			p_key_map = &deque_key;
+			break;
+		case BASE_QUEUE_10BIT:
+			p_key_map = &queue_key;
+			break;
+		case BASE_TREE_10BIT:
+			p_key_map = &tree_key;
+			break;
+		default:
+			return SERVICE_ERROR_CORRUPTED;
+		}
+
+		pVolatileTransaction p_node = &p_base[rec.slot];
+
+		if (p_node->status != BLOCK_STATUS_DESTROYED) return SERVICE_ERROR_WRITE_FORBIDDEN;
+
+		pBlock p_block = block_malloc(rec.total_bytes);
+
+		if (p_block == nullptr) return SERVICE_ERROR_NO_MEM;
+
+		p_node->p_block = p_block;
+		p_node->status	= BLOCK_STATUS_READY;
+		p_node->_lock_	= 0;
+		p_node->p_owner = this;
+
+		slot_base[rec.slot] = rec.base;
+		slots.push_back(rec.slot);
+
+		if (fread(p_block, 1, rec.total_bytes, fp) != (size_t) rec.total_bytes || p_block->total_bytes != rec.total_bytes)
+			return SERVICE_ERROR_CORRUPTED;
+
+		p_node->p_prev	   = state_node(rec.prev);
+		p_node->p_next	   = state_node(rec.next);
+		p_node->level	   = rec.level;
+		p_node->times_used = rec.times_used;
+		p_node->key_hash   = rec.key_hash;
+
+		if (rec.base == BASE_QUEUE_10BIT)
+			p_node->priority = rec.priority;
+		else
+			p_node->p_child = rec.base == BASE_TREE_10BIT ? state_node(rec.child) : nullptr;
+
+		p_key_map->emplace_hint(p_key_map->end(), EntityKeyHash{rec.ent_hash, rec.key_hash}, p_node);
+	}
+
+	auto same_base = [&](pVolatileTransaction p_link, int32_t base) {
+		return p_link == nullptr || slot_base[p_link - p_base] == base;
+	};
+
+	for (int slot : slots) {
+		pVolatileTransaction p_node = &p_base[slot];
+		int32_t base = slot_base[slot];
+
+		if (!same_base(p_node->p_prev, base) || !same_base(p_node->p_next, base) || (base == BASE_TREE_10BIT && !same_base(p_node->p_child, base)))
+			return SERVICE_ERROR_CORRUPTED;
+	}
+
+	rebuild_free_list();
+
+	for (int64_t i = 0; i < head.num_entities; i++) {
+		VolatileStateEnt rec;
+
+		if (fread(&rec, sizeof(rec), 1, fp) != 1) return SERVICE_ERROR_CORRUPTED;
+
+		if (rec.base == BASE_INDEX_10BIT) {
+			if (rec.root < 0 || index_ent.find(rec.ent_hash) != index_ent.end()) return SERVICE_ERROR_CORRUPTED;
+
+			pTransaction p_txn;
+			StatusCode ret;
+
+			if ((ret = new_block(p_txn, CELL_TYPE_INDEX)) != SERVICE_NO_ERROR) return ret;
+
+			index_ent[rec.ent_hash] = (pVolatileTransaction) p_txn;
+
+			Index &index = p_txn->p_hea->index;
+
+			for (int j = 0; j < rec.root; j++) {
+				String key, value;
+
+				if (!read_state_string(fp, key) || !read_state_string(fp, value)) return SERVICE_ERROR_CORRUPTED;
+
+				index.emplace_hint(index.end(), key, value);
+			}
+			continue;
+		}
+
+		if (!valid_slot(rec.root) || !same_base(state_node(rec.root), rec.base)) return SERVICE_ERROR_CORRUPTED;
+
+		switch (rec.base) {
+		case BASE_DEQUE_10BIT:
+			deque_ent[rec.ent_hash] = state_node(rec.root);
+			break;
+
+		case BASE_TREE_10BIT:
+			tree_ent[rec.ent_hash] = state_node(rec.root);
+			break;
+
+		case BASE_QUEUE_10BIT: {
+			if (rec.queue_size <= 0 || rec.queue_use < 0 || rec.queue_use > rec.queue_size) return SERVICE_ERROR_CORRUPTED;
+
+			QueueEnt queue = {rec.queue_size, rec.queue_use, state_node(rec.root)};
+
+			queue_ent[rec.ent_hash] = queue; }
+			break;
+
+		default:
+			return SERVICE_ERROR_CORRUPTED;
+		}
+	}
+
+	key_seed = head.key_seed;
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Undo a failed read_state(): free the blocks of the restored nodes, destroy the indices and leave Volatile empty.
+
+	\param slots	The slots of the restored nodes.
+*/
+void Volatile::clear_state(std::vector<int> &slots) {
+
+	pVolatileTransaction p_base = (pVolatileTransaction) p_buffer;
+
+	for (int slot : slots) {
+		pVolatileTransaction p_node = &p_base[slot];
+
+		if (p_node->p_block != nullptr) {
+			alloc_bytes -= p_node->p_block->total_bytes;
+
+			free(p_node->p_block);
+
+			p_node->p_block = nullptr;
+		}
+		p_node->status = BLOCK_STATUS_DESTROYED;
+	}
+
+	for (HashVolXctMap::iterator it = index_ent.begin(); it != index_ent.end(); ++it) {
+		pTransaction p_txn = it->second;
+		destroy_transaction(p_txn);
+	}
+
+	name.clear();
+	queue_ent.clear();
+	deque_ent.clear();
+	tree_ent.clear();
+	index_ent.clear();
+	deque_key.clear();
+	queue_key.clear();
+	tree_key.clear();
+
+	rebuild_free_list();
+}
+
+
+/** Rebuild the list of free transactions (in increasing slot order) from the status of all the transactions in the buffer.
+*/
+void Volatile::rebuild_free_list() {
+
+	pVolatileTransaction p_base = (pVolatileTransaction) p_buffer;
+
+	lock_container();
+
+	p_free = nullptr;
+
+	for (int i = max_transactions - 1; i >= 0; i--) {
+		if (p_base[i].status == BLOCK_STATUS_DESTROYED) {
+			p_base[i].p_next = (pVolatileTransaction) p_free;
+			p_free = &p_base[i];
+		}
+	}
+
+	unlock_container();
+}
+
+
 /** Allocate a Transaction to share a block via the API.
 
 	\param p_txn	A pointer to a valid Transaction passed by reference. On failure, it will assign nullptr to it.
@@ -234,6 +698,9 @@ void Volatile::destroy_transaction  (pTransaction &p_txn) {
 		return;
 	}
 
+	if (num_views > 0 && release_view(p_txn))
+		return;
+
 	enter_write(p_txn);
 
 	if (p_txn->p_block != nullptr) {
@@ -366,7 +833,8 @@ StatusCode Volatile::get(pTransaction &p_txn, Locator &what, pBlock p_row_filter
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
 Usage-wise, this is equivalent to a new_block() call. On success, it will return a Transaction that belongs to the Container and must
-be destroy_transaction()-ed when the caller is done.
+be destroy_transaction()-ed when the caller is done. Unless the Tuple has attributes (copied to the item), the Transaction is a view
+(see new_view()) of the item inside the stored Tuple.
 */
 StatusCode Volatile::get(pTransaction &p_txn, Locator &what, pChar name) {
 
@@ -388,8 +856,7 @@ StatusCode Volatile::get(pTransaction &p_txn, Locator &what, pChar name) {
 
 		ret = new_block(p_txn, (pTuple) p_int_txn->p_block, name, &att);
 	} else
-		ret = new_block(p_txn, (pTuple) p_int_txn->p_block, name);
-
+		ret = new_view(p_txn, p_int_txn, name);		// Zero-copy, put() keeps the old Block alive (see detach_views()).
 
 	if (pop_ent != 0)
 		destroy_item(TenBitsAtAddress(what.base), pop_ent, (pVolatileTransaction) p_int_txn);
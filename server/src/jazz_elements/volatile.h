@@ -73,6 +73,10 @@ namespace jazz_elements
 #define COMMAND_SECOND_ARG		0x3ff		//< In a put call with a key, it is either a parent key or a priority.
 #define COMMAND_SIZE			0x400		//< For numbers, defining a queue size, this is added to avoid overlap.
 
+#define VOLATILE_STATE_MAGIC	0x4c4f564a	//< The first field of a VolatileStateHeader (to detect corruption).
+#define VOLATILE_STATE_BUFFER	(1 << 20)	//< The stdio buffer of the state file in save_state() and load_state()
+#define VOLATILE_STATE_NO_LINK	-1			//< The slot of a nullptr link in a VolatileStateNode or a VolatileStateEnt
+
 
 /** \brief A pointer to a Transaction-descendant wrapper over a Block for Volatile blocks.
 */
@@ -187,6 +191,72 @@ typedef std::map<uint64_t, NameUse> HashNameUseMap;
 typedef String* pString;
 
 
+/** \brief The head of a state file written by Volatile::save_state().
+
+It is followed by .num_names VolatileStateName (each one followed by the name), .num_nodes VolatileStateNode (each one followed by its
+block) and .num_entities VolatileStateEnt (the index ones followed by their key/value pairs, each string as an int32_t length + chars).
+*/
+struct VolatileStateHeader {
+	uint32_t magic;							///< VOLATILE_STATE_MAGIC
+	int32_t	 max_slot;						///< One above the highest slot of a node (VOLATILE_MAX_TRANSACTIONS must not be below this)
+	uint64_t key_seed;						///< The seed of new_key() (so the new keys do not collide with the restored ones)
+	int64_t	 num_names;						///< The number of VolatileStateName
+	int64_t	 num_nodes;						///< The number of VolatileStateNode
+	int64_t	 num_entities;					///< The number of VolatileStateEnt
+};
+
+
+/** \brief A name (with its use count) in a state file. (See VolatileStateHeader.)
+*/
+struct VolatileStateName {
+	uint64_t hash;							///< The hash() of the name
+	int32_t	 use;							///< Number of times the name is used
+	int32_t	 len;							///< The length of the name that follows
+};
+
+
+/** \brief A node (a VolatileTransaction of a deque, a queue or a tree) in a state file. (See VolatileStateHeader.)
+
+The links are the slots (positions in the buffer of transactions) of the nodes, which are restored to the same slots.
+*/
+struct VolatileStateNode {
+	uint64_t ent_hash;						///< The hash of the entity
+	uint64_t key_hash;						///< The hash of the key
+	union {
+		int64_t child;						///< The slot of the first child in a tree ...
+		double	priority;					///< ... or priority value in a queue.
+	};
+	int32_t	 base;							///< BASE_DEQUE_10BIT, BASE_QUEUE_10BIT or BASE_TREE_10BIT
+	int32_t	 slot;							///< The position of the VolatileTransaction in the buffer
+	union {
+		int32_t prev;						///< The slot of the previous node in a deque (the left one in a queue) ...
+		int32_t parent;						///< ... or parent node in a tree.
+	};
+	int32_t	 next;							///< The slot of the next node in a deque (the right one in a queue) or next sibling in a tree.
+	union {
+		int32_t level;						///< Level in the AA tree ...
+		int32_t num_wins;					///< ... or MCTS tree node number of wins.
+	};
+	union {
+		int32_t times_used;					///< Times the block has been reassigned in the queue ...
+		int32_t num_visits;					///< ... or MCTS tree node number of visits.
+	};
+	int32_t	 total_bytes;					///< The size of the block that follows
+	int32_t	 reserved;						///< Padding (always 0)
+};
+
+
+/** \brief An entity in a state file. (See VolatileStateHeader.)
+*/
+struct VolatileStateEnt {
+	uint64_t ent_hash;						///< The hash of the entity
+	int32_t	 base;							///< BASE_DEQUE_10BIT, BASE_INDEX_10BIT, BASE_QUEUE_10BIT or BASE_TREE_10BIT
+	int32_t	 root;							///< The slot of the root node or, in an index, the number of key/value pairs that follow.
+	int32_t	 queue_size;					///< The maximum number of nodes of a queue
+	int32_t	 queue_use;						///< The number of nodes in a queue
+};
+
+
 /** \brief Volatile: A Service to manage data objects in RAM.
 
 Node Method Reference
@@ -239,6 +309,15 @@ with a parent name that will be ignored. E.g., //tree/name/key~void. All nodes s
 //tree/name/~first. put() only supports an existing parent. Remove //tree/name/key removes a whole subtree, all the descendants and the
 node itself. Remove //tree/name removes the whole entity.
 
+Warm restart
+------------
+
+If the configuration key VOLATILE_STATE_FILE is set, shut_down() writes all the entities to that file with save_state() and start()
+reloads them with load_state() (and removes the file, so a crash does not restore an old state). The file keeps everything: the keys,
+the blocks, the AA trees of the queues (priorities, levels and times_used) and the links, num_wins and num_visits of the trees. Since
+each node is restored to the same slot of the buffer of transactions, the links are restored as they are and nothing is re-inserted:
+the queues are not rebalanced, the key maps are filled in order and the free list is rebuilt in one pass.
+
 */
 class Volatile : public Container {
 
@@ -293,12 +372,40 @@ class Volatile : public Container {
 
 		void base_names(BaseNames &base_names);
 
+		// Warm restart
+
+		StatusCode save_state(pChar path);
+		StatusCode load_state(pChar path);
+
 #ifndef CATCH_TEST
 	private:
 #endif
 
 		StatusCode new_volatile();
 		StatusCode destroy_volatile();
+		StatusCode read_state(FILE *fp, std::vector<int> &slots);
+		void	   clear_state(std::vector<int> &slots);
+		void	   rebuild_free_list();
+
+		/** The slot (position in the buffer of transactions) of a node as it is written in a state file.
+
+			\param p_node	A pointer to a VolatileTransaction or nullptr.
+
+			\return		The slot or VOLATILE_STATE_NO_LINK.
+		*/
+		inline int32_t state_slot(pVolatileTransaction p_node) {
+			return p_node == nullptr ? VOLATILE_STATE_NO_LINK : (int32_t) (p_node - (pVolatileTransaction) p_buffer);
+		}
+
+		/** The node at a slot (position in the buffer of transactions) as it is read from a state file.
+
+			\param slot	A valid slot or VOLATILE_STATE_NO_LINK.
+
+			\return		The pointer to the VolatileTransaction or nullptr.
+		*/
+		inline pVolatileTransaction state_node(int32_t slot) {
+			return slot == VOLATILE_STATE_NO_LINK ? nullptr : (pVolatileTransaction) p_buffer + slot;
+		}
 
 		/** Creates a new 15 character long key starting with a 'k' followed by 14 lowercase hexadecimal digits.
 
@@ -366,8 +473,16 @@ class Volatile : public Container {
 				pBlock p_new = block_malloc(p_block->total_bytes);
 				if (p_new == nullptr) return SERVICE_ERROR_NO_MEM;
 
-				alloc_bytes -= p_item->p_block->total_bytes;
-				free(p_item->p_block);
+				if (detach_views(p_item) != SERVICE_NO_ERROR) {
+					alloc_bytes -= p_block->total_bytes;
+					free(p_new);
+
+					return SERVICE_ERROR_NO_MEM;
+				}
+				if (p_item->p_block != nullptr) {
+					alloc_bytes -= p_item->p_block->total_bytes;
+					free(p_item->p_block);
+				}
 
 				memcpy(p_new, p_block, p_block->total_bytes);
 
@@ -570,8 +685,16 @@ class Volatile : public Container {
 
 			if (p_new == nullptr) return SERVICE_ERROR_NO_MEM;
 
-			alloc_bytes -= p_replace->p_block->total_bytes;
-			free(p_replace->p_block);
+			if (detach_views(p_replace) != SERVICE_NO_ERROR) {
+				alloc_bytes -= p_block->total_bytes;
+				free(p_new);
+
+				return SERVICE_ERROR_NO_MEM;
+			}
+			if (p_replace->p_block != nullptr) {
+				alloc_bytes -= p_replace->p_block->total_bytes;
+				free(p_replace->p_block);
+			}
 
 			memcpy(p_new, p_block, p_block->total_bytes);
 
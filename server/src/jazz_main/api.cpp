@@ -67,6 +67,10 @@ API::API(pLogger	 a_logger,
 	p_model	= a_model;
 
 	www	 = {};
+
+	static_in_ram  = true;
+	static_cache   = {};
+	static_retired = {};
 }
 
 
@@ -87,10 +91,16 @@ pChar const API::id() {
 
 	\return		SERVICE_NO_ERROR if successful, an error code otherwise.
 
-	Configuration-wise the API has just two keys:
+	Configuration-wise the API has these keys:
 
 	- STATIC_HTML_AT_START: which defines a path to a tree of static objects that should be uploaded on start.
 	- REMOVE_STATICS_ON_CLOSE: removes the whole database Persisted //static when this service closes.
+	- HTTP_CACHE_CONTROL_STATIC: (optional) the Cache-Control header returned by get_static().
+	- HTTP_CACHE_CONTROL_<base>: (optional) the Cache-Control header returned by http_get() for blocks in that base (e.g., _lmdb).
+	  A block attribute BLOCK_ATTRIB_CACHE_CTRL overrides it.
+	- STATIC_CACHE_IN_RAM: (optional, default 1) load_statics() also keeps the statics (and their precompressed variants) in RAM.
+	- HTTP_COMPRESS_MIN_SIZE: (optional, default MIN_SIZE_TO_COMPRESS) responses smaller than this are never compressed on the fly.
+	- HTTP_COMPRESS_LEVEL: (optional, default Z_BEST_SPEED) the zlib level (1..9) of the responses compressed on the fly, 0 disables it.
 
 	Besides that, this function initializes global (and object) variables used by the parser (mostly CharLUT).
 */
@@ -117,6 +127,37 @@ StatusCode API::start() {
 		base_server[tt] = it->second;
 	}
 
+	p_channels->base_names(base);
+	p_volatile->base_names(base);
+	p_persisted->base_names(base);
+
+	cache_control.clear();
+
+	for (BaseNames::iterator it = base.begin(); it != base.end(); ++it) {
+		String cc, key("HTTP_CACHE_CONTROL_" + it->first);
+
+		if (get_conf_key(key.c_str(), cc))
+			cache_control[TenBitsAtAddress(it->first.c_str())] = cc;
+	}
+
+	if (!get_conf_key("HTTP_CACHE_CONTROL_STATIC", cache_ctrl_www))
+		cache_ctrl_www = {};
+
+	if (!get_conf_key("STATIC_CACHE_IN_RAM", static_in_ram))
+		static_in_ram = true;
+
+	if (!get_conf_key("HTTP_COMPRESS_MIN_SIZE", compress_min))
+		compress_min = MIN_SIZE_TO_COMPRESS;
+
+	if (!get_conf_key("HTTP_COMPRESS_LEVEL", compress_level))
+		compress_level = Z_BEST_SPEED;
+
+	if (compress_min < 0 || compress_level < 0 || compress_level > Z_BEST_COMPRESSION) {
+		log(LOG_ERROR, "API::start(): Wrong HTTP_COMPRESS_MIN_SIZE or HTTP_COMPRESS_LEVEL.");
+
+		return SERVICE_ERROR_BAD_CONFIG;
+	}
+
 	String statics_path;
 
 	if (get_conf_key("STATIC_HTML_AT_START", statics_path)) {
@@ -159,26 +200,83 @@ StatusCode API::shut_down() {
 
 	www.clear();
 
+	static_cache_clear();
+
 	return BaseAPI::shut_down();	// Closes the one-shot functionality.
 }
 
 
 /** Check a non-API url into and return the static object related with it.
 
-	\param response	A valid (or error) MHD_Response pointer with the resource, status, mime, etc.
-	\param p_url	The http url (that has already been checked not to start with //)
-	\param get_it	If true (default), it actually gets it as a response, otherwise it just check if it exists.
+	\param response		 A valid (or error) MHD_Response pointer with the resource, status, mime, etc.
+	\param p_url			 The http url (that has already been checked not to start with //)
+	\param get_it			 If true (default), it actually gets it as a response, otherwise it just check if it exists.
+	\param p_if_none_match	 The value of the If-None-Match header of the request (or nullptr if none).
+	\param p_accept_encoding The value of the Accept-Encoding header of the request (or nullptr if none).
 
-	\return			Some error code or SERVICE_NO_ERROR if successful.
+	\return					 MHD_HTTP_OK, MHD_HTTP_NOT_MODIFIED (with an empty response) or some error code.
 
+The statics are immutable between restarts, so the etag_of_block() is a strong ETag. Statics in static_cache are served from RAM
+(MHD_RESPMEM_PERSISTENT, no copy, no LMDB access) in the best Content-Encoding the client accepts. Anything else is served from
+Persisted (compressed on the fly by content_response()). A 304 Not Modified carries the same ETag and Cache-Control (the block's
+BLOCK_ATTRIB_CACHE_CTRL or HTTP_CACHE_CONTROL_STATIC) as the full response would.
 */
-MHD_StatusCode API::get_static(pMHD_Response &response, pChar p_url, bool get_it) {
+MHD_StatusCode API::get_static(pMHD_Response &response, pChar p_url, bool get_it, const char *p_if_none_match,
+							   const char *p_accept_encoding) {
+
+	lock_container();
+
+	StaticCache::iterator it_ram = static_cache.find(String(p_url));
+	pStaticCacheItem	  p_item = (it_ram == static_cache.end()) ? nullptr : it_ram->second;
+
+	unlock_container();
+
+	if (p_item != nullptr) {
+		if (!get_it)
+			return MHD_HTTP_OK;
+
+		MHD_StatusCode status = MHD_HTTP_OK;
+
+		int enc = accepted_encoding(p_accept_encoding);
+
+		if (p_item->p_data[enc] == nullptr)
+			enc = ENCODING_IDENTITY;
+
+		if (etag_matches(p_if_none_match, p_item->etag[enc])) {
+			response = MHD_create_response_from_buffer(0, nullptr, MHD_RESPMEM_PERSISTENT);
+
+			status = MHD_HTTP_NOT_MODIFIED;
+		} else {
+			response = MHD_create_response_from_buffer(p_item->size[enc], p_item->p_data[enc], MHD_RESPMEM_PERSISTENT);
+
+			if (p_item->mime_type[0] != 0)
+				MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, p_item->mime_type);
+
+			if (p_item->language[0] != 0)
+				MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_LANGUAGE, p_item->language);
+
+			if (enc != ENCODING_IDENTITY)
+				MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_ENCODING, enc == ENCODING_GZIP ? "gzip" : "deflate");
+		}
+		if (p_item->p_data[ENCODING_GZIP] != nullptr || p_item->p_data[ENCODING_DEFLATE] != nullptr)
+			MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
+		MHD_add_response_header(response, MHD_HTTP_HEADER_ETAG, p_item->etag[enc]);
+
+		if (p_item->cache_ctrl[0] != 0)
+			MHD_add_response_header(response, MHD_HTTP_HEADER_CACHE_CONTROL, p_item->cache_ctrl);
+
+		return status;
+	}
 
 	Index::iterator it = www.find(String(p_url));
 
 	if (it == www.end())
 		return MHD_HTTP_NOT_FOUND;
 
+	if (!get_it)
+		return MHD_HTTP_OK;
+
 	Locator loc = {"lmdb", "www"};
 
 	strcpy(loc.key, it->second.c_str());
@@ -187,25 +285,48 @@ MHD_StatusCode API::get_static(pMHD_Response &response, pChar p_url, bool get_it
 	if (p_persisted->get(p_txn, loc) != SERVICE_NO_ERROR)
 		return MHD_HTTP_BAD_GATEWAY;
 
-	if (p_txn->p_block->cell_type == CELL_TYPE_STRING && p_txn->p_block->size == 1) {
-		pChar p_str = p_txn->p_block->get_string(0);
-		int size = strlen(p_str);
+	pChar p_att;
+	if ((p_att = p_txn->p_block->get_attribute(BLOCK_ATTRIB_CACHE_CTRL)) == nullptr)
+		p_att = (pChar) cache_ctrl_www.c_str();
+
+	pChar p_data;
+	int	  size;
 
-		response = MHD_create_response_from_buffer(size, p_str, MHD_RESPMEM_MUST_COPY);
+	if (p_txn->p_block->cell_type == CELL_TYPE_STRING && p_txn->p_block->size == 1) {
+		p_data = p_txn->p_block->get_string(0);
+		size   = strlen(p_data);
 	} else {
-		int size = (p_txn->p_block->cell_type & 0xff)*p_txn->p_block->size;
+		p_data = (pChar) &p_txn->p_block->tensor;
+		size   = (p_txn->p_block->cell_type & 0xff)*p_txn->p_block->size;
+	}
+
+	int enc = response_encoding(size, p_accept_encoding);
+
+	if (etag_matches(p_if_none_match, p_txn->p_block, enc)) {
+		response = MHD_create_response_from_buffer(0, nullptr, MHD_RESPMEM_PERSISTENT);
+
+		if (compress_level != 0 && size >= compress_min)
+			MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
+		add_validators(response, p_txn->p_block, p_att, enc);
+
+		p_persisted->destroy_transaction(p_txn);
 
-		response = MHD_create_response_from_buffer(size, &p_txn->p_block->tensor, MHD_RESPMEM_MUST_COPY);
+		return MHD_HTTP_NOT_MODIFIED;
 	}
 
-	pChar p_att;
+	bool streamed = content_response(response, p_txn, p_data, size, p_accept_encoding, enc);
+
+	add_validators(response, p_txn->p_block, p_att, enc);
+
 	if ((p_att = p_txn->p_block->get_attribute(BLOCK_ATTRIB_MIMETYPE)) != nullptr)
 		MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, p_att);
 
 	if ((p_att = p_txn->p_block->get_attribute(BLOCK_ATTRIB_LANGUAGE)) != nullptr)
 		MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_LANGUAGE, p_att);
 
-	p_persisted->destroy_transaction(p_txn);
+	if (!streamed)
+		p_persisted->destroy_transaction(p_txn);
 
 	return MHD_HTTP_OK;
 }
@@ -259,6 +380,8 @@ MHD_Result API::return_error_message(pMHD_Connection connection, pChar p_url, in
 	\param size		The size of the data uploaded with the http PUT call.
 	\param q_state	The structure containing the parts of the url successfully parsed.
 	\param sequence SEQUENCE_FIRST_CALL, SEQUENCE_INCREMENT_CALL or SEQUENCE_FINAL_CALL. (See below)
+	\param p_content_encoding The value of the Content-Encoding header of the request (or nullptr if none). gzip and deflate bodies are
+					inflated as they arrive (see inflate_upload()).
 
 	\return			MHD_HTTP_CREATED if SEQUENCE_FINAL_CALL is successful, MHD_HTTP_OK if any othe call is successful, or any HTTP error
 					status code.
@@ -272,7 +395,7 @@ Internals
 It supports any successful HTTP_PUT syntax, that is:
 
 APPLY_NOTHING: With or without node, mandatory base, entity and key.
-APPLY_RAW & APPLY_TEXT: With or without node, mandatory base, entity and key.
+APPLY_RAW, APPLY_TEXT, APPLY_ARROW & APPLY_NPY: With or without node, mandatory base, entity and key.
 APPLY_URL: With or without node and just a base.
 
 In all cases, calls with a node (it can only be l_node) q_state.url contains exactly what has to be forwarded.
@@ -284,14 +407,47 @@ SEQUENCE_FIRST_CALL comes first and is mandatory. On success, the functions keep
 q_state.rr_value.p_extra (that pointer will be returned in successive call of the same PUT query).
 SEQUENCE_INCREMENT_CALL may or may not come, if it does, it must allocate bigger blocks and store more data in the same pTransaction.
 SEQUENCE_FINAL_CALL is called just once, it must destroy the pTransaction when done
+
+With a Content-Encoding, q_state.rr_value.p_extra is a pInflateUpload instead and the pTransaction is only returned by the final call.
+Any other encoding than gzip or deflate is refused with MHD_HTTP_UNSUPPORTED_MEDIA_TYPE.
+Without one, a local APPLY_RAW keeps a pParseUpload instead: numeric tensors are parsed while the body is still arriving (see
+parse_upload()).
 */
-MHD_StatusCode API::http_put(pChar p_upload, size_t size, ApiQueryState &q_state, int sequence) {
+MHD_StatusCode API::http_put(pChar p_upload, size_t size, ApiQueryState &q_state, int sequence, const char *p_content_encoding) {
 
 	if (q_state.state != PSTATE_COMPLETE_OK)
 		return MHD_HTTP_BAD_REQUEST;
 
 	pTransaction p_txn = (pTransaction) q_state.rr_value.p_extra;
 
+	switch (content_encoding(p_content_encoding)) {
+	case ENCODING_IDENTITY:
+		break;
+
+	case ENCODING_UNSUPPORTED:
+		return MHD_HTTP_UNSUPPORTED_MEDIA_TYPE;
+
+	default: {
+		MHD_StatusCode status = inflate_upload(p_txn, p_upload, size, q_state, sequence);
+
+		if (sequence != SEQUENCE_FINAL_CALL || status != MHD_HTTP_OK)
+			return status;
+
+		goto unwrap_and_put; }
+	}
+
+	if (q_state.apply == APPLY_RAW && q_state.l_node[0] == 0) {
+		MHD_StatusCode status = parse_upload(p_txn, p_upload, size, q_state, sequence);
+
+		if (sequence != SEQUENCE_FINAL_CALL || status != MHD_HTTP_OK)
+			return status;
+
+		if (q_state.apply == APPLY_NOTHING)
+			goto put_block;
+
+		goto unwrap_and_put;
+	}
+
 	switch (sequence) {
 	case SEQUENCE_FIRST_CALL: {
 		if (size == 0)
@@ -334,12 +490,20 @@ MHD_StatusCode API::http_put(pChar p_upload, size_t size, ApiQueryState &q_state
 		return MHD_HTTP_OK;
 	}
 
+unwrap_and_put:
+
 	if (unwrap_received(p_txn) != SERVICE_NO_ERROR)
 		return MHD_HTTP_INSUFFICIENT_STORAGE;
 
+put_block:
+
 	switch (put(q_state, p_txn->p_block)) {
 	case SERVICE_NO_ERROR:
 		destroy_transaction(p_txn);
+
+		if (q_state.l_node[0] == 0 && strcmp(q_state.base, "lmdb") == 0 && strcmp(q_state.entity, "www") == 0)
+			static_cache_retire(q_state.key);
+
 		return MHD_HTTP_CREATED;
 
 	case SERVICE_ERROR_WRONG_BASE:
@@ -380,6 +544,9 @@ MHD_StatusCode API::http_delete(ApiQueryState &q_state) {
 
 	switch (remove(q_state)) {
 	case SERVICE_NO_ERROR:
+		if (q_state.l_node[0] == 0 && strcmp(q_state.base, "lmdb") == 0 && strcmp(q_state.entity, "www") == 0)
+			static_cache_retire(q_state.key);
+
 		return MHD_HTTP_OK;
 
 	case SERVICE_ERROR_WRONG_BASE:
@@ -395,6 +562,8 @@ MHD_StatusCode API::http_delete(ApiQueryState &q_state) {
 
 	\param response	A valid (or error) MHD_Response pointer with the resource. It will only be used on success.
 	\param q_state	The structure containing the parts of the url successfully parsed.
+	\param p_if_none_match	 The value of the If-None-Match header of the request (or nullptr if none).
+	\param p_accept_encoding The value of the Accept-Encoding header of the request (or nullptr if none).
 
 	\return			MHD_HTTP_OK if successful, or a valid http status error.
 
@@ -407,14 +576,17 @@ Internals
 It supports, basically everything, which is, all apply in many versions:
 
 APPLY_NOTHING, APPLY_NAME, APPLY_URL, APPLY_FUNCTION, APPLY_FUNCT_CONST, APPLY_FILTER, APPLY_FILT_CONST, APPLY_RAW, APPLY_TEXT,
-APPLY_ASSIGN_NOTHING, APPLY_ASSIGN_NAME, APPLY_ASSIGN_URL, APPLY_ASSIGN_FUNCTION, APPLY_ASSIGN_FUNCT_CONST, APPLY_ASSIGN_FILTER,
-APPLY_ASSIGN_FILT_CONST, APPLY_ASSIGN_RAW, APPLY_ASSIGN_TEXT, APPLY_ASSIGN_CONST, APPLY_NEW_ENTITY, APPLY_GET_ATTRIBUTE,
-APPLY_SET_ATTRIBUTE and APPLY_JAZZ_INFO
+APPLY_ARROW, APPLY_NPY, APPLY_SLICE, APPLY_ASSIGN_NOTHING, APPLY_ASSIGN_NAME, APPLY_ASSIGN_URL, APPLY_ASSIGN_FUNCTION,
+APPLY_ASSIGN_FUNCT_CONST, APPLY_ASSIGN_FILTER, APPLY_ASSIGN_FILT_CONST, APPLY_ASSIGN_RAW, APPLY_ASSIGN_TEXT, APPLY_ASSIGN_ARROW,
+APPLY_ASSIGN_NPY, APPLY_ASSIGN_SLICE, APPLY_ASSIGN_CONST, APPLY_NEW_ENTITY, APPLY_GET_ATTRIBUTE, APPLY_SET_ATTRIBUTE and APPLY_JAZZ_INFO
 
 To simplify, this top level function decomposes the logic into smaller parts.
 
+Blocks and their raw, text, Arrow or NumPy content are compressed on the fly (see content_response()) when the client accepts it.
+
 */
-MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state) {
+MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state, const char *p_if_none_match,
+							 const char *p_accept_encoding) {
 
 	if (q_state.state != PSTATE_COMPLETE_OK)
 		return MHD_HTTP_BAD_REQUEST;
@@ -423,10 +595,35 @@ MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state) {
 	pChar		 p_str;
 
 	switch (q_state.apply) {
-	case APPLY_NOTHING ... APPLY_TEXT: {
+	case APPLY_NOTHING ... APPLY_SLICE: {
 		pBaseAPI p_base_api = (pBaseAPI) base_server[TenBitsAtAddress(q_state.base)];
 		p_base_api = (p_base_api == p_core || p_base_api == p_model) ? p_base_api : this;
 
+		MapIS::iterator it_cc = cache_control.find(TenBitsAtAddress(q_state.base));
+		pChar p_cache_ctrl	  = (it_cc == cache_control.end()) ? nullptr : (pChar) it_cc->second.c_str();
+
+		if (p_if_none_match != nullptr && q_state.apply == APPLY_NOTHING && p_base_api == this) {
+			StaticBlockHeader hea;
+
+			// A block with a single string is served as the string, its size (and so its Content-Encoding) is only known after get().
+			if (	header(hea, q_state) == SERVICE_NO_ERROR
+				&& hea.cell_type != CELL_TYPE_INDEX
+				&& (hea.cell_type != CELL_TYPE_STRING || hea.size != 1 || hea.num_attributes != 0)) {
+				int enc = response_encoding(hea.total_bytes, p_accept_encoding);
+
+				if (etag_matches(p_if_none_match, &hea, enc)) {
+					response = MHD_create_response_from_buffer(0, nullptr, MHD_RESPMEM_PERSISTENT);
+
+					if (compress_level != 0 && hea.total_bytes >= compress_min)
+						MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
+					add_validators(response, &hea, p_cache_ctrl, enc);
+
+					return MHD_HTTP_NOT_MODIFIED;
+				}
+			}
+		}
+
 		switch (p_base_api->get(p_txn, q_state)) {
 		case SERVICE_NO_ERROR:
 			// This condition is required by http. The BaseAPI::get() can return an index block.
@@ -442,21 +639,53 @@ MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state) {
 		default:
 			return MHD_HTTP_NOT_FOUND;
 		}
+		bool streamed;
+		int	 enc;
+
 		// This is the "auto-magic" conversion into string from blocks of string with one element.
 		if (p_txn->p_block->cell_type == CELL_TYPE_STRING && p_txn->p_block->size == 1 && p_txn->p_block->num_attributes == 0) {
 			p_str = p_txn->p_block->get_string(0);
-			response = MHD_create_response_from_buffer(strlen(p_str), p_str, MHD_RESPMEM_MUST_COPY);
+
+			int size = strlen(p_str);
+
+			enc = response_encoding(size, p_accept_encoding);
+
+			if (q_state.apply == APPLY_NOTHING && p_base_api == this && etag_matches(p_if_none_match, p_txn->p_block, enc)) {
+				response = MHD_create_response_from_buffer(0, nullptr, MHD_RESPMEM_PERSISTENT);
+
+				if (compress_level != 0 && size >= compress_min)
+					MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
+				add_validators(response, p_txn->p_block, p_cache_ctrl, enc);
+
+				p_txn->p_owner->destroy_transaction(p_txn);
+
+				return MHD_HTTP_NOT_MODIFIED;
+			}
+			streamed = content_response(response, p_txn, p_str, size, p_accept_encoding, enc);
 		} else {
 			if (q_state.apply == APPLY_TEXT)
-				response = MHD_create_response_from_buffer(p_txn->p_block->size - 1, &p_txn->p_block->tensor, MHD_RESPMEM_MUST_COPY);
-			else {
-				if (p_txn->p_block->hash64 == 0)
-					p_txn->p_block->close_block();
+				streamed = content_response(response, p_txn, (pChar) &p_txn->p_block->tensor, p_txn->p_block->size - 1, p_accept_encoding, enc);
+			else if (q_state.apply == APPLY_ARROW || q_state.apply == APPLY_NPY) {
+				streamed = content_response(response, p_txn, (pChar) &p_txn->p_block->tensor, p_txn->p_block->size, p_accept_encoding, enc);
+
+				MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE,
+										q_state.apply == APPLY_ARROW ? "application/vnd.apache.arrow.stream" : "application/octet-stream");
+			} else {
+				if (p_txn->p_block->hash64 == 0)		// E.g., a mapped file. Keep its (conservative) has_NA.
+					p_txn->p_block->close_block(p_txn->p_block->has_NA ? SET_HAS_NA_TRUE : SET_HAS_NA_FALSE);
 
-				response = MHD_create_response_from_buffer(p_txn->p_block->total_bytes, p_txn->p_block, MHD_RESPMEM_MUST_COPY);
+				streamed = content_response(response, p_txn, (pChar) p_txn->p_block, p_txn->p_block->total_bytes, p_accept_encoding, enc);
 			}
 		}
-		p_txn->p_owner->destroy_transaction(p_txn);
+		if (q_state.apply == APPLY_NOTHING) {
+			if ((p_str = p_txn->p_block->get_attribute(BLOCK_ATTRIB_CACHE_CTRL)) != nullptr)
+				p_cache_ctrl = p_str;
+
+			add_validators(response, p_txn->p_block, p_cache_ctrl, enc);
+		}
+		if (!streamed)
+			p_txn->p_owner->destroy_transaction(p_txn);
 
 		return MHD_HTTP_OK; }
 
@@ -475,9 +704,12 @@ MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state) {
 		if (q_state.apply == APPLY_SET_ATTRIBUTE
 			&& q_state.r_value.attribute == BLOCK_ATTRIB_URL
 			&& strcmp(q_state.base, "lmdb") == 0
-			&& strcmp(q_state.entity, "www") == 0)
+			&& strcmp(q_state.entity, "www") == 0) {
 				www[q_state.url] = q_state.key;
 
+				static_cache_retire(q_state.key, q_state.url);
+		}
+
 		return MHD_HTTP_OK;
 
 	case APPLY_GET_ATTRIBUTE:
@@ -547,6 +779,682 @@ MHD_StatusCode API::http_get(pMHD_Response &response, ApiQueryState &q_state) {
 }
 
 
+/** Add the ETag and Cache-Control headers to a response.
+
+	\param response			A valid MHD_Response.
+	\param p_hea			The header of the block served. If its hash64 is zero, no ETag is added.
+	\param p_cache_control	The value of the Cache-Control header. If it is nullptr or empty, no Cache-Control is added.
+	\param encoding			The ENCODING_ of the content (see as_etag()).
+*/
+void API::add_validators(pMHD_Response response, pStaticBlockHeader p_hea, const char *p_cache_control, int encoding) {
+
+	if (p_hea->hash64 != 0) {
+		char tag[ETAG_BUFFER_SIZE];
+		as_etag(tag, p_hea, encoding);
+
+		MHD_add_response_header(response, MHD_HTTP_HEADER_ETAG, tag);
+	}
+
+	if (p_cache_control != nullptr && p_cache_control[0] != 0)
+		MHD_add_response_header(response, MHD_HTTP_HEADER_CACHE_CONTROL, p_cache_control);
+}
+
+
+/** Create a StaticCacheItem with the content of a static block (and its precompressed variants) and add it to the static_cache.
+
+	\param p_url	The url under which get_static() serves it.
+	\param p_key	The key of the block in //lmdb/www.
+	\param p_block	The block (already put in //lmdb/www).
+
+	\return		SERVICE_NO_ERROR or an error code if the block cannot be served from RAM (it is still served from Persisted).
+*/
+StatusCode API::static_cache_add(pChar p_url, pChar p_key, pBlock p_block) {
+
+	pChar  p_data;
+	size_t size;
+
+	if (p_block->cell_type == CELL_TYPE_STRING && p_block->size == 1) {
+		p_data = p_block->get_string(0);
+		size   = strlen(p_data);
+	} else if ((p_block->cell_type & 0xf0) == 0) {
+		p_data = (pChar) &p_block->tensor;
+		size   = (p_block->cell_type & 0xff)*p_block->size;
+	} else
+		return SERVICE_ERROR_WRONG_TYPE;
+
+	pChar p_mime = p_block->get_attribute(BLOCK_ATTRIB_MIMETYPE);
+	pChar p_lang = p_block->get_attribute(BLOCK_ATTRIB_LANGUAGE);
+	pChar p_ctrl = p_block->get_attribute(BLOCK_ATTRIB_CACHE_CTRL);
+
+	if (p_ctrl == nullptr)
+		p_ctrl = (pChar) cache_ctrl_www.c_str();
+
+	if (   strlen(p_key) >= NAME_SIZE
+		|| (p_mime != nullptr && strlen(p_mime) >= STATIC_HEADER_SIZE)
+		|| (p_lang != nullptr && strlen(p_lang) >= STATIC_HEADER_SIZE)
+		|| strlen(p_ctrl) >= STATIC_HEADER_SIZE)
+		return SERVICE_ERROR_WRONG_ARGUMENTS;
+
+	pStaticCacheItem p_item = (pStaticCacheItem) malloc(sizeof(StaticCacheItem));
+
+	if (p_item == nullptr)
+		return SERVICE_ERROR_NO_MEM;
+
+	memset(p_item, 0, sizeof(StaticCacheItem));
+
+	if ((p_item->p_data[ENCODING_IDENTITY] = (pChar) malloc(size + 1)) == nullptr) {
+		alloc_bytes -= sizeof(StaticCacheItem);
+		free(p_item);
+
+		return SERVICE_ERROR_NO_MEM;
+	}
+	memcpy(p_item->p_data[ENCODING_IDENTITY], p_data, size);
+
+	p_item->size[ENCODING_IDENTITY] = size;
+
+	if (size >= MIN_SIZE_TO_COMPRESS) {
+		for (int enc = ENCODING_DEFLATE; enc < NUM_ENCODINGS; enc++) {
+			size_t out_size;
+
+			p_item->p_data[enc] = compress_buffer(p_data, size, enc, out_size);
+
+			if (p_item->p_data[enc] == nullptr)
+				continue;
+
+			if (out_size > size - size/8) {		// Not worth it (already compressed formats)
+				alloc_bytes -= out_size;
+				free(p_item->p_data[enc]);
+
+				p_item->p_data[enc] = nullptr;
+				continue;
+			}
+			p_item->size[enc] = out_size;
+		}
+	}
+
+	if (p_block->hash64 == 0)
+		p_block->close_block();
+
+	strcpy(p_item->key, p_key);
+	for (int enc = ENCODING_IDENTITY; enc < NUM_ENCODINGS; enc++)
+		as_etag(p_item->etag[enc], p_block, enc);
+
+	if (p_mime != nullptr)
+		strcpy(p_item->mime_type, p_mime);
+
+	if (p_lang != nullptr)
+		strcpy(p_item->language, p_lang);
+
+	strcpy(p_item->cache_ctrl, p_ctrl);
+
+	static_cache_retire(p_key, p_url);
+
+	lock_container();
+
+	static_cache[p_url] = p_item;
+
+	unlock_container();
+
+	return SERVICE_NO_ERROR;
+}
+
+
+/** Remove the items related with a block in //lmdb/www (or an url) from the static_cache.
+
+	\param p_key	The key of the block in //lmdb/www. If it is empty, everything is removed.
+	\param p_url	(optional) An url that is also removed.
+
+The items cannot be freed, since MHD may still be sending them, they are moved to static_retired and freed by static_cache_clear().
+*/
+void API::static_cache_retire(pChar p_key, pChar p_url) {
+
+	lock_container();
+
+	for (StaticCache::iterator it = static_cache.begin(); it != static_cache.end();) {
+		if (p_key[0] == 0 || strcmp(it->second->key, p_key) == 0 || (p_url != nullptr && it->first == p_url)) {
+			static_retired.push_back(it->second);
+
+			it = static_cache.erase(it);
+		} else
+			++it;
+	}
+
+	unlock_container();
+}
+
+
+/** Free all the memory used by static_cache and static_retired. (Called by shut_down() when MHD is not serving anymore.)
+*/
+void API::static_cache_clear() {
+
+	static_cache_retire((pChar) "");
+
+	lock_container();
+
+	for (StaticItems::iterator it = static_retired.begin(); it != static_retired.end(); ++it) {
+		for (int enc = ENCODING_IDENTITY; enc < NUM_ENCODINGS; enc++) {
+			if ((*it)->p_data[enc] != nullptr) {
+				alloc_bytes -= enc == ENCODING_IDENTITY ? (*it)->size[enc] + 1 : (*it)->size[enc];
+				free((*it)->p_data[enc]);
+			}
+		}
+		alloc_bytes -= sizeof(StaticCacheItem);
+		free(*it);
+	}
+	static_retired.clear();
+
+	unlock_container();
+}
+
+
+/** Compress a buffer with zlib into a new buffer allocated by malloc() (and accounted in .alloc_bytes).
+
+	\param p_data	 The data to be compressed.
+	\param size	 The size of the data.
+	\param encoding ENCODING_DEFLATE (zlib format, which is what http calls deflate) or ENCODING_GZIP.
+	\param out_size Returns the size of the compressed data.
+
+	\return		 The compressed buffer or nullptr on failure. The buffer is exactly out_size bytes.
+*/
+pChar API::compress_buffer(pChar p_data, size_t size, int encoding, size_t &out_size) {
+
+	z_stream strm = {};
+
+	if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, encoding == ENCODING_GZIP ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return nullptr;
+
+	size_t bound = deflateBound(&strm, size);
+	pChar  p_buf = (pChar) std::malloc(bound);
+
+	if (p_buf == nullptr) {
+		deflateEnd(&strm);
+
+		return nullptr;
+	}
+
+	strm.next_in   = (Bytef *) p_data;
+	strm.avail_in  = size;
+	strm.next_out  = (Bytef *) p_buf;
+	strm.avail_out = bound;
+
+	int ret = deflate(&strm, Z_FINISH);
+
+	out_size = strm.total_out;
+
+	deflateEnd(&strm);
+
+	pChar p_ret = (ret == Z_STREAM_END) ? (pChar) malloc(out_size) : nullptr;
+
+	if (p_ret != nullptr)
+		memcpy(p_ret, p_buf, out_size);
+
+	std::free(p_buf);
+
+	return p_ret;
+}
+
+
+/** The MHD content reader of the responses created by content_response(): Deflates the next chunk into the buffer given by MHD.
+
+	\param cls	The pDeflateStream.
+	\param pos	The position in the (compressed) stream. Not used, since MHD always reads forward.
+	\param buf	The buffer to fill.
+	\param max	The size of the buffer.
+
+	\return		The number of bytes written, MHD_CONTENT_READER_END_OF_STREAM or MHD_CONTENT_READER_END_WITH_ERROR.
+*/
+ssize_t deflate_reader(void *cls, uint64_t pos, char *buf, size_t max) {
+
+	pDeflateStream p_ds = (pDeflateStream) cls;
+
+	if (p_ds->finished)
+		return MHD_CONTENT_READER_END_OF_STREAM;
+
+	p_ds->strm.next_out	 = (Bytef *) buf;
+	p_ds->strm.avail_out = max;
+
+	switch (deflate(&p_ds->strm, Z_FINISH)) {
+	case Z_STREAM_END:
+		p_ds->finished = true;
+
+		[[fallthrough]];
+
+	case Z_OK:
+	case Z_BUF_ERROR:
+		if (max == p_ds->strm.avail_out)
+			return p_ds->finished ? MHD_CONTENT_READER_END_OF_STREAM : MHD_CONTENT_READER_END_WITH_ERROR;
+
+		return max - p_ds->strm.avail_out;
+	}
+	return MHD_CONTENT_READER_END_WITH_ERROR;
+}
+
+
+/** The MHD free callback of the responses created by content_response(): Releases the zlib stream and the transaction with the data.
+
+	\param cls	The pDeflateStream.
+*/
+void deflate_free(void *cls) {
+
+	pDeflateStream p_ds = (pDeflateStream) cls;
+
+	deflateEnd(&p_ds->strm);
+
+	p_ds->p_txn->p_owner->destroy_transaction(p_ds->p_txn);
+
+	std::free(p_ds);
+}
+
+
+/** Create the response to some data inside a block, compressing it on the fly if the client accepts it and it is worth it.
+
+	\param response			 Returns the new MHD_Response.
+	\param p_txn			 The transaction holding the data.
+	\param p_data			 The data to be sent (inside p_txn->p_block).
+	\param size				 The size of the data.
+	\param p_accept_encoding The value of the Accept-Encoding header of the request (or nullptr if none).
+	\param encoding			 Returns the ENCODING_ of the response (for its ETag, see add_validators()).
+
+	\return	true if the response owns p_txn (it will be destroyed when MHD destroys the response), false if the caller still owns it.
+
+Data of at least HTTP_COMPRESS_MIN_SIZE bytes is compressed (unless HTTP_COMPRESS_LEVEL is 0) with the best Content-Encoding the client
+accepts. The compression is streamed by deflate_reader() in chunks of HTTP_STREAM_BLOCK_SIZE, so neither the whole compressed result nor a
+copy of the data is ever staged. Anything else (or if anything fails) is copied into a normal response. All compressible responses have a
+Vary: Accept-Encoding header.
+*/
+bool API::content_response(pMHD_Response &response, pTransaction p_txn, pChar p_data, size_t size, const char *p_accept_encoding,
+						   int &encoding) {
+
+	encoding = ENCODING_IDENTITY;
+
+	if (compress_level == 0 || size < (size_t) compress_min) {
+		response = MHD_create_response_from_buffer(size, p_data, MHD_RESPMEM_MUST_COPY);
+
+		return false;
+	}
+
+	int enc = accepted_encoding(p_accept_encoding);
+
+	pDeflateStream p_ds = (enc == ENCODING_IDENTITY) ? nullptr : new_deflate_stream(p_txn, p_data, size, enc);
+
+	if (p_ds != nullptr) {
+		response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, HTTP_STREAM_BLOCK_SIZE, &deflate_reader, p_ds, &deflate_free);
+
+		if (response == nullptr) {
+			deflateEnd(&p_ds->strm);
+			std::free(p_ds);
+
+			p_ds = nullptr;
+		}
+	}
+
+	if (p_ds == nullptr)
+		response = MHD_create_response_from_buffer(size, p_data, MHD_RESPMEM_MUST_COPY);
+	else {
+		MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_ENCODING, enc == ENCODING_GZIP ? "gzip" : "deflate");
+
+		encoding = enc;
+	}
+
+	MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
+	return p_ds != nullptr;
+}
+
+
+/** Create the state of a compressed stream for deflate_reader().
+
+	\param p_txn	The transaction holding the data. (Owned by the stream if successful.)
+	\param p_data	The data to be compressed (inside p_txn->p_block).
+	\param size		The size of the data.
+	\param encoding ENCODING_DEFLATE or ENCODING_GZIP.
+
+	\return			The new stream or nullptr on failure.
+
+The stream is allocated with std::malloc() (not accounted in .alloc_bytes) since it is freed by MHD from the connection thread.
+*/
+pDeflateStream API::new_deflate_stream(pTransaction p_txn, pChar p_data, size_t size, int encoding) {
+
+	pDeflateStream p_ds = (pDeflateStream) std::malloc(sizeof(DeflateStream));
+
+	if (p_ds == nullptr)
+		return nullptr;
+
+	memset(p_ds, 0, sizeof(DeflateStream));
+
+	if (deflateInit2(&p_ds->strm, compress_level, Z_DEFLATED, encoding == ENCODING_GZIP ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		std::free(p_ds);
+
+		return nullptr;
+	}
+
+	p_ds->strm.next_in	= (Bytef *) p_data;
+	p_ds->strm.avail_in = size;
+	p_ds->p_txn			= p_txn;
+
+	return p_ds;
+}
+
+
+/** The part of http_put() that handles bodies with a Content-Encoding: Inflates the body into a growing block as it arrives.
+
+	\param p_txn	Returns the transaction with the inflated body (only on the successful final call).
+	\param p_upload	The data as given by MHD.
+	\param size		The size of the data.
+	\param q_state	The structure containing the parts of the url successfully parsed. Its .rr_value.p_extra keeps the pInflateUpload.
+	\param sequence SEQUENCE_FIRST_CALL, SEQUENCE_INCREMENT_CALL or SEQUENCE_FINAL_CALL.
+
+	\return			MHD_HTTP_OK if successful, or an http error status after releasing everything.
+
+The block starts at four times the size of the first chunk and doubles when full, so the upload is never copied more than a logarithmic
+number of times. The final call checks the stream is complete and returns a block with just the inflated bytes. Both gzip and the zlib
+format (what http calls deflate) are accepted regardless of the header, since zlib detects them automatically.
+*/
+MHD_StatusCode API::inflate_upload(pTransaction &p_txn, pChar p_upload, size_t size, ApiQueryState &q_state, int sequence) {
+
+	pInflateUpload p_up = (pInflateUpload) q_state.rr_value.p_extra;
+
+	int dim[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0};
+
+	MHD_StatusCode status = MHD_HTTP_BAD_REQUEST;
+
+	switch (sequence) {
+	case SEQUENCE_FIRST_CALL:
+		if (size == 0)
+			return MHD_HTTP_OK;
+
+		if ((p_up = (pInflateUpload) std::malloc(sizeof(InflateUpload))) == nullptr)
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+
+		memset(p_up, 0, sizeof(InflateUpload));
+
+		if (inflateInit2(&p_up->strm, 15 + 32) != Z_OK) {
+			std::free(p_up);
+
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+		}
+
+		dim[0] = size < INT_MAX/4 ? 4*size : INT_MAX;
+
+		if (new_block(p_up->p_txn, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+			inflateEnd(&p_up->strm);
+			std::free(p_up);
+
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+		}
+		q_state.rr_value.p_extra = (pExtraLocator) p_up;
+
+		[[fallthrough]];
+
+	case SEQUENCE_INCREMENT_CALL:
+		if (p_up->finished && size != 0)
+			goto release_and_fail;
+
+		p_up->strm.next_in	= (Bytef *) p_upload;
+		p_up->strm.avail_in = size;
+
+		while (p_up->strm.avail_in > 0 && !p_up->finished) {
+			pBlock p_block = p_up->p_txn->p_block;
+
+			if (p_up->used == p_block->size) {
+				if (p_block->size > INT_MAX/2) {
+					status = MHD_HTTP_INSUFFICIENT_STORAGE;
+
+					goto release_and_fail;
+				}
+				dim[0] = 2*p_block->size;
+
+				pTransaction p_aux;
+
+				if (new_block(p_aux, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+					status = MHD_HTTP_INSUFFICIENT_STORAGE;
+
+					goto release_and_fail;
+				}
+				memcpy(&p_aux->p_block->tensor.cell_byte[0], &p_block->tensor.cell_byte[0], p_up->used);
+
+				std::swap(p_up->p_txn->p_block, p_aux->p_block);
+
+				destroy_transaction(p_aux);
+
+				p_block = p_up->p_txn->p_block;
+			}
+			p_up->strm.next_out	 = &p_block->tensor.cell_byte[p_up->used];
+			p_up->strm.avail_out = p_block->size - p_up->used;
+
+			int ret = inflate(&p_up->strm, Z_NO_FLUSH);
+
+			p_up->used = p_block->size - p_up->strm.avail_out;
+
+			if (ret == Z_STREAM_END)
+				p_up->finished = true;
+			else if (ret != Z_OK)
+				goto release_and_fail;
+		}
+		if (p_up->strm.avail_in > 0)
+			goto release_and_fail;		// Trailing data after the end of the stream
+
+		return MHD_HTTP_OK;
+	}
+
+	if (!p_up->finished || p_up->used == 0)
+		goto release_and_fail;
+
+	inflateEnd(&p_up->strm);
+
+	p_txn = p_up->p_txn;
+
+	if (p_up->used != p_txn->p_block->size) {
+		dim[0] = p_up->used;
+
+		pTransaction p_aux;
+
+		if (new_block(p_aux, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+			destroy_transaction(p_txn);
+			std::free(p_up);
+
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+		}
+		memcpy(&p_aux->p_block->tensor.cell_byte[0], &p_txn->p_block->tensor.cell_byte[0], p_up->used);
+
+		std::swap(p_txn->p_block, p_aux->p_block);
+
+		destroy_transaction(p_aux);
+	}
+	std::free(p_up);
+
+	return MHD_HTTP_OK;
+
+release_and_fail:
+
+	inflateEnd(&p_up->strm);
+
+	destroy_transaction(p_up->p_txn);
+
+	std::free(p_up);
+
+	return status;
+}
+
+
+/** The part of http_put() that handles .raw bodies without a Content-Encoding: Parses numeric tensors as the body arrives.
+
+	\param p_txn	Returns the transaction with the result (only on the successful final call).
+	\param p_upload	The data as given by MHD.
+	\param size		The size of the data.
+	\param q_state	The structure containing the parts of the url successfully parsed. Its .rr_value.p_extra keeps the pParseUpload.
+	\param sequence SEQUENCE_FIRST_CALL, SEQUENCE_INCREMENT_CALL or SEQUENCE_FINAL_CALL.
+
+	\return			MHD_HTTP_OK if successful, or an http error status after releasing everything.
+
+Each chunk is fed to a TextStream (see Container::feed_text_stream()), so the tensor is parsed while the rest is still being uploaded
+and the text is never stored. Until the first cell has decided the type, the chunks are also kept (see append_upload()) and, if the
+TextStream fails by then, the body is not a numeric tensor and the final call returns it as received for put() to parse with
+new_block() (5), as any other .raw upload. When the TextStream succeeds, the final call returns the tensor and sets q_state.apply to
+APPLY_NOTHING, since it is already parsed.
+*/
+MHD_StatusCode API::parse_upload(pTransaction &p_txn, pChar p_upload, size_t size, ApiQueryState &q_state, int sequence) {
+
+	pParseUpload p_up = (pParseUpload) q_state.rr_value.p_extra;
+
+	switch (sequence) {
+	case SEQUENCE_FIRST_CALL:
+		if (size == 0)
+			return MHD_HTTP_OK;
+
+		if ((p_up = (pParseUpload) std::malloc(sizeof(ParseUpload))) == nullptr)
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+
+		memset(p_up, 0, sizeof(ParseUpload));
+
+		p_up->p_stream = new_text_stream();		// If it fails, the body is just buffered.
+
+		q_state.rr_value.p_extra = (pExtraLocator) p_up;
+
+		[[fallthrough]];
+
+	case SEQUENCE_INCREMENT_CALL:
+		if (size > INT_MAX)
+			goto release_and_fail;
+
+		if (p_up->p_stream != nullptr) {
+			bool decided = p_up->p_stream->cell_type != CELL_TYPE_UNDEFINED;
+
+			if (!feed_text_stream(p_up->p_stream, p_upload, size)) {
+				if (decided)
+					goto release_and_fail;
+
+				destroy_text_stream(p_up->p_stream);
+			} else if (p_up->p_stream->cell_type != CELL_TYPE_UNDEFINED) {
+				if (p_up->p_txn != nullptr)
+					destroy_transaction(p_up->p_txn);
+
+				return MHD_HTTP_OK;
+			}
+		}
+		if (!append_upload(p_up->p_txn, p_up->used, p_upload, size)) {
+			if (p_up->p_stream != nullptr)
+				destroy_text_stream(p_up->p_stream);
+
+			std::free(p_up);
+
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+		}
+
+		return MHD_HTTP_OK;
+	}
+
+	if (p_up->p_stream != nullptr) {
+		if (p_up->p_stream->cell_type != CELL_TYPE_UNDEFINED) {
+			StatusCode ret = new_block(p_txn, p_up->p_stream);
+
+			destroy_text_stream(p_up->p_stream);
+			std::free(p_up);
+
+			if (ret != SERVICE_NO_ERROR)
+				return MHD_HTTP_BAD_REQUEST;
+
+			q_state.apply = APPLY_NOTHING;
+
+			return MHD_HTTP_OK;
+		}
+		destroy_text_stream(p_up->p_stream);
+	}
+	p_txn = p_up->p_txn;
+
+	if (p_up->used != p_txn->p_block->size) {
+		int dim[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0};
+
+		dim[0] = p_up->used;
+
+		pTransaction p_aux;
+
+		if (new_block(p_aux, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+			destroy_transaction(p_txn);
+			std::free(p_up);
+
+			return MHD_HTTP_INSUFFICIENT_STORAGE;
+		}
+		memcpy(&p_aux->p_block->tensor.cell_byte[0], &p_txn->p_block->tensor.cell_byte[0], p_up->used);
+
+		std::swap(p_txn->p_block, p_aux->p_block);
+
+		destroy_transaction(p_aux);
+	}
+	std::free(p_up);
+
+	return MHD_HTTP_OK;
+
+release_and_fail:
+
+	if (p_up->p_stream != nullptr)
+		destroy_text_stream(p_up->p_stream);
+
+	if (p_up->p_txn != nullptr)
+		destroy_transaction(p_up->p_txn);
+
+	std::free(p_up);
+
+	return MHD_HTTP_BAD_REQUEST;
+}
+
+
+/** Append a chunk of an upload to a CELL_TYPE_BYTE block that starts at four times the size of the first chunk and doubles when full.
+
+	\param p_txn	The transaction with the block (nullptr before the first chunk).
+	\param used		The number of bytes of the block already written.
+	\param p_upload	The data as given by MHD.
+	\param size		The size of the data.
+
+	\return			True if successful. On failure, the transaction is destroyed.
+*/
+bool API::append_upload(pTransaction &p_txn, int &used, pChar p_upload, size_t size) {
+
+	int dim[MAX_TENSOR_RANK] = {0, 0, 0, 0, 0, 0};
+
+	if (p_txn == nullptr) {
+		dim[0] = size < INT_MAX/4 ? 4*size : INT_MAX;
+
+		if (new_block(p_txn, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR)
+			return false;
+
+		used = 0;
+	}
+	pBlock p_block = p_txn->p_block;
+
+	if (size > (size_t) (p_block->size - used)) {
+		if ((int64_t) used + size > INT_MAX) {
+			destroy_transaction(p_txn);
+
+			return false;
+		}
+		int64_t need = std::max((int64_t) 2*p_block->size, (int64_t) (used + size));
+
+		dim[0] = need < INT_MAX ? need : INT_MAX;
+
+		pTransaction p_aux;
+
+		if (new_block(p_aux, CELL_TYPE_BYTE, &dim[0], FILL_NEW_DONT_FILL) != SERVICE_NO_ERROR) {
+			destroy_transaction(p_txn);
+
+			return false;
+		}
+		memcpy(&p_aux->p_block->tensor.cell_byte[0], &p_block->tensor.cell_byte[0], used);
+
+		std::swap(p_txn->p_block, p_aux->p_block);
+
+		destroy_transaction(p_aux);
+
+		p_block = p_txn->p_block;
+	}
+	memcpy(&p_block->tensor.cell_byte[used], p_upload, size);
+
+	used += size;
+
+	return true;
+}
+
+
 /** Push a copy of all the files in the path (searched recursively) to the Persisted database "static" and index their names
 to be found by get_static().
 
@@ -684,9 +1592,12 @@ StatusCode API::load_statics(pChar p_base_path, pChar p_relative_path, int rec_l
 
 				ret = p_persisted->put(loc, p_txn->p_block);
 
-				if (ret == SERVICE_NO_ERROR)
+				if (ret == SERVICE_NO_ERROR) {
 					www[p_txn->p_block->get_attribute(BLOCK_ATTRIB_URL)] = loc.key;
 
+					if (static_in_ram && static_cache_add(fn, loc.key, p_txn->p_block) != SERVICE_NO_ERROR)
+						log_printf(LOG_MISS, "API::load_statics(): %s will be served from Persisted.", fn);
+				}
 				destroy_transaction(p_txn);
 
 				if (ret != SERVICE_NO_ERROR) {
@@ -34,6 +34,8 @@
 
 #include <map>
 
+#include <zlib.h>
+
 #include "src/include/jazz_models.h"
 
 #ifdef CATCH_TEST
@@ -82,6 +84,17 @@ using namespace jazz_bebop;
 using namespace jazz_models;
 
 #define MAX_RECURSE_LEVEL_ON_STATICS		16	///< The max directory recursion depth for load_statics()
+#define ETAG_BUFFER_SIZE					24	///< Enough for a strong ETag: a 64 bit hash in hex and a Content-Encoding suffix between double quotes.
+#define STATIC_HEADER_SIZE				   120	///< Max length (ending zero included) of a pre-built header value in a StaticCacheItem.
+#define MIN_SIZE_TO_COMPRESS			   256	///< Statics smaller than this are never precompressed. (Default of HTTP_COMPRESS_MIN_SIZE.)
+#define HTTP_STREAM_BLOCK_SIZE			 32768	///< The block size of the responses compressed on the fly by content_response()
+
+// Content-Encoding variants (also indices of StaticCacheItem.p_data[])
+#define ENCODING_IDENTITY					 0	///< No Content-Encoding
+#define ENCODING_DEFLATE					 1	///< Content-Encoding: deflate (the zlib format RFC 1950)
+#define ENCODING_GZIP						 2	///< Content-Encoding: gzip (RFC 1952)
+#define NUM_ENCODINGS						 3	///< The number of supported Content-Encoding variants
+#define ENCODING_UNSUPPORTED				-1	///< Returned by content_encoding() for any Content-Encoding other than the above
 
 // Values of http_put(sequence)
 #define	SEQUENCE_FIRST_CALL					 0	///< First call, no pTransaction was yet assigned (data must be stored)
@@ -110,6 +123,66 @@ extern MHD_Result http_request_callback(void *cls,
 										void **con_cls);
 
 
+/** \brief A static file served from RAM by get_static() (built by load_statics())
+
+All the memory (the structure itself and the variants) is allocated by API::malloc() and the structure is never modified after creation.
+When the block it comes from is modified through the API, the item is retired (not freed, since responses may still be using it) and
+get_static() falls back to Persisted.
+*/
+struct StaticCacheItem {
+	Name	 key;										///< The key of the block in //lmdb/www
+	char	 etag		[NUM_ENCODINGS][ETAG_BUFFER_SIZE];	///< The pre-built ETag header of each ENCODING_
+	char	 mime_type	[STATIC_HEADER_SIZE];			///< The pre-built Content-Type header (or empty)
+	char	 language	[STATIC_HEADER_SIZE];			///< The pre-built Content-Language header (or empty)
+	char	 cache_ctrl	[STATIC_HEADER_SIZE];			///< The pre-built Cache-Control header (or empty)
+	pChar	 p_data		[NUM_ENCODINGS];				///< The content in each ENCODING_ (nullptr if not worth compressing)
+	size_t	 size		[NUM_ENCODINGS];				///< The size of each p_data[]
+};
+typedef StaticCacheItem *pStaticCacheItem;				///< A pointer to a StaticCacheItem
+
+/** \brief The state of a response compressed on the fly (created by content_response(), destroyed by MHD via deflate_free())
+
+The response owns the transaction holding the data. Each call of the MHD content reader deflates the next HTTP_STREAM_BLOCK_SIZE (at most)
+compressed bytes, so the compressed result is never staged in memory.
+*/
+struct DeflateStream {
+	z_stream	 strm;									///< The zlib stream (next_in points inside p_txn->p_block)
+	pTransaction p_txn;									///< The transaction owning the data being sent
+	bool		 finished;								///< deflate() returned Z_STREAM_END
+};
+typedef DeflateStream *pDeflateStream;					///< A pointer to a DeflateStream
+
+
+/** \brief The state of an http PUT with a Content-Encoding (kept in q_state.rr_value.p_extra between calls to http_put())
+
+The body is inflated as it arrives into a CELL_TYPE_BYTE block that grows geometrically. Only the used part is kept on the final call.
+*/
+struct InflateUpload {
+	z_stream	 strm;									///< The zlib stream
+	pTransaction p_txn;									///< The transaction with the inflated data (its block may be larger than used)
+	int			 used;									///< The number of bytes of the block already written
+	bool		 finished;								///< inflate() returned Z_STREAM_END
+};
+typedef InflateUpload *pInflateUpload;					///< A pointer to an InflateUpload
+
+
+/** \brief The state of an http PUT of a .raw (text to binary) upload parsed as it arrives (kept in q_state.rr_value.p_extra)
+
+Numeric tensors are parsed by a TextStream as the body arrives. The body is also kept in a block that grows geometrically, but only
+until the first cell decides the TextStream can parse it. If it cannot (strings, Tuples, Kinds, ...), the body is parsed by put() as
+before.
+*/
+struct ParseUpload {
+	pTextStream	 p_stream;								///< The text parser (nullptr when the body is not a numeric tensor)
+	pTransaction p_txn;									///< The body received so far (nullptr once the TextStream has decided)
+	int			 used;									///< The number of bytes of the block already written
+};
+typedef ParseUpload *pParseUpload;						///< A pointer to a ParseUpload
+
+typedef std::map<String, pStaticCacheItem> StaticCache;	///< The static cache: url -> pStaticCacheItem
+typedef std::vector<pStaticCacheItem>	   StaticItems;	///< A list of retired pStaticCacheItem (freed at shut_down())
+
+
 /** \brief API: A Service to manage the REST API.
 
 This service parses and executes http queries. It is aware and redistributes to all the appropriate services. It is called directly by
@@ -138,7 +211,9 @@ class API : public BaseAPI {
 
 		MHD_StatusCode get_static	   (pMHD_Response  &response,
 										pChar			p_url,
-										bool			get_it = true);
+										bool			get_it			  = true,
+										const char	   *p_if_none_match	  = nullptr,
+										const char	   *p_accept_encoding = nullptr);
 
 		// deliver http error pages
 
@@ -151,10 +226,13 @@ class API : public BaseAPI {
 		MHD_StatusCode http_put	   (pChar			p_upload,
 									size_t			size,
 									ApiQueryState  &q_state,
-									int				sequence);
+									int				sequence,
+									const char	   *p_content_encoding = nullptr);
 		MHD_StatusCode http_delete (ApiQueryState  &q_state);
 		MHD_StatusCode http_get	   (pMHD_Response  &response,
-									ApiQueryState  &q_state);
+									ApiQueryState  &q_state,
+									const char	   *p_if_none_match	  = nullptr,
+									const char	   *p_accept_encoding = nullptr);
 
 #ifndef CATCH_TEST
 	private:
@@ -166,12 +244,211 @@ class API : public BaseAPI {
 		bool expand_url_encoded	(pChar	p_buff,
 								 int	buff_size,
 								 pChar	p_url);
+		void add_validators		(pMHD_Response	response,
+								 pStaticBlockHeader p_hea,
+								 const char	   *p_cache_control,
+								 int			encoding = ENCODING_IDENTITY);
+		StatusCode static_cache_add	  (pChar		p_url,
+									   pChar		p_key,
+									   pBlock		p_block);
+		void	   static_cache_retire(pChar		p_key,
+									   pChar		p_url = nullptr);
+		void	   static_cache_clear ();
+		pChar	   compress_buffer	  (pChar		p_data,
+									   size_t		size,
+									   int			encoding,
+									   size_t	   &out_size);
+		bool	   content_response	  (pMHD_Response   &response,
+									   pTransaction		p_txn,
+									   pChar			p_data,
+									   size_t			size,
+									   const char	   *p_accept_encoding,
+									   int			   &encoding);
+		pDeflateStream new_deflate_stream(pTransaction	p_txn,
+										  pChar			p_data,
+										  size_t		size,
+										  int			encoding);
+		MHD_StatusCode inflate_upload (pTransaction	   &p_txn,
+									   pChar			p_upload,
+									   size_t			size,
+									   ApiQueryState   &q_state,
+									   int				sequence);
+		MHD_StatusCode parse_upload	  (pTransaction	   &p_txn,
+									   pChar			p_upload,
+									   size_t			size,
+									   ApiQueryState   &q_state,
+									   int				sequence);
+		bool		   append_upload  (pTransaction	   &p_txn,
+									   int			   &used,
+									   pChar			p_upload,
+									   size_t			size);
+
+		/** Parse the value of a Content-Encoding header of an uploaded body.
+
+			\param p_content_encoding	The value of the header as returned by MHD (or nullptr if the header is not in the request).
+
+			\return ENCODING_IDENTITY, ENCODING_DEFLATE, ENCODING_GZIP or ENCODING_UNSUPPORTED.
+		*/
+		inline int content_encoding(const char *p_content_encoding) {
+			if (p_content_encoding == nullptr || p_content_encoding[0] == 0 || strcasecmp(p_content_encoding, "identity") == 0)
+				return ENCODING_IDENTITY;
+
+			if (strcasecmp(p_content_encoding, "gzip") == 0 || strcasecmp(p_content_encoding, "x-gzip") == 0)
+				return ENCODING_GZIP;
+
+			if (strcasecmp(p_content_encoding, "deflate") == 0)
+				return ENCODING_DEFLATE;
+
+			return ENCODING_UNSUPPORTED;
+		}
+
+		/** Select the Content-Encoding for a response from the value of an Accept-Encoding header.
+
+			\param p_accept_encoding	The value of the header as returned by MHD (or nullptr if the header is not in the request).
+
+			\return ENCODING_GZIP or ENCODING_DEFLATE if the client accepts it (gzip is preferred) or ENCODING_IDENTITY.
+
+		Encodings with q=0 are refused and "*" accepts anything not explicitly refused.
+		*/
+		inline int accepted_encoding(const char *p_accept_encoding) {
+			if (p_accept_encoding == nullptr)
+				return ENCODING_IDENTITY;
+
+			int gzip = -1, deflate = -1, any = -1;
+
+			while (true) {
+				while (*p_accept_encoding == ' ' || *p_accept_encoding == '\t' || *p_accept_encoding == ',')
+					p_accept_encoding++;
+
+				if (*p_accept_encoding == 0)
+					break;
+
+				const char *p_name = p_accept_encoding;
+
+				while (*p_accept_encoding != 0 && *p_accept_encoding != ',' && *p_accept_encoding != ';' && *p_accept_encoding != ' ')
+					p_accept_encoding++;
+
+				int len = p_accept_encoding - p_name;
+
+				while (*p_accept_encoding == ' ' || *p_accept_encoding == ';')
+					p_accept_encoding++;
+
+				double q = 1;
+
+				if (p_accept_encoding[0] == 'q' && p_accept_encoding[1] == '=')
+					q = strtod(p_accept_encoding + 2, nullptr);
+
+				while (*p_accept_encoding != 0 && *p_accept_encoding != ',')
+					p_accept_encoding++;
+
+				if (len == 4 && strncmp(p_name, "gzip", 4) == 0)
+					gzip = q > 0;
+				else if (len == 7 && strncmp(p_name, "deflate", 7) == 0)
+					deflate = q > 0;
+				else if (len == 1 && p_name[0] == '*')
+					any = q > 0;
+			}
+			if (gzip == 1 || (gzip < 0 && any == 1))
+				return ENCODING_GZIP;
+
+			if (deflate == 1 || (deflate < 0 && any == 1))
+				return ENCODING_DEFLATE;
+
+			return ENCODING_IDENTITY;
+		}
+
+		/** Select the Content-Encoding content_response() uses for some data.
+
+			\param size				 The size of the data.
+			\param p_accept_encoding The value of the Accept-Encoding header of the request (or nullptr if none).
+
+			\return ENCODING_IDENTITY if the data is not compressed, else the accepted_encoding().
+		*/
+		inline int response_encoding(size_t size, const char *p_accept_encoding) {
+			if (compress_level == 0 || size < (size_t) compress_min)
+				return ENCODING_IDENTITY;
+
+			return accepted_encoding(p_accept_encoding);
+		}
+
+		/** Writes a strong ETag (the etag_of_block() in hex between double quotes) into a buffer.
+
+			\param p_buff	 A buffer of (at least) ETAG_BUFFER_SIZE chars.
+			\param p_hea	 The header of the block. The tag covers the content and the cell_type, size, rank and range.
+			\param encoding The ENCODING_ of the response. Each Content-Encoding is a different representation with its own ETag: the
+							 compressed ones have a "-df" (deflate) or "-gz" (gzip) suffix.
+		*/
+		inline void as_etag(pChar p_buff, pStaticBlockHeader p_hea, int encoding = ENCODING_IDENTITY) {
+			sprintf(p_buff, "\"%016lx%s\"", etag_of_block(p_hea),
+					encoding == ENCODING_GZIP ? "-gz" : encoding == ENCODING_DEFLATE ? "-df" : "");
+		}
+
+		/** Check if the value of an If-None-Match header matches the ETag of a block.
+
+			\param p_if_none_match	The value of the header as returned by MHD (or nullptr if the header is not in the request).
+			\param p_hea			The header of the block. Blocks without a hash (hash64 == 0) never match.
+			\param encoding			The ENCODING_ of the response that would be sent. (See as_etag().)
+
+			\return true if any of the (comma separated) ETags in the header matches or the header is "*".
+		*/
+		inline bool etag_matches(const char *p_if_none_match, pStaticBlockHeader p_hea, int encoding = ENCODING_IDENTITY) {
+			if (p_if_none_match == nullptr || p_hea->hash64 == 0)
+				return false;
+
+			char tag[ETAG_BUFFER_SIZE];
+			as_etag(tag, p_hea, encoding);
+
+			return etag_matches(p_if_none_match, tag);
+		}
+
+		/** Check if the value of an If-None-Match header matches an ETag already built by as_etag().
+
+			\param p_if_none_match	The value of the header as returned by MHD (or nullptr if the header is not in the request).
+			\param p_tag			The ETag (between double quotes).
+
+			\return true if any of the (comma separated) ETags in the header matches or the header is "*".
+
+		The comparison is weak as defined for If-None-Match (RFC 9110 13.1.2), therefore, a W/ prefix is ignored.
+		*/
+		inline bool etag_matches(const char *p_if_none_match, const char *p_tag) {
+			if (p_if_none_match == nullptr)
+				return false;
+
+			int len = strlen(p_tag);
+
+			while (true) {
+				while (*p_if_none_match == ' ' || *p_if_none_match == '\t' || *p_if_none_match == ',')
+					p_if_none_match++;
+
+				switch (*p_if_none_match) {
+				case 0:
+					return false;
+				case '*':
+					return true;
+				case 'W':
+					if (p_if_none_match[1] == '/')
+						p_if_none_match += 2;
+				}
+				if (strncmp(p_if_none_match, p_tag, len) == 0)
+					return true;
+
+				while (*p_if_none_match != 0 && *p_if_none_match != ',')
+					p_if_none_match++;
+			}
+		}
 
 		pCore		p_core;			///< The Core
 		pModelsAPI	p_model;		///< The ModelsAPI
 
 		Index		www;			///< A map from url to locators to serve static files
 		int			remove_statics;	///< A flag to remove the statics from persistence on shutdown configured by REMOVE_STATICS_ON_CLOSE
+		MapIS		cache_control;	///< Cache-Control values by TenBitsAtAddress(base) configured by HTTP_CACHE_CONTROL_<base>
+		String		cache_ctrl_www;	///< The Cache-Control value for get_static() configured by HTTP_CACHE_CONTROL_STATIC
+		int			static_in_ram;	///< A flag to serve statics from static_cache configured by STATIC_CACHE_IN_RAM
+		StaticCache	static_cache;	///< The statics served from RAM
+		StaticItems	static_retired;	///< The items removed from static_cache that cannot be freed until shut_down()
+		int			compress_min;	///< Responses smaller than this are never compressed configured by HTTP_COMPRESS_MIN_SIZE
+		int			compress_level;	///< The zlib level for compressing responses on the fly (0 disables it) configured by HTTP_COMPRESS_LEVEL
 };
 
 #ifdef CATCH_TEST
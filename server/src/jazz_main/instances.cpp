@@ -59,6 +59,7 @@ using namespace std;
 
 // Services
 
+Pool		POOL	 (&LOGGER, &CONFIG);								///< The threads running the parallel parts of requests
 Channels	CHANNELS (&LOGGER, &CONFIG);								///< The container channeling blocks
 Volatile	VOLATILE (&LOGGER, &CONFIG);								///< The container allocating volatile blocks
 Persisted	PERSISTED(&LOGGER, &CONFIG);								///< The container allocating persisted blocks
@@ -163,7 +164,8 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 
 		int sequence = (*upload_data_size == 0) ? SEQUENCE_FINAL_CALL : SEQUENCE_INCREMENT_CALL;
 
-		switch (HTTP_API.http_put((pChar) upload_data, *upload_data_size, q_state, sequence)) {
+		switch (HTTP_API.http_put((pChar) upload_data, *upload_data_size, q_state, sequence,
+								  MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_CONTENT_ENCODING))) {
 		case MHD_HTTP_CREATED:
 			goto create_response_answer_put_ok;
 
@@ -206,6 +208,8 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 #endif
 
 	MHD_StatusCode status;
+	const char	  *if_none_match;			// Not initialized to support the goto logic. Set by HTTP_HEAD and HTTP_GET.
+	const char	  *accept_encoding;			// Not initialized to support the goto logic. Set by HTTP_HEAD and HTTP_GET.
 
 	switch (http_method) {
 	case HTTP_NOTUSED:
@@ -245,9 +249,14 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 
 	case HTTP_HEAD:
 	case HTTP_GET:
+		if_none_match	= MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+		accept_encoding = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+
 		if (url[0] != '/' || url[1] != '/') {
 
-			if ((status = HTTP_API.get_static(response, (pChar) url)) != MHD_HTTP_OK)
+			status = HTTP_API.get_static(response, (pChar) url, true, if_none_match, accept_encoding);
+
+			if (status != MHD_HTTP_OK && status != MHD_HTTP_NOT_MODIFIED)
 				return HTTP_API.return_error_message(connection, (pChar) url, status);
 
 			goto answer_status;
@@ -274,7 +283,8 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 
 	switch (http_method) {
 	case HTTP_PUT:
-		status = HTTP_API.http_put((pChar) upload_data, *upload_data_size, q_state, SEQUENCE_FIRST_CALL);
+		status = HTTP_API.http_put((pChar) upload_data, *upload_data_size, q_state, SEQUENCE_FIRST_CALL,
+								   MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_CONTENT_ENCODING));
 
 		break;
 
@@ -285,7 +295,7 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 
 	default:
 
-		status = HTTP_API.http_get(response, q_state);
+		status = HTTP_API.http_get(response, q_state, if_none_match, accept_encoding);
 	}
 
 	// Step 6 : The core finished, just distribute the answer as appropriate.
@@ -300,7 +310,7 @@ MHD_Result http_request_callback(void *cls, struct MHD_Connection *connection, c
 		}
 	}
 
-	if (status != MHD_HTTP_OK)
+	if (status != MHD_HTTP_OK && status != MHD_HTTP_NOT_MODIFIED)
 		return HTTP_API.return_error_message(connection, (pChar) url, status);
 
 	if (http_method == HTTP_DELETE)
@@ -458,6 +468,8 @@ void signalHandler_SIGTERM(int signum) {
 	if (!stop_service(&VOLATILE))   stop_ok = false;
 	if (!stop_service(&CHANNELS))   stop_ok = false;
 
+	if (!stop_service(&POOL))	    stop_ok = false;
+
 #endif
 
 	if (stop_ok) exit(EXIT_SUCCESS); else exit(EXIT_FAILURE);
@@ -71,6 +71,10 @@ using namespace jazz_models;
 
 #ifndef CATCH_TEST
 
+// Parallel parts of requests:
+
+extern Pool		 POOL;			///< The threads running the parallel parts of requests.
+
 // Block containers:
 
 extern Channels	 CHANNELS;		///< The container channeling blocks.
@@ -75,13 +75,17 @@ void show_credits() {
 /** Explain usage of the command line interface to stdout.
 */
 void show_usage() {
-	cout << "\x20 usage: jazz <config> start | stop | status" << endl << endl
+	cout << "\x20 usage: jazz <config> start | stop | status" << endl
+		 << "\x20 \x20 \x20 \x20 jazz <config> dump <file> <entity> [<entity> ...] [--codec=<codec>]" << endl
+		 << "\x20 \x20 \x20 \x20 jazz <config> restore <file> [<entity>]" << endl << endl
 
 		 << " <config>: A configuration file for the server in case of command start." << endl
 		 << "\x20 \x20 \x20 \x20 \x20\x20 by default, Jazz will try to load: " << JAZZ_DEFAULT_CONFIG_PATH << endl
 		 << "\x20 start\x20 : Start the jazz server." << endl
 		 << "\x20 stop \x20 : Stop the jazz server." << endl
-		 << "\x20 status : Just check if server is running." << endl;
+		 << "\x20 status : Just check if server is running." << endl
+		 << "\x20 dump \x20 : Append the blocks of the persisted entities to a block-log file (none, lz, deflate, delta, xor or auto)." << endl
+		 << "\x20 restore: Write the blocks of a block-log file (of all its entities or just one) into persistence." << endl;
 }
 
 
@@ -94,11 +98,105 @@ int parse_command(const char *arg) {
 	if (!strcmp("start",  arg)) return CMD_START;
 	if (!strcmp("stop",	  arg)) return CMD_STOP;
 	if (!strcmp("status", arg)) return CMD_STATUS;
+	if (!strcmp("dump",	  arg)) return CMD_DUMP;
+	if (!strcmp("restore", arg)) return CMD_RESTORE;
 
 	return CMD_HELP;
 }
 
 
+/** Load a configuration file given in the command line into CONFIG.
+
+	\param path The path of the configuration file.
+	\return true if the file exists and could be parsed, else message + false.
+*/
+bool load_config(const char *path) {
+	if (!jazz_elements::FileExists(path)) {
+		cout << "The file " << path << " does not exist." << endl;
+
+		return false;
+	}
+	if (!CONFIG.load_config(path)) {
+		cout << "The configuration file " << path << " could not be parsed." << endl;
+
+		return false;
+	}
+	cout << endl
+		 << "**NOTE:** The configuration file " << path << " has been loaded." << endl
+		 << "---------" << endl << endl;
+
+	return true;
+}
+
+
+/** Run the commands dump and restore starting just the Persisted service (no http server).
+
+	\param cmd  CMD_DUMP or CMD_RESTORE.
+	\param argc The number of arguments after the command.
+	\param argv The arguments after the command: the block-log file followed by the entities and (for dump) an optional --codec=<codec>.
+
+	\return EXIT_FAILURE or EXIT_SUCCESS
+
+	dump appends all the blocks of each entity to the file (see Persisted::dump()), restore writes the blocks of the file, of all its
+	entities or just the one given, into persistence (see Persisted::restore()). The number of blocks of each entity is written to stdout.
+*/
+int dump_restore(int cmd, int argc, char* argv[]) {
+	if (!start_service(&POOL))
+		return EXIT_FAILURE;
+
+	if (!start_service(&PERSISTED)) {
+		stop_service(&POOL);
+
+		return EXIT_FAILURE;
+	}
+
+	pChar path = argv[0];
+	int codec  = PERSISTED_CODEC_NONE;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strncmp("--codec=", argv[i], 8)) {
+			codec = PERSISTED.codec_by_name(argv[i] + 8);
+			if (codec < 0) {
+				cout << "Unknown codec \"" << argv[i] + 8 << "\"." << endl;
+				stop_service(&PERSISTED);
+				stop_service(&POOL);
+
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	int64_t num_blocks;
+	StatusCode ret = SERVICE_NO_ERROR;
+
+	if (cmd == CMD_RESTORE) {
+		pChar entity = argc > 1 ? argv[1] : nullptr;
+
+		ret = PERSISTED.restore(path, entity, num_blocks);
+
+		if (ret == SERVICE_NO_ERROR)
+			cout << num_blocks << " blocks restored from " << path << "." << endl;
+	} else {
+		for (int i = 1; i < argc && ret == SERVICE_NO_ERROR; i++) {
+			if (!strncmp("--codec=", argv[i], 8))
+				continue;
+
+			ret = PERSISTED.dump(path, argv[i], codec, num_blocks);
+
+			if (ret == SERVICE_NO_ERROR)
+				cout << num_blocks << " blocks of \"" << argv[i] << "\" dumped to " << path << "." << endl;
+		}
+	}
+	if (ret != SERVICE_NO_ERROR)
+		cout << "Failed with status code " << ret << "." << endl;
+
+	stop_service(&PERSISTED);
+	stop_service(&POOL);
+
+	return ret == SERVICE_NO_ERROR ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
 /** Entry point.
 
 \param argc (Linux) number of arguments, counting the name of the executable.
@@ -121,14 +219,26 @@ When the command is "status":
 	if not running already, message + EXIT_FAILURE
 	else message + EXIT_SUCCESS
 
+When the command is "dump" or "restore":
+	if running already, message + EXIT_FAILURE (LMDB may run with MDB_NOLOCK, use the API //lmdb/entity/~dump:path instead)
+	else try to dump or restore calling dump_restore()
+
 When the command is anything else, too many or too few:
 	show help + EXIT_FAILURE
 
 */
 int main(int argc, char* argv[]) {
-	int cmd = (argc < 2 || argc > 3) ? CMD_HELP : parse_command(argv[argc - 1]);
+	int pos = 1, cmd = argc < 2 ? CMD_HELP : parse_command(argv[1]);
 
-	if (cmd == CMD_HELP || argc == 3 && cmd != CMD_START) {
+	if (cmd == CMD_HELP && argc > 2) {
+		pos = 2;
+		cmd = parse_command(argv[2]);
+	}
+
+	int num_args = argc - pos - 1;
+
+	if (cmd == CMD_HELP || (cmd == CMD_DUMP && num_args < 2) || (cmd == CMD_RESTORE && (num_args < 1 || num_args > 2))
+		|| (cmd < CMD_DUMP && (num_args != 0 || (pos == 2 && cmd != CMD_START)))) {
 		show_credits();
 		show_usage();
 
@@ -150,6 +260,18 @@ int main(int argc, char* argv[]) {
 
 	jzzPID = jazz_elements::FindProcessIdByName(proc_name.c_str());
 
+	if (cmd == CMD_DUMP || cmd == CMD_RESTORE) {
+		if (jzzPID) {
+			cout << "The process \"" << proc_name << "\" is running with pid = " << jzzPID << ", use the API instead." << endl;
+
+			exit(EXIT_FAILURE);
+		}
+		if (pos == 2 && !load_config(argv[1]))
+			exit(EXIT_FAILURE);
+
+		exit(dump_restore(cmd, num_args, &argv[pos + 1]));
+	}
+
 	if (!jzzPID) {
 		if (cmd != CMD_START) {
 			cout << "The process \"" << proc_name << "\" is not running." << endl;
@@ -157,30 +279,24 @@ int main(int argc, char* argv[]) {
 			exit(EXIT_FAILURE);
 		}
 
-		if (argc == 3) {
-			if (!jazz_elements::FileExists(argv[1])) {
-				cout << "The file " << argv[1] << " does not exist." << endl;
+		if (pos == 2 && !load_config(argv[1]))
+			exit(EXIT_FAILURE);
 
-				exit(EXIT_FAILURE);
-			}
-			if (!CONFIG.load_config(argv[1])) {
-				cout << "The configuration file " << argv[1] << " could not be parsed." << endl;
+		show_credits();
 
-				exit(EXIT_FAILURE);
-			}
-			cout << endl
-				 << "**NOTE:** The configuration file " << argv[1] << " has been loaded." << endl
-				 << "---------" << endl << endl;
+		if (!start_service(&POOL)) {
+			exit(EXIT_FAILURE);
 		}
 
-		show_credits();
-
 		if (!start_service(&CHANNELS)) {
+			stop_service(&POOL);
+
 			exit(EXIT_FAILURE);
 		}
 
 		if (!start_service(&VOLATILE)) {
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 
 			exit(EXIT_FAILURE);
 		}
@@ -188,6 +304,7 @@ int main(int argc, char* argv[]) {
 		if (!start_service(&PERSISTED)) {
 			stop_service(&VOLATILE);
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 
 			exit(EXIT_FAILURE);
 		}
@@ -196,6 +313,7 @@ int main(int argc, char* argv[]) {
 			stop_service(&PERSISTED);
 			stop_service(&VOLATILE);
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 
 			exit(EXIT_FAILURE);
 		}
@@ -205,6 +323,7 @@ int main(int argc, char* argv[]) {
 			stop_service(&PERSISTED);
 			stop_service(&VOLATILE);
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 
 			exit(EXIT_FAILURE);
 		}
@@ -215,6 +334,7 @@ int main(int argc, char* argv[]) {
 			stop_service(&PERSISTED);
 			stop_service(&VOLATILE);
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 
 			exit(EXIT_FAILURE);
 		}
@@ -230,6 +350,7 @@ int main(int argc, char* argv[]) {
 			stop_service(&PERSISTED);
 			stop_service(&VOLATILE);
 			stop_service(&CHANNELS);
+			stop_service(&POOL);
 		}
 
 		exit(ret_code);
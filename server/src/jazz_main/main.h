@@ -64,5 +64,7 @@
 #define CMD_START		1	///< Command 'start' as a numerical constant (see parse_arg())
 #define CMD_STOP		2	///< Command 'stop' as a numerical constant (see parse_arg())
 #define CMD_STATUS		3	///< Command 'status' as a numerical constant (see parse_arg())
+#define CMD_DUMP		4	///< Command 'dump' as a numerical constant (see parse_arg())
+#define CMD_RESTORE		5	///< Command 'restore' as a numerical constant (see parse_arg())
 
 #endif // ifndef INCLUDED_JAZZ_MAIN_MAIN
@@ -127,11 +127,12 @@ void ModelsAPI::base_names(BaseNames &base_names) {
 
 	\return	SERVICE_NO_ERROR on success (and a valid p_txn), or some negative value (error).
 
-It should support the range from APPLY_NOTHING to APPLY_TEXT. This includes function calls APPLY_FUNCTION and APPLY_FUNCT_CONST,
+It should support the range from APPLY_NOTHING to APPLY_SLICE. This includes function calls APPLY_FUNCTION and APPLY_FUNCT_CONST,
 but also APPLY_FILTER and APPLY_FILT_CONST to select from the result of a function call. Also, APPLY_URL is very convenient for
 passing text as an argument to a function. APPLY_NOTHING can return some metadata about the model including a list of endpoints.
-APPLY_NAME can define specifics of an endpoint. APPLY_RAW and APPLY_TEXT can be used to select the favorite serialization format
-of the result. Therefore, the function interface should be considered as the whole range and not just APPLY_FUNCTION.
+APPLY_NAME can define specifics of an endpoint. APPLY_RAW, APPLY_TEXT, APPLY_ARROW and APPLY_NPY can be used to select the favorite
+serialization format of the result. Therefore, the function interface should be considered as the whole range and not just
+APPLY_FUNCTION.
 */
 StatusCode ModelsAPI::get(pTransaction &p_txn, ApiQueryState &what) {
 